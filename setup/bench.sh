@@ -0,0 +1,33 @@
+#!/bin/bash
+
+#
+# runs the benchmark scripts with and without the loop optimisations
+# @author Tobias Weber (orcid: 0000-0002-7230-1932)
+# @date 18-oct-2026
+# @license see 'LICENSE.EUPL' file
+#
+# usage, from the build directory: ../setup/bench.sh [--jit]
+#
+
+script_run=./script_run
+bench_dir=$(dirname "$0")/../script_tests/bench
+
+if [ ! -x "${script_run}" ]; then
+	echo "${script_run} not found, please run this script from the build directory."
+	exit -1
+fi
+
+
+for script in "${bench_dir}"/*.scr; do
+	echo -e "\n${script}:"
+
+	for opts in "" "--no-loop-opt"; do
+		if [ "${opts}" = "" ]; then
+			echo -n "    optimised loops: "
+		else
+			echo -n "    plain loops:     "
+		fi
+
+		${script_run} "$@" ${opts} "${script}" 2>&1 | grep "VM execution time"
+	done
+done
@@ -118,6 +118,9 @@ class ASTBase
 public:
 	using t_line_range = std::pair<std::size_t, std::size_t>;
 
+	// character offsets [begin, end) in the source
+	using t_source_range = std::pair<std::size_t, std::size_t>;
+
 
 public:
 	ASTBase(std::size_t id, std::optional<std::size_t> tableidx=std::nullopt)
@@ -147,6 +150,19 @@ public:
 		m_line_range = lines;
 	}
 
+	virtual const std::optional<t_source_range>& GetSourceRange() const
+	{
+		return m_source_range;
+	}
+	virtual void SetSourceRange(const t_source_range& range)
+	{
+		m_source_range = range;
+	}
+	virtual void SetSourceRange(const std::optional<t_source_range>& range)
+	{
+		m_source_range = range;
+	}
+
 	virtual VMType GetDataType() const { return m_datatype; }
 	virtual void SetDataType(VMType ty) { m_datatype = ty; }
 
@@ -247,6 +263,9 @@ private:
 
 	// line number range
 	std::optional<t_line_range> m_line_range{std::nullopt};
+
+	// range of characters in the source
+	std::optional<t_source_range> m_source_range{std::nullopt};
 };
 
 
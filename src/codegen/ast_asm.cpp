@@ -50,6 +50,13 @@ ASTAsm::ASTAsm(std::ostream& ostr,
 }
 
 
+ASTAsm::ASTAsm(CodeBuilder& code,
+	std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops)
+	: m_code{&code}, m_ops{ops}, m_binary{true}
+{
+}
+
+
 void ASTAsm::visit(
 	[[maybe_unused]] const ASTToken<t_lval>* ast,
 	[[maybe_unused]] std::size_t level)
@@ -67,13 +74,7 @@ void ASTAsm::visit(const ASTToken<t_real>* ast,
 
 	if(m_binary)
 	{
-		//m_ostr->put(std::to_underlying(OpCode::PUSH));
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-		// write type descriptor byte
-		m_ostr->put(static_cast<t_vm_byte>(VMType::REAL));
-		// write value
-		m_ostr->write(reinterpret_cast<const char*>(&val),
-			vm_type_size<VMType::REAL, false>);
+		m_code->PushReal(val);
 	}
 	else
 	{
@@ -91,13 +92,7 @@ void ASTAsm::visit(const ASTToken<t_int>* ast,
 
 	if(m_binary)
 	{
-		//m_ostr->put(std::to_underlying(OpCode::PUSH));
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-		// write type descriptor byte
-		m_ostr->put(static_cast<t_vm_byte>(VMType::INT));
-		// write data
-		m_ostr->write(reinterpret_cast<const char*>(&val),
-			vm_type_size<VMType::INT, false>);
+		m_code->PushInt(val);
 	}
 	else
 	{
@@ -135,9 +130,9 @@ void ASTAsm::visit(const ASTToken<std::string>* ast,
 				// in global scope
 				if(m_cur_func == "")
 				{
+					m_glob_stack += get_vm_type_size(symty, true);
 					sym = m_symtab.AddSymbol(varname, -m_glob_stack,
 						VMType::ADDR_GBP, symty);
-					m_glob_stack += get_vm_type_size(symty, true);
 
 					//std::cout << "added global symbol \""
 					//	<< varname << "\" with size "
@@ -148,8 +143,9 @@ void ASTAsm::visit(const ASTToken<std::string>* ast,
 				// in local function scope
 				else
 				{
+					// the top of the stack frame holds its size
 					if(m_local_stack.find(m_cur_func) == m_local_stack.end())
-						m_local_stack[m_cur_func] = 0;
+						m_local_stack[m_cur_func] = vm_type_size<VMType::ADDR_MEM, false>;
 
 					m_local_stack[m_cur_func] += get_vm_type_size(symty, true);
 					sym = m_symtab.AddSymbol(varname, -m_local_stack[m_cur_func],
@@ -166,30 +162,18 @@ void ASTAsm::visit(const ASTToken<std::string>* ast,
 			//	<< int(sym->addr) << " of symbol " << "\"" << varname << "\""
 			//	<< "." << std::endl;
 
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-			// register with base address
-			m_ostr->put(static_cast<t_vm_byte>(sym->loc));
-			// relative address
-			m_ostr->write(reinterpret_cast<const char*>(&sym->addr),
-				vm_type_size<VMType::ADDR_BP, false>);
+			// relative address with the register holding the base address
+			m_code->PushAddr(sym->loc, sym->addr);
 
 			// dereference it, if the variable is on the rhs of an assignment
 			if(!ast->IsLValue() && !sym->is_func)
-				m_ostr->put(static_cast<t_vm_byte>(OpCode::RDMEM));
+				m_code->Op(OpCode::RDMEM);
 		}
 
 		// the token names a string literal
 		else
 		{
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-			// write type descriptor byte
-			m_ostr->put(static_cast<t_vm_byte>(VMType::STR));
-			// write string length
-			t_vm_addr len = static_cast<t_vm_addr>(val.length());
-			m_ostr->write(reinterpret_cast<const char*>(&len),
-				vm_type_size<VMType::ADDR_MEM, false>);
-			// write string data
-			m_ostr->write(val.data(), len);
+			m_code->PushStr(val);
 		}
 	}
 	else
@@ -243,7 +227,7 @@ void ASTAsm::visit(const ASTUnary* ast, [[maybe_unused]] std::size_t level)
 			op = OpCode::NOP;
 		else if(op == OpCode::SUB)
 			op = OpCode::USUB;
-		m_ostr->put(static_cast<t_vm_byte>(op));
+		m_code->Op(op);
 	}
 	else
 	{
@@ -275,11 +259,11 @@ void ASTAsm::visit(const ASTBinary* ast, [[maybe_unused]] std::size_t level)
 			if(m_binary)
 			{
 				if(ty == VMType::STR)
-					m_ostr->put(static_cast<t_vm_byte>(OpCode::TOS));
+					m_code->Op(OpCode::TOS);
 				else if(ty == VMType::INT)
-					m_ostr->put(static_cast<t_vm_byte>(OpCode::TOI));
+					m_code->Op(OpCode::TOI);
 				else if(ty == VMType::REAL)
-					m_ostr->put(static_cast<t_vm_byte>(OpCode::TOF));
+					m_code->Op(OpCode::TOF);
 			}
 			else
 			{
@@ -299,7 +283,7 @@ void ASTAsm::visit(const ASTBinary* ast, [[maybe_unused]] std::size_t level)
 		OpCode op = std::get<OpCode>(m_ops->at(opid));
 		if(op != OpCode::INVALID)	// use opcode directly
 		{
-			m_ostr->put(static_cast<t_vm_byte>(op));
+			m_code->Op(op);
 		}
 		else
 		{
@@ -332,23 +316,18 @@ void ASTAsm::visit(const ASTCondition* ast, [[maybe_unused]] std::size_t level)
 	std::size_t labelEndCond = m_glob_label++;
 	std::size_t labelEndIf = m_glob_label++;
 
-	t_vm_addr skipEndCond = 0;         // how many bytes to skip to jump to end of the if block?
-	t_vm_addr skipEndIf = 0;           // how many bytes to skip to jump to end of the entire if statement?
-	std::streampos skip_addr = 0;      // stream position with the condition jump label
-	std::streampos skip_else_addr = 0; // stream position with the if block jump label
+	CodeBuilder::Label endCond, endIf;   // end of the if block and of the entire if statement
 
 	if(m_binary)
 	{
+		endCond = m_code->NewLabel();
+		endIf = m_code->NewLabel();
+
 		// if the condition is not fulfilled...
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::NOT));
+		m_code->Op(OpCode::NOT);
 
 		// ...skip to the end of the if block
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-		m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-		skip_addr = m_ostr->tellp();
-		m_ostr->write(reinterpret_cast<const char*>(&skipEndCond),
-			vm_type_size<VMType::ADDR_IP, false>);
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::JMPCND));
+		m_code->Jump(OpCode::JMPCND, endCond);
 	}
 	else
 	{
@@ -358,19 +337,13 @@ void ASTAsm::visit(const ASTCondition* ast, [[maybe_unused]] std::size_t level)
 	}
 
 	// if block
-	std::streampos before_if_block = m_ostr->tellp();
 	ast->GetIfBlock()->accept(this, level+1);
 	if(ast->GetElseBlock())
 	{
 		if(m_binary)
 		{
 			// skip to end of if statement if there's an else block
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-			m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-			skip_else_addr = m_ostr->tellp();
-			m_ostr->write(reinterpret_cast<const char*>(&skipEndIf),
-				vm_type_size<VMType::ADDR_IP, false>);
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::JMP));
+			m_code->Jump(OpCode::JMP, endIf);
 		}
 		else
 		{
@@ -378,42 +351,21 @@ void ASTAsm::visit(const ASTCondition* ast, [[maybe_unused]] std::size_t level)
 			(*m_ostr) << "jmp\n";
 		}
 	}
-	std::streampos after_if_block = m_ostr->tellp();
 
 	if(m_binary)
-	{
-		// go back and fill in missing number of bytes to skip
-		skipEndCond = after_if_block - before_if_block;
-		m_ostr->seekp(skip_addr);
-		m_ostr->write(reinterpret_cast<const char*>(&skipEndCond),
-			vm_type_size<VMType::ADDR_IP, false>);
-		m_ostr->seekp(after_if_block);
-	}
+		m_code->Bind(endCond);
 	else
-	{
 		(*m_ostr) << "end_cond_" << labelEndCond << ":" << std::endl;
-	}
 
 	// else block
 	if(ast->GetElseBlock())
 	{
-		std::streampos before_else_block = m_ostr->tellp();
 		ast->GetElseBlock()->accept(this, level+1);
-		std::streampos after_else_block = m_ostr->tellp();
 
 		if(m_binary)
-		{
-			// go back and fill in missing number of bytes to skip
-			skipEndIf = after_else_block - before_else_block;
-			m_ostr->seekp(skip_else_addr);
-			m_ostr->write(reinterpret_cast<const char*>(&skipEndIf),
-				vm_type_size<VMType::ADDR_IP, false>);
-			m_ostr->seekp(after_else_block);
-		}
+			m_code->Bind(endIf);
 		else
-		{
 			(*m_ostr) << "end_if_" << labelEndIf << ":" << std::endl;
-		}
 	}
 }
 
@@ -424,30 +376,27 @@ void ASTAsm::visit(const ASTLoop* ast, [[maybe_unused]] std::size_t level)
 
 	std::ostringstream ostrLabel;
 	ostrLabel << "loop_" << labelLoop;
-	m_cur_loop.push_back(ostrLabel.str());
-
-	std::streampos loop_begin = m_ostr->tellp();
 
-	if(!m_binary)
+	LoopInfo loop{ .name = ostrLabel.str() };
+	if(m_binary)
+	{
+		loop.begin = m_code->NewLabel();
+		loop.end = m_code->NewLabel();
+		m_code->Bind(loop.begin);
+	}
+	else
 	{
 		(*m_ostr) << "begin_loop_" << labelLoop << ":" << std::endl;
 	}
+	m_cur_loop.push_back(loop);
 
 	ast->GetCondition()->accept(this, level+1); // condition
 
-	t_vm_addr skip = 0;  // how many bytes to skip to jump to end of the block?
-	std::streampos skip_addr = 0;
-
 	if(m_binary)
 	{
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::NOT));
-
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-		m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-		skip_addr = m_ostr->tellp();
-		m_ostr->write(reinterpret_cast<const char*>(&skip),
-			vm_type_size<VMType::ADDR_IP, false>);
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::JMPCND));
+		// skip to the end of the block
+		m_code->Op(OpCode::NOT);
+		m_code->Jump(OpCode::JMPCND, loop.end);
 	}
 	else
 	{
@@ -456,67 +405,13 @@ void ASTAsm::visit(const ASTLoop* ast, [[maybe_unused]] std::size_t level)
 		(*m_ostr) << "jmpcnd\n";
 	}
 
-	std::streampos before_block = m_ostr->tellp();
 	ast->GetBlock()->accept(this, level+1); // block
 
 	if(m_binary)
 	{
-		// loop back
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-		m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-		std::streampos after_block = m_ostr->tellp();
-		skip = after_block - before_block;
-		t_vm_addr skip_back = loop_begin - after_block;
-		skip_back -= vm_type_size<VMType::ADDR_IP, true>; // include the next two writes
-		m_ostr->write(reinterpret_cast<const char*>(&skip_back),
-			vm_type_size<VMType::ADDR_IP, false>);
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::JMP));
-
-		// go back and fill in missing number of bytes to skip
-		after_block = m_ostr->tellp();
-		skip = after_block - before_block;
-		m_ostr->seekp(skip_addr);
-		m_ostr->write(reinterpret_cast<const char*>(&skip),
-			vm_type_size<VMType::ADDR_IP, false>);
-
-		// fill in any saved, unset start-of-loop jump addresses (continues)
-		while(true)
-		{
-			auto iter = m_loop_begin_comefroms.find(ostrLabel.str());
-			if(iter == m_loop_begin_comefroms.end())
-				break;
-
-			std::streampos pos = iter->second;
-			m_loop_begin_comefroms.erase(iter);
-
-			t_vm_addr to_skip = loop_begin - pos;
-			// already skipped over address and jmp instruction
-			to_skip -= vm_type_size<VMType::ADDR_IP, true>;
-			m_ostr->seekp(pos);
-			m_ostr->write(reinterpret_cast<const char*>(&to_skip),
-				vm_type_size<VMType::ADDR_IP, false>);
-		}
-
-		// fill in any saved, unset end-of-loop jump addresses (breaks)
-		while(true)
-		{
-			auto iter = m_loop_end_comefroms.find(ostrLabel.str());
-			if(iter == m_loop_end_comefroms.end())
-				break;
-
-			std::streampos pos = iter->second;
-			m_loop_end_comefroms.erase(iter);
-
-			t_vm_addr to_skip = after_block - pos;
-			// already skipped over address and jmp instruction
-			to_skip -= vm_type_size<VMType::ADDR_IP, true>;
-			m_ostr->seekp(pos);
-			m_ostr->write(reinterpret_cast<const char*>(&to_skip),
-				vm_type_size<VMType::ADDR_IP, false>);
-		}
-
-		// go to end of stream
-		m_ostr->seekp(after_block);
+		// loop back, continues and breaks jump to the same labels
+		m_code->Jump(OpCode::JMP, loop.begin);
+		m_code->Bind(loop.end);
 	}
 	else
 	{
@@ -542,18 +437,13 @@ void ASTAsm::visit(const ASTFunc* ast, [[maybe_unused]] std::size_t level)
 	// number of function arguments
 	t_vm_int num_args = static_cast<t_vm_int>(ast->NumArgs());
 
-	std::streampos jmp_end_streampos;
-	t_vm_addr end_func_addr = 0;
+	CodeBuilder::Label end_func;
 
 	if(m_binary)
 	{
 		// jump to the end of the function to prevent accidental execution
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-		m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-		jmp_end_streampos = m_ostr->tellp();
-		m_ostr->write(reinterpret_cast<const char*>(&end_func_addr),
-			vm_type_size<VMType::ADDR_IP, false>);
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::JMP));
+		end_func = m_code->NewLabel();
+		m_code->Jump(OpCode::JMP, end_func);
 	}
 	else
 	{
@@ -585,13 +475,26 @@ void ASTAsm::visit(const ASTFunc* ast, [[maybe_unused]] std::size_t level)
 	}
 
 
-	std::streampos before_block = m_ostr->tellp();
+	t_vm_addr before_block = 0;
+	t_vm_addr framesize_pos = 0;
 
 	if(m_binary)
 	{
 		// add function to symbol table
+		before_block = m_code->GetPos();
+		m_code->Bind(GetFuncLabel(func_name));
 		m_symtab.AddSymbol(func_name, before_block, VMType::ADDR_MEM, VMType::UNKNOWN, true, num_args);
 		//std::cout << "function " << func_name << " at address " << before_block << std::endl;
+
+		// set the size of the stack frame, it is known after the function's block
+		m_code->Op(OpCode::FRAME);
+		framesize_pos = m_code->Reserve<t_vm_addr>();
+
+		m_cur_func_ret = m_code->NewLabel();
+	}
+	else
+	{
+		(*m_ostr) << "frame " << func_name << "_framesize\n";
 	}
 
 	ast->GetBlock()->accept(this, level+1); // block
@@ -599,34 +502,20 @@ void ASTAsm::visit(const ASTFunc* ast, [[maybe_unused]] std::size_t level)
 
 	if(m_binary)
 	{
-		std::streampos ret_streampos = m_ostr->tellp();
-
 		// push number of arguments and return
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-		m_ostr->put(static_cast<t_vm_byte>(VMType::INT));
-		m_ostr->write(reinterpret_cast<const char*>(&num_args),
-			vm_type_size<VMType::INT, false>);
-		m_ostr->put(static_cast<t_vm_byte>(OpCode::RET));
-
-		// fill in end-of-function jump address
-		std::streampos end_func_streampos = m_ostr->tellp();
-		end_func_addr = end_func_streampos - before_block;
-		m_ostr->seekp(jmp_end_streampos);
-		m_ostr->write(reinterpret_cast<const char*>(&end_func_addr),
-			vm_type_size<VMType::ADDR_IP, false>);
-
-		// fill in any saved, unset end-of-function jump addresses
-		for(std::streampos pos : m_endfunc_comefroms)
-		{
-			t_vm_addr to_skip = ret_streampos - pos;
-			// already skipped over address and jmp instruction
-			to_skip -= vm_type_size<VMType::ADDR_IP, true>;
-			m_ostr->seekp(pos);
-			m_ostr->write(reinterpret_cast<const char*>(&to_skip),
-				vm_type_size<VMType::ADDR_IP, false>);
-		}
-		m_endfunc_comefroms.clear();
-		m_ostr->seekp(end_func_streampos);
+		m_code->Bind(m_cur_func_ret);
+		m_code->PushInt(num_args);
+		m_code->Op(OpCode::RET);
+
+		// fill in the size of the stack frame for the local variables
+		t_vm_addr framesize = vm_type_size<VMType::ADDR_MEM, false>;
+		if(auto iter = m_local_stack.find(func_name); iter != m_local_stack.end())
+			framesize = iter->second;
+		m_symtab.AddSymbol(func_name, before_block, VMType::ADDR_MEM, VMType::UNKNOWN,
+			true, num_args, framesize);
+		m_code->Patch(framesize_pos, framesize);
+
+		m_code->Bind(end_func);
 	}
 	else
 	{
@@ -653,36 +542,45 @@ void ASTAsm::visit(const ASTFuncCall* ast, [[maybe_unused]] std::size_t level)
 
 	if(m_binary)
 	{
-		// call external function
-		if(is_external_func)
+		// call external function via its index
+		if(std::optional<t_vm_addr> func_idx = GetExternalFuncIndex(func_name);
+			is_external_func && func_idx)
+		{
+			// check number of arguments of built-in functions
+			if(*func_idx < static_cast<t_vm_addr>(ExtFunc::NUM_BUILTIN))
+			{
+				t_vm_int func_args = get_vm_extfunc_num_args(static_cast<ExtFunc>(*func_idx));
+				if(num_args != func_args)
+				{
+					std::ostringstream msg;
+					msg << "External function \"" << func_name << "\" takes " << func_args
+						<< " arguments, but " << num_args << " were given.";
+					throw_err(ast, msg.str());
+				}
+			}
+
+			// write function index
+			m_code->Op(OpCode::EXTCALLI);
+			m_code->Raw(*func_idx);
+		}
+
+		// call external function via its name
+		else if(is_external_func)
 		{
 			// push external function name
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-			// write type descriptor byte
-			m_ostr->put(static_cast<t_vm_byte>(VMType::STR));
-			// write function name
-			t_vm_addr len = static_cast<t_vm_addr>(func_name.length());
-			m_ostr->write(reinterpret_cast<const char*>(&len),
-				vm_type_size<VMType::ADDR_MEM, false>);
-			// write string data
-			m_ostr->write(func_name.data(), len);
+			m_code->PushStr(func_name);
 
 			// TODO: check number of arguments
 
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::EXTCALL));
+			m_code->Op(OpCode::EXTCALL);
 		}
 
 		// call internal function
 		else
 		{
-			// get function address and push it
-			const SymInfo *sym = m_symtab.GetSymbol(func_name);
-			t_vm_addr func_addr = 0;
-			if(sym)
+			// check the arguments if the function is already known
+			if(const SymInfo *sym = m_symtab.GetSymbol(func_name); sym)
 			{
-				// function address already known
-				func_addr = sym->addr;
-
 				if(num_args != sym->num_args)
 				{
 					std::ostringstream msg;
@@ -691,37 +589,25 @@ void ASTAsm::visit(const ASTFuncCall* ast, [[maybe_unused]] std::size_t level)
 					throw_err(ast, msg.str());
 				}
 			}
-
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH));
-	#if AST_ABS_FUNC_ADDR != 0
-			// push absolute function address
-			m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_MEM));
-			std::streampos addr_pos = m_ostr->tellp();
-			m_ostr->write(reinterpret_cast<const char*>(&func_addr),
-				vm_type_size<VMType::ADDR_MEM, false>);
-	#else
-			// push relative function address
-			m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-			// already skipped over address and jmp instruction
-			std::streampos addr_pos = m_ostr->tellp();
-			t_vm_addr to_skip = static_cast<t_vm_addr>(func_addr - addr_pos);
-			to_skip -= vm_type_size<VMType::ADDR_IP, true>;
-			m_ostr->write(reinterpret_cast<const char*>(&to_skip),
-				vm_type_size<VMType::ADDR_IP, false>);
-	#endif
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::CALL));
-
-			if(!sym)
+			else
 			{
-				// function address not yet known
-				m_func_comefroms.emplace_back(
-					std::make_tuple(func_name, addr_pos, num_args, ast));
+				m_func_comefroms.emplace_back(std::make_tuple(func_name, num_args, ast));
 			}
+
+			// push the absolute or relative function address and call it
+			m_code->PushLabel(GetFuncLabel(func_name), AST_ABS_FUNC_ADDR == 0);
+			m_code->Op(OpCode::CALL);
 		}
 	}
 	else
 	{
-		if(is_external_func)
+		if(std::optional<t_vm_addr> func_idx = GetExternalFuncIndex(func_name);
+			is_external_func && func_idx)
+		{
+			// call external function via its index
+			(*m_ostr) << "extcalli " << *func_idx << " (" << func_name << ")" << std::endl;
+		}
+		else if(is_external_func)
 		{
 			// call external function
 			(*m_ostr) << "extcall " << func_name << std::endl;
@@ -748,13 +634,7 @@ void ASTAsm::visit(const ASTJump* ast, [[maybe_unused]] std::size_t level)
 		if(m_binary)
 		{
 			// jump to the end of the function
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-			m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
-			m_endfunc_comefroms.push_back(m_ostr->tellp());
-			t_vm_addr dummy_addr = 0;
-			m_ostr->write(reinterpret_cast<const char*>(&dummy_addr),
-				vm_type_size<VMType::ADDR_IP, false>);
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::JMP));
+			m_code->Jump(OpCode::JMP, m_cur_func_ret);
 		}
 		else
 		{
@@ -784,28 +664,22 @@ void ASTAsm::visit(const ASTJump* ast, [[maybe_unused]] std::size_t level)
 		if(static_cast<std::size_t>(loop_depth) >= m_cur_loop.size() || loop_depth < 0)
 			loop_depth = static_cast<t_int>(m_cur_loop.size()-1);
 
-		const std::string& cur_loop = *(m_cur_loop.rbegin() + loop_depth);
+		const LoopInfo& cur_loop = *(m_cur_loop.rbegin() + loop_depth);
 
 		if(m_binary)
 		{
 			// jump to the beginning (continue) or end (break) of the loop
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::PUSH)); // push jump address
-			m_ostr->put(static_cast<t_vm_byte>(VMType::ADDR_IP));
 			if(ast->GetJumpType() == ASTJump::JumpType::BREAK)
-				m_loop_end_comefroms.insert(std::make_pair(cur_loop, m_ostr->tellp()));
+				m_code->Jump(OpCode::JMP, cur_loop.end);
 			else if(ast->GetJumpType() == ASTJump::JumpType::CONTINUE)
-				m_loop_begin_comefroms.insert(std::make_pair(cur_loop, m_ostr->tellp()));
-			t_vm_addr dummy_addr = 0;
-			m_ostr->write(reinterpret_cast<const char*>(&dummy_addr),
-				vm_type_size<VMType::ADDR_IP, false>);
-			m_ostr->put(static_cast<t_vm_byte>(OpCode::JMP));
+				m_code->Jump(OpCode::JMP, cur_loop.begin);
 		}
 		else
 		{
 			if(ast->GetJumpType() == ASTJump::JumpType::BREAK)
-				(*m_ostr) << "jmp end_" << cur_loop << std::endl;
+				(*m_ostr) << "jmp end_" << cur_loop.name << std::endl;
 			else if(ast->GetJumpType() == ASTJump::JumpType::CONTINUE)
-				(*m_ostr) << "jmp begin_" << cur_loop << std::endl;
+				(*m_ostr) << "jmp begin_" << cur_loop.name << std::endl;
 		}
 	}
 }
@@ -829,11 +703,53 @@ void ASTAsm::visit(const ASTDeclare* ast, [[maybe_unused]] std::size_t level)
 
 
 /**
- * fill in function addresses for calls
+ * register an external function with its index in the vm
+ */
+void ASTAsm::AddExternalFunc(const std::string& name, t_vm_addr idx)
+{
+	m_ext_funcs.insert(name);
+	m_ext_func_indices.insert_or_assign(name, idx);
+}
+
+
+/**
+ * get the index of an external function if it is known at compile time
+ */
+std::optional<t_vm_addr> ASTAsm::GetExternalFuncIndex(const std::string& name) const
+{
+	// function registered by the host
+	if(auto iter = m_ext_func_indices.find(name); iter != m_ext_func_indices.end())
+		return iter->second;
+
+	// built-in function
+	if(std::optional<ExtFunc> func = get_vm_extfunc(name); func)
+		return static_cast<t_vm_addr>(*func);
+
+	return std::nullopt;
+}
+
+
+/**
+ * get the label of a function, which is bound at its definition
+ */
+CodeBuilder::Label ASTAsm::GetFuncLabel(const std::string& name)
+{
+	if(auto iter = m_func_labels.find(name); iter != m_func_labels.end())
+		return iter->second;
+
+	CodeBuilder::Label label = m_code->NewLabel();
+	m_func_labels.emplace(name, label);
+	return label;
+}
+
+
+/**
+ * check the calls of functions which were defined after them,
+ * their addresses are filled in with the other labels
  */
 void ASTAsm::PatchFunctionAddresses()
 {
-	for(const auto& [func_name, pos, num_args, call_ast] : m_func_comefroms)
+	for(const auto& [func_name, num_args, call_ast] : m_func_comefroms)
 	{
 		const SymInfo *sym = m_symtab.GetSymbol(func_name);
 		if(!sym)
@@ -849,35 +765,35 @@ void ASTAsm::PatchFunctionAddresses()
 				<< " arguments, but " << num_args << " were given.";
 			throw_err(call_ast, msg.str());
 		}
+	}
 
-		/*std::cout << "Patching function \"" << func_name << "\""
-			<< " at address " << sym->addr
-			<< " to stream position " << pos
-			<< "." << std::endl;*/
-
-		m_ostr->seekp(pos);
-
-#if AST_ABS_FUNC_ADDR != 0
-		// write absolute function address
-		m_ostr->write(reinterpret_cast<const char*>(&sym->addr),
-			vm_type_size<VMType::ADDR_IP, false>);
-#else
-		// write relative function address
-		t_vm_addr to_skip = static_cast<t_vm_addr>(sym->addr - pos);
-		// already skipped over address and jmp instruction
-		to_skip -= vm_type_size<VMType::ADDR_IP, true>;
-		m_ostr->write(reinterpret_cast<const char*>(&to_skip),
-			vm_type_size<VMType::ADDR_IP, false>);
-#endif
-	}
-
-	// seek to end of stream
-	m_ostr->seekp(0, std::ios_base::end);
+	m_func_comefroms.clear();
 }
 
 
+/**
+ * start the program by setting the size of the global variables' stack frame
+ */
+void ASTAsm::StartCodegen()
+{
+	m_code->Op(OpCode::FRAME);
+	m_glob_frame_pos = m_code->Reserve<t_vm_addr>();
+}
+
+
+/**
+ * finish the program and fill in the jump addresses
+ */
 void ASTAsm::FinishCodegen()
 {
+	PatchFunctionAddresses();
+
 	// add a final halt instruction
-	m_ostr->put(static_cast<t_vm_byte>(OpCode::HALT));
+	m_code->Op(OpCode::HALT);
+
+	// fill in the size of the global stack frame
+	if(m_glob_frame_pos)
+		m_code->Patch(*m_glob_frame_pos, m_glob_stack);
+
+	m_code->Resolve();
 }
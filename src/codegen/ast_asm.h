@@ -11,21 +11,33 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <tuple>
+#include <optional>
 #include <iostream>
 #include <cstdint>
 
 #include "lval.h"
 #include "ast.h"
 #include "sym.h"
+#include "code_builder.h"
 #include "../vm/opcodes.h"
+#include "../vm/extfuncs.h"
 
 
 class ASTAsm : public ASTVisitor
 {
 public:
+	/**
+	 * generate text asm code
+	 */
 	ASTAsm(std::ostream& ostr = std::cout,
 		std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops = nullptr);
 
+	/**
+	 * generate binary code
+	 */
+	ASTAsm(CodeBuilder& code,
+		std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops = nullptr);
+
 	ASTAsm(const ASTAsm&) = delete;
 	const ASTAsm& operator=(const ASTAsm&) = delete;
 
@@ -46,39 +58,61 @@ public:
 	virtual void visit(const ASTDeclare* ast, std::size_t level) override;
 
 	void SetStream(std::ostream* ostr) { m_ostr = ostr; }
-	void SetBinary(bool bin) { m_binary = bin; }
 
 	void AddExternalFunc(const std::string& name) { m_ext_funcs.insert(name); }
+	void AddExternalFunc(const std::string& name, t_vm_addr idx);
 	void AlwaysCallExternal(bool b) { m_always_call_ext = b; }
 	void PatchFunctionAddresses();
+	void StartCodegen();
 	void FinishCodegen();
 
 	const SymTab& GetSymbolTable() const { return m_symtab; }
 
 
+protected:
+	std::optional<t_vm_addr> GetExternalFuncIndex(const std::string& name) const;
+
+	/**
+	 * get the label of a function, which is bound at its definition
+	 */
+	CodeBuilder::Label GetFuncLabel(const std::string& name);
+
+	/**
+	 * running loop and the labels of its beginning and end
+	 */
+	struct LoopInfo
+	{
+		std::string name{};
+		CodeBuilder::Label begin{}, end{};
+	};
+
+
 private:
 	std::ostream* m_ostr{&std::cout};
+	CodeBuilder* m_code{nullptr};
 	const std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *m_ops{nullptr};
 	bool m_binary{false};
 
 	SymTab m_symtab{};
-	t_vm_addr m_glob_stack{};              // current offset into global variable stack
+	// current offset into global variable stack, its top holds the frame size
+	t_vm_addr m_glob_stack{vm_type_size<VMType::ADDR_MEM, false>};
+	std::optional<t_vm_addr> m_glob_frame_pos{};
 	std::unordered_map<std::string, t_vm_addr> m_local_stack{};
 
 	std::string m_cur_func{};              // currently active function
-	std::vector<std::string> m_cur_loop{}; // currently active loops in function
+	CodeBuilder::Label m_cur_func_ret{};   // return point of the active function
+	std::vector<LoopInfo> m_cur_loop{};    // currently active loops in function
 
-	// stream positions where addresses need to be patched in
-	std::vector<std::tuple<std::string, std::streampos, t_vm_addr, const ASTBase*>>
-		m_func_comefroms{};
-	std::vector<std::streampos> m_endfunc_comefroms{};
-	std::unordered_multimap<std::string, std::streampos> m_loop_begin_comefroms{};
-	std::unordered_multimap<std::string, std::streampos> m_loop_end_comefroms{};
+	// labels of the functions
+	std::unordered_map<std::string, CodeBuilder::Label> m_func_labels{};
+	// calls to functions which were not yet defined, with their number of arguments
+	std::vector<std::tuple<std::string, t_vm_addr, const ASTBase*>> m_func_comefroms{};
 
 	std::size_t m_glob_label{0};           // jump label counter
 
 	bool m_always_call_ext{false};         // always call external function
 	std::unordered_set<std::string> m_ext_funcs{};  // external functions
+	std::unordered_map<std::string, t_vm_addr> m_ext_func_indices{};  // registered by the host
 };
 
 
@@ -0,0 +1,775 @@
+/**
+ * lowers the syntax tree to the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ast_ir.h"
+#include "parallel.h"
+#include "../vm/extfuncs.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+/**
+ * exit with an error
+ */
+static void throw_err(const ASTBase* ast, const std::string& err)
+{
+	if(ast)
+	{
+		std::ostringstream ostr;
+
+		if(auto line_range = ast->GetLineRange(); line_range)
+		{
+			auto start_line = std::get<0>(*line_range);
+			auto end_line = std::get<1>(*line_range);
+
+			if(start_line == end_line)
+				ostr << "Line " << start_line << ": ";
+			else
+				ostr << "Lines " << start_line << "..." << end_line << ": ";
+		}
+
+		ostr << err;
+		throw std::runtime_error(ostr.str());
+	}
+	else
+	{
+		throw std::runtime_error(err);
+	}
+}
+
+
+
+/**
+ * find the external functions declared in the statements of a block
+ */
+static void get_declared_ext_funcs(const ASTBase* ast, std::unordered_set<std::string>& ext_funcs)
+{
+	if(!ast)
+		return;
+
+	switch(ast->GetType())
+	{
+		case ASTType::DECLARE:
+		{
+			auto decl = static_cast<const ASTDeclare*>(ast);
+			if(!decl->IsFunc() || !decl->IsExternal())
+				break;
+
+			for(std::size_t idx=0; idx<decl->NumIdents(); ++idx)
+			{
+				if(const std::string* func_name = decl->GetIdent(idx); func_name)
+					ext_funcs.insert(*func_name);
+			}
+			break;
+		}
+
+		case ASTType::DELEGATE:
+		case ASTType::LIST:
+		case ASTType::CONDITION:
+		case ASTType::LOOP:
+		{
+			for(std::size_t idx=0; idx<ast->NumChildren(); ++idx)
+				get_declared_ext_funcs(ast->GetChild(idx).get(), ext_funcs);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+
+
+ASTIR::ASTIR(std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops)
+	: m_ops{ops}
+{
+	// entry block of the global code
+	StartBlock(NewBlock());
+}
+
+
+/**
+ * generator for a deferred function, its program only consists of
+ * an empty global code and the function
+ */
+ASTIR::ASTIR(const ASTIR& parent, const DeferredFunc& func)
+	: m_ops{parent.m_ops}, m_parent{&parent}, m_always_call_ext{parent.m_always_call_ext},
+	m_ext_funcs{*func.ext_funcs}
+{
+	m_prog.GetFunctions().emplace_back(IRFunc{ .name = func.ast->GetName(),
+		.num_args = static_cast<t_vm_int>(func.ast->NumArgs()) });
+}
+
+
+t_ir_block ASTIR::NewBlock()
+{
+	std::vector<IRBlock>& blocks = m_prog.GetFunctions()[m_func].blocks;
+	blocks.emplace_back(IRBlock{});
+	return blocks.size() - 1;
+}
+
+
+bool ASTIR::IsTerminated() const
+{
+	const IRBlock& block = m_prog.GetFunctions()[m_func].blocks[m_block];
+	return !block.instrs.empty() && block.GetTerminator().IsTerminator();
+}
+
+
+/**
+ * continue in the given block, the previous one falls through to it
+ */
+void ASTIR::StartBlock(t_ir_block block)
+{
+	if(!m_layout.empty() && !IsTerminated())
+		Jump(block, nullptr);
+
+	m_layout.push_back(block);
+	m_block = block;
+	m_stack.clear();
+}
+
+
+/**
+ * add an instruction to the current block, its arguments are
+ * taken from the top of the stack and its result is pushed
+ */
+t_ir_reg ASTIR::Emit(IRInstr&& instr, const ASTBase* ast,
+	std::size_t num_args, bool has_result)
+{
+	if(m_stack.size() < num_args)
+		throw_err(ast, "Expression has no value.");
+
+	instr.args.assign(m_stack.end() - num_args, m_stack.end());
+	m_stack.resize(m_stack.size() - num_args);
+
+	if(has_result)
+	{
+		instr.dst = m_prog.NewRegister();
+		m_stack.push_back(instr.dst);
+	}
+
+	t_ir_reg dst = instr.dst;
+	m_prog.GetFunctions()[m_func].blocks[m_block].instrs.emplace_back(std::move(instr));
+	return dst;
+}
+
+
+void ASTIR::Terminate(IRInstr&& instr, const ASTBase* ast, std::size_t num_args)
+{
+	Emit(std::move(instr), ast, num_args, false);
+	m_stack.clear();
+}
+
+
+void ASTIR::Jump(t_ir_block target, const ASTBase* ast)
+{
+	Terminate(IRInstr{ .op = IROp::JMP, .targets = { target, 0 } }, ast);
+}
+
+
+/**
+ * put the blocks of the current function in code order
+ */
+void ASTIR::FinishFunction()
+{
+	IRFunc& func = m_prog.GetFunctions()[m_func];
+
+	constexpr const t_ir_block none = std::numeric_limits<t_ir_block>::max();
+	std::vector<t_ir_block> new_idx(func.blocks.size(), none);
+	for(std::size_t idx=0; idx<m_layout.size(); ++idx)
+		new_idx[m_layout[idx]] = idx;
+
+	std::vector<IRBlock> blocks;
+	blocks.reserve(m_layout.size());
+	for(t_ir_block block : m_layout)
+		blocks.emplace_back(std::move(func.blocks[block]));
+
+	for(IRBlock& block : blocks)
+	{
+		IRInstr& term = block.GetTerminator();
+		std::size_t num_targets = block.GetSuccessors().size();
+		for(std::size_t i=0; i<num_targets; ++i)
+		{
+			term.targets[i] = new_idx[term.targets[i]];
+			if(term.targets[i] == none)
+				throw std::runtime_error("Jump to an unknown position.");
+		}
+	}
+
+	func.blocks = std::move(blocks);
+	m_layout.clear();
+}
+
+
+void ASTIR::visit(
+	[[maybe_unused]] const ASTToken<t_lval>* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	std::cerr << "Error: " << __func__ << " not implemented." << std::endl;
+}
+
+
+void ASTIR::visit(const ASTToken<t_real>* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	if(!ast->HasLexerValue())
+		return;
+
+	t_vm_real val = static_cast<t_vm_real>(ast->GetLexerValue());
+	Emit(IRInstr{ .op = IROp::CONST, .val = val }, ast);
+}
+
+
+void ASTIR::visit(const ASTToken<t_int>* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	if(!ast->HasLexerValue())
+		return;
+
+	t_vm_int val = static_cast<t_vm_int>(ast->GetLexerValue());
+	Emit(IRInstr{ .op = IROp::CONST, .val = val }, ast);
+}
+
+
+/**
+ * get the variable named by an identifier, registers it if it is new
+ */
+const SymInfo* ASTIR::GetVariable(const ASTToken<std::string>* ast)
+{
+	const std::string& val = ast->GetLexerValue();
+	std::string varname;
+	if(m_cur_func != "")
+		varname = m_cur_func + "/" + val;
+	else
+		varname = val;
+
+	SymTab& symtab = m_prog.GetSymbolTable();
+	const SymInfo *sym = symtab.GetSymbol(varname);
+	if(sym)
+		return sym;
+
+	// symbol not yet seen -> register it
+	VMType symty = ast->GetDataType();
+
+	// in global scope
+	if(m_cur_func == "")
+	{
+		m_glob_stack += get_vm_type_size(symty, true);
+		return symtab.AddSymbol(varname, -m_glob_stack, VMType::ADDR_GBP, symty);
+	}
+
+	// in local function scope, the top of the stack frame holds its size
+	if(m_local_stack.find(m_cur_func) == m_local_stack.end())
+		m_local_stack[m_cur_func] = vm_type_size<VMType::ADDR_MEM, false>;
+
+	m_local_stack[m_cur_func] += get_vm_type_size(symty, true);
+	return symtab.AddSymbol(varname, -m_local_stack[m_cur_func], VMType::ADDR_BP, symty);
+}
+
+
+void ASTIR::visit(const ASTToken<std::string>* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	if(!ast->HasLexerValue())
+		return;
+
+	// the token names a string literal
+	if(!ast->IsIdent())
+	{
+		Emit(IRInstr{ .op = IROp::CONST, .val = ast->GetLexerValue() }, ast);
+		return;
+	}
+
+	// the token names a variable identifier
+	const SymInfo *sym = GetVariable(ast);
+
+	// dereference it, if the variable is on the rhs of an assignment
+	IROp op = (!ast->IsLValue() && !sym->is_func) ? IROp::LOAD : IROp::ADDR;
+	Emit(IRInstr{ .op = op, .name = ast->GetLexerValue(), .sym = *sym }, ast);
+}
+
+
+void ASTIR::visit(
+	[[maybe_unused]] const ASTToken<void*>* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	std::cerr << "Error: " << __func__ << " not implemented." << std::endl;
+}
+
+
+void ASTIR::visit(
+	[[maybe_unused]] const ASTDelegate* ast,
+	[[maybe_unused]] std::size_t level)
+{
+	for(std::size_t i=0; i<ast->NumChildren(); ++i)
+		ast->GetChild(i)->accept(this, level+1);
+}
+
+
+void ASTIR::visit(const ASTUnary* ast, [[maybe_unused]] std::size_t level)
+{
+	ast->GetChild(0)->accept(this, level+1);
+
+	OpCode op = std::get<OpCode>(m_ops->at(ast->GetOpId()));
+	if(op == OpCode::ADD)
+		return;
+	else if(op == OpCode::SUB)
+		op = OpCode::USUB;
+
+	Emit(IRInstr{ .op = IROp::OP, .vmop = op }, ast, 1);
+}
+
+
+void ASTIR::visit(const ASTBinary* ast, [[maybe_unused]] std::size_t level)
+{
+	std::size_t opid = ast->GetOpId();
+	VMType ty = ast->GetDataType();
+	OpCode op = std::get<OpCode>(m_ops->at(opid));
+
+	// assignment to a variable
+	auto lval = std::dynamic_pointer_cast<ASTToken<std::string>>(ast->GetChild(1));
+	if(op == OpCode::WRMEM && lval && lval->IsIdent() && lval->HasLexerValue())
+	{
+		ast->GetChild(0)->accept(this, level+1);
+
+		const SymInfo *sym = GetVariable(lval.get());
+		Emit(IRInstr{ .op = IROp::STORE, .name = lval->GetLexerValue(), .sym = *sym },
+			ast, 1, false);
+		return;
+	}
+
+	// iterate the operands
+	for(std::size_t childidx=0; childidx<2; ++childidx)
+	{
+		auto child = ast->GetChild(childidx);
+		child->accept(this, level+1);
+
+		VMType subty = child->GetDataType();
+		if(subty != ty && opid != '=' /* no cast on assignments */)
+		{
+			// child type is different from derived type -> cast
+			OpCode cast = OpCode::INVALID;
+			if(ty == VMType::STR)
+				cast = OpCode::TOS;
+			else if(ty == VMType::INT)
+				cast = OpCode::TOI;
+			else if(ty == VMType::REAL)
+				cast = OpCode::TOF;
+
+			if(cast != OpCode::INVALID)
+				Emit(IRInstr{ .op = IROp::OP, .vmop = cast }, child.get(), 1);
+		}
+	}
+
+	// generate the binary operation
+	if(op != OpCode::INVALID)
+		Emit(IRInstr{ .op = IROp::OP, .vmop = op }, ast, 2, op != OpCode::WRMEM);
+}
+
+
+void ASTIR::visit(const ASTList* ast, [[maybe_unused]] std::size_t level)
+{
+	for(std::size_t i=0; i<ast->NumChildren(); ++i)
+		ast->GetChild(i)->accept(this, level+1);
+}
+
+
+void ASTIR::visit(const ASTCondition* ast, [[maybe_unused]] std::size_t level)
+{
+	// condition
+	ast->GetCondition()->accept(this, level+1);
+
+	t_ir_block if_block = NewBlock();
+	t_ir_block else_block = ast->GetElseBlock() ? NewBlock() : 0;
+	t_ir_block end_block = NewBlock();
+
+	Terminate(IRInstr{ .op = IROp::BRANCH, .targets = { if_block,
+		ast->GetElseBlock() ? else_block : end_block } }, ast->GetCondition().get(), 1);
+
+	// if block
+	StartBlock(if_block);
+	ast->GetIfBlock()->accept(this, level+1);
+	Jump(end_block, ast);
+
+	// else block
+	if(ast->GetElseBlock())
+	{
+		StartBlock(else_block);
+		ast->GetElseBlock()->accept(this, level+1);
+		Jump(end_block, ast);
+	}
+
+	StartBlock(end_block);
+}
+
+
+/**
+ * the condition is placed after the loop's block,
+ * so that every iteration only needs one conditional jump
+ */
+void ASTIR::visit(const ASTLoop* ast, [[maybe_unused]] std::size_t level)
+{
+	t_ir_block cond_block = NewBlock();
+	t_ir_block loop_block = NewBlock();
+	t_ir_block end_block = NewBlock();
+
+	// enter the loop at its condition
+	Jump(cond_block, ast);
+
+	StartBlock(cond_block);
+	std::size_t cond_pos = m_layout.size() - 1;
+	ast->GetCondition()->accept(this, level+1);
+	Terminate(IRInstr{ .op = IROp::BRANCH, .targets = { loop_block, end_block } },
+		ast->GetCondition().get(), 1);
+
+	m_cur_loop.emplace_back(LoopInfo{ .cond = cond_block, .end = end_block });
+	StartBlock(loop_block);
+	ast->GetBlock()->accept(this, level+1);
+	Jump(cond_block, ast);
+	m_cur_loop.pop_back();
+
+	// move the condition behind the loop's block
+	m_layout.erase(m_layout.begin() + static_cast<std::ptrdiff_t>(cond_pos));
+	m_layout.push_back(cond_block);
+
+	StartBlock(end_block);
+}
+
+
+void ASTIR::visit(const ASTFunc* ast, std::size_t level)
+{
+	if(m_cur_func != "")
+		throw_err(ast, "Nested functions are not allowed.");
+
+	// function name and number of arguments
+	const std::string& func_name = ast->GetName();
+	t_vm_int num_args = static_cast<t_vm_int>(ast->NumArgs());
+
+	// add function to symbol table, its address is known after code generation
+	m_prog.GetSymbolTable().AddSymbol(func_name, 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, num_args);
+
+	// place the function in the global code
+	std::size_t func_idx = m_prog.GetFunctions().size();
+	Emit(IRInstr{ .op = IROp::FUNC, .name = func_name, .func = func_idx }, ast, 0, false);
+	m_prog.GetFunctions().emplace_back(IRFunc{ .name = func_name, .num_args = num_args });
+
+	if(m_num_threads == 1)
+	{
+		GenerateFunction(ast, func_idx, level);
+		return;
+	}
+
+	// generate the function's code after the global code, the declarations of
+	// external functions in it still apply to the code which follows it
+	if(!m_deferred_ext_funcs || m_deferred_ext_funcs->size() != m_ext_funcs.size())
+		m_deferred_ext_funcs = std::make_shared<const std::unordered_set<std::string>>(m_ext_funcs);
+	m_deferred_funcs.emplace_back(DeferredFunc{ .ast = ast, .func_idx = func_idx,
+		.ext_funcs = m_deferred_ext_funcs });
+	get_declared_ext_funcs(ast->GetBlock().get(), m_ext_funcs);
+}
+
+
+/**
+ * generate the code of a function which is already placed in the global code
+ */
+void ASTIR::GenerateFunction(const ASTFunc* ast, std::size_t func_idx, std::size_t level)
+{
+	const std::string& func_name = ast->GetName();
+	t_vm_int num_args = static_cast<t_vm_int>(ast->NumArgs());
+	m_cur_func = func_name;
+
+	SymTab& symtab = m_prog.GetSymbolTable();
+
+	// function arguments
+	if(ast->GetArgs())
+	{
+		for(std::size_t i=0; i<ast->GetArgs()->NumChildren(); ++i)
+		{
+			auto ident = std::dynamic_pointer_cast<ASTToken<std::string>>(ast->GetArgs()->GetChild(i));
+			const std::string& argname = ident->GetLexerValue();
+			std::string varname = m_cur_func + "/" + argname;
+
+			symtab.AddSymbol(varname, static_cast<t_vm_addr>(i+2), VMType::ADDR_BP_ARG, VMType::UNKNOWN);
+		}
+	}
+
+	// switch to the function
+	t_ir_block glob_block = m_block;
+	std::vector<t_ir_block> glob_layout = std::move(m_layout);
+	std::vector<t_ir_reg> glob_stack = std::move(m_stack);
+	std::vector<LoopInfo> glob_loops = std::move(m_cur_loop);
+	m_layout.clear();
+	m_stack.clear();
+	m_cur_loop.clear();
+	m_func = func_idx;
+	StartBlock(NewBlock());
+
+	ast->GetBlock()->accept(this, level+1); // block
+
+	// return at the end of the function
+	Terminate(IRInstr{ .op = IROp::RET }, ast);
+
+	// fill in the size of the stack frame for the local variables
+	t_vm_addr framesize = vm_type_size<VMType::ADDR_MEM, false>;
+	if(auto iter = m_local_stack.find(func_name); iter != m_local_stack.end())
+		framesize = iter->second;
+	symtab.AddSymbol(func_name, 0, VMType::ADDR_MEM, VMType::UNKNOWN,
+		true, num_args, framesize);
+	m_prog.GetFunctions()[func_idx].frame_size = framesize;
+	FinishFunction();
+
+	// switch back to the global code
+	m_func = 0;
+	m_block = glob_block;
+	m_layout = std::move(glob_layout);
+	m_stack = std::move(glob_stack);
+	m_cur_loop = std::move(glob_loops);
+	m_cur_func = "";
+}
+
+
+/**
+ * generate the code of the functions deferred until the end of the global code
+ */
+void ASTIR::GenerateDeferredFunctions()
+{
+	// every function is generated into its own program, numbering its own registers
+	std::vector<std::unique_ptr<ASTIR>> gens(m_deferred_funcs.size());
+	parallel_for(m_deferred_funcs.size(), m_num_threads,
+		[this, &gens](std::size_t idx)
+		{
+			const DeferredFunc& func = m_deferred_funcs[idx];
+			gens[idx].reset(new ASTIR{*this, func});
+			gens[idx]->GenerateFunction(func.ast, 1, 0);
+		});
+
+	// move the functions, their registers and symbols into the program
+	for(std::size_t idx=0; idx<m_deferred_funcs.size(); ++idx)
+	{
+		ASTIR& gen = *gens[idx];
+		IRFunc& func = gen.m_prog.GetFunctions()[1];
+
+		m_prog.AddRegisters(func, gen.m_prog.GetRegisters());
+		m_prog.GetFunctions()[m_deferred_funcs[idx].func_idx] = std::move(func);
+
+		for(const auto& [name, sym] : gen.m_prog.GetSymbolTable().GetSymbols())
+		{
+			m_prog.GetSymbolTable().AddSymbol(name, sym.addr, sym.loc, sym.ty,
+				sym.is_func, sym.num_args, sym.frame_size);
+		}
+
+		m_func_comefroms.insert(m_func_comefroms.end(),
+			gen.m_func_comefroms.begin(), gen.m_func_comefroms.end());
+	}
+
+	m_deferred_funcs.clear();
+	m_deferred_ext_funcs.reset();
+}
+
+
+void ASTIR::visit(const ASTFuncCall* ast, [[maybe_unused]] std::size_t level)
+{
+	const std::string& func_name = ast->GetName();
+	t_vm_int num_args = static_cast<t_vm_int>(ast->NumArgs());
+	bool is_external_func = (m_always_call_ext ||
+		m_ext_funcs.find(func_name) != m_ext_funcs.end());
+
+	// push the function arguments
+	if(ast->GetArgs())
+		ast->GetArgs()->accept(this, level+1);
+
+	// call external function via its index
+	if(std::optional<t_vm_addr> func_idx = GetExternalFuncIndex(func_name);
+		is_external_func && func_idx)
+	{
+		// check number of arguments of built-in functions
+		if(*func_idx < static_cast<t_vm_addr>(ExtFunc::NUM_BUILTIN))
+		{
+			t_vm_int func_args = get_vm_extfunc_num_args(static_cast<ExtFunc>(*func_idx));
+			if(num_args != func_args)
+			{
+				std::ostringstream msg;
+				msg << "External function \"" << func_name << "\" takes " << func_args
+					<< " arguments, but " << num_args << " were given.";
+				throw_err(ast, msg.str());
+			}
+		}
+
+		Emit(IRInstr{ .op = IROp::EXTCALL, .name = func_name, .ext_idx = func_idx },
+			ast, static_cast<std::size_t>(num_args));
+	}
+
+	// call external function via its name
+	else if(is_external_func)
+	{
+		Emit(IRInstr{ .op = IROp::EXTCALL, .name = func_name },
+			ast, static_cast<std::size_t>(num_args));
+	}
+
+	// call internal function
+	else
+	{
+		// check the arguments if the function is already known,
+		// the functions are declared by the generator of the global code
+		const SymTab& symtab = m_parent ? m_parent->m_prog.GetSymbolTable() : m_prog.GetSymbolTable();
+		if(const SymInfo *sym = symtab.GetSymbol(func_name); sym)
+		{
+			if(num_args != sym->num_args)
+			{
+				std::ostringstream msg;
+				msg << "Function \"" << func_name << "\" takes " << sym->num_args
+					<< " arguments, but " << num_args << " were given.";
+				throw_err(ast, msg.str());
+			}
+		}
+		else
+		{
+			m_func_comefroms.emplace_back(std::make_tuple(func_name, num_args, ast));
+		}
+
+		Emit(IRInstr{ .op = IROp::CALL, .name = func_name },
+			ast, static_cast<std::size_t>(num_args));
+	}
+}
+
+
+void ASTIR::visit(const ASTJump* ast, [[maybe_unused]] std::size_t level)
+{
+	if(ast->GetJumpType() == ASTJump::JumpType::RETURN)
+	{
+		std::size_t stack_size = m_stack.size();
+		if(ast->GetExpr())
+			ast->GetExpr()->accept(this, level+1);
+
+		if(m_cur_func == "")
+			throw_err(ast, "Tried to return outside any function.");
+
+		// return the value of the expression if it has one
+		Terminate(IRInstr{ .op = IROp::RET }, ast, m_stack.size() > stack_size ? 1 : 0);
+	}
+	else if(ast->GetJumpType() == ASTJump::JumpType::BREAK
+		|| ast->GetJumpType() == ASTJump::JumpType::CONTINUE)
+	{
+		if(!m_cur_loop.size())
+			throw_err(ast, "Tried to use break/continue outside loop.");
+
+		t_int loop_depth = 0; // how many loop levels to break/continue?
+
+		if(ast->GetExpr())
+		{
+			auto int_val = std::dynamic_pointer_cast<ASTToken<t_int>>(ast->GetExpr());
+			auto real_val = std::dynamic_pointer_cast<ASTToken<t_real>>(ast->GetExpr());
+
+			if(int_val)
+				loop_depth = int_val->GetLexerValue();
+			else if(real_val)
+				loop_depth = static_cast<t_int>(std::round(real_val->GetLexerValue()));
+		}
+
+		// reduce to maximum loop depth
+		if(static_cast<std::size_t>(loop_depth) >= m_cur_loop.size() || loop_depth < 0)
+			loop_depth = static_cast<t_int>(m_cur_loop.size()-1);
+
+		const LoopInfo& cur_loop = *(m_cur_loop.rbegin() + loop_depth);
+
+		// jump to the condition (continue) or end (break) of the loop
+		if(ast->GetJumpType() == ASTJump::JumpType::BREAK)
+			Jump(cur_loop.end, ast);
+		else
+			Jump(cur_loop.cond, ast);
+	}
+	else
+	{
+		return;
+	}
+
+	// code following the jump is unreachable
+	StartBlock(NewBlock());
+}
+
+
+void ASTIR::visit(const ASTDeclare* ast, [[maybe_unused]] std::size_t level)
+{
+	std::size_t num_idents = ast->NumIdents();
+
+	// external function declarations
+	if(ast->IsFunc() && ast->IsExternal())
+	{
+		for(std::size_t idx=0; idx<num_idents; ++idx)
+		{
+			const std::string* func_name = ast->GetIdent(idx);
+			if(func_name)
+				m_ext_funcs.insert(*func_name);
+		}
+	}
+}
+
+
+/**
+ * register an external function with its index in the vm
+ */
+void ASTIR::AddExternalFunc(const std::string& name, t_vm_addr idx)
+{
+	m_ext_funcs.insert(name);
+	m_ext_func_indices.insert_or_assign(name, idx);
+}
+
+
+/**
+ * get the index of an external function if it is known at compile time
+ */
+std::optional<t_vm_addr> ASTIR::GetExternalFuncIndex(const std::string& name) const
+{
+	if(m_parent)
+		return m_parent->GetExternalFuncIndex(name);
+
+	// function registered by the host
+	if(auto iter = m_ext_func_indices.find(name); iter != m_ext_func_indices.end())
+		return iter->second;
+
+	// built-in function
+	if(std::optional<ExtFunc> func = get_vm_extfunc(name); func)
+		return static_cast<t_vm_addr>(*func);
+
+	return std::nullopt;
+}
+
+
+/**
+ * terminate the global code and check the function calls
+ */
+void ASTIR::FinishCodegen()
+{
+	Terminate(IRInstr{ .op = IROp::HALT }, nullptr);
+	m_prog.GetGlobal().frame_size = m_glob_stack;
+	FinishFunction();
+	GenerateDeferredFunctions();
+
+	// check the calls of functions which were defined after them
+	for(const auto& [func_name, num_args, call_ast] : m_func_comefroms)
+	{
+		const SymInfo *sym = m_prog.GetSymbolTable().GetSymbol(func_name);
+		if(!sym)
+		{
+			throw_err(call_ast,
+				"Tried to call unknown function \"" + func_name + "\".");
+		}
+
+		if(num_args != sym->num_args)
+		{
+			std::ostringstream msg;
+			msg << "Function \"" << func_name << "\" takes " << sym->num_args
+				<< " arguments, but " << num_args << " were given.";
+			throw_err(call_ast, msg.str());
+		}
+	}
+	m_func_comefroms.clear();
+
+	m_prog.Check();
+}
@@ -0,0 +1,163 @@
+/**
+ * lowers the syntax tree to the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_AST_IR_H__
+#define __LR1_AST_IR_H__
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <tuple>
+#include <optional>
+#include <memory>
+
+#include "ast.h"
+#include "ir.h"
+#include "../vm/opcodes.h"
+
+
+class ASTIR : public ASTVisitor
+{
+public:
+	ASTIR(std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops = nullptr);
+
+	ASTIR(const ASTIR&) = delete;
+	const ASTIR& operator=(const ASTIR&) = delete;
+
+	virtual void visit(const ASTToken<t_lval>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<t_real>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<t_int>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<std::string>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<void*>* ast, std::size_t level) override;
+	virtual void visit(const ASTDelegate* ast, std::size_t level) override;
+	virtual void visit(const ASTUnary* ast, std::size_t level) override;
+	virtual void visit(const ASTBinary* ast, std::size_t level) override;
+	virtual void visit(const ASTList* ast, std::size_t level) override;
+	virtual void visit(const ASTCondition* ast, std::size_t level) override;
+	virtual void visit(const ASTLoop* ast, std::size_t level) override;
+	virtual void visit(const ASTFunc* ast, std::size_t level) override;
+	virtual void visit(const ASTFuncCall* ast, std::size_t level) override;
+	virtual void visit(const ASTJump* ast, std::size_t level) override;
+	virtual void visit(const ASTDeclare* ast, std::size_t level) override;
+
+	void AddExternalFunc(const std::string& name) { m_ext_funcs.insert(name); }
+	void AddExternalFunc(const std::string& name, t_vm_addr idx);
+	void AlwaysCallExternal(bool b) { m_always_call_ext = b; }
+
+	/**
+	 * generate the code of the functions after the global code using the
+	 * given number of threads (0: all hardware threads), the syntax tree
+	 * has to be kept until FinishCodegen
+	 */
+	void SetNumThreads(std::size_t num_threads) { m_num_threads = num_threads; }
+
+	/**
+	 * terminate the global code and check the function calls
+	 */
+	void FinishCodegen();
+
+	IRProgram& GetProgram() { return m_prog; }
+	const IRProgram& GetProgram() const { return m_prog; }
+
+
+protected:
+	std::optional<t_vm_addr> GetExternalFuncIndex(const std::string& name) const;
+
+	/**
+	 * get the variable named by an identifier, registers it if it is new
+	 */
+	const SymInfo* GetVariable(const ASTToken<std::string>* ast);
+
+	/**
+	 * add an instruction to the current block, its arguments are
+	 * taken from the top of the stack and its result is pushed
+	 */
+	t_ir_reg Emit(IRInstr&& instr, const ASTBase* ast,
+		std::size_t num_args = 0, bool has_result = true);
+
+	/**
+	 * blocks of the current function
+	 */
+	t_ir_block NewBlock();
+	void StartBlock(t_ir_block block);
+	void Terminate(IRInstr&& instr, const ASTBase* ast, std::size_t num_args = 0);
+	void Jump(t_ir_block target, const ASTBase* ast);
+	bool IsTerminated() const;
+
+	/**
+	 * put the blocks of the current function in code order
+	 */
+	void FinishFunction();
+
+	/**
+	 * generate the code of a function which is already placed in the global code
+	 */
+	void GenerateFunction(const ASTFunc* ast, std::size_t func_idx, std::size_t level);
+
+	/**
+	 * generate the code of the functions deferred until the end of the global code,
+	 * every function has its own generator and registers
+	 */
+	void GenerateDeferredFunctions();
+
+	/**
+	 * running loop and its blocks for continue and break
+	 */
+	struct LoopInfo
+	{
+		t_ir_block cond{}, end{};
+	};
+
+	/**
+	 * function whose code is generated after the global code,
+	 * with the external functions declared before it
+	 */
+	struct DeferredFunc
+	{
+		const ASTFunc* ast{nullptr};
+		std::size_t func_idx{0};
+		std::shared_ptr<const std::unordered_set<std::string>> ext_funcs{};
+	};
+
+
+private:
+	/**
+	 * generator for a deferred function
+	 */
+	ASTIR(const ASTIR& parent, const DeferredFunc& func);
+
+
+	const std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *m_ops{nullptr};
+	const ASTIR* m_parent{nullptr};        // generator of the global code for deferred functions
+
+	IRProgram m_prog{};
+
+	// current offset into global variable stack, its top holds the frame size
+	t_vm_addr m_glob_stack{vm_type_size<VMType::ADDR_MEM, false>};
+	std::unordered_map<std::string, t_vm_addr> m_local_stack{};
+
+	std::string m_cur_func{};              // currently active function
+	std::size_t m_func{0};                 // index of the current function
+	t_ir_block m_block{0};                 // current block
+	std::vector<t_ir_block> m_layout{};    // blocks in code order
+	std::vector<t_ir_reg> m_stack{};       // registers of the current block on the vm stack
+	std::vector<LoopInfo> m_cur_loop{};    // currently active loops in function
+
+	// calls to functions which were not yet defined, with their number of arguments
+	std::vector<std::tuple<std::string, t_vm_int, const ASTBase*>> m_func_comefroms{};
+
+	bool m_always_call_ext{false};         // always call external function
+	std::unordered_set<std::string> m_ext_funcs{};  // external functions
+	std::unordered_map<std::string, t_vm_addr> m_ext_func_indices{};  // registered by the host
+
+	std::size_t m_num_threads{1};          // threads generating the functions' code
+	std::vector<DeferredFunc> m_deferred_funcs{};
+	std::shared_ptr<const std::unordered_set<std::string>> m_deferred_ext_funcs{};  // shared by them
+};
+
+
+#endif
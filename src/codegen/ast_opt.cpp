@@ -0,0 +1,424 @@
+/**
+ * constant folding and algebraic simplification of the syntax tree
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ast_opt.h"
+
+#include <type_traits>
+#include <limits>
+#include <sstream>
+#include <cmath>
+
+
+using t_uint = std::make_unsigned_t<t_int>;
+
+
+ASTOpt::ASTOpt(const std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops)
+	: m_ops{ops}
+{
+	// the shift operator is needed for the strength reduction
+	if(m_ops)
+	{
+		for(const auto& [opid, op] : *m_ops)
+		{
+			if(std::get<OpCode>(op) == OpCode::SHL)
+			{
+				m_shl_id = opid;
+				break;
+			}
+		}
+	}
+}
+
+
+t_astbaseptr ASTOpt::Optimise(const t_astbaseptr& ast)
+{
+	if(!ast)
+		return ast;
+
+	for(std::size_t childidx=0; childidx<ast->NumChildren(); ++childidx)
+	{
+		t_astbaseptr child = ast->GetChild(childidx);
+		t_astbaseptr newchild = Optimise(child);
+		if(newchild != child)
+			ast->SetChild(childidx, newchild);
+	}
+
+	m_result = nullptr;
+	ast->accept(this);
+
+	t_astbaseptr result = m_result ? m_result : ast;
+	m_result = nullptr;
+	return result;
+}
+
+
+/**
+ * get the value of a literal
+ */
+ASTOpt::t_const ASTOpt::get_const(const t_astbaseptr& ast)
+{
+	if(!ast)
+		return t_const{};
+
+	if(auto tok = std::dynamic_pointer_cast<ASTToken<t_int>>(ast); tok && tok->HasLexerValue())
+		return t_const{tok->GetLexerValue()};
+	if(auto tok = std::dynamic_pointer_cast<ASTToken<t_real>>(ast); tok && tok->HasLexerValue())
+		return t_const{tok->GetLexerValue()};
+	if(auto tok = std::dynamic_pointer_cast<ASTToken<std::string>>(ast);
+		tok && tok->HasLexerValue() && !tok->IsIdent())
+		return t_const{tok->GetLexerValue()};
+
+	return t_const{};
+}
+
+
+/**
+ * convert a constant like the vm's cast instructions do,
+ * conversions which are undefined or need parsing are not done
+ */
+ASTOpt::t_const ASTOpt::cast_const(const t_const& val, VMType ty)
+{
+	if(ty == VMType::INT)
+	{
+		if(std::holds_alternative<t_int>(val))
+			return val;
+
+		if(std::holds_alternative<t_real>(val))
+		{
+			t_real real = std::get<t_real>(val);
+			if(std::isfinite(real) &&
+				real > static_cast<t_real>(std::numeric_limits<t_int>::lowest()) &&
+				real < static_cast<t_real>(std::numeric_limits<t_int>::max()))
+				return t_const{static_cast<t_int>(real)};
+		}
+	}
+
+	else if(ty == VMType::REAL)
+	{
+		if(std::holds_alternative<t_real>(val))
+			return val;
+		if(std::holds_alternative<t_int>(val))
+			return t_const{static_cast<t_real>(std::get<t_int>(val))};
+	}
+
+	else if(ty == VMType::STR)
+	{
+		if(std::holds_alternative<std::string>(val))
+			return val;
+
+		std::ostringstream ostr;
+		if(std::holds_alternative<t_int>(val))
+			ostr << std::get<t_int>(val);
+		else if(std::holds_alternative<t_real>(val))
+			ostr << std::get<t_real>(val);
+		else
+			return t_const{};
+		return t_const{ostr.str()};
+	}
+
+	return t_const{};
+}
+
+
+/**
+ * apply an operator to two constants of the same type,
+ * operations which fail or differ at run time are not folded
+ */
+ASTOpt::t_const ASTOpt::fold(OpCode op, const t_const& val1, const t_const& val2)
+{
+	if(val1.index() != val2.index())
+		return t_const{};
+
+	if(std::holds_alternative<t_int>(val1))
+	{
+		t_int int1 = std::get<t_int>(val1);
+		t_int int2 = std::get<t_int>(val2);
+
+		// let overflows wrap around
+		t_uint uint1 = static_cast<t_uint>(int1);
+		t_uint uint2 = static_cast<t_uint>(int2);
+
+		bool invalid_div = int2 == 0 ||
+			(int1 == std::numeric_limits<t_int>::lowest() && int2 == -1);
+		bool valid_shift = int2 >= 0 &&
+			int2 < static_cast<t_int>(sizeof(t_int)*8);
+
+		switch(op)
+		{
+			case OpCode::ADD: return t_const{static_cast<t_int>(uint1 + uint2)};
+			case OpCode::SUB: return t_const{static_cast<t_int>(uint1 - uint2)};
+			case OpCode::MUL: return t_const{static_cast<t_int>(uint1 * uint2)};
+			case OpCode::DIV: if(!invalid_div) return t_const{int1 / int2}; break;
+			case OpCode::MOD: if(!invalid_div) return t_const{int1 % int2}; break;
+			case OpCode::BINAND: return t_const{int1 & int2};
+			case OpCode::BINOR: return t_const{int1 | int2};
+			case OpCode::BINXOR: return t_const{int1 ^ int2};
+			case OpCode::SHL: if(valid_shift) return t_const{static_cast<t_int>(uint1 << int2)}; break;
+			case OpCode::SHR: if(valid_shift) return t_const{int1 >> int2}; break;
+			default: break;
+		}
+	}
+
+	else if(std::holds_alternative<t_real>(val1))
+	{
+		t_real real1 = std::get<t_real>(val1);
+		t_real real2 = std::get<t_real>(val2);
+
+		switch(op)
+		{
+			case OpCode::ADD: return t_const{real1 + real2};
+			case OpCode::SUB: return t_const{real1 - real2};
+			case OpCode::MUL: return t_const{real1 * real2};
+			case OpCode::DIV: return t_const{real1 / real2};
+			case OpCode::MOD: return t_const{std::fmod(real1, real2)};
+			case OpCode::POW: return t_const{std::pow(real1, real2)};
+			default: break;
+		}
+	}
+
+	else if(std::holds_alternative<std::string>(val1))
+	{
+		if(op == OpCode::ADD)
+			return t_const{std::get<std::string>(val1) + std::get<std::string>(val2)};
+	}
+
+	return t_const{};
+}
+
+
+/**
+ * create a literal with the given value in place of an expression,
+ * the symbol ids are taken from a literal of the same type
+ */
+t_astbaseptr ASTOpt::MakeConst(const t_const& val, const ASTBase* expr,
+	const t_astbaseptr& proto) const
+{
+	std::size_t line = 0;
+	if(expr->GetLineRange())
+		line = std::get<0>(*expr->GetLineRange());
+
+	t_astbaseptr tok;
+	VMType ty = VMType::UNKNOWN;
+
+	if(std::holds_alternative<t_int>(val))
+	{
+		tok = std::make_shared<ASTToken<t_int>>(proto->GetId(),
+			proto->GetTableIdx(), std::get<t_int>(val), line);
+		ty = VMType::INT;
+	}
+	else if(std::holds_alternative<t_real>(val))
+	{
+		tok = std::make_shared<ASTToken<t_real>>(proto->GetId(),
+			proto->GetTableIdx(), std::get<t_real>(val), line);
+		ty = VMType::REAL;
+	}
+	else if(std::holds_alternative<std::string>(val))
+	{
+		tok = std::make_shared<ASTToken<std::string>>(proto->GetId(),
+			proto->GetTableIdx(), std::get<std::string>(val), line);
+		ty = VMType::STR;
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	tok->SetDataType(ty);
+	tok->SetLineRange(expr->GetLineRange());
+	return tok;
+}
+
+
+void ASTOpt::visit(const ASTUnary* ast, [[maybe_unused]] std::size_t level)
+{
+	auto iterop = m_ops->find(ast->GetOpId());
+	if(iterop == m_ops->end())
+		return;
+	OpCode op = std::get<OpCode>(iterop->second);
+
+	t_astbaseptr child = ast->GetChild(0);
+
+	// unary plus
+	if(op == OpCode::ADD)
+	{
+		m_result = child;
+		++m_num_simplified;
+		return;
+	}
+
+	t_const val = get_const(child);
+	t_const result;
+
+	if(op == OpCode::SUB && std::holds_alternative<t_int>(val))
+		result = static_cast<t_int>(t_uint{0} - static_cast<t_uint>(std::get<t_int>(val)));
+	else if(op == OpCode::SUB && std::holds_alternative<t_real>(val))
+		result = -std::get<t_real>(val);
+	else if(op == OpCode::BINNOT && std::holds_alternative<t_int>(val))
+		result = ~std::get<t_int>(val);
+
+	if(std::holds_alternative<std::monostate>(result))
+		return;
+
+	m_result = MakeConst(result, ast, child);
+	++m_num_folded;
+}
+
+
+void ASTOpt::visit(const ASTBinary* ast, [[maybe_unused]] std::size_t level)
+{
+	auto iterop = m_ops->find(ast->GetOpId());
+	if(iterop == m_ops->end())
+		return;
+	OpCode op = std::get<OpCode>(iterop->second);
+
+	VMType ty = ast->GetDataType();
+	if(ty != VMType::INT && ty != VMType::REAL && ty != VMType::STR)
+		return;
+
+	t_astbaseptr lhs = ast->GetChild(0);
+	t_astbaseptr rhs = ast->GetChild(1);
+	t_const val1 = cast_const(get_const(lhs), ty);
+	t_const val2 = cast_const(get_const(rhs), ty);
+
+	// both operands are constant
+	if(!std::holds_alternative<std::monostate>(val1) &&
+		!std::holds_alternative<std::monostate>(val2))
+	{
+		t_const result = fold(op, val1, val2);
+		if(std::holds_alternative<std::monostate>(result))
+			return;
+
+		const t_astbaseptr& proto = lhs->GetDataType() == ty ? lhs : rhs;
+		if(proto->GetDataType() != ty)
+			return;
+
+		m_result = MakeConst(result, ast, proto);
+		++m_num_folded;
+		return;
+	}
+
+	// identities only hold for numbers of the operation's type
+	if(ty == VMType::STR)
+		return;
+
+	auto is_value = [ty](const t_const& val, t_int ival) -> bool
+	{
+		if(ty == VMType::INT && std::holds_alternative<t_int>(val))
+			return std::get<t_int>(val) == ival;
+		else if(ty == VMType::REAL && std::holds_alternative<t_real>(val))
+			return std::get<t_real>(val) == static_cast<t_real>(ival);
+		return false;
+	};
+
+	auto simplify = [this, ty](const t_astbaseptr& expr) -> void
+	{
+		if(expr->GetDataType() != ty)
+			return;
+		m_result = expr;
+		++m_num_simplified;
+	};
+
+	switch(op)
+	{
+		case OpCode::ADD:
+		{
+			// not for reals: -0 + 0 = +0
+			if(ty != VMType::INT)
+				break;
+			if(is_value(val2, 0))
+				simplify(lhs);
+			else if(is_value(val1, 0))
+				simplify(rhs);
+			break;
+		}
+		case OpCode::SUB:
+		{
+			if(is_value(val2, 0))
+				simplify(lhs);
+			break;
+		}
+		case OpCode::MUL:
+		{
+			if(is_value(val2, 1))
+				simplify(lhs);
+			else if(is_value(val1, 1))
+				simplify(rhs);
+			break;
+		}
+		case OpCode::DIV:
+		{
+			if(is_value(val2, 1))
+				simplify(lhs);
+			break;
+		}
+		case OpCode::POW:
+		{
+			// the vm has no integer power
+			if(ty == VMType::REAL && is_value(val2, 1))
+				simplify(lhs);
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	if(m_result || op != OpCode::MUL || ty != VMType::INT || !m_shl_id)
+		return;
+
+	// multiplication with a power of two -> shift
+	const t_astbaseptr* expr = nullptr;
+	const t_astbaseptr* factor = nullptr;
+	t_int fac = 0;
+	if(std::holds_alternative<t_int>(val2))
+	{
+		expr = &lhs;
+		factor = &rhs;
+		fac = std::get<t_int>(val2);
+	}
+	else if(std::holds_alternative<t_int>(val1))
+	{
+		expr = &rhs;
+		factor = &lhs;
+		fac = std::get<t_int>(val1);
+	}
+
+	if(!expr || (*expr)->GetDataType() != ty || (*factor)->GetDataType() != ty)
+		return;
+	if(fac < 2 || (fac & (fac - 1)) != 0)
+		return;
+
+	t_int shift = 0;
+	while((t_int{1} << shift) != fac)
+		++shift;
+
+	t_astbaseptr shiftconst = MakeConst(t_const{shift}, factor->get(), *factor);
+	auto shl = std::make_shared<ASTBinary>(ast->GetId(), ast->GetTableIdx(),
+		*expr, shiftconst, *m_shl_id);
+	shl->SetDataType(ty);
+	shl->SetLineRange(ast->GetLineRange());
+
+	m_result = shl;
+	++m_num_simplified;
+}
+
+
+// nodes without own simplifications, their children are handled in Optimise()
+void ASTOpt::visit([[maybe_unused]] const ASTToken<t_lval>* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTToken<t_real>* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTToken<t_int>* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTToken<std::string>* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTToken<void*>* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTDelegate* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTList* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTCondition* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTLoop* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTFunc* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTFuncCall* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTJump* ast, [[maybe_unused]] std::size_t level) {}
+void ASTOpt::visit([[maybe_unused]] const ASTDeclare* ast, [[maybe_unused]] std::size_t level) {}
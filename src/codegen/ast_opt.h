@@ -0,0 +1,96 @@
+/**
+ * constant folding and algebraic simplification of the syntax tree
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_AST_OPT_H__
+#define __LR1_AST_OPT_H__
+
+#include <unordered_map>
+#include <tuple>
+#include <variant>
+#include <optional>
+
+#include "ast.h"
+#include "../vm/opcodes.h"
+
+
+/**
+ * replaces operations on constants by their results, removes identities
+ * (x*1, x/1, x+0, x-0, x^1) and turns multiplications of integers with
+ * powers of two into shifts, the data types have to be derived before
+ */
+class ASTOpt : public ASTVisitor
+{
+public:
+	using t_const = std::variant<std::monostate, t_int, t_real, std::string>;
+
+
+public:
+	ASTOpt(const std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *ops);
+
+	ASTOpt(const ASTOpt&) = delete;
+	const ASTOpt& operator=(const ASTOpt&) = delete;
+
+	/**
+	 * optimise the tree from the leaves upwards, returns the new root
+	 */
+	t_astbaseptr Optimise(const t_astbaseptr& ast);
+
+	virtual void visit(const ASTToken<t_lval>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<t_real>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<t_int>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<std::string>* ast, std::size_t level) override;
+	virtual void visit(const ASTToken<void*>* ast, std::size_t level) override;
+	virtual void visit(const ASTDelegate* ast, std::size_t level) override;
+	virtual void visit(const ASTUnary* ast, std::size_t level) override;
+	virtual void visit(const ASTBinary* ast, std::size_t level) override;
+	virtual void visit(const ASTList* ast, std::size_t level) override;
+	virtual void visit(const ASTCondition* ast, std::size_t level) override;
+	virtual void visit(const ASTLoop* ast, std::size_t level) override;
+	virtual void visit(const ASTFunc* ast, std::size_t level) override;
+	virtual void visit(const ASTFuncCall* ast, std::size_t level) override;
+	virtual void visit(const ASTJump* ast, std::size_t level) override;
+	virtual void visit(const ASTDeclare* ast, std::size_t level) override;
+
+	std::size_t GetNumFolded() const { return m_num_folded; }
+	std::size_t GetNumSimplified() const { return m_num_simplified; }
+
+	/**
+	 * get the value of a literal
+	 */
+	static t_const get_const(const t_astbaseptr& ast);
+
+	/**
+	 * convert a constant like the vm's cast instructions do
+	 */
+	static t_const cast_const(const t_const& val, VMType ty);
+
+
+protected:
+	/**
+	 * create a literal with the given value in place of an expression
+	 */
+	t_astbaseptr MakeConst(const t_const& val, const ASTBase* expr,
+		const t_astbaseptr& proto) const;
+
+	/**
+	 * apply an operator to two constants of the same type
+	 */
+	static t_const fold(OpCode op, const t_const& val1, const t_const& val2);
+
+
+private:
+	const std::unordered_map<std::size_t, std::tuple<std::string, OpCode>> *m_ops{nullptr};
+	std::optional<std::size_t> m_shl_id{};  // operator id of the left shift
+
+	t_astbaseptr m_result{};                // replacement of the visited node
+
+	std::size_t m_num_folded{0};
+	std::size_t m_num_simplified{0};
+};
+
+
+#endif
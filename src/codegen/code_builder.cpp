@@ -0,0 +1,99 @@
+/**
+ * in-memory builder for the vm's binary code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "code_builder.h"
+
+#include <stdexcept>
+
+
+void CodeBuilder::PushReal(t_vm_real val)
+{
+	Op(OpCode::PUSH);
+	Raw(static_cast<t_byte>(VMType::REAL));
+	Raw(val);
+}
+
+
+void CodeBuilder::PushInt(t_vm_int val)
+{
+	Op(OpCode::PUSH);
+	Raw(static_cast<t_byte>(VMType::INT));
+	Raw(val);
+}
+
+
+void CodeBuilder::PushStr(const std::string& str)
+{
+	Op(OpCode::PUSH);
+	Raw(static_cast<t_byte>(VMType::STR));
+	Raw(static_cast<t_addr>(str.length()));
+	m_code.insert(m_code.end(), str.begin(), str.end());
+}
+
+
+void CodeBuilder::PushAddr(VMType base, t_addr addr)
+{
+	Op(OpCode::PUSH);
+	Raw(static_cast<t_byte>(base));
+	Raw(addr);
+}
+
+
+/**
+ * push the address of a label, a relative address counts from the
+ * end of the following one-byte instruction, e.g. the jump or call
+ */
+void CodeBuilder::PushLabel(const Label& label, bool relative)
+{
+	Op(OpCode::PUSH);
+	Raw(static_cast<t_byte>(relative ? VMType::ADDR_IP : VMType::ADDR_MEM));
+
+	Fixup fixup{ .pos = Reserve<t_addr>(), .label = label.idx };
+	if(relative)
+		fixup.base = GetPos() + 1;
+	m_fixups.push_back(fixup);
+}
+
+
+CodeBuilder::Label CodeBuilder::NewLabel()
+{
+	m_labels.emplace_back(std::nullopt);
+	return Label{ .idx = m_labels.size() - 1 };
+}
+
+
+/**
+ * set the label to the current position
+ */
+void CodeBuilder::Bind(const Label& label)
+{
+	m_labels.at(label.idx) = GetPos();
+}
+
+
+std::optional<CodeBuilder::t_addr> CodeBuilder::GetAddr(const Label& label) const
+{
+	return m_labels.at(label.idx);
+}
+
+
+/**
+ * fill in the addresses of all labels, throws if one has not been bound
+ */
+void CodeBuilder::Resolve()
+{
+	for(const Fixup& fixup : m_fixups)
+	{
+		const std::optional<t_addr>& addr = m_labels.at(fixup.label);
+		if(!addr)
+			throw std::runtime_error("Jump to an unknown position.");
+
+		Patch(fixup.pos, fixup.base ? *addr - *fixup.base : *addr);
+	}
+
+	m_fixups.clear();
+}
@@ -0,0 +1,149 @@
+/**
+ * in-memory builder for the vm's binary code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_CODE_BUILDER_H__
+#define __LR1_CODE_BUILDER_H__
+
+#include <vector>
+#include <span>
+#include <string>
+#include <optional>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+
+#include "../vm/types.h"
+#include "../vm/opcodes.h"
+
+
+/**
+ * appends instructions to a growing byte vector; jump targets are labels
+ * which can be used before their position is known, all uses of the
+ * labels are filled in at once by Resolve()
+ */
+class CodeBuilder
+{
+public:
+	using t_byte = t_vm_byte;
+	using t_addr = t_vm_addr;
+
+	/**
+	 * position in the code, which is bound later
+	 */
+	struct Label
+	{
+		std::size_t idx{};
+	};
+
+
+public:
+	CodeBuilder() = default;
+	~CodeBuilder() = default;
+
+	CodeBuilder(const CodeBuilder&) = delete;
+	CodeBuilder& operator=(const CodeBuilder&) = delete;
+
+	t_addr GetPos() const { return static_cast<t_addr>(m_code.size()); }
+
+	void Op(OpCode op) { m_code.push_back(static_cast<t_byte>(op)); }
+
+	/**
+	 * append the bytes of a value
+	 */
+	template<class t_val>
+	void Raw(const t_val& val)
+	{
+		static_assert(std::is_trivially_copyable_v<t_val>, "Invalid value type.");
+
+		const std::size_t pos = m_code.size();
+		m_code.resize(pos + sizeof(t_val));
+		std::memcpy(m_code.data() + pos, &val, sizeof(t_val));
+	}
+
+	/**
+	 * overwrite a value which has been appended before
+	 */
+	template<class t_val>
+	void Patch(t_addr pos, const t_val& val)
+	{
+		static_assert(std::is_trivially_copyable_v<t_val>, "Invalid value type.");
+		std::memcpy(m_code.data() + pos, &val, sizeof(t_val));
+	}
+
+	/**
+	 * append a value that is patched later, returns its position
+	 */
+	template<class t_val>
+	t_addr Reserve()
+	{
+		t_addr pos = GetPos();
+		Raw(t_val{});
+		return pos;
+	}
+
+	/**
+	 * push instructions for direct data
+	 */
+	void PushReal(t_vm_real val);
+	void PushInt(t_vm_int val);
+	void PushStr(const std::string& str);
+	void PushAddr(VMType base, t_addr addr);
+
+	/**
+	 * push the address of a label, a relative address counts from the
+	 * end of the following one-byte instruction, e.g. the jump or call
+	 */
+	void PushLabel(const Label& label, bool relative = true);
+
+	/**
+	 * jump to, or call, a label using a relative address
+	 */
+	void Jump(OpCode op, const Label& label)
+	{
+		PushLabel(label, true);
+		Op(op);
+	}
+
+	Label NewLabel();
+
+	/**
+	 * set the label to the current position
+	 */
+	void Bind(const Label& label);
+	std::optional<t_addr> GetAddr(const Label& label) const;
+
+	/**
+	 * fill in the addresses of all labels, throws if one has not been bound
+	 */
+	void Resolve();
+
+	std::span<const t_byte> GetCode() const { return m_code; }
+
+	/**
+	 * take the code out of the builder
+	 */
+	std::vector<t_byte> Release() { return std::move(m_code); }
+
+
+private:
+	/**
+	 * use of a label
+	 */
+	struct Fixup
+	{
+		t_addr pos{};                    // position of the address
+		std::size_t label{};
+		std::optional<t_addr> base{};    // start of relative addresses
+	};
+
+	std::vector<t_byte> m_code{};
+	std::vector<std::optional<t_addr>> m_labels{};
+	std::vector<Fixup> m_fixups{};
+};
+
+
+#endif
@@ -0,0 +1,248 @@
+/**
+ * cache of compiled programs, addressed by the hash of their inputs
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "compile_cache.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <cstring>
+
+#if __has_include(<filesystem>)
+	#include <filesystem>
+	namespace fs = std::filesystem;
+#elif __has_include(<boost/filesystem.hpp>)
+	#include <boost/filesystem.hpp>
+	namespace fs = boost::filesystem;
+#else
+	#error No filesystem support found.
+#endif
+
+
+// identifies cache files and their layout
+static constexpr const char g_cache_magic[8] = { 'L', 'R', '1', 'C', 'A', 'C', 'H', 'E' };
+
+// fnv-1a parameters
+static constexpr const CompileCache::t_hash g_fnv_offset = 0xcbf29ce484222325ull;
+static constexpr const CompileCache::t_hash g_fnv_prime = 0x100000001b3ull;
+
+
+template<class t_val>
+static void write_raw(std::ostream& ostr, const t_val& val)
+{
+	ostr.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+
+static void write_str(std::ostream& ostr, const std::string& str)
+{
+	write_raw<std::uint64_t>(ostr, str.size());
+	ostr.write(str.data(), str.size());
+}
+
+
+template<class t_val>
+static void read_raw(std::istream& istr, t_val& val)
+{
+	istr.read(reinterpret_cast<char*>(&val), sizeof(val));
+	if(!istr)
+		throw std::runtime_error("Invalid cache file.");
+}
+
+
+static void read_str(std::istream& istr, std::string& str,
+	std::uint64_t max_size = 0x10000)
+{
+	std::uint64_t size = 0;
+	read_raw(istr, size);
+	if(size > max_size)
+		throw std::runtime_error("Invalid cache file.");
+
+	str.resize(size);
+	istr.read(str.data(), size);
+	if(!istr)
+		throw std::runtime_error("Invalid cache file.");
+}
+
+
+
+CompileCache::Key::Key() : m_hash{g_fnv_offset}
+{
+	Add(m_version);
+	Add(sizeof(t_vm_addr));
+	Add(sizeof(t_vm_int));
+	Add(sizeof(t_vm_real));
+}
+
+
+void CompileCache::Key::Add(const void* data, std::size_t size)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	for(std::size_t i=0; i<size; ++i)
+	{
+		m_hash ^= bytes[i];
+		m_hash *= g_fnv_prime;
+	}
+}
+
+
+void CompileCache::Key::Add(const std::string& str)
+{
+	Add(str.size());
+	Add(str.data(), str.size());
+}
+
+
+void CompileCache::Key::Add(const t_table& tab)
+{
+	Add(tab.size1());
+	Add(tab.size2());
+
+	for(std::size_t row=0; row<tab.size1(); ++row)
+		for(std::size_t col=0; col<tab.size2(); ++col)
+			Add(tab(row, col));
+}
+
+
+void CompileCache::Key::Add(const t_vecIdx& vec)
+{
+	Add(vec.size());
+	Add(vec.data(), vec.size() * sizeof(t_vecIdx::value_type));
+}
+
+
+
+CompileCache::CompileCache(const std::string& dir) : m_dir{dir}
+{}
+
+
+/**
+ * get the name of the file holding the program with the given hash
+ */
+std::string CompileCache::GetFilename(t_hash hash) const
+{
+	std::ostringstream ostr;
+	ostr << std::hex << std::setw(16) << std::setfill('0') << hash << ".lr1c";
+	return (fs::path{m_dir} / ostr.str()).string();
+}
+
+
+/**
+ * get a cached program, nullopt if it is not in the cache
+ */
+std::optional<CompileCache::Entry> CompileCache::Load(t_hash hash) const
+{
+	const std::string filename = GetFilename(hash);
+	std::ifstream istr(filename, std::ios_base::binary);
+	if(!istr)
+		return std::nullopt;
+
+	char magic[sizeof(g_cache_magic)]{};
+	std::uint32_t version = 0, addrsize = 0, intsize = 0, realsize = 0;
+	t_hash filehash = 0;
+	istr.read(magic, sizeof(magic));
+	read_raw(istr, version);
+	read_raw(istr, addrsize);
+	read_raw(istr, intsize);
+	read_raw(istr, realsize);
+	read_raw(istr, filehash);
+
+	if(std::memcmp(magic, g_cache_magic, sizeof(magic)) != 0
+		|| version != m_version || addrsize != sizeof(t_vm_addr)
+		|| intsize != sizeof(t_vm_int) || realsize != sizeof(t_vm_real)
+		|| filehash != hash)
+		throw std::runtime_error("\"" + filename + "\" is not a compatible cache file.");
+
+	Entry entry;
+
+	// symbol table, including the functions' entry addresses
+	std::uint64_t num_syms = 0;
+	read_raw(istr, num_syms);
+	for(std::uint64_t symidx=0; symidx<num_syms; ++symidx)
+	{
+		std::string name;
+		SymInfo info;
+		std::uint8_t is_func = 0;
+
+		read_str(istr, name);
+		read_raw(istr, info.addr);
+		read_raw(istr, info.loc);
+		read_raw(istr, info.ty);
+		read_raw(istr, is_func);
+		read_raw(istr, info.num_args);
+		read_raw(istr, info.frame_size);
+
+		entry.symtab.AddSymbol(name, info.addr, info.loc, info.ty,
+			is_func != 0, info.num_args, info.frame_size);
+	}
+
+	// code
+	std::uint64_t code_size = 0;
+	read_raw(istr, code_size);
+	if(code_size > 0x40000000)
+		throw std::runtime_error("Invalid cache file.");
+	entry.code.resize(code_size);
+	istr.read(reinterpret_cast<char*>(entry.code.data()), code_size);
+	if(!istr)
+		throw std::runtime_error("Invalid cache file.");
+
+	return entry;
+}
+
+
+/**
+ * store a compiled program
+ */
+void CompileCache::Store(t_hash hash, std::span<const t_vm_byte> code,
+	const SymTab& symtab) const
+{
+	fs::create_directories(fs::path{m_dir});
+
+	// write to a temporary file first and then move it into place
+	const std::string filename = GetFilename(hash);
+	const std::string tmpname = filename + ".tmp"
+		+ std::to_string(std::random_device{}());
+
+	{
+		std::ofstream ostr(tmpname, std::ios_base::binary);
+		if(!ostr)
+			throw std::runtime_error("Cannot open cache file \"" + tmpname + "\".");
+
+		ostr.write(g_cache_magic, sizeof(g_cache_magic));
+		write_raw<std::uint32_t>(ostr, m_version);
+		write_raw<std::uint32_t>(ostr, sizeof(t_vm_addr));
+		write_raw<std::uint32_t>(ostr, sizeof(t_vm_int));
+		write_raw<std::uint32_t>(ostr, sizeof(t_vm_real));
+		write_raw(ostr, hash);
+
+		write_raw<std::uint64_t>(ostr, symtab.GetSymbols().size());
+		for(const auto& [name, info] : symtab.GetSymbols())
+		{
+			write_str(ostr, name);
+			write_raw(ostr, info.addr);
+			write_raw(ostr, info.loc);
+			write_raw(ostr, info.ty);
+			write_raw<std::uint8_t>(ostr, info.is_func);
+			write_raw(ostr, info.num_args);
+			write_raw(ostr, info.frame_size);
+		}
+
+		write_raw<std::uint64_t>(ostr, code.size());
+		ostr.write(reinterpret_cast<const char*>(code.data()), code.size());
+
+		if(!ostr.flush())
+		{
+			ostr.close();
+			fs::remove(fs::path{tmpname});
+			throw std::runtime_error("Cannot write cache file \"" + tmpname + "\".");
+		}
+	}
+
+	fs::rename(fs::path{tmpname}, fs::path{filename});
+}
@@ -0,0 +1,101 @@
+/**
+ * cache of compiled programs, addressed by the hash of their inputs
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_COMPILE_CACHE_H__
+#define __LR1_COMPILE_CACHE_H__
+
+#include <string>
+#include <vector>
+#include <span>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+
+#include "sym.h"
+#include "../parsergen/common.h"
+#include "../vm/types.h"
+
+
+/**
+ * directory of compiled programs and their symbol tables, the files are named
+ * after the hash of everything the compilation depends on: the source text,
+ * the parse tables and the code generation options
+ */
+class CompileCache
+{
+public:
+	using t_hash = std::uint64_t;
+
+	// version of the file format and of the generated code,
+	// to be increased whenever the code generation changes
+	static constexpr const std::uint32_t m_version = 3;
+
+
+	/**
+	 * 64 bit fnv-1a hash of the compilation's inputs
+	 */
+	class Key
+	{
+	public:
+		Key();
+
+		void Add(const void* data, std::size_t size);
+		void Add(const std::string& str);
+		void Add(const t_table& tab);
+		void Add(const t_vecIdx& vec);
+
+		template<class t_val>
+		void Add(t_val val)
+		{
+			static_assert(std::is_arithmetic_v<t_val>, "Invalid value type.");
+			Add(&val, sizeof(val));
+		}
+
+		t_hash GetHash() const { return m_hash; }
+
+
+	private:
+		t_hash m_hash{};
+	};
+
+
+	/**
+	 * cached program
+	 */
+	struct Entry
+	{
+		std::vector<t_vm_byte> code{};
+		SymTab symtab{};
+	};
+
+
+public:
+	CompileCache(const std::string& dir);
+
+	/**
+	 * get the name of the file holding the program with the given hash
+	 */
+	std::string GetFilename(t_hash hash) const;
+
+	/**
+	 * get a cached program, nullopt if it is not in the cache
+	 */
+	std::optional<Entry> Load(t_hash hash) const;
+
+	/**
+	 * store a compiled program, replacing any previous file in one step,
+	 * so that concurrent compilations only see complete files
+	 */
+	void Store(t_hash hash, std::span<const t_vm_byte> code, const SymTab& symtab) const;
+
+
+private:
+	std::string m_dir{};
+};
+
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * intermediate representation between the syntax tree and the vm code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir.h"
+
+#include <unordered_set>
+#include <stdexcept>
+#include <sstream>
+
+
+/**
+ * exit with an error in the given function
+ */
+static void throw_err(const IRFunc& func, const std::string& err)
+{
+	std::ostringstream ostr;
+	ostr << "Invalid intermediate code in "
+		<< (func.name == "" ? std::string{"global code"} : "function \"" + func.name + "\"")
+		<< ": " << err;
+	throw std::runtime_error(ostr.str());
+}
+
+
+/**
+ * can the instruction be removed if its result is not needed?
+ */
+bool IRInstr::HasSideEffects() const
+{
+	switch(op)
+	{
+		case IROp::CONST:
+		case IROp::LOAD:
+		case IROp::ADDR:
+		case IROp::OP:
+			return false;
+		default:
+			return true;
+	}
+}
+
+
+std::vector<t_ir_block> IRBlock::GetSuccessors() const
+{
+	if(instrs.empty())
+		return {};
+
+	const IRInstr& term = GetTerminator();
+	if(term.op == IROp::JMP)
+		return { term.targets[0] };
+	else if(term.op == IROp::BRANCH)
+		return { term.targets[0], term.targets[1] };
+	return {};
+}
+
+
+std::size_t IRFunc::NumInstructions() const
+{
+	std::size_t num = 0;
+	for(const IRBlock& block : blocks)
+		num += block.instrs.size();
+	return num;
+}
+
+
+
+IRProgram::IRProgram()
+{
+	// global code
+	m_funcs.emplace_back(IRFunc{});
+}
+
+
+std::size_t IRProgram::NumInstructions() const
+{
+	std::size_t num = 0;
+	for(const IRFunc& func : m_funcs)
+		num += func.NumInstructions();
+	return num;
+}
+
+
+/**
+ * move the registers of a function which were numbered by its own
+ * allocator behind the ones of the program, returns the offset added to them
+ */
+t_ir_reg IRProgram::AddRegisters(IRFunc& func, const IRRegisters& regs)
+{
+	const t_ir_reg offset = m_regs.NewRegisters(regs.GetNumRegisters()) - regs.GetFirst();
+	if(offset == 0)
+		return offset;
+
+	for(IRBlock& block : func.blocks)
+	{
+		for(IRInstr& instr : block.instrs)
+		{
+			if(regs.Contains(instr.dst))
+				instr.dst += offset;
+			for(t_ir_reg& arg : instr.args)
+			{
+				if(regs.Contains(arg))
+					arg += offset;
+			}
+		}
+	}
+
+	return offset;
+}
+
+
+/**
+ * check that the registers follow the stack discipline
+ * and that the jump targets exist, throws otherwise
+ */
+void IRProgram::Check() const
+{
+	std::unordered_set<t_ir_reg> defined;
+
+	for(std::size_t funcidx=0; funcidx<m_funcs.size(); ++funcidx)
+	{
+		const IRFunc& func = m_funcs[funcidx];
+		if(func.blocks.empty())
+			throw_err(func, "No code.");
+
+		for(std::size_t blockidx=0; blockidx<func.blocks.size(); ++blockidx)
+		{
+			const IRBlock& block = func.blocks[blockidx];
+			if(block.instrs.empty() || !block.GetTerminator().IsTerminator())
+				throw_err(func, "Block " + std::to_string(blockidx) + " is not terminated.");
+
+			// registers on the stack
+			std::vector<t_ir_reg> stack;
+
+			for(std::size_t instridx=0; instridx<block.instrs.size(); ++instridx)
+			{
+				const IRInstr& instr = block.instrs[instridx];
+				if(instr.IsTerminator() && instridx+1 != block.instrs.size())
+				{
+					throw_err(func, "Terminator in the middle of block "
+						+ std::to_string(blockidx) + ".");
+				}
+
+				// the arguments have to be on top of the stack
+				for(auto iter = instr.args.rbegin(); iter != instr.args.rend(); ++iter)
+				{
+					if(stack.empty() || stack.back() != *iter)
+					{
+						throw_err(func, "Register %" + std::to_string(*iter)
+							+ " is not on top of the stack in block "
+							+ std::to_string(blockidx) + ".");
+					}
+					stack.pop_back();
+				}
+
+				if(instr.dst != g_ir_noreg)
+				{
+					if(!defined.insert(instr.dst).second)
+					{
+						throw_err(func, "Register %" + std::to_string(instr.dst)
+							+ " is assigned more than once.");
+					}
+					stack.push_back(instr.dst);
+				}
+
+				for(t_ir_block target : block.GetSuccessors())
+				{
+					if(target >= func.blocks.size())
+						throw_err(func, "Jump to an unknown block.");
+				}
+
+				if(instr.op == IROp::FUNC && (funcidx != 0 || instr.func == 0
+					|| instr.func >= m_funcs.size()))
+				{
+					throw_err(func, "Invalid function definition.");
+				}
+			}
+		}
+	}
+}
+
+
+
+std::ostream& operator<<(std::ostream& ostr, const IRInstr& instr)
+{
+	if(instr.dst != g_ir_noreg)
+		ostr << "%" << instr.dst << " = ";
+
+	switch(instr.op)
+	{
+		case IROp::CONST: ostr << (instr.vmop == OpCode::NOP
+			? "const" : get_vm_opcode_name(instr.vmop)); break;
+		case IROp::LOAD: ostr << "load " << instr.name; break;
+		case IROp::STORE: ostr << "store " << instr.name; break;
+		case IROp::ADDR: ostr << "addr " << instr.name; break;
+		case IROp::OP: ostr << get_vm_opcode_name(instr.vmop); break;
+		case IROp::CALL: ostr << "call " << instr.name; break;
+		case IROp::EXTCALL: ostr << "extcall " << instr.name; break;
+		case IROp::FUNC: ostr << "func #" << instr.func; break;
+		case IROp::JMP: ostr << "jmp block_" << instr.targets[0]; break;
+		case IROp::BRANCH: ostr << "branch block_" << instr.targets[0]
+			<< ", block_" << instr.targets[1]; break;
+		case IROp::RET: ostr << "ret"; break;
+		case IROp::TAILCALL: ostr << "tailcall " << instr.name; break;
+		case IROp::HALT: ostr << "halt"; break;
+	}
+
+	if(instr.vmreg)
+		ostr << " (r" << *instr.vmreg << ")";
+
+	// constant value
+	if(std::holds_alternative<t_vm_int>(instr.val))
+		ostr << " int " << std::get<t_vm_int>(instr.val);
+	else if(std::holds_alternative<t_vm_real>(instr.val))
+		ostr << " real " << std::get<t_vm_real>(instr.val);
+	else if(std::holds_alternative<t_vm_str>(instr.val))
+		ostr << " string \"" << std::get<t_vm_str>(instr.val) << "\"";
+
+	for(std::size_t i=0; i<instr.args.size(); ++i)
+		ostr << (i == 0 ? " " : ", ") << "%" << instr.args[i];
+
+	return ostr;
+}
+
+
+std::ostream& operator<<(std::ostream& ostr, const IRFunc& func)
+{
+	if(func.name == "")
+		ostr << "global code";
+	else
+		ostr << "function " << func.name << " (" << func.num_args << " args)";
+	ostr << ", frame " << func.frame_size << ":\n";
+
+	for(std::size_t blockidx=0; blockidx<func.blocks.size(); ++blockidx)
+	{
+		ostr << "block_" << blockidx << ":\n";
+		for(const IRInstr& instr : func.blocks[blockidx].instrs)
+			ostr << "\t" << instr << "\n";
+	}
+
+	return ostr;
+}
+
+
+std::ostream& operator<<(std::ostream& ostr, const IRProgram& prog)
+{
+	for(std::size_t funcidx=0; funcidx<prog.m_funcs.size(); ++funcidx)
+	{
+		if(funcidx > 0)
+			ostr << "\n#" << funcidx << ": ";
+		ostr << prog.m_funcs[funcidx];
+	}
+
+	return ostr;
+}
@@ -0,0 +1,195 @@
+/**
+ * intermediate representation between the syntax tree and the vm code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://llvm.org/docs/LangRef.html
+ * 	- https://en.wikipedia.org/wiki/Static_single-assignment_form
+ */
+
+#ifndef __LR1_IR_H__
+#define __LR1_IR_H__
+
+#include <vector>
+#include <string>
+#include <variant>
+#include <optional>
+#include <limits>
+#include <ostream>
+
+#include "sym.h"
+#include "../vm/types.h"
+#include "../vm/opcodes.h"
+
+
+// virtual register, every register is assigned exactly once
+using t_ir_reg = std::size_t;
+
+// index of a basic block in its function
+using t_ir_block = std::size_t;
+
+constexpr const t_ir_reg g_ir_noreg = std::numeric_limits<t_ir_reg>::max();
+
+
+enum class IROp
+{
+	// instructions
+	CONST,    // dst = constant
+	LOAD,     // dst = variable
+	STORE,    // variable = args[0]
+	ADDR,     // dst = address of a variable or function
+	OP,       // dst = vm operator applied to the args
+	CALL,     // dst = function(args)
+	EXTCALL,  // dst = external function(args)
+	FUNC,     // the code of a function is placed here
+
+	// block terminators
+	JMP,      // continue at targets[0]
+	BRANCH,   // continue at targets[0] if args[0] is true, else at targets[1]
+	RET,      // return from the function, optionally with args[0]
+	TAILCALL, // return the result of calling a function with args
+	HALT,     // stop the program
+};
+
+
+/**
+ * an instruction, it pushes its result onto the vm stack and pops its arguments
+ */
+struct IRInstr
+{
+	using t_const = std::variant<std::monostate, t_vm_int, t_vm_real, t_vm_str>;
+
+	IROp op{IROp::OP};
+	OpCode vmop{OpCode::NOP};            // operator for OP instructions, PUSHI or PUSHF for untagged constants
+
+	t_ir_reg dst{g_ir_noreg};            // defined register
+	std::vector<t_ir_reg> args{};        // used registers, in the order they are pushed
+
+	t_const val{};                       // constant value
+	std::string name{};                  // name of the variable or function
+	SymInfo sym{};                       // location of the variable
+	std::optional<t_vm_addr> vmreg{};    // vm register holding the variable
+	std::optional<t_vm_addr> ext_idx{};  // index of an external function
+
+	std::size_t func{0};                 // index of the defined function
+	t_ir_block targets[2]{0, 0};         // jump targets
+
+	bool IsTerminator() const { return op >= IROp::JMP; }
+	bool HasSideEffects() const;
+};
+
+
+/**
+ * a basic block, its last instruction is a terminator
+ */
+struct IRBlock
+{
+	std::vector<IRInstr> instrs{};
+
+	const IRInstr& GetTerminator() const { return instrs.back(); }
+	IRInstr& GetTerminator() { return instrs.back(); }
+	std::vector<t_ir_block> GetSuccessors() const;
+};
+
+
+/**
+ * a function or the global code with its blocks in code order,
+ * the first block is the entry
+ */
+struct IRFunc
+{
+	std::string name{};          // empty for the global code
+	t_vm_int num_args{0};
+	t_vm_addr frame_size{0};     // size of the stack frame for the local variables
+
+	std::vector<IRBlock> blocks{};
+
+	std::size_t NumInstructions() const;
+};
+
+
+/**
+ * numbers the registers of a function which is generated or transformed
+ * independently of the other ones, e.g. on its own thread
+ */
+class IRRegisters
+{
+public:
+	IRRegisters(t_ir_reg first = 0) : m_first{first}, m_end{first} {}
+
+	t_ir_reg NewRegister() { return m_end++; }
+	t_ir_reg NewRegisters(std::size_t num) { t_ir_reg first = m_end; m_end += num; return first; }
+
+	t_ir_reg GetFirst() const { return m_first; }
+	t_ir_reg GetEnd() const { return m_end; }
+	std::size_t GetNumRegisters() const { return m_end - m_first; }
+
+	bool Contains(t_ir_reg reg) const { return reg >= m_first && reg < m_end; }
+
+
+private:
+	t_ir_reg m_first{0};
+	t_ir_reg m_end{0};
+};
+
+
+/**
+ * the global code and the functions
+ *
+ * The registers follow the stack discipline of the vm: the arguments of an
+ * instruction are the most recently defined registers of its block which are
+ * not yet used, and every register is used at most once, in the same block.
+ * Registers which are not used remain on the stack, e.g. as return values.
+ * Variables stay in memory, or in a vm register, and are only accessed by
+ * explicit loads and stores, so no phi nodes are needed at the joins of the
+ * control flow.
+ */
+class IRProgram
+{
+public:
+	IRProgram();
+
+	IRFunc& GetGlobal() { return m_funcs[0]; }
+	const IRFunc& GetGlobal() const { return m_funcs[0]; }
+
+	std::vector<IRFunc>& GetFunctions() { return m_funcs; }
+	const std::vector<IRFunc>& GetFunctions() const { return m_funcs; }
+
+	SymTab& GetSymbolTable() { return m_symtab; }
+	const SymTab& GetSymbolTable() const { return m_symtab; }
+
+	t_ir_reg NewRegister() { return m_regs.NewRegister(); }
+	t_ir_reg GetNumRegisters() const { return m_regs.GetEnd(); }
+	const IRRegisters& GetRegisters() const { return m_regs; }
+
+	/**
+	 * move the registers of a function which were numbered by its own
+	 * allocator behind the ones of the program, returns the offset added to them
+	 */
+	t_ir_reg AddRegisters(IRFunc& func, const IRRegisters& regs);
+
+	std::size_t NumInstructions() const;
+
+	/**
+	 * check that the registers follow the stack discipline
+	 * and that the jump targets exist, throws otherwise
+	 */
+	void Check() const;
+
+	friend std::ostream& operator<<(std::ostream& ostr, const IRProgram& prog);
+
+
+private:
+	std::vector<IRFunc> m_funcs{};
+	SymTab m_symtab{};
+	IRRegisters m_regs{};
+};
+
+
+extern std::ostream& operator<<(std::ostream& ostr, const IRInstr& instr);
+extern std::ostream& operator<<(std::ostream& ostr, const IRFunc& func);
+
+
+#endif
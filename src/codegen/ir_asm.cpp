@@ -0,0 +1,270 @@
+/**
+ * lowers the intermediate representation to vm code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_asm.h"
+
+#include <stdexcept>
+
+
+IRAsm::IRAsm(CodeBuilder& code) : m_code{&code}
+{
+}
+
+
+/**
+ * get the label of a function, which is bound at its definition
+ */
+CodeBuilder::Label IRAsm::GetFuncLabel(const std::string& name)
+{
+	if(auto iter = m_func_labels.find(name); iter != m_func_labels.end())
+		return iter->second;
+
+	CodeBuilder::Label label = m_code->NewLabel();
+	m_func_labels.emplace(name, label);
+	return label;
+}
+
+
+/**
+ * generate the code of the program and fill in
+ * the function addresses in its symbol table
+ */
+void IRAsm::Emit(IRProgram& prog)
+{
+	EmitFunc(prog, prog.GetGlobal());
+	m_code->Resolve();
+}
+
+
+void IRAsm::EmitFunc(IRProgram& prog, const IRFunc& func)
+{
+	if(func.name != "")
+	{
+		t_vm_addr addr = m_code->GetPos();
+		m_code->Bind(GetFuncLabel(func.name));
+		prog.GetSymbolTable().AddSymbol(func.name, addr, VMType::ADDR_MEM, VMType::UNKNOWN,
+			true, func.num_args, func.frame_size);
+	}
+
+	// set the size of the stack frame
+	m_code->Op(OpCode::FRAME);
+	m_code->Raw(func.frame_size);
+
+	std::vector<CodeBuilder::Label> blocks;
+	blocks.reserve(func.blocks.size());
+	for(std::size_t idx=0; idx<func.blocks.size(); ++idx)
+		blocks.push_back(m_code->NewLabel());
+
+	for(std::size_t idx=0; idx<func.blocks.size(); ++idx)
+	{
+		m_code->Bind(blocks[idx]);
+
+		const std::vector<IRInstr>& instrs = func.blocks[idx].instrs;
+		for(std::size_t instridx=0; instridx<instrs.size(); ++instridx)
+		{
+			if(instridx + 1 < instrs.size() && EmitRegisterOp(instrs[instridx], instrs[instridx + 1]))
+			{
+				++instridx;
+				continue;
+			}
+
+			EmitInstr(prog, func, instrs[instridx], blocks, idx + 1);
+		}
+	}
+}
+
+
+/**
+ * apply a binary operator directly to a variable held in a register
+ */
+bool IRAsm::EmitRegisterOp(const IRInstr& load, const IRInstr& op)
+{
+	// the loaded variable has to be the operator's second argument
+	if(load.op != IROp::LOAD || !load.vmreg || op.op != IROp::OP ||
+		!is_vm_register_op(op.vmop) || op.args.size() != 2 || op.args[1] != load.dst)
+		return false;
+
+	m_code->Op(OpCode::OPR);
+	m_code->Raw(static_cast<t_vm_byte>(op.vmop));
+	m_code->Raw(static_cast<t_vm_byte>(*load.vmreg));
+	return true;
+}
+
+
+/**
+ * push the address of a variable or function
+ */
+void IRAsm::PushAddr(const IRInstr& instr)
+{
+	if(instr.sym.is_func)
+		m_code->PushLabel(GetFuncLabel(instr.name), false);
+	else
+		m_code->PushAddr(instr.sym.loc, instr.sym.addr);
+}
+
+
+void IRAsm::EmitInstr(IRProgram& prog, const IRFunc& func, const IRInstr& instr,
+	const std::vector<CodeBuilder::Label>& blocks, t_ir_block next_block)
+{
+	switch(instr.op)
+	{
+		case IROp::CONST:
+		{
+			// constants used by untagged operators have no type descriptors
+			if(instr.vmop == OpCode::PUSHI)
+			{
+				m_code->Op(OpCode::PUSHI);
+				m_code->Raw(std::get<t_vm_int>(instr.val));
+			}
+			else if(instr.vmop == OpCode::PUSHF)
+			{
+				m_code->Op(OpCode::PUSHF);
+				m_code->Raw(std::get<t_vm_real>(instr.val));
+			}
+			else if(std::holds_alternative<t_vm_int>(instr.val))
+				m_code->PushInt(std::get<t_vm_int>(instr.val));
+			else if(std::holds_alternative<t_vm_real>(instr.val))
+				m_code->PushReal(std::get<t_vm_real>(instr.val));
+			else if(std::holds_alternative<t_vm_str>(instr.val))
+				m_code->PushStr(std::get<t_vm_str>(instr.val));
+			else
+				throw std::runtime_error("Invalid constant.");
+			break;
+		}
+
+		case IROp::LOAD:
+		{
+			if(instr.vmreg)
+			{
+				m_code->Op(OpCode::LDR);
+				m_code->Raw(static_cast<t_vm_byte>(*instr.vmreg));
+				break;
+			}
+
+			PushAddr(instr);
+			m_code->Op(OpCode::RDMEM);
+			break;
+		}
+
+		case IROp::STORE:
+		{
+			if(instr.vmreg)
+			{
+				m_code->Op(OpCode::STR);
+				m_code->Raw(static_cast<t_vm_byte>(*instr.vmreg));
+				break;
+			}
+
+			PushAddr(instr);
+			m_code->Op(OpCode::WRMEM);
+			break;
+		}
+
+		case IROp::ADDR:
+		{
+			PushAddr(instr);
+			break;
+		}
+
+		case IROp::OP:
+		{
+			m_code->Op(instr.vmop);
+			break;
+		}
+
+		case IROp::CALL:
+		{
+			// push the relative function address and call it
+			m_code->PushLabel(GetFuncLabel(instr.name), true);
+			m_code->Op(OpCode::CALL);
+			break;
+		}
+
+		case IROp::EXTCALL:
+		{
+			if(instr.ext_idx)
+			{
+				// call external function via its index
+				m_code->Op(OpCode::EXTCALLI);
+				m_code->Raw(*instr.ext_idx);
+			}
+			else
+			{
+				// call external function via its name
+				m_code->PushStr(instr.name);
+				m_code->Op(OpCode::EXTCALL);
+			}
+			break;
+		}
+
+		case IROp::FUNC:
+		{
+			// jump over the function to prevent accidental execution
+			CodeBuilder::Label end_func = m_code->NewLabel();
+			m_code->Jump(OpCode::JMP, end_func);
+			EmitFunc(prog, prog.GetFunctions().at(instr.func));
+			m_code->Bind(end_func);
+			break;
+		}
+
+		case IROp::JMP:
+		{
+			// fall through to the next block
+			if(instr.targets[0] != next_block)
+				m_code->Jump(OpCode::JMP, blocks[instr.targets[0]]);
+			break;
+		}
+
+		case IROp::BRANCH:
+		{
+			if(instr.targets[1] == next_block)
+			{
+				m_code->Jump(OpCode::JMPCND, blocks[instr.targets[0]]);
+			}
+			else
+			{
+				// if the condition is not fulfilled, skip to the else block
+				m_code->Op(OpCode::NOT);
+				m_code->Jump(OpCode::JMPCND, blocks[instr.targets[1]]);
+
+				if(instr.targets[0] != next_block)
+					m_code->Jump(OpCode::JMP, blocks[instr.targets[0]]);
+			}
+			break;
+		}
+
+		case IROp::RET:
+		{
+			// push number of arguments and return
+			m_code->PushInt(func.num_args);
+			m_code->Op(OpCode::RET);
+			break;
+		}
+
+		case IROp::TAILCALL:
+		{
+			// push the absolute function address, as the following numbers of
+			// the current and the called function's arguments are part of the
+			// instruction, and call the function in place of the current one
+			m_code->PushLabel(GetFuncLabel(instr.name), false);
+			m_code->Op(OpCode::TAILCALL);
+			m_code->Raw(static_cast<t_vm_addr>(func.num_args));
+			m_code->Raw(static_cast<t_vm_addr>(instr.args.size()));
+
+			// interrupt service routines return after a regular call
+			m_code->PushInt(func.num_args);
+			m_code->Op(OpCode::RET);
+			break;
+		}
+
+		case IROp::HALT:
+		{
+			m_code->Op(OpCode::HALT);
+			break;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/**
+ * lowers the intermediate representation to vm code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_IR_ASM_H__
+#define __LR1_IR_ASM_H__
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+#include "ir.h"
+#include "code_builder.h"
+
+
+class IRAsm
+{
+public:
+	IRAsm(CodeBuilder& code);
+
+	IRAsm(const IRAsm&) = delete;
+	const IRAsm& operator=(const IRAsm&) = delete;
+
+	/**
+	 * generate the code of the program and fill in
+	 * the function addresses in its symbol table
+	 */
+	void Emit(IRProgram& prog);
+
+
+protected:
+	void EmitFunc(IRProgram& prog, const IRFunc& func);
+	void EmitInstr(IRProgram& prog, const IRFunc& func, const IRInstr& instr,
+		const std::vector<CodeBuilder::Label>& blocks, t_ir_block next_block);
+
+	/**
+	 * apply a binary operator directly to a variable held in a register,
+	 * returns false if the instructions cannot be combined
+	 */
+	bool EmitRegisterOp(const IRInstr& load, const IRInstr& op);
+
+	/**
+	 * push the address of a variable or function
+	 */
+	void PushAddr(const IRInstr& instr);
+
+	/**
+	 * get the label of a function, which is bound at its definition
+	 */
+	CodeBuilder::Label GetFuncLabel(const std::string& name);
+
+
+private:
+	CodeBuilder* m_code{nullptr};
+
+	// labels of the functions
+	std::unordered_map<std::string, CodeBuilder::Label> m_func_labels{};
+};
+
+
+#endif
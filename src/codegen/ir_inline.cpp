@@ -0,0 +1,424 @@
+/**
+ * inlining of small functions and tail call optimisation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_inline.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+
+// variable name and location
+using t_ir_var = std::pair<std::string, SymInfo>;
+
+
+/**
+ * get the indices of the functions by their names
+ */
+static std::unordered_map<std::string, std::size_t> get_func_indices(const IRProgram& prog)
+{
+	std::unordered_map<std::string, std::size_t> indices;
+
+	const std::vector<IRFunc>& funcs = prog.GetFunctions();
+	for(std::size_t funcidx=1; funcidx<funcs.size(); ++funcidx)
+		indices.emplace(funcs[funcidx].name, funcidx);
+
+	return indices;
+}
+
+
+/**
+ * get the name of a variable in the symbol table
+ */
+static std::string get_var_name(const IRFunc& func, const std::string& name)
+{
+	if(func.name == "")
+		return name;
+	return func.name + "/" + name;
+}
+
+
+/**
+ * get the name and location of a function argument
+ */
+static t_ir_var get_arg(const SymTab& symtab, const IRFunc& func, t_vm_int idx)
+{
+	// index 0 is the saved base pointer and 1 the return address
+	const t_vm_addr addr = static_cast<t_vm_addr>(idx + 2);
+	const std::string prefix = func.name + "/";
+
+	for(const auto& [name, sym] : symtab.GetSymbols())
+	{
+		if(name.starts_with(prefix) && sym.loc == VMType::ADDR_BP_ARG && sym.addr == addr)
+			return std::make_pair(name.substr(prefix.length()), sym);
+	}
+
+	return std::make_pair("arg" + std::to_string(idx),
+		SymInfo{ .addr = addr, .loc = VMType::ADDR_BP_ARG });
+}
+
+
+/**
+ * get the number of values on the stack before the given instruction of a block
+ */
+static std::size_t get_stack_depth(const IRBlock& block, std::size_t end)
+{
+	std::size_t depth = 0;
+
+	for(std::size_t idx=0; idx<end && idx<block.instrs.size(); ++idx)
+	{
+		const IRInstr& instr = block.instrs[idx];
+		depth -= std::min(depth, instr.args.size());
+		if(instr.dst != g_ir_noreg)
+			++depth;
+	}
+
+	return depth;
+}
+
+
+/**
+ * are all values on the stack used in their blocks?
+ */
+static bool has_leftovers(const IRFunc& func)
+{
+	return std::any_of(func.blocks.begin(), func.blocks.end(), [](const IRBlock& block) -> bool
+	{
+		return get_stack_depth(block, block.instrs.size()) != 0;
+	});
+}
+
+
+/**
+ * can the function's code be copied to its call sites?
+ */
+static bool can_inline(const IRFunc& func, std::size_t max_instrs)
+{
+	// the function has to consist of a single block which returns a value
+	if(func.blocks.size() != 1 || func.NumInstructions() > max_instrs || has_leftovers(func))
+		return false;
+
+	const IRBlock& block = func.blocks[0];
+	const IRInstr& term = block.GetTerminator();
+	if(term.op != IROp::RET || term.args.size() != 1)
+		return false;
+
+	for(const IRInstr& instr : block.instrs)
+	{
+		// calls and addresses need the function's own stack frame
+		if(instr.op == IROp::CALL || instr.op == IROp::TAILCALL ||
+			instr.op == IROp::ADDR || instr.op == IROp::FUNC)
+			return false;
+
+		if((instr.op == IROp::LOAD || instr.op == IROp::STORE) &&
+			instr.sym.loc == VMType::ADDR_BP_ARG &&
+			(instr.sym.addr < 2 || instr.sym.addr >= func.num_args + 2))
+			return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * copy the code of a function to a call site, the arguments and local
+ * variables get their own slots in the caller's stack frame,
+ * returns the register holding the function's result
+ */
+static t_ir_reg inline_call(IRProgram& prog, IRFunc& caller, const IRFunc& callee,
+	const IRInstr& call, std::vector<IRInstr>& instrs, std::size_t site)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+	const VMType loc = caller.name == "" ? VMType::ADDR_GBP : VMType::ADDR_BP;
+	const std::string prefix = callee.name + "#" + std::to_string(site) + ".";
+
+	auto add_var = [&](const std::string& name, t_vm_addr addr, VMType ty) -> t_ir_var
+	{
+		const SymInfo *sym = symtab.AddSymbol(get_var_name(caller, prefix + name), addr, loc, ty);
+		return std::make_pair(prefix + name, *sym);
+	};
+
+	// the callee's local variables are placed below the caller's,
+	// the tops of both stack frames hold their sizes
+	const t_vm_addr locals_offs = caller.frame_size - vm_type_size<VMType::ADDR_MEM, false>;
+	caller.frame_size += callee.frame_size - vm_type_size<VMType::ADDR_MEM, false>;
+
+	// the arguments become local variables, they can have any type
+	std::vector<t_ir_var> args;
+	for(t_vm_int idx=0; idx<callee.num_args; ++idx)
+	{
+		caller.frame_size += vm_type_size<VMType::UNKNOWN, true>;
+		args.emplace_back(add_var(get_arg(symtab, callee, idx).first,
+			-caller.frame_size, VMType::UNKNOWN));
+	}
+
+	// the first argument is on top of the stack
+	for(std::size_t idx=0; idx<args.size(); ++idx)
+	{
+		const auto& [name, sym] = args[idx];
+		instrs.emplace_back(IRInstr{ .op = IROp::STORE,
+			.args = { call.args[call.args.size() - idx - 1] }, .name = name, .sym = sym });
+	}
+
+	std::unordered_map<t_ir_reg, t_ir_reg> regs;
+	std::unordered_map<std::string, t_ir_var> locals;
+
+	for(const IRInstr& callee_instr : callee.blocks[0].instrs)
+	{
+		IRInstr instr = callee_instr;
+		for(t_ir_reg& arg : instr.args)
+			arg = regs.at(arg);
+
+		// the returned value stays on the stack
+		if(instr.op == IROp::RET)
+			return instr.args[0];
+
+		if(instr.dst != g_ir_noreg)
+		{
+			t_ir_reg reg = prog.NewRegister();
+			regs.emplace(instr.dst, reg);
+			instr.dst = reg;
+		}
+
+		if(instr.op == IROp::LOAD || instr.op == IROp::STORE)
+		{
+			if(instr.sym.loc == VMType::ADDR_BP_ARG)
+			{
+				std::tie(instr.name, instr.sym) = args[static_cast<std::size_t>(instr.sym.addr - 2)];
+			}
+			else if(instr.sym.loc == VMType::ADDR_BP)
+			{
+				auto iter = locals.find(instr.name);
+				if(iter == locals.end())
+				{
+					iter = locals.emplace(instr.name, add_var(instr.name,
+						instr.sym.addr - locals_offs, instr.sym.ty)).first;
+				}
+				std::tie(instr.name, instr.sym) = iter->second;
+			}
+		}
+
+		instrs.emplace_back(std::move(instr));
+	}
+
+	return g_ir_noreg;
+}
+
+
+/**
+ * remove the given functions if they are neither called nor referenced anymore
+ */
+static void remove_unused_funcs(IRProgram& prog, const std::vector<bool>& candidates)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	SymTab& symtab = prog.GetSymbolTable();
+
+	std::unordered_set<std::string> used;
+	for(const IRFunc& func : funcs)
+	{
+		for(const IRBlock& block : func.blocks)
+		{
+			for(const IRInstr& instr : block.instrs)
+			{
+				if(instr.op == IROp::CALL || instr.op == IROp::TAILCALL ||
+					(instr.op == IROp::ADDR && instr.sym.is_func))
+					used.insert(instr.name);
+			}
+		}
+	}
+
+	constexpr const std::size_t none = std::numeric_limits<std::size_t>::max();
+	std::vector<std::size_t> new_idx(funcs.size(), none);
+	std::vector<IRFunc> kept;
+	for(std::size_t funcidx=0; funcidx<funcs.size(); ++funcidx)
+	{
+		if(funcidx == 0 || !candidates[funcidx] || used.contains(funcs[funcidx].name))
+		{
+			new_idx[funcidx] = kept.size();
+			kept.emplace_back(std::move(funcs[funcidx]));
+			continue;
+		}
+
+		// remove the function and its variables from the symbol table
+		const std::string& name = funcs[funcidx].name;
+		std::vector<std::string> syms{ name };
+		for(const auto& [symname, sym] : symtab.GetSymbols())
+		{
+			if(symname.starts_with(name + "/"))
+				syms.push_back(symname);
+		}
+		for(const std::string& symname : syms)
+			symtab.RemoveSymbol(symname);
+	}
+
+	// remove the definitions from the global code
+	for(IRBlock& block : kept[0].blocks)
+	{
+		std::erase_if(block.instrs, [&new_idx](const IRInstr& instr) -> bool
+		{
+			return instr.op == IROp::FUNC && new_idx[instr.func] == none;
+		});
+
+		for(IRInstr& instr : block.instrs)
+		{
+			if(instr.op == IROp::FUNC)
+				instr.func = new_idx[instr.func];
+		}
+	}
+
+	funcs = std::move(kept);
+}
+
+
+/**
+ * replace the calls of small functions without calls and branches by their
+ * code, the arguments and local variables of the inlined functions are moved
+ * to the callers' stack frames and the functions which are not used anymore
+ * are removed, returns the number of inlined calls
+ */
+std::size_t ir_inline_calls(IRProgram& prog, std::size_t max_instrs)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	std::unordered_map<std::string, std::size_t> func_indices = get_func_indices(prog);
+
+	// the inlined functions themselves contain no calls
+	std::vector<bool> inlinable(funcs.size(), false);
+	for(std::size_t funcidx=1; funcidx<funcs.size(); ++funcidx)
+		inlinable[funcidx] = can_inline(funcs[funcidx], max_instrs);
+
+	std::size_t num_inlined = 0;
+	for(IRFunc& func : funcs)
+	{
+		for(IRBlock& block : func.blocks)
+		{
+			// the result of the function takes the place of the call's result
+			std::unordered_map<t_ir_reg, t_ir_reg> renamed;
+			std::vector<IRInstr> instrs;
+			instrs.reserve(block.instrs.size());
+
+			for(IRInstr& instr : block.instrs)
+			{
+				for(t_ir_reg& arg : instr.args)
+				{
+					if(auto iter = renamed.find(arg); iter != renamed.end())
+						arg = iter->second;
+				}
+
+				if(instr.op == IROp::CALL && instr.dst != g_ir_noreg)
+				{
+					auto iter = func_indices.find(instr.name);
+					if(iter != func_indices.end() && inlinable[iter->second] &&
+						static_cast<t_vm_int>(instr.args.size()) == funcs[iter->second].num_args)
+					{
+						t_ir_reg result = inline_call(prog, func, funcs[iter->second],
+							instr, instrs, ++num_inlined);
+						renamed.emplace(instr.dst, result);
+						continue;
+					}
+				}
+
+				instrs.emplace_back(std::move(instr));
+			}
+
+			block.instrs = std::move(instrs);
+		}
+	}
+
+	if(num_inlined)
+		remove_unused_funcs(prog, inlinable);
+	return num_inlined;
+}
+
+
+/**
+ * replace calls whose results are directly returned: recursive calls
+ * overwrite the arguments and jump back to the start of the function,
+ * other calls reuse the stack frame of the calling function,
+ * returns the number of replaced calls
+ */
+std::size_t ir_tail_calls(IRProgram& prog, const IRTypes& types)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	std::unordered_map<std::string, std::size_t> func_indices = get_func_indices(prog);
+	const SymTab& symtab = prog.GetSymbolTable();
+
+	std::size_t num_replaced = 0;
+	for(std::size_t funcidx=1; funcidx<funcs.size(); ++funcidx)
+	{
+		IRFunc& func = funcs[funcidx];
+
+		// the stack frame is left with only the called function's arguments
+		// on the stack, variable addresses would point into the old frame
+		if(has_leftovers(func) || std::any_of(func.blocks.begin(), func.blocks.end(),
+			[](const IRBlock& block) -> bool
+			{
+				return std::any_of(block.instrs.begin(), block.instrs.end(),
+					[](const IRInstr& instr) -> bool
+					{
+						return instr.op == IROp::ADDR && !instr.sym.is_func;
+					});
+			}))
+			continue;
+
+		for(IRBlock& block : func.blocks)
+		{
+			std::size_t num_instrs = block.instrs.size();
+			if(num_instrs < 2)
+				continue;
+
+			const IRInstr& ret = block.instrs[num_instrs - 1];
+			const IRInstr& call = block.instrs[num_instrs - 2];
+			if(ret.op != IROp::RET || ret.args.size() != 1 ||
+				call.op != IROp::CALL || call.dst != ret.args[0])
+				continue;
+
+			auto iter = func_indices.find(call.name);
+			if(iter == func_indices.end() ||
+				static_cast<t_vm_int>(call.args.size()) != funcs[iter->second].num_args ||
+				get_stack_depth(block, num_instrs - 2) != call.args.size())
+				continue;
+
+			// recursive calls with arguments of the same types, and thus sizes,
+			// can overwrite the arguments in place
+			bool in_place = (iter->second == funcidx);
+			for(std::size_t idx=0; in_place && idx<call.args.size(); ++idx)
+			{
+				const IRType& ty = types.args[funcidx][idx];
+				in_place = ty.kind == IRType::Kind::ONE &&
+					types.regs[call.args[call.args.size() - idx - 1]] == ty;
+			}
+
+			IRInstr tailcall{ .op = IROp::TAILCALL, .args = call.args, .name = call.name };
+			block.instrs.resize(num_instrs - 2);
+
+			if(in_place)
+			{
+				// the first argument is on top of the stack
+				for(std::size_t idx=0; idx<tailcall.args.size(); ++idx)
+				{
+					auto [name, sym] = get_arg(symtab, func, static_cast<t_vm_int>(idx));
+					block.instrs.emplace_back(IRInstr{ .op = IROp::STORE,
+						.args = { tailcall.args[tailcall.args.size() - idx - 1] },
+						.name = name, .sym = sym });
+				}
+
+				// jump back to the function's first block
+				block.instrs.emplace_back(IRInstr{ .op = IROp::JMP });
+			}
+			else
+			{
+				block.instrs.emplace_back(std::move(tailcall));
+			}
+
+			++num_replaced;
+		}
+	}
+
+	return num_replaced;
+}
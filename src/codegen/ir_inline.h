@@ -0,0 +1,37 @@
+/**
+ * inlining of small functions and tail call optimisation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://en.wikipedia.org/wiki/Inline_expansion
+ * 	- https://en.wikipedia.org/wiki/Tail_call
+ */
+
+#ifndef __LR1_IR_INLINE_H__
+#define __LR1_IR_INLINE_H__
+
+#include "ir.h"
+#include "ir_types.h"
+
+
+/**
+ * replace the calls of small functions without calls and branches by their
+ * code, the arguments and local variables of the inlined functions are moved
+ * to the callers' stack frames and the functions which are not used anymore
+ * are removed, returns the number of inlined calls
+ */
+extern std::size_t ir_inline_calls(IRProgram& prog, std::size_t max_instrs = 32);
+
+
+/**
+ * replace calls whose results are directly returned: recursive calls
+ * overwrite the arguments and jump back to the start of the function,
+ * other calls reuse the stack frame of the calling function,
+ * returns the number of replaced calls
+ */
+extern std::size_t ir_tail_calls(IRProgram& prog, const IRTypes& types);
+
+
+#endif
@@ -0,0 +1,983 @@
+/**
+ * loop optimisations on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_loops.h"
+#include "parallel.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <limits>
+
+
+// variable name and location
+using t_ir_var = std::pair<std::string, SymInfo>;
+
+
+/**
+ * blocks of a loop, which is entered via its header
+ */
+struct IRLoop
+{
+	t_ir_block header{0};
+	std::vector<bool> body{};      // indexed by block
+	std::size_t size{0};           // number of blocks
+
+	bool Contains(t_ir_block block) const { return block < body.size() && body[block]; }
+};
+
+
+/**
+ * expression computing the register defined by an instruction,
+ * it consists of the instructions from begin to the defining one
+ */
+struct IRTree
+{
+	std::size_t begin{0};
+	std::size_t num_instrs{1};
+	bool invariant{false};         // does the value stay the same in the loop?
+	bool has_op{false};            // is the value computed by an operator?
+};
+
+
+/**
+ * get the name of a variable in the symbol table
+ */
+static std::string get_var_name(const IRFunc& func, const std::string& name)
+{
+	if(func.name == "")
+		return name;
+	return func.name + "/" + name;
+}
+
+
+/**
+ * get the type of a register, the ones created after the type inference are unknown
+ */
+static IRType get_reg_type(const IRTypes& types, t_ir_reg reg)
+{
+	if(reg >= types.regs.size())
+		return IRType::Any();
+	return types.regs[reg];
+}
+
+
+static bool is_number(const IRType& ty)
+{
+	return ty.Is(VMType::INT) || ty.Is(VMType::REAL);
+}
+
+
+/**
+ * is the instruction a load or store of a variable or argument in the function's stack frame?
+ */
+static bool is_local_var(const IRInstr& instr)
+{
+	if((instr.op != IROp::LOAD && instr.op != IROp::STORE) || instr.sym.is_func)
+		return false;
+
+	return instr.sym.loc == VMType::ADDR_BP || instr.sym.loc == VMType::ADDR_GBP ||
+		instr.sym.loc == VMType::ADDR_BP_ARG;
+}
+
+
+/**
+ * get the integer value of a constant
+ */
+static std::optional<t_vm_int> get_int_const(const IRInstr& instr)
+{
+	if(instr.op != IROp::CONST || !std::holds_alternative<t_vm_int>(instr.val))
+		return std::nullopt;
+	return std::get<t_vm_int>(instr.val);
+}
+
+
+/**
+ * can the operator be computed in front of the loop, i.e. it has no side effects
+ * and does not throw if the loop would not have been entered
+ */
+static bool is_hoistable_op(OpCode op)
+{
+	switch(op)
+	{
+		case OpCode::USUB: case OpCode::ADD: case OpCode::SUB: case OpCode::MUL:
+		case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+		case OpCode::TOI: case OpCode::TOF:
+		case OpCode::BINAND: case OpCode::BINOR: case OpCode::BINXOR: case OpCode::BINNOT:
+		case OpCode::SHL: case OpCode::SHR: case OpCode::ROTL: case OpCode::ROTR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+/**
+ * get the predecessors of the blocks
+ */
+static std::vector<std::vector<t_ir_block>> get_predecessors(const IRFunc& func)
+{
+	std::vector<std::vector<t_ir_block>> preds(func.blocks.size());
+
+	for(t_ir_block idx=0; idx<func.blocks.size(); ++idx)
+	{
+		for(t_ir_block succ : func.blocks[idx].GetSuccessors())
+			preds[succ].push_back(idx);
+	}
+
+	return preds;
+}
+
+
+/**
+ * find the natural loops of a function, which are closed by jumps to blocks dominating
+ * the jumping one, loops sharing a header are merged
+ */
+static std::vector<IRLoop> find_loops(const IRFunc& func)
+{
+	const std::size_t num_blocks = func.blocks.size();
+	const std::vector<std::vector<t_ir_block>> preds = get_predecessors(func);
+
+	// blocks which can be reached from the entry
+	std::vector<bool> reachable(num_blocks, false);
+	std::vector<t_ir_block> todo{0};
+	reachable[0] = true;
+	while(!todo.empty())
+	{
+		t_ir_block cur = todo.back();
+		todo.pop_back();
+
+		for(t_ir_block next : func.blocks[cur].GetSuccessors())
+		{
+			if(reachable[next])
+				continue;
+			reachable[next] = true;
+			todo.push_back(next);
+		}
+	}
+
+	// dominators, i.e. the blocks which are on every path from the entry to a block
+	std::vector<std::vector<bool>> doms(num_blocks, std::vector<bool>(num_blocks, true));
+	doms[0].assign(num_blocks, false);
+	doms[0][0] = true;
+	for(bool changed = true; changed;)
+	{
+		changed = false;
+		for(t_ir_block idx=1; idx<num_blocks; ++idx)
+		{
+			if(!reachable[idx])
+				continue;
+
+			std::vector<bool> dom(num_blocks, true);
+			for(t_ir_block pred : preds[idx])
+			{
+				if(!reachable[pred])
+					continue;
+				for(t_ir_block domidx=0; domidx<num_blocks; ++domidx)
+					dom[domidx] = dom[domidx] && doms[pred][domidx];
+			}
+			dom[idx] = true;
+
+			if(dom != doms[idx])
+			{
+				doms[idx] = std::move(dom);
+				changed = true;
+			}
+		}
+	}
+
+	// the body consists of the blocks reaching the jump back without passing the header
+	std::vector<IRLoop> loops;
+	for(t_ir_block idx=0; idx<num_blocks; ++idx)
+	{
+		if(!reachable[idx])
+			continue;
+
+		for(t_ir_block header : func.blocks[idx].GetSuccessors())
+		{
+			if(!doms[idx][header])
+				continue;
+
+			auto iter = std::find_if(loops.begin(), loops.end(),
+				[header](const IRLoop& loop) -> bool { return loop.header == header; });
+			if(iter == loops.end())
+			{
+				loops.emplace_back(IRLoop{ .header = header,
+					.body = std::vector<bool>(num_blocks, false) });
+				iter = std::prev(loops.end());
+			}
+
+			IRLoop& loop = *iter;
+			loop.body[header] = true;
+			std::vector<t_ir_block> body_todo{idx};
+			while(!body_todo.empty())
+			{
+				t_ir_block cur = body_todo.back();
+				body_todo.pop_back();
+				if(loop.body[cur])
+					continue;
+
+				loop.body[cur] = true;
+				for(t_ir_block pred : preds[cur])
+				{
+					if(reachable[pred])
+						body_todo.push_back(pred);
+				}
+			}
+		}
+	}
+
+	for(IRLoop& loop : loops)
+		loop.size = static_cast<std::size_t>(std::count(loop.body.begin(), loop.body.end(), true));
+	return loops;
+}
+
+
+/**
+ * get the variables which might be read before they are written
+ */
+static std::unordered_set<std::string> get_unassigned_vars(const IRFunc& func)
+{
+	const std::size_t num_blocks = func.blocks.size();
+	std::vector<std::unordered_set<std::string>> uses(num_blocks), defs(num_blocks);
+
+	for(t_ir_block idx=0; idx<num_blocks; ++idx)
+	{
+		for(const IRInstr& instr : func.blocks[idx].instrs)
+		{
+			if(!is_local_var(instr))
+				continue;
+			if(instr.op == IROp::LOAD && !defs[idx].contains(instr.name))
+				uses[idx].insert(instr.name);
+			else if(instr.op == IROp::STORE)
+				defs[idx].insert(instr.name);
+		}
+	}
+
+	// live variables at the beginning of the blocks
+	std::vector<std::unordered_set<std::string>> live_in(num_blocks);
+	for(bool changed = true; changed;)
+	{
+		changed = false;
+		for(t_ir_block idx=num_blocks; idx-- > 0;)
+		{
+			std::unordered_set<std::string> in = uses[idx];
+			for(t_ir_block succ : func.blocks[idx].GetSuccessors())
+			{
+				for(const std::string& var : live_in[succ])
+				{
+					if(!defs[idx].contains(var))
+						in.insert(var);
+				}
+			}
+
+			if(in != live_in[idx])
+			{
+				live_in[idx] = std::move(in);
+				changed = true;
+			}
+		}
+	}
+
+	return live_in[0];
+}
+
+
+/**
+ * optimisation of the loops of a function
+ */
+class IRLoopOpt
+{
+public:
+	IRLoopOpt(const SymTab& symtab, IRFunc& func, const IRTypes& types, t_ir_reg first_reg)
+		: m_symtab{symtab}, m_func{func}, m_types{types}, m_regs{first_reg},
+		m_unassigned{get_unassigned_vars(func)}
+	{}
+
+	/**
+	 * registers and variables created by the optimisation,
+	 * they are added to the program when all functions are finished
+	 */
+	const IRRegisters& GetRegisters() const { return m_regs; }
+	const SymTab& GetVariables() const { return m_vars; }
+
+	/**
+	 * optimise the loops, the inner ones first, so that the moved
+	 * expressions can then be moved further out of the outer loops
+	 */
+	std::size_t Optimise()
+	{
+		std::size_t num_optimised = 0;
+		std::vector<t_ir_block> done;
+
+		while(true)
+		{
+			// the loops are searched again as new blocks can be
+			// added in front of them, the headers keep their indices
+			std::vector<IRLoop> loops = find_loops(m_func);
+			std::erase_if(loops, [&done](const IRLoop& loop) -> bool
+			{
+				return std::find(done.begin(), done.end(), loop.header) != done.end();
+			});
+			if(loops.empty())
+				break;
+
+			const IRLoop& loop = *std::min_element(loops.begin(), loops.end(),
+				[](const IRLoop& loop1, const IRLoop& loop2) -> bool
+				{
+					return loop1.size < loop2.size;
+				});
+			done.push_back(loop.header);
+
+			num_optimised += HoistInvariants(loop);
+			num_optimised += ReduceInductionVars(loop.header);
+		}
+
+		return num_optimised;
+	}
+
+
+protected:
+	/**
+	 * get the variables written in the loop with their number of stores
+	 */
+	std::unordered_map<std::string, std::size_t> GetStores(const IRLoop& loop) const
+	{
+		std::unordered_map<std::string, std::size_t> stores;
+
+		for(t_ir_block idx=0; idx<m_func.blocks.size(); ++idx)
+		{
+			if(!loop.Contains(idx))
+				continue;
+
+			for(const IRInstr& instr : m_func.blocks[idx].instrs)
+			{
+				if(instr.op == IROp::STORE)
+					++stores[instr.name];
+			}
+		}
+
+		return stores;
+	}
+
+
+	/**
+	 * has the variable been assigned when the loop is entered?
+	 */
+	bool IsAssigned(const IRInstr& instr) const
+	{
+		return instr.sym.loc == VMType::ADDR_BP_ARG || !m_unassigned.contains(instr.name);
+	}
+
+
+	/**
+	 * create a local variable for holding a value computed in front of the loop
+	 */
+	t_ir_var NewVariable(const std::string& prefix, VMType ty)
+	{
+		std::string name;
+		for(std::size_t idx=1; ; ++idx)
+		{
+			name = prefix + "#" + std::to_string(idx);
+			if(!m_symtab.GetSymbol(get_var_name(m_func, name)) &&
+				!m_vars.GetSymbol(get_var_name(m_func, name)))
+				break;
+		}
+
+		const VMType loc = m_func.name == "" ? VMType::ADDR_GBP : VMType::ADDR_BP;
+		m_func.frame_size += get_vm_type_size(ty, true);
+		const SymInfo *sym = m_vars.AddSymbol(get_var_name(m_func, name), -m_func.frame_size, loc, ty);
+
+		return std::make_pair(name, *sym);
+	}
+
+
+	/**
+	 * create a new register having the given type
+	 */
+	t_ir_reg NewRegister(const IRType& ty)
+	{
+		m_reg_types.push_back(ty);
+		return m_regs.NewRegister();
+	}
+
+
+	/**
+	 * get the type of an existing or a new register
+	 */
+	IRType GetRegType(t_ir_reg reg) const
+	{
+		if(m_regs.Contains(reg))
+			return m_reg_types[reg - m_regs.GetFirst()];
+		return get_reg_type(m_types, reg);
+	}
+
+
+	/**
+	 * copy code with new registers
+	 */
+	std::vector<IRInstr> CopyCode(const std::vector<IRInstr>& code)
+	{
+		std::unordered_map<t_ir_reg, t_ir_reg> regs;
+		std::vector<IRInstr> copy = code;
+
+		for(IRInstr& instr : copy)
+		{
+			for(t_ir_reg& arg : instr.args)
+				arg = regs.at(arg);
+
+			if(instr.dst != g_ir_noreg)
+			{
+				t_ir_reg reg = NewRegister(GetRegType(instr.dst));
+				regs.emplace(instr.dst, reg);
+				instr.dst = reg;
+			}
+		}
+
+		return copy;
+	}
+
+
+	/**
+	 * can code be placed in front of the loop?
+	 */
+	bool HasEntry(const IRLoop& loop) const
+	{
+		for(t_ir_block idx=0; idx<m_func.blocks.size(); ++idx)
+		{
+			if(loop.Contains(idx))
+				continue;
+
+			std::vector<t_ir_block> succs = m_func.blocks[idx].GetSuccessors();
+			if(std::find(succs.begin(), succs.end(), loop.header) != succs.end())
+				return true;
+		}
+
+		return false;
+	}
+
+
+	/**
+	 * place code at the end of all blocks entering the loop, blocks which
+	 * enter it conditionally jump to a new block holding the code
+	 */
+	void InsertBeforeLoop(const IRLoop& loop, const std::vector<IRInstr>& code)
+	{
+		const std::size_t num_blocks = m_func.blocks.size();
+		for(t_ir_block idx=0; idx<num_blocks; ++idx)
+		{
+			if(loop.Contains(idx))
+				continue;
+
+			IRInstr& term = m_func.blocks[idx].GetTerminator();
+			if(term.op == IROp::JMP && term.targets[0] == loop.header)
+			{
+				std::vector<IRInstr>& instrs = m_func.blocks[idx].instrs;
+				std::vector<IRInstr> copy = CopyCode(code);
+				instrs.insert(std::prev(instrs.end()), copy.begin(), copy.end());
+			}
+			else if(term.op == IROp::BRANCH &&
+				(term.targets[0] == loop.header || term.targets[1] == loop.header))
+			{
+				for(t_ir_block& target : term.targets)
+				{
+					if(target == loop.header)
+						target = m_func.blocks.size();
+				}
+
+				IRBlock block{ .instrs = CopyCode(code) };
+				block.instrs.emplace_back(IRInstr{ .op = IROp::JMP, .targets = { loop.header, 0 } });
+				m_func.blocks.emplace_back(std::move(block));
+			}
+		}
+	}
+
+
+	/**
+	 * find the expression trees in a block
+	 */
+	std::vector<IRTree> GetTrees(const IRBlock& block,
+		const std::unordered_map<std::string, std::size_t>& stores) const
+	{
+		const std::vector<IRInstr>& instrs = block.instrs;
+		std::vector<IRTree> trees(instrs.size());
+		std::unordered_map<t_ir_reg, std::size_t> defs;
+
+		for(std::size_t idx=0; idx<instrs.size(); ++idx)
+		{
+			const IRInstr& instr = instrs[idx];
+			IRTree& tree = trees[idx];
+			tree.begin = idx;
+			tree.has_op = instr.op == IROp::OP;
+
+			bool args_invariant = true;
+			for(t_ir_reg arg : instr.args)
+			{
+				auto iter = defs.find(arg);
+				if(iter == defs.end())
+				{
+					args_invariant = false;
+					continue;
+				}
+
+				const IRTree& argtree = trees[iter->second];
+				tree.begin = std::min(tree.begin, argtree.begin);
+				tree.num_instrs += argtree.num_instrs;
+				tree.has_op = tree.has_op || argtree.has_op;
+				args_invariant = args_invariant && argtree.invariant;
+			}
+
+			switch(instr.op)
+			{
+				case IROp::CONST:
+					tree.invariant = true;
+					break;
+
+				// variables which are not written in the loop
+				case IROp::LOAD:
+					tree.invariant = is_local_var(instr) && !stores.contains(instr.name) &&
+						IsAssigned(instr) && is_number(GetRegType(instr.dst));
+					break;
+
+				// the operands have to directly precede the operator
+				case IROp::OP:
+					tree.invariant = args_invariant &&
+						tree.num_instrs == idx - tree.begin + 1 &&
+						IsHoistable(instrs, defs, instr);
+					break;
+
+				default:
+					tree.invariant = false;
+					break;
+			}
+
+			if(instr.dst != g_ir_noreg)
+				defs[instr.dst] = idx;
+		}
+
+		return trees;
+	}
+
+
+	/**
+	 * can the operator be computed in front of the loop?
+	 */
+	bool IsHoistable(const std::vector<IRInstr>& instrs,
+		const std::unordered_map<t_ir_reg, std::size_t>& defs, const IRInstr& instr) const
+	{
+		if(!is_hoistable_op(instr.vmop) || !is_number(GetRegType(instr.dst)))
+			return false;
+		for(t_ir_reg arg : instr.args)
+		{
+			if(!is_number(GetRegType(arg)))
+				return false;
+		}
+
+		// integer divisions need a divisor which is known not to fail
+		if((instr.vmop == OpCode::DIV || instr.vmop == OpCode::MOD) &&
+			GetRegType(instr.dst).Is(VMType::INT))
+		{
+			if(instr.args.size() != 2)
+				return false;
+			std::optional<t_vm_int> divisor = get_int_const(instrs[defs.at(instr.args[1])]);
+			if(!divisor || *divisor == 0 || *divisor == -1)
+				return false;
+		}
+
+		return true;
+	}
+
+
+	/**
+	 * move the largest expressions which do not change in the loop in front of it
+	 */
+	std::size_t HoistInvariants(const IRLoop& loop)
+	{
+		if(!HasEntry(loop))
+			return 0;
+
+		const std::unordered_map<std::string, std::size_t> stores = GetStores(loop);
+		std::vector<IRInstr> code;
+		std::size_t num_hoisted = 0;
+
+		for(t_ir_block blockidx=0; blockidx<m_func.blocks.size(); ++blockidx)
+		{
+			if(!loop.Contains(blockidx))
+				continue;
+
+			std::vector<IRInstr>& instrs = m_func.blocks[blockidx].instrs;
+			const std::vector<IRTree> trees = GetTrees(m_func.blocks[blockidx], stores);
+
+			std::unordered_map<t_ir_reg, std::size_t> users;
+			for(std::size_t idx=0; idx<instrs.size(); ++idx)
+			{
+				for(t_ir_reg arg : instrs[idx].args)
+					users[arg] = idx;
+			}
+
+			// the trees are replaced from the back, so that the indices stay valid
+			for(std::size_t idx=instrs.size(); idx-- > 0;)
+			{
+				const IRTree& tree = trees[idx];
+				if(!tree.invariant || !tree.has_op)
+					continue;
+
+				// values which remain on the stack are not moved,
+				// and neither are parts of larger invariant expressions
+				auto user = users.find(instrs[idx].dst);
+				if(user == users.end() || trees[user->second].invariant)
+					continue;
+
+				const IRType ty = GetRegType(instrs[idx].dst);
+				const auto [name, sym] = NewVariable("inv", ty.ty);
+
+				auto begin = instrs.begin() + static_cast<std::ptrdiff_t>(tree.begin);
+				auto end = instrs.begin() + static_cast<std::ptrdiff_t>(idx + 1);
+				code.insert(code.end(), begin, end);
+				code.emplace_back(IRInstr{ .op = IROp::STORE,
+					.args = { instrs[idx].dst }, .name = name, .sym = sym });
+
+				IRInstr load{ .op = IROp::LOAD, .dst = instrs[idx].dst, .name = name, .sym = sym };
+				instrs.erase(begin, end);
+				instrs.insert(instrs.begin() + static_cast<std::ptrdiff_t>(tree.begin), std::move(load));
+
+				idx = tree.begin;
+				++num_hoisted;
+			}
+		}
+
+		if(num_hoisted)
+			InsertBeforeLoop(loop, code);
+		return num_hoisted;
+	}
+
+
+	/**
+	 * replace the multiplications of integer induction variables by constants and their
+	 * casts to real by variables which are incremented alongside the induction variables
+	 */
+	std::size_t ReduceInductionVars(t_ir_block header)
+	{
+		std::vector<IRLoop> loops = find_loops(m_func);
+		auto loop_iter = std::find_if(loops.begin(), loops.end(),
+			[header](const IRLoop& loop) -> bool { return loop.header == header; });
+		if(loop_iter == loops.end() || !HasEntry(*loop_iter))
+			return 0;
+		const IRLoop& loop = *loop_iter;
+
+		// induction variables, which are only changed by adding a constant
+		const std::unordered_map<std::string, std::size_t> stores = GetStores(loop);
+		std::vector<std::pair<IRInstr, t_vm_int>> ind_vars;
+		for(t_ir_block blockidx=0; blockidx<m_func.blocks.size(); ++blockidx)
+		{
+			if(!loop.Contains(blockidx))
+				continue;
+
+			const std::vector<IRInstr>& instrs = m_func.blocks[blockidx].instrs;
+			for(std::size_t idx=3; idx<instrs.size(); ++idx)
+			{
+				const IRInstr& store = instrs[idx];
+				if(store.op != IROp::STORE || !is_local_var(store) ||
+					stores.at(store.name) != 1 || !IsAssigned(store))
+					continue;
+
+				std::optional<t_vm_int> step = GetStep(store, instrs[idx - 3],
+					instrs[idx - 2], instrs[idx - 1]);
+				if(step)
+					ind_vars.emplace_back(std::make_pair(store, *step));
+			}
+		}
+
+		std::size_t num_reduced = 0;
+		for(const auto& [ind_var, step] : ind_vars)
+			num_reduced += ReduceInductionVar(loops, loop, ind_var, step);
+		return num_reduced;
+	}
+
+
+	/**
+	 * get the constant added to a variable by the instructions in front of its store
+	 */
+	std::optional<t_vm_int> GetStep(const IRInstr& store,
+		const IRInstr& arg1, const IRInstr& arg2, const IRInstr& op) const
+	{
+		if(op.op != IROp::OP || (op.vmop != OpCode::ADD && op.vmop != OpCode::SUB) ||
+			op.dst != store.args[0] || op.args.size() != 2 ||
+			!GetRegType(op.dst).Is(VMType::INT))
+			return std::nullopt;
+
+		auto is_var = [&store](const IRInstr& instr) -> bool
+		{
+			return instr.op == IROp::LOAD && instr.name == store.name;
+		};
+
+		// var + step, var - step or step + var
+		std::optional<t_vm_int> step;
+		if(is_var(arg1) && op.args[0] == arg1.dst && op.args[1] == arg2.dst)
+			step = get_int_const(arg2);
+		else if(op.vmop == OpCode::ADD && is_var(arg2) &&
+			op.args[0] == arg1.dst && op.args[1] == arg2.dst)
+			step = get_int_const(arg1);
+
+		if(step && op.vmop == OpCode::SUB)
+			step = -*step;
+		return step;
+	}
+
+
+	/**
+	 * replace the expressions derived from an induction variable
+	 */
+	std::size_t ReduceInductionVar(const std::vector<IRLoop>& loops, const IRLoop& loop,
+		const IRInstr& ind_var, t_vm_int step)
+	{
+		// uses of var*c, c*var or real(var), indexed by the factor,
+		// which is not set for the casts
+		using t_key = std::optional<t_vm_int>;
+		struct Use { t_ir_block block{}; std::size_t begin{}, end{}; };
+		std::vector<std::pair<t_key, std::vector<Use>>> derived;
+
+		t_ir_block store_block = 0;
+		for(t_ir_block blockidx=0; blockidx<m_func.blocks.size(); ++blockidx)
+		{
+			if(!loop.Contains(blockidx))
+				continue;
+
+			const std::vector<IRInstr>& instrs = m_func.blocks[blockidx].instrs;
+			for(std::size_t idx=0; idx<instrs.size(); ++idx)
+			{
+				const IRInstr& instr = instrs[idx];
+				if(instr.op == IROp::STORE && instr.name == ind_var.name)
+					store_block = blockidx;
+
+				std::optional<std::pair<t_key, std::size_t>> use = GetDerived(instrs, idx, ind_var);
+				if(!use)
+					continue;
+
+				auto iter = std::find_if(derived.begin(), derived.end(),
+					[&use](const auto& uses) -> bool { return uses.first == use->first; });
+				if(iter == derived.end())
+				{
+					derived.emplace_back(std::make_pair(use->first, std::vector<Use>{}));
+					iter = std::prev(derived.end());
+				}
+				iter->second.emplace_back(Use{ .block = blockidx, .begin = use->second, .end = idx + 1 });
+			}
+		}
+
+		// the replacement costs an addition per iteration, so it is only done
+		// for multiple uses or for ones in inner loops, which run more often
+		auto in_inner_loop = [&loops, &loop, store_block](const Use& use) -> bool
+		{
+			return std::any_of(loops.begin(), loops.end(), [&](const IRLoop& inner) -> bool
+			{
+				return inner.size < loop.size && inner.Contains(use.block) &&
+					!inner.Contains(store_block);
+			});
+		};
+		std::erase_if(derived, [&in_inner_loop](const auto& uses) -> bool
+		{
+			return uses.second.size() < 2 &&
+				std::none_of(uses.second.begin(), uses.second.end(), in_inner_loop);
+		});
+		if(derived.empty())
+			return 0;
+
+		std::vector<IRInstr> init_code, step_code;
+		std::vector<std::pair<Use, IRInstr>> replacements;
+		const IRType int_ty = IRType::One(VMType::INT);
+		const IRType real_ty = IRType::One(VMType::REAL);
+
+		for(const auto& [factor, uses] : derived)
+		{
+			const VMType ty = factor ? VMType::INT : VMType::REAL;
+			const auto [name, sym] = NewVariable("iv", ty);
+
+			// initial value in front of the loop
+			t_ir_reg var_reg = NewRegister(int_ty);
+			init_code.emplace_back(IRInstr{ .op = IROp::LOAD, .dst = var_reg,
+				.name = ind_var.name, .sym = ind_var.sym });
+			t_ir_reg init_reg = g_ir_noreg;
+			if(factor)
+			{
+				t_ir_reg factor_reg = NewRegister(int_ty);
+				init_reg = NewRegister(int_ty);
+				init_code.emplace_back(IRInstr{ .op = IROp::CONST, .dst = factor_reg, .val = *factor });
+				init_code.emplace_back(IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL,
+					.dst = init_reg, .args = { var_reg, factor_reg } });
+			}
+			else
+			{
+				init_reg = NewRegister(real_ty);
+				init_code.emplace_back(IRInstr{ .op = IROp::OP, .vmop = OpCode::TOF,
+					.dst = init_reg, .args = { var_reg } });
+			}
+			init_code.emplace_back(IRInstr{ .op = IROp::STORE,
+				.args = { init_reg }, .name = name, .sym = sym });
+
+			// increment, the variable is the second operand, so that it can be held in a register;
+			// the real sums stay exact as long as the integers can be represented
+			t_ir_reg incr_reg = NewRegister(IRType::One(ty));
+			t_ir_reg old_reg = NewRegister(IRType::One(ty));
+			t_ir_reg new_reg = NewRegister(IRType::One(ty));
+			if(factor)
+			{
+				step_code.emplace_back(IRInstr{ .op = IROp::CONST, .dst = incr_reg,
+					.val = step * *factor });
+			}
+			else
+			{
+				step_code.emplace_back(IRInstr{ .op = IROp::CONST, .dst = incr_reg,
+					.val = static_cast<t_vm_real>(step) });
+			}
+			step_code.emplace_back(IRInstr{ .op = IROp::LOAD, .dst = old_reg, .name = name, .sym = sym });
+			step_code.emplace_back(IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD,
+				.dst = new_reg, .args = { incr_reg, old_reg } });
+			step_code.emplace_back(IRInstr{ .op = IROp::STORE, .args = { new_reg }, .name = name, .sym = sym });
+
+			for(const Use& use : uses)
+			{
+				const IRInstr& op = m_func.blocks[use.block].instrs[use.end - 1];
+				replacements.emplace_back(std::make_pair(use,
+					IRInstr{ .op = IROp::LOAD, .dst = op.dst, .name = name, .sym = sym }));
+			}
+		}
+
+		// replace the uses from the back, so that the indices stay valid
+		std::sort(replacements.begin(), replacements.end(),
+			[](const auto& repl1, const auto& repl2) -> bool
+			{
+				if(repl1.first.block != repl2.first.block)
+					return repl1.first.block < repl2.first.block;
+				return repl1.first.begin > repl2.first.begin;
+			});
+		for(auto& [use, load] : replacements)
+		{
+			std::vector<IRInstr>& instrs = m_func.blocks[use.block].instrs;
+			auto begin = instrs.begin() + static_cast<std::ptrdiff_t>(use.begin);
+			instrs.erase(begin, instrs.begin() + static_cast<std::ptrdiff_t>(use.end));
+			instrs.insert(instrs.begin() + static_cast<std::ptrdiff_t>(use.begin), std::move(load));
+		}
+
+		// increment the derived variables directly after the induction variable
+		std::vector<IRInstr>& instrs = m_func.blocks[store_block].instrs;
+		auto store = std::find_if(instrs.begin(), instrs.end(), [&ind_var](const IRInstr& instr) -> bool
+		{
+			return instr.op == IROp::STORE && instr.name == ind_var.name;
+		});
+		instrs.insert(std::next(store), step_code.begin(), step_code.end());
+
+		InsertBeforeLoop(loop, init_code);
+		return replacements.size();
+	}
+
+
+	/**
+	 * is the instruction at the given index the multiplication of the induction variable by
+	 * a constant or its cast to real? returns the factor and the first instruction of the use
+	 */
+	std::optional<std::pair<std::optional<t_vm_int>, std::size_t>>
+	GetDerived(const std::vector<IRInstr>& instrs, std::size_t idx, const IRInstr& ind_var) const
+	{
+		const IRInstr& op = instrs[idx];
+		if(op.op != IROp::OP)
+			return std::nullopt;
+
+		auto is_var = [&ind_var](const IRInstr& instr, t_ir_reg reg) -> bool
+		{
+			return instr.op == IROp::LOAD && instr.name == ind_var.name && instr.dst == reg;
+		};
+
+		if(op.vmop == OpCode::TOF && op.args.size() == 1 && idx >= 1 &&
+			is_var(instrs[idx - 1], op.args[0]) &&
+			GetRegType(op.args[0]).Is(VMType::INT))
+		{
+			return std::make_pair(std::nullopt, idx - 1);
+		}
+
+		if(op.vmop == OpCode::MUL && op.args.size() == 2 && idx >= 2 &&
+			GetRegType(op.dst).Is(VMType::INT) &&
+			instrs[idx - 2].dst == op.args[0] && instrs[idx - 1].dst == op.args[1])
+		{
+			std::optional<t_vm_int> factor;
+			if(is_var(instrs[idx - 2], op.args[0]))
+				factor = get_int_const(instrs[idx - 1]);
+			else if(is_var(instrs[idx - 1], op.args[1]))
+				factor = get_int_const(instrs[idx - 2]);
+			if(factor)
+				return std::make_pair(factor, idx - 2);
+		}
+
+		return std::nullopt;
+	}
+
+
+private:
+	const SymTab& m_symtab;
+	IRFunc& m_func;
+	const IRTypes& m_types;
+
+	// new registers and variables
+	IRRegisters m_regs{};
+	std::vector<IRType> m_reg_types{};
+	SymTab m_vars{};
+
+	// variables which might be read before being assigned
+	std::unordered_set<std::string> m_unassigned{};
+};
+
+
+/**
+ * move int and real expressions which do not change in a loop in front of it
+ * and replace expressions derived from induction variables by additions
+ */
+std::size_t ir_optimise_loops(IRProgram& prog, const IRTypes& types, std::size_t num_threads)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	std::vector<std::optional<IRLoopOpt>> opts(funcs.size());
+	std::vector<std::size_t> num_optimised(funcs.size(), 0);
+
+	// the functions number their new registers from the same one,
+	// they are moved behind each other afterwards
+	const t_ir_reg first_reg = prog.GetNumRegisters();
+	const SymTab& symtab = prog.GetSymbolTable();
+
+	parallel_for(funcs.size(), num_threads,
+		[&funcs, &types, &opts, &num_optimised, &symtab, first_reg](std::size_t idx)
+		{
+			IRFunc& func = funcs[idx];
+
+			// variables whose addresses are used might be written indirectly
+			for(const IRBlock& block : func.blocks)
+			{
+				for(const IRInstr& instr : block.instrs)
+				{
+					if(instr.op == IROp::ADDR && !instr.sym.is_func)
+						return;
+				}
+			}
+
+			IRLoopOpt& opt = opts[idx].emplace(symtab, func, types, first_reg);
+			num_optimised[idx] = opt.Optimise();
+		});
+
+	// add the new registers and variables in the order of the functions
+	for(std::size_t idx=0; idx<funcs.size(); ++idx)
+	{
+		if(!opts[idx])
+			continue;
+
+		prog.AddRegisters(funcs[idx], opts[idx]->GetRegisters());
+		for(const auto& [name, sym] : opts[idx]->GetVariables().GetSymbols())
+			prog.GetSymbolTable().AddSymbol(name, sym.addr, sym.loc, sym.ty);
+	}
+
+	return std::accumulate(num_optimised.begin(), num_optimised.end(), std::size_t{0});
+}
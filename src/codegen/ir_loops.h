@@ -0,0 +1,32 @@
+/**
+ * loop optimisations on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://en.wikipedia.org/wiki/Loop-invariant_code_motion
+ * 	- https://en.wikipedia.org/wiki/Induction_variable
+ * 	- https://en.wikipedia.org/wiki/Dominator_(graph_theory)
+ */
+
+#ifndef __LR1_IR_LOOPS_H__
+#define __LR1_IR_LOOPS_H__
+
+#include "ir.h"
+#include "ir_types.h"
+
+
+/**
+ * move int and real expressions which do not change in a loop in front of it,
+ * including casts, and replace multiplications of an integer induction variable
+ * by a constant, as well as its casts to real, by variables which are
+ * incremented alongside it; the results are kept in new local variables;
+ * the functions are optimised using the given number of threads
+ * (0: all hardware threads), returns the number of moved and replaced expressions
+ */
+extern std::size_t ir_optimise_loops(IRProgram& prog, const IRTypes& types,
+	std::size_t num_threads = 1);
+
+
+#endif
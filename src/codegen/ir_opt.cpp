@@ -0,0 +1,163 @@
+/**
+ * optimisations of the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_opt.h"
+#include "ir_types.h"
+#include "ir_inline.h"
+#include "ir_loops.h"
+#include "ir_regalloc.h"
+#include "parallel.h"
+
+#include <limits>
+
+
+/**
+ * follow a chain of blocks which only consist of a jump
+ */
+static t_ir_block ir_final_target(const IRFunc& func, t_ir_block target)
+{
+	for(std::size_t i=0; i<func.blocks.size(); ++i)
+	{
+		const IRBlock& block = func.blocks[target];
+		if(block.instrs.size() != 1 || block.GetTerminator().op != IROp::JMP)
+			break;
+
+		t_ir_block next = block.GetTerminator().targets[0];
+		if(next == target)
+			break;
+		target = next;
+	}
+
+	return target;
+}
+
+
+/**
+ * shortens jumps to jumps, copies returns into the blocks jumping
+ * to them and removes the blocks which cannot be reached
+ */
+void ir_simplify_cfg(IRFunc& func)
+{
+	for(IRBlock& block : func.blocks)
+	{
+		IRInstr& term = block.GetTerminator();
+		std::size_t num_targets = block.GetSuccessors().size();
+		for(std::size_t i=0; i<num_targets; ++i)
+			term.targets[i] = ir_final_target(func, term.targets[i]);
+
+		// a jump to a return or halt is replaced by it,
+		// which takes at most the same space in the vm code
+		if(term.op == IROp::JMP)
+		{
+			const IRBlock& target = func.blocks[term.targets[0]];
+			const IRInstr& target_term = target.GetTerminator();
+			if(target.instrs.size() == 1 && target_term.args.empty() &&
+				(target_term.op == IROp::RET || target_term.op == IROp::HALT))
+			{
+				term = target_term;
+			}
+		}
+	}
+
+	// find the reachable blocks, function definitions are always kept
+	std::vector<bool> reachable(func.blocks.size(), false);
+	std::vector<t_ir_block> todo;
+	for(std::size_t idx=0; idx<func.blocks.size(); ++idx)
+	{
+		bool has_func = false;
+		for(const IRInstr& instr : func.blocks[idx].instrs)
+			has_func = has_func || instr.op == IROp::FUNC;
+
+		if(idx == 0 || has_func)
+		{
+			reachable[idx] = true;
+			todo.push_back(idx);
+		}
+	}
+
+	while(!todo.empty())
+	{
+		t_ir_block cur = todo.back();
+		todo.pop_back();
+
+		for(t_ir_block next : func.blocks[cur].GetSuccessors())
+		{
+			if(reachable[next])
+				continue;
+			reachable[next] = true;
+			todo.push_back(next);
+		}
+	}
+
+	// remove the other ones, keeping the order of the blocks
+	constexpr const t_ir_block none = std::numeric_limits<t_ir_block>::max();
+	std::vector<t_ir_block> new_idx(func.blocks.size(), none);
+	std::vector<IRBlock> blocks;
+	for(std::size_t idx=0; idx<func.blocks.size(); ++idx)
+	{
+		if(!reachable[idx])
+			continue;
+		new_idx[idx] = blocks.size();
+		blocks.emplace_back(std::move(func.blocks[idx]));
+	}
+
+	for(IRBlock& block : blocks)
+	{
+		IRInstr& term = block.GetTerminator();
+		std::size_t num_targets = block.GetSuccessors().size();
+		for(std::size_t i=0; i<num_targets; ++i)
+			term.targets[i] = new_idx[term.targets[i]];
+	}
+
+	func.blocks = std::move(blocks);
+}
+
+
+/**
+ * run the optimisations on all functions and the type inference on the program,
+ * functions up to the given number of instructions are inlined (0: none),
+ * local variables are held in up to the given number of vm registers,
+ * invariant and induction expressions are moved out of loops and
+ * arithmetic on ints or reals uses the untagged operations, after which
+ * no other passes should be run on the program; the passes working on single
+ * functions use the given number of threads (0: all hardware threads)
+ */
+void ir_optimise(IRProgram& prog, std::size_t max_inline_instrs, std::size_t num_regs,
+	bool optimise_loops, bool untag_values, std::size_t num_threads)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	parallel_for(funcs.size(), num_threads,
+		[&funcs](std::size_t idx)
+		{
+			ir_simplify_cfg(funcs[idx]);
+		});
+	if(max_inline_instrs)
+		ir_inline_calls(prog, max_inline_instrs);
+
+	// specialise the functions on their argument types and remove unneeded casts
+	ir_specialise_calls(prog);
+	IRTypes types = ir_infer_types(prog);
+	ir_remove_casts(prog, types);
+
+	// the loop optimisations add variables and registers, whose types are needed afterwards
+	if(optimise_loops && ir_optimise_loops(prog, types, num_threads))
+		types = ir_infer_types(prog);
+	ir_set_symbol_types(prog, types);
+
+	// the argument types decide if recursive calls can reuse the arguments
+	ir_tail_calls(prog, types);
+
+	// the variables are allocated last, when the calls are known
+	if(num_regs)
+		ir_allocate_registers(prog, types, num_regs, num_threads);
+
+	// monomorphic arithmetic works on values without type descriptors
+	if(untag_values)
+		ir_untag_values(prog, types);
+
+	prog.Check();
+}
@@ -0,0 +1,35 @@
+/**
+ * optimisations of the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_IR_OPT_H__
+#define __LR1_IR_OPT_H__
+
+#include "ir.h"
+
+
+/**
+ * shortens jumps to jumps, copies returns into the blocks jumping
+ * to them and removes the blocks which cannot be reached
+ */
+extern void ir_simplify_cfg(IRFunc& func);
+
+
+/**
+ * run the optimisations on all functions and the type inference on the program,
+ * functions up to the given number of instructions are inlined (0: none),
+ * local variables are held in up to the given number of vm registers,
+ * invariant and induction expressions are moved out of loops and
+ * arithmetic on ints or reals uses the untagged operations, after which
+ * no other passes should be run on the program; the passes working on single
+ * functions use the given number of threads (0: all hardware threads)
+ */
+extern void ir_optimise(IRProgram& prog, std::size_t max_inline_instrs = 32,
+	std::size_t num_regs = g_vm_num_regs, bool optimise_loops = true,
+	bool untag_values = true, std::size_t num_threads = 1);
+
+
+#endif
@@ -0,0 +1,303 @@
+/**
+ * linear-scan allocation of local variables to the vm's registers
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_regalloc.h"
+#include "parallel.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+
+
+/**
+ * range of instruction positions in which a variable is live
+ */
+struct IRInterval
+{
+	std::size_t var{0};                                     // index of the variable
+	std::size_t begin{std::numeric_limits<std::size_t>::max()};
+	std::size_t end{0};
+
+	double weight{0.};                                      // accesses weighted by loop depth
+	bool valid{true};                                       // can it be held in a register?
+
+	void Extend(std::size_t pos)
+	{
+		begin = std::min(begin, pos);
+		end = std::max(end, pos);
+	}
+};
+
+
+/**
+ * get the name of a variable in the symbol table
+ */
+static std::string get_var_name(const IRFunc& func, const IRInstr& instr)
+{
+	if(func.name == "")
+		return instr.name;
+	return func.name + "/" + instr.name;
+}
+
+
+/**
+ * get the frame address of a local variable accessed by a load or store
+ */
+static std::optional<t_vm_addr> get_local_addr(const IRFunc& func, const IRInstr& instr)
+{
+	if((instr.op != IROp::LOAD && instr.op != IROp::STORE) || instr.sym.is_func)
+		return std::nullopt;
+
+	// in the global code the base pointer is the global one
+	if(instr.sym.loc == VMType::ADDR_BP ||
+		(func.name == "" && instr.sym.loc == VMType::ADDR_GBP))
+		return instr.sym.addr;
+
+	return std::nullopt;
+}
+
+
+/**
+ * get the number of loops around each block, the loops are
+ * given by the jumps back to a block placed before the jump
+ */
+static std::vector<std::size_t> get_loop_depths(const IRFunc& func)
+{
+	std::vector<std::size_t> depths(func.blocks.size(), 0);
+
+	for(t_ir_block idx=0; idx<func.blocks.size(); ++idx)
+	{
+		for(t_ir_block target : func.blocks[idx].GetSuccessors())
+		{
+			if(target > idx)
+				continue;
+			for(t_ir_block loop_idx=target; loop_idx<=idx; ++loop_idx)
+				++depths[loop_idx];
+		}
+	}
+
+	return depths;
+}
+
+
+/**
+ * allocate the registers for the variables of a function
+ */
+static std::size_t allocate_func(IRFunc& func, const IRTypes& types, std::size_t num_regs)
+{
+	// variables whose addresses are used might be accessed indirectly
+	for(const IRBlock& block : func.blocks)
+	{
+		for(const IRInstr& instr : block.instrs)
+		{
+			if(instr.op == IROp::ADDR && !instr.sym.is_func)
+				return 0;
+		}
+	}
+
+	const std::size_t num_blocks = func.blocks.size();
+	const std::vector<std::size_t> depths = get_loop_depths(func);
+
+	std::unordered_map<t_vm_addr, std::size_t> var_indices;
+	std::vector<IRInterval> intervals;
+
+	// variables read before and written in the blocks, indexed by block and variable
+	std::vector<std::vector<bool>> uses(num_blocks), defs(num_blocks);
+	std::vector<std::size_t> block_begin(num_blocks), block_end(num_blocks);
+
+	// positions of the calls, which may change any register
+	std::vector<std::size_t> calls;
+
+	std::size_t pos = 0;
+	for(t_ir_block blockidx=0; blockidx<num_blocks; ++blockidx)
+	{
+		block_begin[blockidx] = pos;
+
+		for(const IRInstr& instr : func.blocks[blockidx].instrs)
+		{
+			if(instr.op == IROp::CALL || instr.op == IROp::TAILCALL)
+				calls.push_back(pos);
+
+			std::optional<t_vm_addr> addr = get_local_addr(func, instr);
+			if(addr)
+			{
+				auto [iter, inserted] = var_indices.emplace(*addr, intervals.size());
+				if(inserted)
+					intervals.emplace_back(IRInterval{ .var = iter->second });
+
+				IRInterval& interval = intervals[iter->second];
+				interval.Extend(pos);
+				interval.weight += std::pow(8., static_cast<double>(
+					std::min<std::size_t>(depths[blockidx], 4)));
+
+				// only ints and reals can be held in registers
+				auto ty = types.vars.find(get_var_name(func, instr));
+				if(ty == types.vars.end() ||
+					(!ty->second.Is(VMType::INT) && !ty->second.Is(VMType::REAL)))
+					interval.valid = false;
+
+				std::vector<bool>& use = uses[blockidx];
+				std::vector<bool>& def = defs[blockidx];
+				use.resize(intervals.size(), false);
+				def.resize(intervals.size(), false);
+				if(instr.op == IROp::LOAD && !def[iter->second])
+					use[iter->second] = true;
+				else if(instr.op == IROp::STORE)
+					def[iter->second] = true;
+			}
+
+			++pos;
+		}
+
+		block_end[blockidx] = pos - 1;
+	}
+
+	const std::size_t num_vars = intervals.size();
+	if(num_vars == 0)
+		return 0;
+	for(t_ir_block blockidx=0; blockidx<num_blocks; ++blockidx)
+	{
+		uses[blockidx].resize(num_vars, false);
+		defs[blockidx].resize(num_vars, false);
+	}
+
+	// live variables at the beginning and end of the blocks
+	std::vector<std::vector<bool>> live_in(num_blocks, std::vector<bool>(num_vars, false));
+	std::vector<std::vector<bool>> live_out = live_in;
+
+	for(bool changed = true; changed;)
+	{
+		changed = false;
+		for(t_ir_block blockidx=num_blocks; blockidx-- > 0;)
+		{
+			std::vector<bool> out(num_vars, false);
+			for(t_ir_block succ : func.blocks[blockidx].GetSuccessors())
+			{
+				for(std::size_t var=0; var<num_vars; ++var)
+					out[var] = out[var] || live_in[succ][var];
+			}
+
+			std::vector<bool> in(num_vars, false);
+			for(std::size_t var=0; var<num_vars; ++var)
+				in[var] = uses[blockidx][var] || (out[var] && !defs[blockidx][var]);
+
+			if(in != live_in[blockidx] || out != live_out[blockidx])
+			{
+				live_in[blockidx] = std::move(in);
+				live_out[blockidx] = std::move(out);
+				changed = true;
+			}
+		}
+	}
+
+	for(IRInterval& interval : intervals)
+	{
+		// variables which might be read before they are assigned keep their memory
+		if(live_in[0][interval.var])
+			interval.valid = false;
+
+		for(t_ir_block blockidx=0; blockidx<num_blocks; ++blockidx)
+		{
+			if(live_in[blockidx][interval.var])
+				interval.Extend(block_begin[blockidx]);
+			if(live_out[blockidx][interval.var])
+				interval.Extend(block_end[blockidx]);
+		}
+
+		for(std::size_t call : calls)
+		{
+			if(call >= interval.begin && call <= interval.end)
+				interval.valid = false;
+		}
+	}
+
+	// linear scan over the intervals, ordered by their beginnings
+	std::vector<IRInterval*> sorted;
+	for(IRInterval& interval : intervals)
+	{
+		if(interval.valid)
+			sorted.push_back(&interval);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(),
+		[](const IRInterval* interval1, const IRInterval* interval2) -> bool
+		{
+			return interval1->begin < interval2->begin;
+		});
+
+	std::vector<std::optional<t_vm_addr>> regs(num_vars);
+	std::vector<t_vm_addr> free_regs;
+	for(std::size_t reg=num_regs; reg-- > 0;)
+		free_regs.push_back(static_cast<t_vm_addr>(reg));
+	std::vector<IRInterval*> active;
+
+	for(IRInterval* cur : sorted)
+	{
+		// release the registers of the variables which are not live anymore
+		std::erase_if(active, [cur, &regs, &free_regs](const IRInterval* interval) -> bool
+		{
+			if(interval->end >= cur->begin)
+				return false;
+			free_regs.push_back(*regs[interval->var]);
+			return true;
+		});
+
+		if(!free_regs.empty())
+		{
+			regs[cur->var] = free_regs.back();
+			free_regs.pop_back();
+			active.push_back(cur);
+			continue;
+		}
+
+		// all registers are in use, the variable with the fewest accesses stays in memory
+		auto lightest = std::min_element(active.begin(), active.end(),
+			[](const IRInterval* interval1, const IRInterval* interval2) -> bool
+			{
+				return interval1->weight < interval2->weight;
+			});
+		if(lightest == active.end() || (*lightest)->weight >= cur->weight)
+			continue;
+
+		regs[cur->var] = regs[(*lightest)->var];
+		regs[(*lightest)->var].reset();
+		*lightest = cur;
+	}
+
+	// access the variables via their registers
+	for(IRBlock& block : func.blocks)
+	{
+		for(IRInstr& instr : block.instrs)
+		{
+			if(std::optional<t_vm_addr> addr = get_local_addr(func, instr); addr)
+				instr.vmreg = regs[var_indices.at(*addr)];
+		}
+	}
+
+	return static_cast<std::size_t>(std::count_if(regs.begin(), regs.end(),
+		[](const std::optional<t_vm_addr>& reg) -> bool { return reg.has_value(); }));
+}
+
+
+/**
+ * keep the int and real local variables in the vm's registers
+ */
+std::size_t ir_allocate_registers(IRProgram& prog, const IRTypes& types,
+	std::size_t num_regs, std::size_t num_threads)
+{
+	std::vector<IRFunc>& funcs = prog.GetFunctions();
+	std::vector<std::size_t> num_allocated(funcs.size(), 0);
+
+	parallel_for(funcs.size(), num_threads,
+		[&funcs, &types, &num_allocated, num_regs](std::size_t idx)
+		{
+			num_allocated[idx] = allocate_func(funcs[idx], types, num_regs);
+		});
+
+	return std::accumulate(num_allocated.begin(), num_allocated.end(), std::size_t{0});
+}
@@ -0,0 +1,31 @@
+/**
+ * linear-scan allocation of local variables to the vm's registers
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://doi.org/10.1145/330249.330250
+ * 	- https://en.wikipedia.org/wiki/Live-variable_analysis
+ */
+
+#ifndef __LR1_IR_REGALLOC_H__
+#define __LR1_IR_REGALLOC_H__
+
+#include "ir.h"
+#include "ir_types.h"
+
+
+/**
+ * keep the int and real local variables in the vm's registers, the ones in
+ * loops are preferred; as the registers are not saved by function calls, only
+ * variables which are not live across a call are considered; the functions
+ * are independent of each other and are processed using the given number of
+ * threads (0: all hardware threads),
+ * returns the number of variables which are held in registers
+ */
+extern std::size_t ir_allocate_registers(IRProgram& prog, const IRTypes& types,
+	std::size_t num_regs = g_vm_num_regs, std::size_t num_threads = 1);
+
+
+#endif
@@ -0,0 +1,778 @@
+/**
+ * whole-program type inference on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "ir_types.h"
+#include "../vm/extfuncs.h"
+
+#include <algorithm>
+#include <optional>
+#include <map>
+#include <tuple>
+
+
+bool IRType::Join(const IRType& other)
+{
+	if(other.kind == Kind::NONE || kind == Kind::ANY || *this == other)
+		return false;
+
+	if(kind == Kind::NONE)
+		*this = other;
+	else
+		*this = Any();  // differing types
+	return true;
+}
+
+
+/**
+ * get the indices of the functions by their names
+ */
+static std::unordered_map<std::string, std::size_t> get_func_indices(const IRProgram& prog)
+{
+	std::unordered_map<std::string, std::size_t> indices;
+
+	const std::vector<IRFunc>& funcs = prog.GetFunctions();
+	for(std::size_t funcidx=1; funcidx<funcs.size(); ++funcidx)
+		indices.emplace(funcs[funcidx].name, funcidx);
+
+	return indices;
+}
+
+
+/**
+ * get the name of a variable in the symbol table
+ */
+static std::string get_var_name(const IRFunc& func, const IRInstr& instr)
+{
+	if(func.name == "")
+		return instr.name;
+	return func.name + "/" + instr.name;
+}
+
+
+/**
+ * get the index of an accessed function argument
+ */
+static std::optional<std::size_t> get_arg_index(const IRInstr& instr)
+{
+	// index 0 is the saved base pointer and 1 the return address
+	if(instr.sym.loc != VMType::ADDR_BP_ARG || instr.sym.addr < 2)
+		return std::nullopt;
+	return static_cast<std::size_t>(instr.sym.addr - 2);
+}
+
+
+static bool is_cast(OpCode op)
+{
+	return op == OpCode::TOI || op == OpCode::TOF || op == OpCode::TOS;
+}
+
+
+/**
+ * get the type produced by a vm operator
+ */
+static IRType get_op_type(OpCode op, const std::vector<IRType>& args)
+{
+	switch(op)
+	{
+		case OpCode::TOI:
+			return IRType::One(VMType::INT);
+		case OpCode::TOF:
+			return IRType::One(VMType::REAL);
+		case OpCode::TOS:
+			return IRType::One(VMType::STR);
+
+		// comparisons and logical operations leave a raw boolean
+		case OpCode::GT: case OpCode::LT: case OpCode::GEQU:
+		case OpCode::LEQU: case OpCode::EQU: case OpCode::NEQU:
+		case OpCode::IGT: case OpCode::ILT: case OpCode::IGEQU:
+		case OpCode::ILEQU: case OpCode::IEQU: case OpCode::INEQU:
+		case OpCode::FGT: case OpCode::FLT: case OpCode::FGEQU:
+		case OpCode::FLEQU: case OpCode::FEQU: case OpCode::FNEQU:
+		case OpCode::AND: case OpCode::OR: case OpCode::XOR: case OpCode::NOT:
+			return IRType::One(VMType::BOOLEAN);
+
+		// operations on untagged values
+		case OpCode::UNTAGI: case OpCode::TAGI:
+		case OpCode::IUSUB: case OpCode::IADD: case OpCode::ISUB:
+		case OpCode::IMUL: case OpCode::IDIV: case OpCode::IMOD:
+			return IRType::One(VMType::INT);
+		case OpCode::UNTAGF: case OpCode::TAGF:
+		case OpCode::FUSUB: case OpCode::FADD: case OpCode::FSUB:
+		case OpCode::FMUL: case OpCode::FDIV: case OpCode::FMOD:
+			return IRType::One(VMType::REAL);
+
+		// the operands have to be of the same type, otherwise the vm throws
+		case OpCode::USUB:
+		case OpCode::ADD: case OpCode::SUB: case OpCode::MUL:
+		case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+		{
+			IRType ty{};
+			for(const IRType& arg : args)
+				ty.Join(arg);
+			if(ty.kind == IRType::Kind::NONE)
+				return ty;
+
+			if(ty.Is(VMType::INT) || ty.Is(VMType::REAL))
+				return ty;
+			if(ty.Is(VMType::STR) && op != OpCode::USUB)
+				return ty;
+			return IRType::Any();
+		}
+
+		// integer operations
+		case OpCode::BINAND: case OpCode::BINOR: case OpCode::BINXOR: case OpCode::BINNOT:
+		case OpCode::SHL: case OpCode::SHR: case OpCode::ROTL: case OpCode::ROTR:
+		{
+			IRType ty{};
+			for(const IRType& arg : args)
+				ty.Join(arg);
+			if(ty.kind == IRType::Kind::NONE || ty.Is(VMType::INT))
+				return ty;
+			return IRType::Any();
+		}
+
+		default:
+			return IRType::Any();
+	}
+}
+
+
+/**
+ * get the return type of an external function,
+ * it is only known for some of the built-in ones
+ */
+static IRType get_extfunc_type(const IRInstr& instr)
+{
+	if(!instr.ext_idx)
+		return IRType::Any();
+
+	switch(static_cast<ExtFunc>(*instr.ext_idx))
+	{
+		case ExtFunc::INPUT_INT:
+			return IRType::One(VMType::INT);
+		case ExtFunc::INPUT_REAL:
+		case ExtFunc::GET_EPS:
+			return IRType::One(VMType::REAL);
+		default:
+			return IRType::Any();
+	}
+}
+
+
+/**
+ * infer the types of all values by iterating over the whole program until
+ * the types of the variables, function arguments and return values are stable
+ */
+IRTypes ir_infer_types(const IRProgram& prog)
+{
+	const std::vector<IRFunc>& funcs = prog.GetFunctions();
+	std::unordered_map<std::string, std::size_t> func_indices = get_func_indices(prog);
+
+	IRTypes types;
+	types.regs.resize(prog.GetNumRegisters());
+	types.args.resize(funcs.size());
+	types.rets.resize(funcs.size());
+	types.escaping.resize(funcs.size(), false);
+	for(std::size_t funcidx=0; funcidx<funcs.size(); ++funcidx)
+		types.args[funcidx].resize(static_cast<std::size_t>(funcs[funcidx].num_args));
+
+	// the types only get less specific, so this terminates
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		auto join = [&changed](IRType& ty, const IRType& newty)
+		{
+			if(ty.Join(newty))
+				changed = true;
+		};
+
+		// type of a variable or function argument
+		auto get_var = [&types](std::size_t funcidx, const IRFunc& func,
+			const IRInstr& instr) -> IRType*
+		{
+			if(instr.sym.loc == VMType::ADDR_BP_ARG)
+			{
+				std::optional<std::size_t> idx = get_arg_index(instr);
+				if(!idx || *idx >= types.args[funcidx].size())
+					return nullptr;
+				return &types.args[funcidx][*idx];
+			}
+
+			return &types.vars[get_var_name(func, instr)];
+		};
+
+		for(std::size_t funcidx=0; funcidx<funcs.size(); ++funcidx)
+		{
+			const IRFunc& func = funcs[funcidx];
+
+			for(const IRBlock& block : func.blocks)
+			{
+				for(const IRInstr& instr : block.instrs)
+				{
+					std::vector<IRType> args;
+					args.reserve(instr.args.size());
+					for(t_ir_reg arg : instr.args)
+						args.push_back(types.regs[arg]);
+
+					IRType result = IRType::Any();
+
+					switch(instr.op)
+					{
+						case IROp::CONST:
+						{
+							if(std::holds_alternative<t_vm_int>(instr.val))
+								result = IRType::One(VMType::INT);
+							else if(std::holds_alternative<t_vm_real>(instr.val))
+								result = IRType::One(VMType::REAL);
+							else if(std::holds_alternative<t_vm_str>(instr.val))
+								result = IRType::One(VMType::STR);
+							break;
+						}
+
+						case IROp::LOAD:
+						{
+							if(IRType *ty = get_var(funcidx, func, instr); ty)
+								result = *ty;
+							break;
+						}
+
+						case IROp::STORE:
+						{
+							if(IRType *ty = get_var(funcidx, func, instr); ty)
+								join(*ty, args[0]);
+							break;
+						}
+
+						case IROp::ADDR:
+						{
+							if(instr.sym.is_func)
+							{
+								// the function can be called from anywhere
+								auto iter = func_indices.find(instr.name);
+								if(iter != func_indices.end() && !types.escaping[iter->second])
+								{
+									types.escaping[iter->second] = true;
+									for(IRType& ty : types.args[iter->second])
+										join(ty, IRType::Any());
+								}
+							}
+							else if(IRType *ty = get_var(funcidx, func, instr); ty)
+							{
+								// the variable can be written via its address
+								join(*ty, IRType::Any());
+							}
+							break;
+						}
+
+						case IROp::OP:
+						{
+							result = get_op_type(instr.vmop, args);
+							break;
+						}
+
+						case IROp::CALL:
+						case IROp::TAILCALL:
+						{
+							auto iter = func_indices.find(instr.name);
+							if(iter == func_indices.end())
+								break;
+
+							// the first argument is pushed last
+							std::vector<IRType>& callee_args = types.args[iter->second];
+							for(std::size_t i=0; i<args.size() && i<callee_args.size(); ++i)
+								join(callee_args[i], args[args.size() - i - 1]);
+							result = types.rets[iter->second];
+
+							// the result of a tail call is returned directly
+							if(instr.op == IROp::TAILCALL)
+								join(types.rets[funcidx], result);
+							break;
+						}
+
+						case IROp::EXTCALL:
+						{
+							result = get_extfunc_type(instr);
+							break;
+						}
+
+						case IROp::RET:
+						{
+							// without an argument the stack top is returned, if any
+							join(types.rets[funcidx], args.empty() ? IRType::Any() : args[0]);
+							break;
+						}
+
+						default:
+						{
+							break;
+						}
+					}
+
+					if(instr.dst != g_ir_noreg)
+						join(types.regs[instr.dst], result);
+				}
+			}
+		}
+	}
+
+	return types;
+}
+
+
+/**
+ * does the function contain casts which might become unnecessary?
+ */
+static bool has_casts(const IRFunc& func)
+{
+	for(const IRBlock& block : func.blocks)
+	{
+		for(const IRInstr& instr : block.instrs)
+		{
+			if(instr.op == IROp::OP && is_cast(instr.vmop))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * copy a function under a new name, its registers are renamed
+ */
+static void clone_func(IRProgram& prog, std::size_t funcidx, const std::string& name)
+{
+	IRFunc func = prog.GetFunctions()[funcidx];
+	const std::string base_name = func.name;
+	func.name = name;
+
+	// the registers are defined before their use in the same block
+	std::unordered_map<t_ir_reg, t_ir_reg> regs;
+	for(IRBlock& block : func.blocks)
+	{
+		for(IRInstr& instr : block.instrs)
+		{
+			for(t_ir_reg& arg : instr.args)
+				arg = regs.at(arg);
+
+			if(instr.dst != g_ir_noreg)
+			{
+				t_ir_reg reg = prog.NewRegister();
+				regs.emplace(instr.dst, reg);
+				instr.dst = reg;
+			}
+		}
+	}
+
+	// copy the arguments and local variables
+	SymTab& symtab = prog.GetSymbolTable();
+	std::vector<std::pair<std::string, SymInfo>> vars;
+	for(const auto& [symname, sym] : symtab.GetSymbols())
+	{
+		if(symname.starts_with(base_name + "/"))
+			vars.emplace_back(name + symname.substr(base_name.length()), sym);
+	}
+	for(const auto& [symname, sym] : vars)
+	{
+		symtab.AddSymbol(symname, sym.addr, sym.loc, sym.ty,
+			sym.is_func, sym.num_args, sym.frame_size);
+	}
+
+	// its address is known after code generation
+	symtab.AddSymbol(name, 0, VMType::ADDR_MEM, VMType::UNKNOWN,
+		true, func.num_args, func.frame_size);
+
+	prog.GetFunctions().emplace_back(std::move(func));
+}
+
+
+/**
+ * clone functions which are called with differing argument types and which
+ * contain casts, so that every copy sees only one combination of types,
+ * returns the number of created functions
+ */
+std::size_t ir_specialise_calls(IRProgram& prog, std::size_t max_variants)
+{
+	using t_sig = std::vector<VMType>;
+
+	std::size_t num_created = 0;
+	std::unordered_map<std::string, std::string> bases;       // original function of a copy
+	std::unordered_map<std::string, t_sig> base_sigs;         // argument types of the original
+	std::map<std::tuple<std::string, t_sig>, std::string> variants;
+	std::unordered_map<std::string, std::size_t> num_variants;
+
+	// redirecting the calls makes the argument types more specific,
+	// which in turn can change the argument types of the calls in the copies
+	constexpr const std::size_t max_iterations = 8;
+	for(std::size_t iter=0; iter<max_iterations; ++iter)
+	{
+		IRTypes types = ir_infer_types(prog);
+		std::unordered_map<std::string, std::size_t> func_indices = get_func_indices(prog);
+		std::vector<std::tuple<std::size_t, std::size_t>> new_funcs;  // original and copy
+		bool changed = false;
+
+		const std::size_t num_funcs = prog.GetFunctions().size();
+		for(std::size_t funcidx=0; funcidx<num_funcs; ++funcidx)
+		{
+			for(std::size_t blockidx=0; blockidx<prog.GetFunctions()[funcidx].blocks.size(); ++blockidx)
+			{
+				std::vector<IRInstr>& instrs = prog.GetFunctions()[funcidx].blocks[blockidx].instrs;
+
+				for(std::size_t instridx=0; instridx<instrs.size(); ++instridx)
+				{
+					if(instrs[instridx].op != IROp::CALL)
+						continue;
+
+					// only specialise for known argument types
+					t_sig sig;
+					bool known = true;
+					const std::vector<t_ir_reg>& args = instrs[instridx].args;
+					for(auto iterarg = args.rbegin(); iterarg != args.rend(); ++iterarg)
+					{
+						const IRType& ty = types.regs[*iterarg];
+						if(ty.kind != IRType::Kind::ONE)
+						{
+							known = false;
+							break;
+						}
+						sig.push_back(ty.ty);
+					}
+					if(!known)
+						continue;
+
+					std::string callee = instrs[instridx].name;
+					std::string base = callee;
+					if(auto iterbase = bases.find(callee); iterbase != bases.end())
+						base = iterbase->second;
+
+					auto iterfunc = func_indices.find(base);
+					if(iterfunc == func_indices.end())
+						continue;
+					std::size_t base_idx = iterfunc->second;
+					if(types.escaping[base_idx] || !has_casts(prog.GetFunctions()[base_idx]))
+						continue;
+
+					// the first combination of argument types stays with the original function
+					std::string target;
+					auto itersig = base_sigs.try_emplace(base, sig).first;
+					if(itersig->second == sig)
+					{
+						target = base;
+					}
+					else if(auto itervar = variants.find(std::make_tuple(base, sig));
+						itervar != variants.end())
+					{
+						target = itervar->second;
+					}
+					else if(num_variants[base] < max_variants)
+					{
+						target = base + "<";
+						for(std::size_t i=0; i<sig.size(); ++i)
+						{
+							if(i > 0)
+								target += ",";
+							target += get_vm_type_name(sig[i]);
+						}
+						target += ">";
+
+						std::size_t new_idx = prog.GetFunctions().size();
+						clone_func(prog, base_idx, target);
+						new_funcs.emplace_back(std::make_tuple(base_idx, new_idx));
+
+						bases.emplace(target, base);
+						variants.emplace(std::make_tuple(base, sig), target);
+						++num_variants[base];
+						++num_created;
+					}
+					else
+					{
+						continue;
+					}
+
+					std::vector<IRInstr>& curinstrs = prog.GetFunctions()[funcidx].blocks[blockidx].instrs;
+					if(curinstrs[instridx].name != target)
+					{
+						curinstrs[instridx].name = target;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		// place the copies after their originals in the global code
+		for(const auto& [base_idx, new_idx] : new_funcs)
+		{
+			for(IRBlock& block : prog.GetGlobal().blocks)
+			{
+				auto iterfunc = std::find_if(block.instrs.begin(), block.instrs.end(),
+					[base_idx](const IRInstr& instr) -> bool
+				{
+					return instr.op == IROp::FUNC && instr.func == base_idx;
+				});
+
+				if(iterfunc != block.instrs.end())
+				{
+					std::string name = prog.GetFunctions()[new_idx].name;
+					block.instrs.insert(iterfunc + 1,
+						IRInstr{ .op = IROp::FUNC, .name = name, .func = new_idx });
+					break;
+				}
+			}
+		}
+
+		if(!changed)
+			break;
+	}
+
+	return num_created;
+}
+
+
+/**
+ * remove casts of values which already have the target type,
+ * returns the number of removed instructions
+ */
+std::size_t ir_remove_casts(IRProgram& prog, const IRTypes& types)
+{
+	std::size_t num_removed = 0;
+
+	for(IRFunc& func : prog.GetFunctions())
+	{
+		for(IRBlock& block : func.blocks)
+		{
+			// the casted value takes the place of the cast's result
+			std::unordered_map<t_ir_reg, t_ir_reg> renamed;
+			std::vector<IRInstr> instrs;
+			instrs.reserve(block.instrs.size());
+
+			for(IRInstr& instr : block.instrs)
+			{
+				for(t_ir_reg& arg : instr.args)
+				{
+					if(auto iter = renamed.find(arg); iter != renamed.end())
+						arg = iter->second;
+				}
+
+				if(instr.op == IROp::OP && is_cast(instr.vmop) && instr.args.size() == 1 &&
+					instr.args[0] < types.regs.size() && instr.dst != g_ir_noreg)
+				{
+					const IRType& ty = types.regs[instr.args[0]];
+					if(get_op_type(instr.vmop, {}) == ty)
+					{
+						renamed.emplace(instr.dst, instr.args[0]);
+						++num_removed;
+						continue;
+					}
+				}
+
+				instrs.emplace_back(std::move(instr));
+			}
+
+			block.instrs = std::move(instrs);
+		}
+	}
+
+	return num_removed;
+}
+
+
+/**
+ * write the inferred types of the variables into the symbol table
+ */
+void ir_set_symbol_types(IRProgram& prog, const IRTypes& types)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+
+	auto set_type = [&symtab](const std::string& name, const IRType& ty)
+	{
+		if(ty.kind != IRType::Kind::ONE)
+			return;
+
+		const SymInfo *sym = symtab.GetSymbol(name);
+		if(!sym || sym->is_func || sym->ty == ty.ty)
+			return;
+
+		SymInfo info = *sym;
+		symtab.AddSymbol(name, info.addr, info.loc, ty.ty,
+			info.is_func, info.num_args, info.frame_size);
+	};
+
+	for(const auto& [name, ty] : types.vars)
+		set_type(name, ty);
+
+	// function arguments
+	const std::vector<IRFunc>& funcs = prog.GetFunctions();
+	for(std::size_t funcidx=1; funcidx<funcs.size(); ++funcidx)
+	{
+		for(const IRBlock& block : funcs[funcidx].blocks)
+		{
+			for(const IRInstr& instr : block.instrs)
+			{
+				std::optional<std::size_t> idx = get_arg_index(instr);
+				if(idx && *idx < types.args[funcidx].size())
+					set_type(get_var_name(funcs[funcidx], instr), types.args[funcidx][*idx]);
+			}
+		}
+	}
+}
+
+
+/**
+ * get the untagged form of an operator whose operands are all ints or all reals,
+ * INVALID if the operator has to work on tagged values
+ */
+static OpCode get_untagged_op(const std::vector<IRInstr>& instrs, std::size_t idx,
+	const IRTypes& types)
+{
+	const IRInstr& instr = instrs[idx];
+	if(instr.op != IROp::OP || instr.args.empty())
+		return OpCode::INVALID;
+
+	// keep operators which are applied to a register, see IRAsm::EmitRegisterOp
+	if(idx > 0 && is_vm_register_op(instr.vmop) && instr.args.size() == 2)
+	{
+		const IRInstr& load = instrs[idx - 1];
+		if(load.op == IROp::LOAD && load.vmreg && load.dst == instr.args[1])
+			return OpCode::INVALID;
+	}
+
+	std::optional<VMType> ty;
+	for(t_ir_reg arg : instr.args)
+	{
+		if(arg >= types.regs.size())
+			return OpCode::INVALID;
+
+		const IRType& argty = types.regs[arg];
+		if(!argty.Is(VMType::INT) && !argty.Is(VMType::REAL))
+			return OpCode::INVALID;
+		if(ty && *ty != argty.ty)
+			return OpCode::INVALID;
+		ty = argty.ty;
+	}
+
+	return get_vm_untagged_op(instr.vmop, *ty == VMType::REAL);
+}
+
+
+/**
+ * does the untagged operator work on reals?
+ */
+static bool is_real_op(OpCode op)
+{
+	return (op >= OpCode::FUSUB && op <= OpCode::FMOD) ||
+		(op >= OpCode::FGT && op <= OpCode::FNEQU);
+}
+
+
+/**
+ * use the untagged forms of the arithmetic operations and comparisons whose
+ * operands are all ints or all reals, the type descriptors are only removed
+ * and added again where the values are passed from or to other instructions,
+ * constants are directly pushed without them, returns the number of untagged operations
+ */
+std::size_t ir_untag_values(IRProgram& prog, const IRTypes& types)
+{
+	std::size_t num_untagged = 0;
+
+	for(IRFunc& func : prog.GetFunctions())
+	{
+		for(IRBlock& block : func.blocks)
+		{
+			std::vector<IRInstr>& instrs = block.instrs;
+
+			// the untagged operators and the instructions using the registers
+			std::vector<OpCode> untagged(instrs.size(), OpCode::INVALID);
+			std::unordered_map<t_ir_reg, std::size_t> users;
+			bool any_untagged = false;
+
+			for(std::size_t idx=0; idx<instrs.size(); ++idx)
+			{
+				for(t_ir_reg arg : instrs[idx].args)
+					users.emplace(arg, idx);
+
+				untagged[idx] = get_untagged_op(instrs, idx, types);
+				if(untagged[idx] != OpCode::INVALID)
+					any_untagged = true;
+			}
+
+			if(!any_untagged)
+				continue;
+
+			// the converted value takes the place of the original one
+			std::unordered_map<t_ir_reg, t_ir_reg> renamed;
+			std::vector<IRInstr> new_instrs;
+			new_instrs.reserve(instrs.size());
+
+			for(std::size_t idx=0; idx<instrs.size(); ++idx)
+			{
+				IRInstr& instr = instrs[idx];
+				for(t_ir_reg& arg : instr.args)
+				{
+					if(auto iter = renamed.find(arg); iter != renamed.end())
+						arg = iter->second;
+				}
+
+				// comparisons leave a raw boolean in either form
+				const OpCode op = untagged[idx];
+				const bool untagged_dst = (op != OpCode::INVALID &&
+					get_vm_tagged_op(op) < OpCode::GT);
+				if(op != OpCode::INVALID)
+				{
+					instr.vmop = op;
+					++num_untagged;
+				}
+
+				const t_ir_reg dst = instr.dst;
+				if(dst == g_ir_noreg)
+				{
+					new_instrs.emplace_back(std::move(instr));
+					continue;
+				}
+
+				// unused values stay on the stack and need their type descriptors
+				auto user = users.find(dst);
+				const OpCode user_op = (user == users.end()
+					? OpCode::INVALID : untagged[user->second]);
+				const bool untagged_use = (user_op != OpCode::INVALID);
+
+				// constants of the operator's type are pushed without type descriptors
+				if(untagged_use && instr.op == IROp::CONST && (is_real_op(user_op)
+					? std::holds_alternative<t_vm_real>(instr.val)
+					: std::holds_alternative<t_vm_int>(instr.val)))
+				{
+					instr.vmop = is_real_op(user_op) ? OpCode::PUSHF : OpCode::PUSHI;
+					new_instrs.emplace_back(std::move(instr));
+					continue;
+				}
+
+				new_instrs.emplace_back(std::move(instr));
+				if(untagged_dst == untagged_use)
+					continue;
+
+				OpCode conv = OpCode::INVALID;
+				if(untagged_dst)
+					conv = is_real_op(op) ? OpCode::TAGF : OpCode::TAGI;
+				else
+					conv = is_real_op(user_op) ? OpCode::UNTAGF : OpCode::UNTAGI;
+
+				t_ir_reg conv_dst = prog.NewRegister();
+				renamed.emplace(dst, conv_dst);
+				// the instruction is set up in place, so that its constant is never copied
+				IRInstr& conv_instr = new_instrs.emplace_back();
+				conv_instr.op = IROp::OP;
+				conv_instr.vmop = conv;
+				conv_instr.dst = conv_dst;
+				conv_instr.args = { dst };
+			}
+
+			instrs = std::move(new_instrs);
+		}
+	}
+
+	return num_untagged;
+}
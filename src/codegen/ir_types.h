@@ -0,0 +1,102 @@
+/**
+ * whole-program type inference on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://en.wikipedia.org/wiki/Data-flow_analysis
+ * 	- https://en.wikipedia.org/wiki/Polymorphic_inline_cache
+ */
+
+#ifndef __LR1_IR_TYPES_H__
+#define __LR1_IR_TYPES_H__
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cstdint>
+
+#include "ir.h"
+
+
+/**
+ * inferred type of a value: not yet known, a single vm type or varying
+ */
+struct IRType
+{
+	enum class Kind : std::uint8_t
+	{
+		NONE,    // no value has been seen yet
+		ONE,     // always of the same type
+		ANY,     // of different or unknown types
+	};
+
+	Kind kind{Kind::NONE};
+	VMType ty{VMType::UNKNOWN};
+
+	static IRType One(VMType ty) { return IRType{ .kind = Kind::ONE, .ty = ty }; }
+	static IRType Any() { return IRType{ .kind = Kind::ANY }; }
+
+	bool Is(VMType _ty) const { return kind == Kind::ONE && ty == _ty; }
+
+	/**
+	 * merge with the type of another value, returns true if the type changed
+	 */
+	bool Join(const IRType& other);
+
+	bool operator==(const IRType& other) const = default;
+};
+
+
+/**
+ * types of the registers, variables and functions of a program
+ */
+struct IRTypes
+{
+	std::vector<IRType> regs{};                      // indexed by register
+	std::unordered_map<std::string, IRType> vars{};  // indexed by symbol name
+
+	// indexed by function
+	std::vector<std::vector<IRType>> args{};         // argument types
+	std::vector<IRType> rets{};                      // return types
+	std::vector<bool> escaping{};                    // address is used, e.g. as interrupt
+};
+
+
+/**
+ * infer the types of all values by iterating over the whole program until
+ * the types of the variables, function arguments and return values are stable
+ */
+extern IRTypes ir_infer_types(const IRProgram& prog);
+
+
+/**
+ * clone functions which are called with differing argument types and which
+ * contain casts, so that every copy sees only one combination of types,
+ * returns the number of created functions
+ */
+extern std::size_t ir_specialise_calls(IRProgram& prog, std::size_t max_variants = 4);
+
+
+/**
+ * remove casts of values which already have the target type,
+ * returns the number of removed instructions
+ */
+extern std::size_t ir_remove_casts(IRProgram& prog, const IRTypes& types);
+
+
+/**
+ * write the inferred types of the variables into the symbol table
+ */
+extern void ir_set_symbol_types(IRProgram& prog, const IRTypes& types);
+
+
+/**
+ * use the untagged forms of the arithmetic operations and comparisons whose
+ * operands are all ints or all reals, returns the number of untagged operations
+ */
+extern std::size_t ir_untag_values(IRProgram& prog, const IRTypes& types);
+
+
+#endif
@@ -209,7 +209,8 @@ static void replace_escapes(std::string& str)
  * get next token and attribute
  */
 t_lexer_match
-get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
+get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line,
+	ASTBase::t_source_range* range)
 {
 	std::string input;
 	std::vector<t_lexer_match> longest_lexer_matching;
@@ -221,6 +222,15 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 	std::size_t *line = _line;
 	if(!line) line = &dummy_line;
 
+	// character offsets of the current position and the token's beginning
+	std::size_t offs = range ? range->second : 0;
+	std::size_t tok_begin = offs;
+	auto set_range = [range, &tok_begin, &offs]()
+	{
+		if(range)
+			*range = std::make_pair(tok_begin, offs);
+	};
+
 	// find longest matching token
 	while(!(eof = istr.eof()))
 	{
@@ -230,6 +240,7 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 			eof = true;
 			break;
 		}
+		++offs;
 		//std::cout << "Input: " << c << " (0x" << std::hex << int(c) << ")." << std::endl;
 
 		if(in_line_comment && c != '\n')
@@ -243,12 +254,14 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 				if(!in_string)
 				{
 					in_string = true;
+					tok_begin = offs - 1;
 					continue;
 				}
 				else
 				{
 					replace_escapes(input);
 					in_string = false;
+					set_range();
 					return std::make_tuple(
 						static_cast<t_tok>(Token::STR), input, *line);
 				}
@@ -270,6 +283,8 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 			{
 				if(end_on_newline)
 				{
+					tok_begin = offs - 1;
+					set_range();
 					return std::make_tuple(
 						static_cast<t_tok>(Token::END), std::nullopt, *line);
 				}
@@ -282,6 +297,8 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 			}
 		}
 
+		if(input.empty() && !in_string)
+			tok_begin = offs - 1;
 		input += c;
 		if(in_string)
 			continue;
@@ -301,12 +318,17 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 		{
 			// no more matches
 			istr.putback(c);
+			--offs;
 			break;
 		}
 	}
 
 	if(longest_lexer_matching.size() == 0 && eof)
+	{
+		tok_begin = offs;
+		set_range();
 		return std::make_tuple((t_tok)Token::END, std::nullopt, *line);
+	}
 
 	if(longest_lexer_matching.size() == 0)
 	{
@@ -323,6 +345,7 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 			<< input << "\"." << std::endl;
 	}*/
 
+	set_range();
 	return longest_lexer_matching[0];
 }
 
@@ -331,15 +354,15 @@ get_next_token(std::istream& istr, bool end_on_newline, std::size_t* _line)
 template<std::size_t IDX> struct _Lval_LoopFunc
 {
 	void operator()(
-		std::vector<t_toknode>* vec, std::size_t id, std::size_t tableidx,
+		t_toknode* node, std::size_t id, std::size_t tableidx,
 		const t_lval& lval, std::size_t line) const
 	{
 		using t_val = std::variant_alternative_t<IDX, typename t_lval::value_type>;
 
 		if(std::holds_alternative<t_val>(*lval))
 		{
-			vec->emplace_back(std::make_shared<ASTToken<t_val>>(
-				id, tableidx, std::get<IDX>(*lval), line));
+			*node = std::make_shared<ASTToken<t_val>>(
+				id, tableidx, std::get<IDX>(*lval), line);
 		}
 	};
 };
@@ -347,47 +370,65 @@ template<std::size_t IDX> struct _Lval_LoopFunc
 
 
 /**
- * get all tokens and attributes
+ * create the syntax tree node for a token
+ */
+t_toknode create_token_node(const t_lexer_match& tok,
+	const t_mapIdIdx* mapTermIdx,
+	const std::optional<ASTBase::t_source_range>& range)
+{
+	std::size_t id = std::get<0>(tok);
+	const t_lval& lval = std::get<1>(tok);
+	std::size_t line = std::get<2>(tok);
+
+	// get index into parse tables
+	std::size_t tableidx = 0;
+	if(mapTermIdx)
+	{
+		auto iter = mapTermIdx->find(id);
+		if(iter != mapTermIdx->end())
+			tableidx = iter->second;
+	}
+
+	t_toknode node;
+
+	// does this token have an attribute?
+	if(lval)
+	{
+		// find the correct type in the variant
+		auto seq = std::make_index_sequence<
+			std::variant_size_v<typename t_lval::value_type>>();
+
+		constexpr_loop<_Lval_LoopFunc>(
+			seq, std::make_tuple(&node, id, tableidx, lval, line));
+	}
+	else
+	{
+		node = std::make_shared<ASTToken<void*>>(id, tableidx, line);
+	}
+
+	node->SetSourceRange(range);
+	return node;
+}
+
+
+
+/**
+ * get all tokens and attributes,
+ * starting at the given line number and character offset
  */
 std::vector<t_toknode> get_all_tokens(
 	std::istream& istr, const t_mapIdIdx* mapTermIdx,
-	bool end_on_newline)
+	bool end_on_newline, std::size_t line, std::size_t offs)
 {
 	std::vector<t_toknode> vec;
-	std::size_t line = 1;
+	ASTBase::t_source_range range{offs, offs};
 
 	while(1)
 	{
-		auto tup = get_next_token(istr, end_on_newline, &line);
-		std::size_t id = std::get<0>(tup);
-		const t_lval& lval = std::get<1>(tup);
-		std::size_t line = std::get<2>(tup);
-
-		// get index into parse tables
-		std::size_t tableidx = 0;
-		if(mapTermIdx)
-		{
-			auto iter = mapTermIdx->find(id);
-			if(iter != mapTermIdx->end())
-				tableidx = iter->second;
-		}
-
-		// does this token have an attribute?
-		if(lval)
-		{
-			// find the correct type in the variant
-			auto seq = std::make_index_sequence<
-				std::variant_size_v<typename t_lval::value_type>>();
-
-			constexpr_loop<_Lval_LoopFunc>(
-				seq, std::make_tuple(&vec, id, tableidx, lval, line));
-		}
-		else
-		{
-			vec.emplace_back(std::make_shared<ASTToken<void*>>(id, tableidx, line));
-		}
+		auto tup = get_next_token(istr, end_on_newline, &line, &range);
+		vec.emplace_back(create_token_node(tup, mapTermIdx, range));
 
-		if(id == (t_tok)Token::END)
+		if(std::get<0>(tup) == (t_tok)Token::END)
 			break;
 	}
 
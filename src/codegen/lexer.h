@@ -70,19 +70,31 @@ extern std::vector<t_lexer_match>
 
 
 /**
- * get next token and attribute
+ * get next token and attribute,
+ * range.second gives the current character offset in the input
+ * and is set to the token's [begin, end) offsets on return
  */
 extern t_lexer_match
 	get_next_token(std::istream& istr = std::cin,
-		bool end_on_newline = true, std::size_t* line = nullptr);
+		bool end_on_newline = true, std::size_t* line = nullptr,
+		ASTBase::t_source_range* range = nullptr);
 
 
 /**
- * get all tokens and attributes
+ * create the syntax tree node for a token
+ */
+extern t_toknode create_token_node(const t_lexer_match& tok,
+	const t_mapIdIdx* mapTermIdx = nullptr,
+	const std::optional<ASTBase::t_source_range>& range = std::nullopt);
+
+
+/**
+ * get all tokens and attributes,
+ * starting at the given line number and character offset
  */
 extern std::vector<t_toknode> get_all_tokens(
 	std::istream& istr = std::cin, const t_mapIdIdx* mapTermIdx = nullptr,
-	bool end_on_newline = true);
+	bool end_on_newline = true, std::size_t line = 1, std::size_t offs = 0);
 
 
 #endif
@@ -0,0 +1,65 @@
+/**
+ * running independent jobs of the code generation on worker threads
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_PARALLEL_H__
+#define __LR1_PARALLEL_H__
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+
+/**
+ * call func(idx) for all indices in [0, num) using up to the given number
+ * of threads, all hardware threads are used if num_threads is 0; the jobs
+ * are taken in the order of their indices, and the exception of the job with
+ * the lowest index is rethrown after all of them have finished
+ */
+template<class t_func>
+void parallel_for(std::size_t num, std::size_t num_threads, t_func&& func)
+{
+	if(num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	num_threads = std::min(num_threads, num);
+
+	std::vector<std::exception_ptr> errors(num);
+	std::atomic<std::size_t> next_idx{0};
+
+	auto worker = [num, &func, &errors, &next_idx]()
+	{
+		for(std::size_t idx = next_idx++; idx < num; idx = next_idx++)
+		{
+			try
+			{
+				func(idx);
+			}
+			catch(...)
+			{
+				errors[idx] = std::current_exception();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_threads);
+	for(std::size_t i=1; i<num_threads; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for(std::thread& thread : threads)
+		thread.join();
+
+	for(const std::exception_ptr& error : errors)
+	{
+		if(error)
+			std::rethrow_exception(error);
+	}
+}
+
+
+#endif
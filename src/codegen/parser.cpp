@@ -72,6 +72,22 @@ std::string get_line_numbers(const t_toknode& node)
 }
 
 
+/**
+ * set the source range of a reduced symbol from its arguments
+ */
+void Parser::AssignSourceRange(const t_astbaseptr& sym,
+	const std::vector<t_astbaseptr>& args)
+{
+	std::vector<std::optional<ASTBase::t_source_range>> ranges;
+	ranges.reserve(args.size());
+	for(const t_astbaseptr& arg : args)
+		ranges.push_back(arg->GetSourceRange());
+
+	if(auto range = get_minmax_lines<ASTBase::t_source_range>(ranges); range)
+		sym->SetSourceRange(range);
+}
+
+
 t_astbaseptr Parser::Parse(const std::vector<t_toknode>& input) const
 {
 	constexpr bool debug = false;
@@ -173,6 +189,7 @@ t_astbaseptr Parser::Parse(const std::vector<t_toknode>& input) const
 
 			// execute semantic rule
 			t_astbaseptr reducedSym = m_semantics[newrule](args);
+			AssignSourceRange(reducedSym, args);
 			symbols.push(reducedSym);
 
 			topstate = states.top();
@@ -39,7 +39,13 @@ public:
 	t_astbaseptr Parse(const std::vector<t_toknode>& input) const;
 
 
-private:
+protected:
+	// set the source range of a reduced symbol from its arguments
+	static void AssignSourceRange(const t_astbaseptr& sym,
+		const std::vector<t_astbaseptr>& args);
+
+
+protected:
 	// parse tables
 	t_table m_tabActionShift{};
 	t_table m_tabActionReduce{};
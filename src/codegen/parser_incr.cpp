@@ -0,0 +1,465 @@
+/**
+ * incremental lr(1) parser for edited sources
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- T. A. Wagner, S. L. Graham, "Efficient and flexible incremental parsing",
+ * 	  ACM TOPLAS 20(5), pp. 980-1013 (1998), doi: 10.1145/293677.293678
+ */
+
+#include "parser_incr.h"
+
+#include <streambuf>
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+
+/**
+ * stream buffer reading a string from a given offset without copying it
+ */
+class SourceBuffer : public std::streambuf
+{
+public:
+	SourceBuffer(const std::string& str, std::size_t offs)
+	{
+		char* begin = const_cast<char*>(str.data());
+		setg(begin, begin + offs, begin + str.size());
+	}
+};
+
+
+/**
+ * move a position by the given (possibly negative) distance
+ */
+static void shift_position(std::size_t& pos, std::ptrdiff_t diff)
+{
+	pos = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(pos) + diff);
+}
+
+
+/**
+ * move the source and line ranges of a subtree
+ */
+static void shift_positions(const t_astbaseptr& node, std::ptrdiff_t offs_diff, std::ptrdiff_t line_diff)
+{
+	if(!node)
+		return;
+
+	if(std::optional<ASTBase::t_source_range> range = node->GetSourceRange(); range)
+	{
+		shift_position(range->first, offs_diff);
+		shift_position(range->second, offs_diff);
+		node->SetSourceRange(range);
+	}
+
+	if(std::optional<ASTBase::t_line_range> lines = node->GetLineRange(); lines)
+	{
+		shift_position(lines->first, line_diff);
+		shift_position(lines->second, line_diff);
+		node->SetLineRange(lines);
+	}
+
+	for(std::size_t childidx=0; childidx<node->NumChildren(); ++childidx)
+		shift_positions(node->GetChild(childidx), offs_diff, line_diff);
+}
+
+
+/**
+ * parse a complete source text
+ */
+t_astbaseptr IncrementalParser::Parse(const std::string& src)
+{
+	m_src.clear();
+	m_tokens.clear();
+	m_snapshots.clear();
+	m_subtrees.clear();
+
+	return Reparse(0, 0, src);
+}
+
+
+/**
+ * replace len characters at offset offs in the source text
+ * by the given text and parse the changed source
+ */
+t_astbaseptr IncrementalParser::Reparse(std::size_t offs, std::size_t len, const std::string& text)
+{
+	if(offs > m_src.size() || len > m_src.size() - offs)
+		throw std::runtime_error("Edited range is outside of the source text.");
+
+	m_src.replace(offs, len, text);
+	m_ast = nullptr;
+	m_num_lexed = m_num_shifted = m_num_reused = 0;
+
+	const std::size_t num_old = m_tokens.size();
+	const std::size_t edit_end = offs + text.size();
+	const std::ptrdiff_t offs_diff = static_cast<std::ptrdiff_t>(text.size())
+		- static_cast<std::ptrdiff_t>(len);
+
+	// first token touched by the edit
+	const std::size_t changed = static_cast<std::size_t>(
+		std::partition_point(m_tokens.begin(), m_tokens.end(),
+			[offs](const SourceToken& tok) -> bool
+			{
+				return tok.range.second < offs;
+			}) - m_tokens.begin());
+
+	// lex from the end of the previous token until the
+	// new tokens coincide with the old ones after the edit
+	std::size_t line = changed > 0 ? std::get<2>(m_tokens[changed - 1].match) : 1;
+	std::size_t lex_begin = changed > 0 ? m_tokens[changed - 1].range.second : 0;
+	ASTBase::t_source_range range{lex_begin, lex_begin};
+
+	std::vector<SourceToken> lexed;
+	std::size_t realigned = num_old;   // first old token kept after the edit
+	std::ptrdiff_t line_diff = 0;
+
+	try
+	{
+		SourceBuffer buf{m_src, lex_begin};
+		std::istream istr{&buf};
+
+		for(std::size_t old_idx = changed; true;)
+		{
+			t_lexer_match match = get_next_token(istr, false, &line, &range);
+			++m_num_lexed;
+
+			// the rest of the source is unchanged if an old token is found at the same position
+			if(range.first >= edit_end)
+			{
+				std::size_t old_begin = range.first - text.size() + len;
+				while(old_idx < num_old && m_tokens[old_idx].range.first < old_begin)
+					++old_idx;
+
+				if(old_idx < num_old)
+				{
+					const SourceToken& old = m_tokens[old_idx];
+					if(old.range.first == old_begin &&
+						old.range.second - old.range.first == range.second - range.first &&
+						std::get<0>(old.match) == std::get<0>(match))
+					{
+						realigned = old_idx;
+						line_diff = static_cast<std::ptrdiff_t>(std::get<2>(match))
+							- static_cast<std::ptrdiff_t>(std::get<2>(old.match));
+						break;
+					}
+				}
+			}
+
+			std::size_t id = std::get<0>(match);
+			std::size_t tableidx = 0;
+			if(auto iter = m_mapTermIdx.find(id); iter != m_mapTermIdx.end())
+				tableidx = iter->second;
+
+			lexed.emplace_back(SourceToken{ .match = std::move(match), .range = range, .tableidx = tableidx });
+			if(id == static_cast<t_tok>(Token::END))
+				break;
+		}
+	}
+	catch(const std::exception&)
+	{
+		// only the tokens before the edit are still known
+		m_tokens.resize(changed);
+		m_snapshots.resize(std::min(m_snapshots.size(), changed));
+		m_subtrees.resize(changed);
+		for(std::vector<Subtree>& trees : m_subtrees)
+		{
+			std::erase_if(trees, [changed](const Subtree& tree) -> bool
+			{
+				return tree.next >= changed;
+			});
+		}
+		throw;
+	}
+
+	// restart from the last known parser state before the changed tokens
+	std::size_t restart = std::min(changed, m_snapshots.size());
+	while(restart > 0 && (restart >= m_snapshots.size() || !m_snapshots[restart]))
+		--restart;
+	t_stackptr stack = restart < m_snapshots.size() && m_snapshots[restart]
+		? RestoreStack(m_snapshots[restart])
+		: std::make_shared<const StackEntry>();
+
+	const std::size_t num_new = changed + lexed.size() + (num_old - realigned);
+	const std::ptrdiff_t idx_diff = static_cast<std::ptrdiff_t>(changed + lexed.size())
+		- static_cast<std::ptrdiff_t>(realigned);
+
+	// the subtrees before the restart are part of its stack, the ones between the
+	// restart and the edit and the ones after the edit can be reused if their
+	// tokens including the following one are unchanged
+	t_subtrees subtrees(num_new), reusable(num_new);
+	for(std::size_t idx=0; idx<std::min(changed, m_subtrees.size()); ++idx)
+	{
+		for(Subtree& tree : m_subtrees[idx])
+		{
+			if(tree.next < restart)
+				subtrees[idx].emplace_back(std::move(tree));
+			else if(idx >= restart && tree.next < changed)
+				reusable[idx].emplace_back(std::move(tree));
+		}
+	}
+	for(std::size_t idx=realigned; idx<m_subtrees.size(); ++idx)
+	{
+		for(Subtree& tree : m_subtrees[idx])
+		{
+			shift_position(tree.first, idx_diff);
+			shift_position(tree.next, idx_diff);
+			reusable[tree.first].emplace_back(std::move(tree));
+		}
+	}
+	m_subtrees = std::move(subtrees);
+
+	// move the unchanged tokens after the edit
+	for(std::size_t idx=realigned; idx<num_old; ++idx)
+	{
+		SourceToken& tok = m_tokens[idx];
+		shift_position(tok.range.first, offs_diff);
+		shift_position(tok.range.second, offs_diff);
+		shift_position(std::get<2>(tok.match), line_diff);
+	}
+
+	m_tokens.erase(m_tokens.begin() + changed, m_tokens.begin() + realigned);
+	m_tokens.insert(m_tokens.begin() + changed,
+		std::make_move_iterator(lexed.begin()), std::make_move_iterator(lexed.end()));
+
+	m_snapshots.resize(std::min(m_snapshots.size(), restart));
+	m_snapshots.resize(num_new);
+
+	m_ast = Run(restart, stack, reusable);
+	return m_ast;
+}
+
+
+/**
+ * copy a parser stack with new nodes for its terminals,
+ * as the semantic rules may have modified the old ones
+ */
+IncrementalParser::t_stackptr IncrementalParser::RestoreStack(const t_stackptr& stack) const
+{
+	std::vector<t_stackptr> entries;
+	for(t_stackptr entry = stack; entry; entry = entry->below)
+		entries.push_back(entry);
+
+	// keep the lower part of the stack without terminals
+	std::size_t keep = entries.size();
+	while(keep > 0 && !(entries[keep - 1]->sym && entries[keep - 1]->sym->IsTerminal()))
+		--keep;
+	if(keep == 0)
+		return stack;
+
+	t_stackptr restored = keep < entries.size() ? entries[keep] : nullptr;
+	for(std::size_t idx=keep; idx-- > 0;)
+	{
+		StackEntry entry = *entries[idx];
+		if(entry.sym && entry.sym->IsTerminal())
+		{
+			const SourceToken& tok = m_tokens[entry.first];
+			entry.sym = create_token_node(tok.match, &m_mapTermIdx, tok.range);
+		}
+		entry.below = restored;
+		restored = std::make_shared<const StackEntry>(std::move(entry));
+	}
+
+	return restored;
+}
+
+
+/**
+ * shift the largest reusable subtree beginning at the current token
+ */
+bool IncrementalParser::ReuseSubtree(std::size_t& pos, t_stackptr& stack, t_subtrees& reusable)
+{
+	if(pos >= reusable.size())
+		return false;
+	std::vector<Subtree>& trees = reusable[pos];
+
+	// enclosing subtrees have been reduced after the ones they contain
+	for(std::size_t treeidx=trees.size(); treeidx-- > 0;)
+	{
+		Subtree& tree = trees[treeidx];
+
+		// the parser has to be in the same state as when the subtree was reduced
+		if(tree.state != stack->state)
+			continue;
+		std::size_t jumpstate = m_tabJump(stack->state, tree.node->GetTableIdx());
+		if(jumpstate == ERROR_VAL)
+			continue;
+
+		// move the subtree's nodes to their new positions
+		const SourceToken& tok = m_tokens[pos];
+		std::ptrdiff_t offs_diff = 0;
+		if(const auto& range = tree.node->GetSourceRange(); range)
+		{
+			offs_diff = static_cast<std::ptrdiff_t>(tok.range.first)
+				- static_cast<std::ptrdiff_t>(range->first);
+		}
+		std::ptrdiff_t line_diff = static_cast<std::ptrdiff_t>(std::get<2>(tok.match))
+			- static_cast<std::ptrdiff_t>(tree.line);
+		if(offs_diff || line_diff)
+			shift_positions(tree.node, offs_diff, line_diff);
+
+		// take over the subtree and the ones it contains
+		const std::size_t next = tree.next;
+		t_astbaseptr node = tree.node;
+		for(std::size_t idx=pos; idx<next; ++idx)
+		{
+			std::vector<Subtree>& contained = reusable[idx];
+			std::size_t num = idx == pos ? treeidx + 1 : contained.size();
+
+			for(std::size_t subidx=0; subidx<num; ++subidx)
+			{
+				Subtree& sub = contained[subidx];
+				if(sub.next > next)
+					continue;
+				shift_position(sub.line, line_diff);
+				m_subtrees[idx].emplace_back(std::move(sub));
+			}
+			contained.clear();
+		}
+
+		stack = std::make_shared<const StackEntry>(StackEntry{
+			.state = jumpstate, .sym = node, .first = pos, .next = next, .below = stack });
+		pos = next;
+		++m_num_reused;
+		return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * a semantic rule has modified the node of a stack entry,
+ * which thus cannot be reused and invalidates the stacks containing it
+ */
+void IncrementalParser::Invalidate(const StackEntry& entry, std::size_t pos)
+{
+	std::erase_if(m_subtrees[entry.first], [&entry](const Subtree& tree) -> bool
+	{
+		return tree.node == entry.sym;
+	});
+
+	for(std::size_t idx=entry.next+1; idx<=pos && idx<m_snapshots.size(); ++idx)
+		m_snapshots[idx] = nullptr;
+}
+
+
+/**
+ * parse from the given token and parser stack
+ */
+t_astbaseptr IncrementalParser::Run(std::size_t pos, t_stackptr stack, t_subtrees& reusable)
+{
+	auto get_line = [this](std::size_t pos) -> std::string
+	{
+		std::ostringstream ostr;
+		ostr << " (line " << std::get<2>(m_tokens[pos].match) << ")";
+		return ostr.str();
+	};
+
+	bool next_token = true;
+	while(true)
+	{
+		if(pos >= m_tokens.size())
+			throw std::runtime_error("Input buffer underflow.");
+
+		// save the parser state before processing the token
+		const SourceToken& tok = m_tokens[pos];
+		if(next_token)
+		{
+			m_snapshots[pos] = stack;
+			next_token = false;
+		}
+
+		std::size_t topstate = stack->state;
+		std::size_t newstate = m_tabActionShift(topstate, tok.tableidx);
+		std::size_t newrule = m_tabActionReduce(topstate, tok.tableidx);
+
+		if(newstate == ERROR_VAL && newrule == ERROR_VAL)
+		{
+			std::ostringstream ostrErr;
+			ostrErr << "Undefined shift and reduce entries"
+				<< " from state " << topstate << ".";
+			ostrErr << " Current token id is " << std::get<0>(tok.match);
+			ostrErr << get_line(pos);
+			ostrErr << ".";
+
+			throw std::runtime_error(ostrErr.str());
+		}
+		else if(newstate != ERROR_VAL && newrule != ERROR_VAL)
+		{
+			std::ostringstream ostrErr;
+			ostrErr << "Shift/reduce conflict between shift"
+				<< " from state " << topstate << " to state " << newstate
+				<< " and reduce using rule " << newrule << ".";
+			ostrErr << " Current token id is " << std::get<0>(tok.match);
+			ostrErr << get_line(pos);
+			ostrErr << ".";
+
+			throw std::runtime_error(ostrErr.str());
+		}
+
+		// accept
+		else if(newrule == ACCEPT_VAL)
+		{
+			return stack->sym;
+		}
+
+		// shift
+		else if(newstate != ERROR_VAL)
+		{
+			next_token = true;
+			if(ReuseSubtree(pos, stack, reusable))
+				continue;
+
+			t_toknode node = create_token_node(tok.match, &m_mapTermIdx, tok.range);
+			stack = std::make_shared<const StackEntry>(StackEntry{
+				.state = newstate, .sym = node, .first = pos, .next = pos + 1, .below = stack });
+			++pos;
+			++m_num_shifted;
+		}
+
+		// reduce
+		else if(newrule != ERROR_VAL)
+		{
+			std::size_t numSyms = m_numRhsSymsPerRule[newrule];
+
+			// take the symbols from the stack and create an argument vector for the semantic rule
+			std::vector<t_astbaseptr> args(numSyms);
+			std::vector<t_stackptr> entries(numSyms);
+			std::size_t first = pos;
+			for(std::size_t arg=numSyms; arg-- > 0;)
+			{
+				entries[arg] = stack;
+				args[arg] = stack->sym;
+				first = stack->first;
+				stack = stack->below;
+			}
+
+			// execute semantic rule
+			t_astbaseptr reducedSym = m_semantics[newrule](args);
+			AssignSourceRange(reducedSym, args);
+
+			for(const t_stackptr& entry : entries)
+			{
+				if(entry->sym == reducedSym && !reducedSym->IsTerminal())
+					Invalidate(*entry, pos);
+			}
+
+			if(first < pos)
+			{
+				m_subtrees[first].emplace_back(Subtree{
+					.node = reducedSym, .first = first, .next = pos,
+					.state = stack->state, .line = std::get<2>(m_tokens[first].match) });
+			}
+
+			std::size_t jumpstate = m_tabJump(stack->state, reducedSym->GetTableIdx());
+			stack = std::make_shared<const StackEntry>(StackEntry{
+				.state = jumpstate, .sym = reducedSym, .first = first, .next = pos, .below = stack });
+		}
+	}
+
+	return nullptr;
+}
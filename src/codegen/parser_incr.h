@@ -0,0 +1,118 @@
+/**
+ * incremental lr(1) parser for edited sources
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- T. A. Wagner, S. L. Graham, "Efficient and flexible incremental parsing",
+ * 	  ACM TOPLAS 20(5), pp. 980-1013 (1998), doi: 10.1145/293677.293678
+ */
+
+#ifndef __LR1_PARSER_INCR_H__
+#define __LR1_PARSER_INCR_H__
+
+#include "parser.h"
+#include "lexer.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+
+/**
+ * lr(1) parser which keeps its state at the token boundaries and,
+ * after an edit, only lexes and parses the changed part of the source again,
+ * reusing the subtrees whose tokens and left contexts have not changed
+ *
+ * the nodes of the returned trees are reused by later parses and must not be
+ * modified, the semantic rules may only modify non-terminal arguments which
+ * they return as result
+ */
+class IncrementalParser : public Parser
+{
+public:
+	using Parser::Parser;
+	using Parser::Parse;
+
+	/**
+	 * parse a complete source text
+	 */
+	t_astbaseptr Parse(const std::string& src);
+
+	/**
+	 * replace len characters at offset offs in the source text
+	 * by the given text and parse the changed source
+	 */
+	t_astbaseptr Reparse(std::size_t offs, std::size_t len, const std::string& text);
+
+	const std::string& GetSource() const { return m_src; }
+	const t_astbaseptr& GetAST() const { return m_ast; }
+
+	// statistics of the last parse
+	std::size_t GetNumLexedTokens() const { return m_num_lexed; }
+	std::size_t GetNumShiftedTokens() const { return m_num_shifted; }
+	std::size_t GetNumReusedSubtrees() const { return m_num_reused; }
+
+
+protected:
+	/**
+	 * token from the lexer
+	 */
+	struct SourceToken
+	{
+		t_lexer_match match{};
+		ASTBase::t_source_range range{};
+		std::size_t tableidx{0};
+	};
+
+	/**
+	 * entry of the parser stack, the stacks share their lower entries
+	 */
+	struct StackEntry
+	{
+		std::size_t state{0};
+		t_astbaseptr sym{};
+		std::size_t first{0};      // index of the symbol's first token
+		std::size_t next{0};       // index of the token following the symbol
+		std::shared_ptr<const StackEntry> below{};
+	};
+
+	using t_stackptr = std::shared_ptr<const StackEntry>;
+
+	/**
+	 * reduced non-terminal covering the tokens [first, next)
+	 */
+	struct Subtree
+	{
+		t_astbaseptr node{};
+		std::size_t first{0};
+		std::size_t next{0};       // lookahead token when the node was reduced
+		std::size_t state{0};      // state left of the node
+		std::size_t line{0};       // line of the first token
+	};
+
+	using t_subtrees = std::vector<std::vector<Subtree>>;
+
+	t_stackptr RestoreStack(const t_stackptr& stack) const;
+	bool ReuseSubtree(std::size_t& pos, t_stackptr& stack, t_subtrees& reusable);
+	void Invalidate(const StackEntry& entry, std::size_t pos);
+	t_astbaseptr Run(std::size_t pos, t_stackptr stack, t_subtrees& reusable);
+
+
+private:
+	std::string m_src{};                     // current source text
+	std::vector<SourceToken> m_tokens{};     // tokens of the source text
+
+	std::vector<t_stackptr> m_snapshots{};   // parser stacks before the tokens, if known
+	t_subtrees m_subtrees{};                 // subtrees of the tree, indexed by first token
+
+	t_astbaseptr m_ast{};
+
+	std::size_t m_num_lexed{0};
+	std::size_t m_num_shifted{0};
+	std::size_t m_num_reused{0};
+};
+
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * lr(1) parser working on the top-level statements in parallel
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "parser_parallel.h"
+#include "parallel.h"
+
+#include <streambuf>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <cctype>
+
+
+/**
+ * stream buffer reading a range of a string without copying it
+ */
+class ChunkBuffer : public std::streambuf
+{
+public:
+	ChunkBuffer(const std::string& str, std::size_t begin, std::size_t end)
+	{
+		char* data = const_cast<char*>(str.data());
+		setg(data + begin, data + begin, data + end);
+	}
+};
+
+
+/**
+ * can the character be part of an identifier?
+ */
+static bool is_ident_char(char c)
+{
+	return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+
+/**
+ * find the character offsets following the top-level statements
+ */
+std::vector<std::size_t> ParallelParser::FindStatementEnds(const std::string& src)
+{
+	std::vector<std::size_t> ends;
+
+	std::ptrdiff_t depth = 0;
+	bool in_string = false;
+	bool in_comment = false;
+
+	// end of a top-level block which could still be continued by an 'else'
+	std::size_t block_end = 0;
+	bool after_block = false;
+
+	for(std::size_t idx=0; idx<src.size(); ++idx)
+	{
+		const char c = src[idx];
+
+		if(in_comment)
+		{
+			if(c == '\n')
+				in_comment = false;
+			continue;
+		}
+
+		if(in_string)
+		{
+			if(c == '\"')
+				in_string = false;
+			continue;
+		}
+
+		if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+			continue;
+
+		if(c == '#')
+		{
+			in_comment = true;
+			continue;
+		}
+
+		if(after_block)
+		{
+			bool is_else = src.compare(idx, 4, "else") == 0 &&
+				(idx + 4 >= src.size() || !is_ident_char(src[idx + 4]));
+			if(!is_else)
+				ends.push_back(block_end);
+			after_block = false;
+		}
+
+		switch(c)
+		{
+			case '\"':
+				in_string = true;
+				break;
+			case '(':
+			case '{':
+				++depth;
+				break;
+			case ')':
+				--depth;
+				break;
+			case '}':
+				if(--depth == 0)
+				{
+					block_end = idx + 1;
+					after_block = true;
+				}
+				break;
+			case ';':
+				if(depth == 0)
+					ends.push_back(idx + 1);
+				break;
+		}
+	}
+
+	if(after_block)
+		ends.push_back(block_end);
+
+	return ends;
+}
+
+
+/**
+ * lex and parse the characters [begin, end) of the source text
+ */
+t_astbaseptr ParallelParser::ParseChunk(const std::string& src,
+	std::size_t begin, std::size_t end, std::size_t line) const
+{
+	ChunkBuffer buf{src, begin, end};
+	std::istream istr{&buf};
+
+	std::vector<t_toknode> tokens = get_all_tokens(
+		istr, &m_mapTermIdx, false, line, begin);
+	return Parse(tokens);
+}
+
+
+/**
+ * append the top-level statements of all chunks to the list of the first one
+ */
+t_astbaseptr ParallelParser::JoinChunks(const std::vector<t_astbaseptr>& chunks)
+{
+	// nodes between the root and the statement list
+	auto get_path = [](const t_astbaseptr& root) -> std::vector<t_astbaseptr>
+	{
+		std::vector<t_astbaseptr> path;
+		for(t_astbaseptr node = root; node; node = node->GetChild(0))
+		{
+			path.push_back(node);
+			if(node->GetType() != ASTType::DELEGATE)
+				break;
+		}
+
+		if(!path.size() || path.back()->GetType() != ASTType::LIST)
+			throw std::runtime_error("The start symbol does not derive a statement list.");
+		return path;
+	};
+
+	std::vector<t_astbaseptr> path = get_path(chunks[0]);
+	auto list = std::dynamic_pointer_cast<ASTList>(path.back());
+	if(!list)
+		throw std::runtime_error("The start symbol does not derive a statement list.");
+
+	std::vector<std::optional<ASTBase::t_source_range>> ranges;
+	ranges.reserve(chunks.size());
+	ranges.push_back(list->GetSourceRange());
+
+	for(std::size_t chunkidx=1; chunkidx<chunks.size(); ++chunkidx)
+	{
+		const t_astbaseptr chunklist = get_path(chunks[chunkidx]).back();
+		for(std::size_t childidx=0; childidx<chunklist->NumChildren(); ++childidx)
+			list->AddChild(chunklist->GetChild(childidx));
+		ranges.push_back(chunklist->GetSourceRange());
+	}
+
+	if(auto range = get_minmax_lines<ASTBase::t_source_range>(ranges); range)
+	{
+		for(const t_astbaseptr& node : path)
+			node->SetSourceRange(range);
+	}
+
+	return chunks[0];
+}
+
+
+/**
+ * parse a complete source text using the given number of threads
+ */
+t_astbaseptr ParallelParser::Parse(const std::string& src, std::size_t num_threads)
+{
+	if(num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// split the source into chunks of similar sizes,
+	// using more chunks than threads to balance the load
+	const std::size_t max_chunks = num_threads > 1 ? num_threads * 4 : 1;
+	std::vector<std::size_t> begins{ 0 };
+	std::vector<std::size_t> lines{ 1 };
+
+	for(std::size_t end : FindStatementEnds(src))
+	{
+		if(begins.size() >= max_chunks)
+			break;
+		if(end >= src.size() || end < begins.size() * src.size() / max_chunks)
+			continue;
+
+		lines.push_back(lines.back() + std::count(
+			src.begin() + begins.back(), src.begin() + end, '\n'));
+		begins.push_back(end);
+	}
+
+	const std::size_t num_chunks = begins.size();
+	begins.push_back(src.size());
+	m_num_chunks = num_chunks;
+
+	// lex and parse the chunks, the error which comes first in the source is reported
+	std::vector<t_astbaseptr> chunks(num_chunks);
+	parallel_for(num_chunks, num_threads,
+		[this, &src, &begins, &lines, &chunks](std::size_t idx)
+		{
+			chunks[idx] = ParseChunk(src, begins[idx], begins[idx + 1], lines[idx]);
+		});
+
+	return JoinChunks(chunks);
+}
@@ -0,0 +1,61 @@
+/**
+ * lr(1) parser working on the top-level statements in parallel
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_PARSER_PARALLEL_H__
+#define __LR1_PARSER_PARALLEL_H__
+
+#include "parser.h"
+#include "lexer.h"
+
+#include <string>
+#include <vector>
+
+
+/**
+ * lr(1) parser which splits a source text at the boundaries of its top-level
+ * statements and lexes and parses the chunks concurrently, the statement lists
+ * of the chunks are then joined into the list of the first one
+ *
+ * the grammar's start symbol has to derive a list of statements, and the
+ * semantic rules must not modify any state shared between the chunks
+ */
+class ParallelParser : public Parser
+{
+public:
+	using Parser::Parser;
+	using Parser::Parse;
+
+	/**
+	 * parse a complete source text using the given number of threads,
+	 * all hardware threads are used if num_threads is 0
+	 */
+	t_astbaseptr Parse(const std::string& src, std::size_t num_threads = 0);
+
+	/**
+	 * find the character offsets following the top-level statements,
+	 * i.e. the offsets after the ';' or '}' characters outside any brackets,
+	 * strings and comments which are not followed by an 'else' block
+	 */
+	static std::vector<std::size_t> FindStatementEnds(const std::string& src);
+
+	// statistics of the last parse
+	std::size_t GetNumChunks() const { return m_num_chunks; }
+
+
+protected:
+	t_astbaseptr ParseChunk(const std::string& src,
+		std::size_t begin, std::size_t end, std::size_t line) const;
+
+	static t_astbaseptr JoinChunks(const std::vector<t_astbaseptr>& chunks);
+
+
+private:
+	std::size_t m_num_chunks{0};
+};
+
+
+#endif
@@ -29,6 +29,7 @@ struct SymInfo
 	bool is_func{false};           // function or variable
 
 	t_vm_int num_args{0};          // number of arguments
+	t_vm_addr frame_size{0};       // size of the function's stack frame
 };
 
 
@@ -55,7 +56,7 @@ public:
 	const SymInfo* AddSymbol(const std::string& name,
 		t_vm_addr addr, VMType loc = VMType::ADDR_BP,
 		VMType ty = VMType::UNKNOWN, bool is_func = false,
-		t_vm_int num_args = 0)
+		t_vm_int num_args = 0, t_vm_addr frame_size = 0)
 	{
 		SymInfo info
 		{
@@ -64,12 +65,19 @@ public:
 			.ty = ty,
 			.is_func = is_func,
 			.num_args = num_args,
+			.frame_size = frame_size,
 		};
 
 		return &m_syms.insert_or_assign(name, info).first->second;
 	}
 
 
+	void RemoveSymbol(const std::string& name)
+	{
+		m_syms.erase(name);
+	}
+
+
 	const std::unordered_map<std::string, SymInfo>& GetSymbols() const
 	{
 		return m_syms;
@@ -84,7 +92,7 @@ public:
 		std::ios_base::fmtflags base = ostr.flags(std::ios_base::basefield);
 
 		const int len_name = 24;
-		const int len_type = 24;
+		const int len_type = 32;
 		const int len_addr = 14;
 		const int len_base = 14;
 
@@ -102,6 +110,8 @@ public:
 			{
 				ty = "function, ";
 				ty += std::to_string(info.num_args) + " args";
+				if(info.frame_size)
+					ty += ", frame " + std::to_string(info.frame_size);
 			}
 			else
 			{
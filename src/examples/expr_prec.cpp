@@ -517,14 +517,12 @@ static void lr1_run_parser()
 			ast->accept(&astasm);
 #endif
 
-			std::ostringstream ostrAsmBin(
-				std::ios_base::out | std::ios_base::binary);
-			ASTAsm astasmbin{ostrAsmBin, &ops};
+			CodeBuilder codeBin;
+			ASTAsm astasmbin{codeBin, &ops};
 			astasmbin.AlwaysCallExternal(true);
-			astasmbin.SetBinary(true);
 			ast->accept(&astasmbin);
 			astasmbin.FinishCodegen();
-			std::string strAsmBin = ostrAsmBin.str();
+			std::span<const t_vm_byte> codeAsmBin = codeBin.GetCode();
 
 #if WRITE_BINFILE != 0
 			std::string binfile{"expr_prec.bin"};
@@ -534,7 +532,8 @@ static void lr1_run_parser()
 				std::cerr << "Cannot open \""
 					<< binfile << "\"." << std::endl;
 			}
-			ofstrAsmBin.write(strAsmBin.data(), strAsmBin.size());
+			ofstrAsmBin.write(reinterpret_cast<const char*>(codeAsmBin.data()),
+				static_cast<std::streamsize>(codeAsmBin.size()));
 			if(ofstrAsmBin.fail())
 			{
 				std::cerr << "Cannot write \""
@@ -544,13 +543,13 @@ static void lr1_run_parser()
 
 #if DEBUG_CODEGEN != 0
 			std::cout << "\nGenerated code ("
-				<< strAsmBin.size() << " bytes):\n"
+				<< codeAsmBin.size() << " bytes):\n"
 				<< ostrAsm.str();
 #endif
 
 			VM vm(1024);
 			//vm.SetDebug(true);
-			vm.SetMem(0, strAsmBin);
+			vm.SetMem(0, codeAsmBin.data(), codeAsmBin.size());
 			vm.Run();
 
 			std::cout << "\nResult: ";
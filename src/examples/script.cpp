@@ -10,7 +10,10 @@
 #include "codegen/lexer.h"
 #include "codegen/ast.h"
 #include "codegen/ast_printer.h"
-#include "codegen/ast_asm.h"
+#include "codegen/ast_ir.h"
+#include "codegen/ast_opt.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_asm.h"
 #include "vm/vm.h"
 
 #include <unordered_map>
@@ -20,6 +23,10 @@
 #include <iomanip>
 #include <chrono>
 #include <cstdint>
+#include <iterator>
+#include <charconv>
+#include <optional>
+#include <string_view>
 
 #if __has_include(<filesystem>)
 	#include <filesystem>
@@ -529,8 +536,17 @@ static bool lr1_create_parser()
 
 #if !__has_include("script.tab")
 
-static std::tuple<bool, std::string>
-lr1_run_parser([[maybe_unused]] const char* script_file = nullptr)
+static std::tuple<bool, std::vector<t_vm_byte>>
+lr1_run_parser([[maybe_unused]] const char* script_file = nullptr,
+	[[maybe_unused]] SymTab* symtab = nullptr,
+	[[maybe_unused]] bool optimise_ast = true,
+	[[maybe_unused]] bool inline_calls = true,
+	[[maybe_unused]] bool use_regs = true,
+	[[maybe_unused]] bool optimise_loops = true,
+	[[maybe_unused]] bool untag_values = true,
+	[[maybe_unused]] std::size_t parse_threads = 1,
+	[[maybe_unused]] std::size_t codegen_threads = 1,
+	[[maybe_unused]] const std::string& cache_dir = "")
 {
 	std::cerr << "No parsing tables available, please\n"
 		"\t- run \"./script_create\" first,\n"
@@ -538,16 +554,21 @@ lr1_run_parser([[maybe_unused]] const char* script_file = nullptr)
 		"\t- rebuild using \"make\"."
 		<< std::endl;
 
-	return std::make_tuple(false, "");
+	return std::make_tuple(false, std::vector<t_vm_byte>{});
 }
 
 #else
 
-#include "codegen/parser.h"
+#include "codegen/parser_parallel.h"
+#include "codegen/compile_cache.h"
 #include "script.tab"
 
-static std::tuple<bool, std::string>
-lr1_run_parser(const char* script_file = nullptr)
+static std::tuple<bool, std::vector<t_vm_byte>>
+lr1_run_parser(const char* script_file = nullptr, SymTab* symtab = nullptr,
+	bool optimise_ast = true, bool inline_calls = true, bool use_regs = true,
+	bool optimise_loops = true, bool untag_values = true,
+	std::size_t parse_threads = 1, std::size_t codegen_threads = 1,
+	const std::string& cache_dir = "")
 {
 	try
 	{
@@ -1069,7 +1090,40 @@ lr1_run_parser(const char* script_file = nullptr)
 			},
 		}};
 
-		Parser parser{parsetables, rules};
+		ParallelParser parser{parsetables, rules};
+
+		// write the compiled program for the standalone vm
+		auto write_bin = [script_file](std::span<const t_vm_byte> code) -> bool
+		{
+			fs::path binfile(script_file ? script_file : "script.scr");
+			binfile = binfile.filename();
+			binfile.replace_extension(".bin");
+
+			std::ofstream ofstrAsmBin(binfile.string(), std::ios_base::binary);
+			if(!ofstrAsmBin)
+			{
+				std::cerr << "Cannot open \""
+					<< binfile.string() << "\"." << std::endl;
+				return false;
+			}
+			ofstrAsmBin.write(reinterpret_cast<const char*>(code.data()),
+				static_cast<std::streamsize>(code.size()));
+			if(ofstrAsmBin.fail())
+			{
+				std::cerr << "Cannot write \""
+					<< binfile.string() << "\"." << std::endl;
+				return false;
+			}
+			ofstrAsmBin.flush();
+
+			std::cout << "\nCreated compiled program \""
+				<< binfile.string() << "\"." << std::endl;
+			return true;
+		};
+
+		// compiled programs, addressed by the hash of the script and the compilation settings
+		CompileCache cache{cache_dir};
+		std::optional<CompileCache::t_hash> cache_hash;
 
 		bool loop_input = true;
 		while(loop_input)
@@ -1086,10 +1140,50 @@ lr1_run_parser(const char* script_file = nullptr)
 				{
 					std::cerr << "Error: Cannot open file \""
 						<< script_file << "\"." << std::endl;
-					return std::make_tuple(false, "");
+					return std::make_tuple(false, std::vector<t_vm_byte>{});
 				}
 
 				std::cout << "Running \"" << script_file << "\"." << std::endl;
+
+				if(!cache_dir.empty())
+				{
+					std::string script{std::istreambuf_iterator<char>{*istr},
+						std::istreambuf_iterator<char>{}};
+
+					CompileCache::Key key;
+					key.Add(script);
+					key.Add(*std::get<0>(parsetables));
+					key.Add(*std::get<1>(parsetables));
+					key.Add(*std::get<2>(parsetables));
+					key.Add(*std::get<5>(parsetables));
+					key.Add(optimise_ast);
+					key.Add(inline_calls ? std::size_t{32} : std::size_t{0});
+					key.Add(use_regs ? static_cast<std::size_t>(g_vm_num_regs) : std::size_t{0});
+					key.Add(optimise_loops);
+					key.Add(untag_values);
+					cache_hash = key.GetHash();
+
+					// skip the compilation if the program is already cached
+					try
+					{
+						if(auto entry = cache.Load(*cache_hash); entry)
+						{
+							std::cout << "Using cached program \""
+								<< cache.GetFilename(*cache_hash) << "\"." << std::endl;
+							if(symtab)
+								*symtab = std::move(entry->symtab);
+							if(!write_bin(entry->code))
+								return std::make_tuple(false, std::vector<t_vm_byte>{});
+							return std::make_tuple(true, std::move(entry->code));
+						}
+					}
+					catch(const std::exception& ex)
+					{
+						std::cerr << ex.what() << " Compiling the script." << std::endl;
+					}
+
+					istr = std::make_unique<std::istringstream>(std::move(script));
+				}
 			}
 			else
 			{
@@ -1100,25 +1194,38 @@ lr1_run_parser(const char* script_file = nullptr)
 				istr = std::make_unique<std::istringstream>(script);
 			}
 
-			// tokenise script
-			bool end_on_newline = (script_file == nullptr);
-			auto tokens = get_all_tokens(*istr, &mapTermIdx, end_on_newline);
-
-#if DEBUG_CODEGEN != 0
-			std::cout << "\nTokens: ";
-			for(const t_toknode& tok : tokens)
+			t_astbaseptr cst;
+			if(script_file && parse_threads != 1)
 			{
-				std::size_t tokid = tok->GetId();
-				if(tokid == (std::size_t)Token::END)
-					std::cout << "END";
-				else
-					std::cout << tokid;
-				std::cout << " ";
+				// lex and parse the top-level statements in parallel
+				std::string script{std::istreambuf_iterator<char>{*istr},
+					std::istreambuf_iterator<char>{}};
+				cst = parser.Parse(script, parse_threads);
 			}
-			std::cout << "\n";
+			else
+			{
+				// tokenise script
+				bool end_on_newline = (script_file == nullptr);
+				auto tokens = get_all_tokens(*istr, &mapTermIdx, end_on_newline);
+
+#if DEBUG_CODEGEN != 0
+				std::cout << "\nTokens: ";
+				for(const t_toknode& tok : tokens)
+				{
+					std::size_t tokid = tok->GetId();
+					if(tokid == (std::size_t)Token::END)
+						std::cout << "END";
+					else
+						std::cout << tokid;
+					std::cout << " ";
+				}
+				std::cout << "\n";
 #endif
 
-			auto ast = ASTBase::cst_to_ast(parser.Parse(tokens));
+				cst = parser.Parse(tokens);
+			}
+
+			auto ast = ASTBase::cst_to_ast(cst);
 			ast->AssignLineNumbers();
 			ast->DeriveDataType();
 
@@ -1166,63 +1273,71 @@ lr1_run_parser(const char* script_file = nullptr)
 					std::make_tuple("shr", OpCode::SHR)),
 			}};
 
+			// fold constant expressions and simplify the arithmetic
+			if(optimise_ast)
+			{
+				ASTOpt astopt{&ops};
+				ast = astopt.Optimise(ast);
 #if DEBUG_CODEGEN != 0
-			std::ostringstream ostrAsm;
-			ASTAsm astasm{ostrAsm, &ops};
-			ast->accept(&astasm);
+				std::cout << "\nFolded " << astopt.GetNumFolded()
+					<< " constant expressions, simplified "
+					<< astopt.GetNumSimplified() << " operations.\n";
 #endif
+			}
 
-			std::ostringstream ostrAsmBin(
-				std::ios_base::out | std::ios_base::binary);
-			ASTAsm astasmbin{ostrAsmBin, &ops};
-			astasmbin.SetBinary(true);
-			ast->accept(&astasmbin);
-			astasmbin.PatchFunctionAddresses();
-			astasmbin.FinishCodegen();
-			std::string strAsmBin = ostrAsmBin.str();
+			// lower the syntax tree to the intermediate representation
+			ASTIR astir{&ops};
+			astir.SetNumThreads(codegen_threads);
+			ast->accept(&astir);
+			astir.FinishCodegen();
+			IRProgram& ir = astir.GetProgram();
+			ir_optimise(ir, inline_calls ? 32 : 0, use_regs ? g_vm_num_regs : 0,
+				optimise_loops, untag_values, codegen_threads);
+
+			CodeBuilder codeBin;
+			IRAsm irasm{codeBin};
+			irasm.Emit(ir);
+			std::span<const t_vm_byte> codeAsmBin = codeBin.GetCode();
+			if(symtab)
+				*symtab = ir.GetSymbolTable();
 
 #if DEBUG_CODEGEN != 0
+			std::cout << "\nIntermediate code:\n" << ir;
 			std::cout << "\nSymbol table:\n";
-			std::cout << astasmbin.GetSymbolTable();
+			std::cout << ir.GetSymbolTable();
 
 			std::cout << "\nGenerated code ("
-				<< strAsmBin.size() << " bytes):\n"
-				<< ostrAsm.str();
+				<< codeAsmBin.size() << " bytes):\n";
+			VM::Disassemble(std::cout, codeAsmBin.data(),
+				static_cast<VM::t_addr>(codeAsmBin.size()));
 #endif
 
-			fs::path binfile(script_file ? script_file : "script.scr");
-			binfile = binfile.filename();
-			binfile.replace_extension(".bin");
+			if(!write_bin(codeAsmBin))
+				return std::make_tuple(false, std::vector<t_vm_byte>{});
 
-			std::ofstream ofstrAsmBin(binfile.string(), std::ios_base::binary);
-			if(!ofstrAsmBin)
+			if(cache_hash)
 			{
-				std::cerr << "Cannot open \""
-					<< binfile.string() << "\"." << std::endl;
-				return std::make_tuple(false, "");
-			}
-			ofstrAsmBin.write(strAsmBin.data(), strAsmBin.size());
-			if(ofstrAsmBin.fail())
-			{
-				std::cerr << "Cannot write \""
-					<< binfile.string() << "\"." << std::endl;
-				return std::make_tuple(false, "");
+				try
+				{
+					cache.Store(*cache_hash, codeAsmBin, ir.GetSymbolTable());
+				}
+				catch(const std::exception& ex)
+				{
+					std::cerr << ex.what() << " Not caching the program." << std::endl;
+				}
 			}
-			ofstrAsmBin.flush();
 
-			std::cout << "\nCreated compiled program \""
-				<< binfile.string() << "\"." << std::endl;
-
-			return std::make_tuple(true, strAsmBin);
+			// the vm takes over the code without copying it
+			return std::make_tuple(true, codeBin.Release());
 		}
 	}
 	catch(const std::exception& err)
 	{
 		std::cerr << "Error: " << err.what() << std::endl;
-		return std::make_tuple(false, "");
+		return std::make_tuple(false, std::vector<t_vm_byte>{});
 	}
 
-	return std::make_tuple(true, "");
+	return std::make_tuple(true, std::vector<t_vm_byte>{});
 }
 
 #endif
@@ -1231,17 +1346,52 @@ lr1_run_parser(const char* script_file = nullptr)
 
 
 #if defined(RUN_PARSER) && RUN_VM != 0
-static bool run_vm(const std::string& prog)
+static bool run_vm(std::vector<VM::t_byte>&& prog, bool use_jit = false,
+	const SymTab* symtab = nullptr,
+	const std::string& profile_file = "", const std::string& folded_file = "")
 {
+	if(prog.empty())
+		return false;
+
 	VM vm(4096);
+	vm.SetJit(use_jit);
+
+	// count the instructions and time the function calls
+	const bool profile = !profile_file.empty() || !folded_file.empty();
+	if(profile)
+	{
+		vm.SetProfiling(true);
+
+		std::unordered_map<VM::t_addr, std::string> funcnames;
+		if(symtab)
+		{
+			for(const auto& [name, sym] : symtab->GetSymbols())
+			{
+				if(sym.is_func)
+					funcnames.emplace(sym.addr, name);
+			}
+		}
+		vm.GetProfiler()->SetFunctionNames(funcnames);
+	}
 	//vm.SetDebug(true);
 	//vm.SetZeroPoppedVals(true);
 	//vm.SetDrawMemImages(true);
-	VM::t_addr sp_initial = vm.GetSP();
-	vm.SetMem(0, prog, true);
+	vm.SetCode(std::make_shared<const VMCode>(std::move(prog)));
+
+	// verified code runs without bounds checks
+	try
+	{
+		vm.Verify();
+	}
+	catch(const std::exception& ex)
+	{
+		std::cerr << ex.what() << " Running with checks." << std::endl;
+	}
+
 	vm.Run();
 
-	if(vm.GetSP() != sp_initial)
+	// is there a value left below the global stack frame?
+	if(vm.GetSP() < vm.GetBP() - vm.GetFrameSize())
 	{
 		std::cout << "\nResult: ";
 		std::visit([](auto&& val) -> void
@@ -1255,12 +1405,53 @@ static bool run_vm(const std::string& prog)
 		std::cout << std::endl;
 	}
 
+	if(profile)
+	{
+		const VMProfiler* profiler = vm.GetProfiler();
+		std::cout << "\nProfile: " << profiler->GetNumInstructions() << " instructions, "
+			<< "maximum stack size: " << profiler->GetMaxStackSize() << " bytes."
+			<< std::endl;
+
+		if(!profile_file.empty())
+		{
+			std::ofstream ofstr(profile_file);
+			profiler->WriteJson(ofstr);
+			if(!ofstr)
+				std::cerr << "Cannot write \"" << profile_file << "\"." << std::endl;
+		}
+
+		if(!folded_file.empty())
+		{
+			std::ofstream ofstr(folded_file);
+			profiler->WriteFolded(ofstr);
+			if(!ofstr)
+				std::cerr << "Cannot write \"" << folded_file << "\"." << std::endl;
+		}
+	}
+
 	return true;
 }
 #endif
 
 
 
+#ifdef RUN_PARSER
+/**
+ * get the number of threads given as an option's value, nullopt if it is invalid
+ */
+static std::optional<std::size_t> get_num_threads(std::string_view val)
+{
+	std::size_t num = 0;
+	const char* end = val.data() + val.size();
+	if(auto [ptr, err] = std::from_chars(val.data(), end, num);
+		val.empty() || err != std::errc{} || ptr != end)
+		return std::nullopt;
+	return num;
+}
+#endif
+
+
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
 	std::ios_base::sync_with_stdio(false);
@@ -1280,18 +1471,69 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 #ifdef RUN_PARSER
 	t_timepoint start_codegen = t_clock::now();
 	const char* script_file = nullptr;
-	if(argc >= 2)
-		script_file = argv[1];
+	[[maybe_unused]] bool use_jit = false;
+	bool optimise_ast = true;
+	bool inline_calls = true;
+	bool use_regs = true;
+	bool optimise_loops = true;
+	bool untag_values = true;
+	// threads lexing and parsing the top-level statements, 0: all hardware threads
+	std::size_t parse_threads = 1;
+	// threads generating and optimising the functions' code, 0: all hardware threads
+	std::size_t codegen_threads = 1;
+	// directory of the compiled programs cache, none if empty
+	std::string cache_dir;
+	// profile outputs, as json and as folded stacks for flame graphs
+	[[maybe_unused]] std::string profile_file, folded_file;
+	for(int arg=1; arg<argc; ++arg)
+	{
+		const std::string argstr = argv[arg];
+		if(argstr == "--jit")
+			use_jit = true;
+		else if(argstr.starts_with("--profile="))
+			profile_file = argstr.substr(10);
+		else if(argstr.starts_with("--folded="))
+			folded_file = argstr.substr(9);
+		else if(argstr == "--no-fold")
+			optimise_ast = false;
+		else if(argstr == "--no-inline")
+			inline_calls = false;
+		else if(argstr == "--no-regs")
+			use_regs = false;
+		else if(argstr == "--no-loop-opt")
+			optimise_loops = false;
+		else if(argstr == "--no-untag")
+			untag_values = false;
+		else if(argstr.starts_with("--parse-threads=") || argstr.starts_with("--codegen-threads="))
+		{
+			const bool parse = argstr.starts_with("--parse-threads=");
+			std::optional<std::size_t> num_threads = get_num_threads(
+				std::string_view{argstr}.substr(parse ? 16 : 18));
+			if(!num_threads)
+			{
+				std::cerr << "Invalid number of threads in \"" << argstr << "\"." << std::endl;
+				return -1;
+			}
+			(parse ? parse_threads : codegen_threads) = *num_threads;
+		}
+		else if(argstr.starts_with("--cache-dir="))
+			cache_dir = argstr.substr(12);
+		else
+			script_file = argv[arg];
+	}
 
 	create_symbols();
-	if(auto [code_ok, prog] = lr1_run_parser(script_file); code_ok)
+	SymTab symtab;
+	if(auto [code_ok, prog] = lr1_run_parser(script_file, &symtab,
+		optimise_ast, inline_calls, use_regs, optimise_loops, untag_values,
+		parse_threads, codegen_threads, cache_dir); code_ok)
 	{
 		t_duration time_codegen = t_clock::now() - start_codegen;
 		std::cout << "Code generation time: " << time_codegen.count() << " s." << std::endl;
 
 #if RUN_VM != 0
 		t_timepoint start_vm = t_clock::now();
-		if(run_vm(prog))
+		if(run_vm(std::move(prog), use_jit, &symtab, profile_file, folded_file))
 		{
 			t_duration time_vm = t_clock::now() - start_vm;
 			std::cout << "VM execution time: " << time_vm.count() << " s." << std::endl;
@@ -40,16 +40,16 @@ static bool run_vm(const char* _prog = nullptr)
 	try
 	{
 		VM vm(4096);
-		VM::t_addr sp_initial = vm.GetSP();
 
 		vm.SetDebug(false);
 		vm.SetChecks(true);
 		vm.SetMem(0, bytes.data(), filesize, true);
 		vm.Run();
 
-		// print remaining stack
+		// print remaining stack below the global stack frame
 		std::size_t stack_idx = 0;
-		while(vm.GetSP() < sp_initial)
+		const VM::t_addr sp_frame = vm.GetBP() - vm.GetFrameSize();
+		while(vm.GetSP() < sp_frame)
 		{
 			VM::t_data dat = vm.PopData();
 			const char* type_name = VM::GetDataTypeName(dat);
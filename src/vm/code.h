@@ -0,0 +1,81 @@
+/**
+ * immutable code image which can be shared between several vm instances
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_CODE_H__
+#define __LR1_0ACVM_CODE_H__
+
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "types.h"
+
+
+
+/**
+ * compiled program, mapped to the addresses [0, size) of every vm using it
+ */
+class VMCode
+{
+public:
+	using t_byte = t_vm_byte;
+	using t_addr = t_vm_addr;
+
+
+public:
+	explicit VMCode(std::vector<t_byte>&& code) : m_code{std::move(code)}
+	{
+		if(m_code.empty())
+			throw std::runtime_error("Empty code image.");
+	}
+
+	VMCode(const t_byte* code, std::size_t size)
+		: VMCode(std::vector<t_byte>(code, code + size))
+	{}
+
+	VMCode(const VMCode&) = delete;
+	VMCode& operator=(const VMCode&) = delete;
+
+
+	const t_byte* GetData() const { return m_code.data(); }
+	t_addr GetSize() const { return static_cast<t_addr>(m_code.size()); }
+
+
+	/**
+	 * create a shared code image
+	 */
+	static std::shared_ptr<const VMCode> Create(const t_byte* code, std::size_t size)
+	{
+		return std::make_shared<const VMCode>(code, size);
+	}
+
+
+	/**
+	 * load a shared code image from a compiled program file
+	 */
+	static std::shared_ptr<const VMCode> Load(const std::string& filename)
+	{
+		std::ifstream ifstr(filename, std::ios_base::binary);
+		if(!ifstr)
+			throw std::runtime_error("Cannot open code file \"" + filename + "\".");
+
+		std::vector<t_byte> code{std::istreambuf_iterator<char>(ifstr),
+			std::istreambuf_iterator<char>()};
+		return std::make_shared<const VMCode>(std::move(code));
+	}
+
+
+private:
+	const std::vector<t_byte> m_code{};
+};
+
+
+#endif
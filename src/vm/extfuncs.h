@@ -0,0 +1,112 @@
+/**
+ * external function indices shared by the code generator and the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_EXTFUNCS_H__
+#define __LR1_EXTFUNCS_H__
+
+#include <optional>
+#include <string_view>
+
+#include "types.h"
+
+
+
+/**
+ * built-in external functions, the values are their indices in the
+ * vm's function registry, functions registered by the host come afterwards
+ */
+enum class ExtFunc : t_vm_addr
+{
+	SQRT        = 0x00,
+	POW         = 0x01,
+	SIN         = 0x02,
+	COS         = 0x03,
+	TAN         = 0x04,
+
+	SET_EPS     = 0x05,
+	GET_EPS     = 0x06,
+
+	PRINT       = 0x07,
+	PRINTLN     = 0x08,
+	INPUT_REAL  = 0x09,
+	INPUT_INT   = 0x0a,
+
+	SET_ISR     = 0x0b,
+	SLEEP       = 0x0c,
+	SET_TIMER   = 0x0d,
+
+	NUM_BUILTIN = 0x0e,  // number of built-in functions
+};
+
+
+
+/**
+ * get the name of a built-in external function
+ */
+template<class t_str = const char*>
+constexpr t_str get_vm_extfunc_name(ExtFunc func)
+{
+	switch(func)
+	{
+		case ExtFunc::SQRT:        return "sqrt";
+		case ExtFunc::POW:         return "pow";
+		case ExtFunc::SIN:         return "sin";
+		case ExtFunc::COS:         return "cos";
+		case ExtFunc::TAN:         return "tan";
+		case ExtFunc::SET_EPS:     return "set_eps";
+		case ExtFunc::GET_EPS:     return "get_eps";
+		case ExtFunc::PRINT:       return "print";
+		case ExtFunc::PRINTLN:     return "println";
+		case ExtFunc::INPUT_REAL:  return "input_real";
+		case ExtFunc::INPUT_INT:   return "input_int";
+		case ExtFunc::SET_ISR:     return "set_isr";
+		case ExtFunc::SLEEP:       return "sleep";
+		case ExtFunc::SET_TIMER:   return "set_timer";
+		default:                   return "<unknown>";
+	}
+}
+
+
+
+/**
+ * get the number of arguments of a built-in external function
+ */
+constexpr t_vm_int get_vm_extfunc_num_args(ExtFunc func)
+{
+	switch(func)
+	{
+		case ExtFunc::POW:
+		case ExtFunc::SET_ISR:
+			return 2;
+		case ExtFunc::GET_EPS:
+		case ExtFunc::INPUT_REAL:
+		case ExtFunc::INPUT_INT:
+			return 0;
+		default:
+			return 1;
+	}
+}
+
+
+
+/**
+ * find a built-in external function by its name
+ */
+constexpr std::optional<ExtFunc> get_vm_extfunc(std::string_view name)
+{
+	for(t_vm_addr idx=0; idx<static_cast<t_vm_addr>(ExtFunc::NUM_BUILTIN); ++idx)
+	{
+		ExtFunc func = static_cast<ExtFunc>(idx);
+		if(name == get_vm_extfunc_name(func))
+			return func;
+	}
+
+	return std::nullopt;
+}
+
+
+#endif
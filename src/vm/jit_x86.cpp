@@ -0,0 +1,527 @@
+/**
+ * x86-64 machine code emitter and executable memory for the vm's jit compiler
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ *   - Intel 64 and IA-32 Architectures Software Developer's Manual, Vol. 2
+ *   - System V AMD64 ABI
+ */
+
+#include "jit_x86.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+#if LR1_VM_JIT_X86 != 0
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+
+static constexpr std::uint8_t reg_num(X86Reg reg)
+{
+	return static_cast<std::uint8_t>(reg);
+}
+
+
+
+// ----------------------------------------------------------------------------
+// encoding
+// ----------------------------------------------------------------------------
+
+void X86Emitter::Emit32(std::int32_t val)
+{
+	t_byte bytes[sizeof(val)];
+	std::memcpy(bytes, &val, sizeof(val));
+	m_code.insert(m_code.end(), bytes, bytes + sizeof(val));
+}
+
+
+void X86Emitter::Emit64(std::int64_t val)
+{
+	t_byte bytes[sizeof(val)];
+	std::memcpy(bytes, &val, sizeof(val));
+	m_code.insert(m_code.end(), bytes, bytes + sizeof(val));
+}
+
+
+void X86Emitter::Patch32(std::size_t pos, std::int32_t val)
+{
+	std::memcpy(m_code.data() + pos, &val, sizeof(val));
+}
+
+
+/**
+ * emit a rex prefix if needed
+ */
+void X86Emitter::Rex(bool w, std::uint8_t reg, std::uint8_t rm, std::uint8_t index, bool force)
+{
+	t_byte rex = 0x40;
+	if(w)
+		rex |= 0b1000;
+	if(reg & 0b1000)
+		rex |= 0b0100;
+	if(index & 0b1000)
+		rex |= 0b0010;
+	if(rm & 0b1000)
+		rex |= 0b0001;
+
+	if(rex != 0x40 || force)
+		Emit(rex);
+}
+
+
+/**
+ * emit an instruction with a memory operand,
+ * always using the [base + index + disp32] form
+ */
+void X86Emitter::Op(std::optional<t_byte> prefix, bool w, std::initializer_list<t_byte> opcode,
+	std::uint8_t reg, const X86Mem& mem, bool byte_reg)
+{
+	std::uint8_t base = reg_num(mem.base);
+	std::uint8_t index = mem.index ? reg_num(*mem.index) : 0;
+
+	if(prefix)
+		Emit(*prefix);
+	Rex(w, reg, base, index, byte_reg && reg >= 4);
+	for(t_byte op : opcode)
+		Emit(op);
+
+	// mod = 0b10: 32 bit displacement
+	if(mem.index || (base & 0b111) == 0b100)
+	{
+		// sib byte needed
+		Emit(0b10000000 | ((reg & 0b111) << 3) | 0b100);
+		std::uint8_t sib_index = mem.index ? (index & 0b111) : 0b100;
+		Emit((sib_index << 3) | (base & 0b111));
+	}
+	else
+	{
+		Emit(0b10000000 | ((reg & 0b111) << 3) | (base & 0b111));
+	}
+
+	Emit32(mem.disp);
+}
+
+
+/**
+ * emit an instruction with a register operand
+ */
+void X86Emitter::Op(std::optional<t_byte> prefix, bool w, std::initializer_list<t_byte> opcode,
+	std::uint8_t reg, std::uint8_t rm, bool byte_reg)
+{
+	if(prefix)
+		Emit(*prefix);
+	Rex(w, reg, rm, 0, byte_reg && (reg >= 4 || rm >= 4));
+	for(t_byte op : opcode)
+		Emit(op);
+
+	// mod = 0b11: register
+	Emit(0b11000000 | ((reg & 0b111) << 3) | (rm & 0b111));
+}
+
+
+
+// ----------------------------------------------------------------------------
+// moves
+// ----------------------------------------------------------------------------
+
+void X86Emitter::Mov64(X86Reg dst, X86Reg src)
+{
+	Op(std::nullopt, true, { 0x89 }, reg_num(src), reg_num(dst));
+}
+
+
+void X86Emitter::Mov64(X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, true, { 0x8b }, reg_num(dst), src);
+}
+
+
+void X86Emitter::Mov64(const X86Mem& dst, X86Reg src)
+{
+	Op(std::nullopt, true, { 0x89 }, reg_num(src), dst);
+}
+
+
+void X86Emitter::MovImm64(X86Reg dst, std::int64_t imm)
+{
+	Rex(true, 0, reg_num(dst), 0);
+	Emit(0xb8 + (reg_num(dst) & 0b111));
+	Emit64(imm);
+}
+
+
+void X86Emitter::MovImm64(const X86Mem& dst, std::int32_t imm)
+{
+	Op(std::nullopt, true, { 0xc7 }, 0, dst);
+	Emit32(imm);
+}
+
+
+void X86Emitter::Movsxd(X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, true, { 0x63 }, reg_num(dst), src);
+}
+
+
+void X86Emitter::Lea64(X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, true, { 0x8d }, reg_num(dst), src);
+}
+
+
+void X86Emitter::Mov32(const X86Mem& dst, X86Reg src)
+{
+	Op(std::nullopt, false, { 0x89 }, reg_num(src), dst);
+}
+
+
+void X86Emitter::MovImm32(const X86Mem& dst, std::int32_t imm)
+{
+	Op(std::nullopt, false, { 0xc7 }, 0, dst);
+	Emit32(imm);
+}
+
+
+void X86Emitter::Mov8(const X86Mem& dst, X86Reg src)
+{
+	Op(std::nullopt, false, { 0x88 }, reg_num(src), dst, true);
+}
+
+
+void X86Emitter::MovImm8(const X86Mem& dst, std::uint8_t imm)
+{
+	Op(std::nullopt, false, { 0xc6 }, 0, dst);
+	Emit(imm);
+}
+
+
+void X86Emitter::Movzx8(X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, false, { 0x0f, 0xb6 }, reg_num(dst), src);
+}
+
+
+
+// ----------------------------------------------------------------------------
+// arithmetic
+// ----------------------------------------------------------------------------
+
+void X86Emitter::Alu64(std::uint8_t op, X86Reg dst, X86Reg src)
+{
+	Op(std::nullopt, true, { static_cast<t_byte>((op << 3) | 0x01) },
+		reg_num(src), reg_num(dst));
+}
+
+
+void X86Emitter::Alu64(std::uint8_t op, X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, true, { static_cast<t_byte>((op << 3) | 0x03) },
+		reg_num(dst), src);
+}
+
+
+void X86Emitter::AluImm64(std::uint8_t op, X86Reg dst, std::int32_t imm)
+{
+	Op(std::nullopt, true, { 0x81 }, op, reg_num(dst));
+	Emit32(imm);
+}
+
+
+void X86Emitter::Imul64(X86Reg dst, const X86Mem& src)
+{
+	Op(std::nullopt, true, { 0x0f, 0xaf }, reg_num(dst), src);
+}
+
+
+void X86Emitter::Idiv64(X86Reg src)
+{
+	Op(std::nullopt, true, { 0xf7 }, 7, reg_num(src));
+}
+
+
+void X86Emitter::Cqo()
+{
+	Emit(0x48);
+	Emit(0x99);
+}
+
+
+void X86Emitter::Neg64(const X86Mem& dst)
+{
+	Op(std::nullopt, true, { 0xf7 }, 3, dst);
+}
+
+
+void X86Emitter::Not64(const X86Mem& dst)
+{
+	Op(std::nullopt, true, { 0xf7 }, 2, dst);
+}
+
+
+void X86Emitter::Shift64(std::uint8_t op, X86Reg dst)
+{
+	Op(std::nullopt, true, { 0xd3 }, op, reg_num(dst));
+}
+
+
+void X86Emitter::BitImm64(std::uint8_t op, X86Reg dst, std::uint8_t bit)
+{
+	Op(std::nullopt, true, { 0x0f, 0xba }, op, reg_num(dst));
+	Emit(bit);
+}
+
+
+void X86Emitter::BitImm64(std::uint8_t op, const X86Mem& dst, std::uint8_t bit)
+{
+	Op(std::nullopt, true, { 0x0f, 0xba }, op, dst);
+	Emit(bit);
+}
+
+
+void X86Emitter::Alu8(std::uint8_t op, const X86Mem& dst, X86Reg src)
+{
+	Op(std::nullopt, false, { static_cast<t_byte>(op << 3) }, reg_num(src), dst, true);
+}
+
+
+void X86Emitter::Alu8(std::uint8_t op, X86Reg dst, X86Reg src)
+{
+	Op(std::nullopt, false, { static_cast<t_byte>(op << 3) }, reg_num(src), reg_num(dst), true);
+}
+
+
+void X86Emitter::AluImm8(std::uint8_t op, const X86Mem& dst, std::uint8_t imm)
+{
+	Op(std::nullopt, false, { 0x80 }, op, dst);
+	Emit(imm);
+}
+
+
+void X86Emitter::AluImm8(std::uint8_t op, X86Reg dst, std::uint8_t imm)
+{
+	Op(std::nullopt, false, { 0x80 }, op, reg_num(dst), true);
+	Emit(imm);
+}
+
+
+void X86Emitter::Test8(X86Reg reg1, X86Reg reg2)
+{
+	Op(std::nullopt, false, { 0x84 }, reg_num(reg2), reg_num(reg1), true);
+}
+
+
+void X86Emitter::Test64(X86Reg reg1, X86Reg reg2)
+{
+	Op(std::nullopt, true, { 0x85 }, reg_num(reg2), reg_num(reg1));
+}
+
+
+void X86Emitter::Setcc(X86Cond cond, X86Reg dst)
+{
+	Op(std::nullopt, false, { 0x0f, static_cast<t_byte>(0x90 | static_cast<t_byte>(cond)) },
+		0, reg_num(dst), true);
+}
+
+
+
+// ----------------------------------------------------------------------------
+// scalar doubles
+// ----------------------------------------------------------------------------
+
+void X86Emitter::Sse(std::uint8_t op, std::uint8_t xmm, const X86Mem& src)
+{
+	Op(0xf2, false, { 0x0f, op }, xmm, src);
+}
+
+
+void X86Emitter::Sse(std::uint8_t op, std::uint8_t xmm, std::uint8_t xmm_src)
+{
+	Op(0xf2, false, { 0x0f, op }, xmm, xmm_src);
+}
+
+
+void X86Emitter::MovsdStore(const X86Mem& dst, std::uint8_t xmm)
+{
+	Op(0xf2, false, { 0x0f, 0x11 }, xmm, dst);
+}
+
+
+void X86Emitter::Ucomisd(std::uint8_t xmm1, std::uint8_t xmm2)
+{
+	Op(0x66, false, { 0x0f, 0x2e }, xmm1, xmm2);
+}
+
+
+void X86Emitter::Cvtsi2sd(std::uint8_t xmm, const X86Mem& src)
+{
+	Op(0xf2, true, { 0x0f, 0x2a }, xmm, src);
+}
+
+
+void X86Emitter::Cvttsd2si(X86Reg dst, const X86Mem& src)
+{
+	Op(0xf2, true, { 0x0f, 0x2c }, reg_num(dst), src);
+}
+
+
+void X86Emitter::MovqToXmm(std::uint8_t xmm, X86Reg src)
+{
+	Op(0x66, true, { 0x0f, 0x6e }, xmm, reg_num(src));
+}
+
+
+void X86Emitter::MovqFromXmm(X86Reg dst, std::uint8_t xmm)
+{
+	Op(0x66, true, { 0x0f, 0x7e }, xmm, reg_num(dst));
+}
+
+
+
+// ----------------------------------------------------------------------------
+// control flow
+// ----------------------------------------------------------------------------
+
+/**
+ * emit a conditional jump, its target is set using Bind()
+ */
+X86Emitter::t_label X86Emitter::Jcc(X86Cond cond)
+{
+	Emit(0x0f);
+	Emit(0x80 | static_cast<t_byte>(cond));
+
+	t_label label = GetPos();
+	Emit32(0);
+	return label;
+}
+
+
+/**
+ * emit an unconditional jump, its target is set using Bind()
+ */
+X86Emitter::t_label X86Emitter::Jmp()
+{
+	Emit(0xe9);
+
+	t_label label = GetPos();
+	Emit32(0);
+	return label;
+}
+
+
+/**
+ * let a jump point to the current position
+ */
+void X86Emitter::Bind(t_label label)
+{
+	Bind(label, GetPos());
+}
+
+
+/**
+ * let a jump point to the given position
+ */
+void X86Emitter::Bind(t_label label, std::size_t target)
+{
+	Patch32(label, static_cast<std::int32_t>(target) -
+		static_cast<std::int32_t>(label + sizeof(std::int32_t)));
+}
+
+
+void X86Emitter::CallReg(X86Reg reg)
+{
+	Op(std::nullopt, false, { 0xff }, 2, reg_num(reg));
+}
+
+
+void X86Emitter::Push(X86Reg reg)
+{
+	Rex(false, 0, reg_num(reg), 0);
+	Emit(0x50 + (reg_num(reg) & 0b111));
+}
+
+
+void X86Emitter::Pop(X86Reg reg)
+{
+	Rex(false, 0, reg_num(reg), 0);
+	Emit(0x58 + (reg_num(reg) & 0b111));
+}
+
+
+void X86Emitter::Ret()
+{
+	Emit(0xc3);
+}
+
+
+
+// ----------------------------------------------------------------------------
+// executable memory
+// ----------------------------------------------------------------------------
+
+JitMemory::~JitMemory()
+{
+	Clear();
+}
+
+
+/**
+ * copy code into executable memory and get its address,
+ * the memory is only writable while the code is copied
+ */
+const JitMemory::t_byte* JitMemory::Add(const std::vector<t_byte>& code)
+{
+#if LR1_VM_JIT_X86 != 0
+	const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+
+	if(m_regions.empty() || m_regions.back().used + code.size() > m_regions.back().size)
+	{
+		// allocate a new region
+		std::size_t size = std::max<std::size_t>(16*page_size, code.size());
+		size = (size + page_size - 1) / page_size * page_size;
+
+		void *mem = ::mmap(nullptr, size, PROT_READ | PROT_EXEC,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(mem == MAP_FAILED)
+			throw std::runtime_error("Cannot allocate executable memory.");
+
+		m_regions.emplace_back(Region{static_cast<t_byte*>(mem), size, 0});
+	}
+
+	Region& region = m_regions.back();
+	if(::mprotect(region.mem, region.size, PROT_READ | PROT_WRITE) != 0)
+		throw std::runtime_error("Cannot make code memory writable.");
+
+	t_byte *dst = region.mem + region.used;
+	std::memcpy(dst, code.data(), code.size());
+	// keep the entry points aligned
+	region.used += (code.size() + 15) / 16 * 16;
+
+	if(::mprotect(region.mem, region.size, PROT_READ | PROT_EXEC) != 0)
+		throw std::runtime_error("Cannot make code memory executable.");
+
+	return dst;
+
+#else
+	(void)code;
+	throw std::runtime_error("Native code generation is not supported on this system.");
+#endif
+}
+
+
+/**
+ * free all code
+ */
+void JitMemory::Clear()
+{
+#if LR1_VM_JIT_X86 != 0
+	for(Region& region : m_regions)
+		::munmap(region.mem, region.size);
+#endif
+
+	m_regions.clear();
+}
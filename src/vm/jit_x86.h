@@ -0,0 +1,234 @@
+/**
+ * x86-64 machine code emitter and executable memory for the vm's jit compiler
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_JIT_X86_H__
+#define __LR1_0ACVM_JIT_X86_H__
+
+
+#include <vector>
+#include <optional>
+#include <initializer_list>
+#include <cstdint>
+#include <cstddef>
+
+#include "types.h"
+
+
+// native code generation is only available on x86-64 posix systems,
+// the generated code uses 32-bit vm addresses
+#if defined(__x86_64__) && __has_include(<sys/mman.h>) && LR1_VM_ADDR_BITS == 32
+	#define LR1_VM_JIT_X86 1
+#else
+	#define LR1_VM_JIT_X86 0
+#endif
+
+
+
+/**
+ * vm registers and tables shared with the native code
+ */
+struct VMJitRegs
+{
+	t_vm_byte* mem{nullptr};         // vm memory, indexed by absolute addresses
+	void* vm{nullptr};               // vm instance for helper calls
+	t_vm_byte* regfile{nullptr};     // registers holding ints and reals
+	t_vm_real eps{};                 // epsilon for real comparisons
+
+	t_vm_addr ip{};                  // instruction pointer
+	t_vm_addr sp{};                  // stack pointer
+	t_vm_addr bp{};                  // base pointer
+	t_vm_addr gbp{};                 // global base pointer
+	t_vm_addr stacklimit{};          // lowest allowed stack address
+	t_vm_addr irqbp{-1};             // base pointer of the running interrupt routine
+
+	// sizes of function arguments including their type descriptor,
+	// indexed by the type descriptor, 0 for unsupported types
+	t_vm_byte argsizes[256]{};       // for looking up argument addresses
+	t_vm_byte popsizes[256]{};       // for removing arguments from the stack
+};
+
+
+// entry point of a native code block, returns false if it exited
+// at its first instruction without making progress
+using t_vm_jitfunc = bool (*)(VMJitRegs* regs);
+
+
+
+enum class X86Reg : std::uint8_t
+{
+	RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+	R8, R9, R10, R11, R12, R13, R14, R15,
+};
+
+
+enum class X86Cond : std::uint8_t
+{
+	O = 0x0, NO = 0x1,
+	B = 0x2, AE = 0x3,     // unsigned <, >=
+	E = 0x4, NE = 0x5,
+	BE = 0x6, A = 0x7,     // unsigned <=, >
+	S = 0x8, NS = 0x9,
+	P = 0xa, NP = 0xb,
+	L = 0xc, GE = 0xd,     // signed <, >=
+	LE = 0xe, G = 0xf,     // signed <=, >
+};
+
+
+/**
+ * memory operand [base + index + disp]
+ */
+struct X86Mem
+{
+	X86Reg base{X86Reg::RAX};
+	std::optional<X86Reg> index{};
+	std::int32_t disp{0};
+};
+
+
+
+/**
+ * emits x86-64 machine code, only the instruction forms
+ * needed by the jit compiler are provided
+ */
+class X86Emitter
+{
+public:
+	using t_byte = std::uint8_t;
+	using t_label = std::size_t;
+
+
+public:
+	X86Emitter() = default;
+	~X86Emitter() = default;
+
+	const std::vector<t_byte>& GetCode() const { return m_code; }
+	std::size_t GetPos() const { return m_code.size(); }
+
+	// 64 bit moves
+	void Mov64(X86Reg dst, X86Reg src);
+	void Mov64(X86Reg dst, const X86Mem& src);
+	void Mov64(const X86Mem& dst, X86Reg src);
+	void MovImm64(X86Reg dst, std::int64_t imm);
+	void MovImm64(const X86Mem& dst, std::int32_t imm);
+	void Movsxd(X86Reg dst, const X86Mem& src);
+	void Lea64(X86Reg dst, const X86Mem& src);
+
+	// 32 and 8 bit moves
+	void Mov32(const X86Mem& dst, X86Reg src);
+	void MovImm32(const X86Mem& dst, std::int32_t imm);
+	void Mov8(const X86Mem& dst, X86Reg src);
+	void MovImm8(const X86Mem& dst, std::uint8_t imm);
+	void Movzx8(X86Reg dst, const X86Mem& src);
+
+	// 64 bit arithmetic, op is one of the opcode extensions
+	// (add: 0, or: 1, and: 4, sub: 5, xor: 6, cmp: 7)
+	void Alu64(std::uint8_t op, X86Reg dst, X86Reg src);
+	void Alu64(std::uint8_t op, X86Reg dst, const X86Mem& src);
+	void AluImm64(std::uint8_t op, X86Reg dst, std::int32_t imm);
+	void Imul64(X86Reg dst, const X86Mem& src);
+	void Idiv64(X86Reg src);
+	void Cqo();
+	void Neg64(const X86Mem& dst);
+	void Not64(const X86Mem& dst);
+	// shifts and rotations by cl (rol: 0, ror: 1, shl: 4, sar: 7)
+	void Shift64(std::uint8_t op, X86Reg dst);
+	// bit test and complement/reset (btr: 6, btc: 7)
+	void BitImm64(std::uint8_t op, X86Reg dst, std::uint8_t bit);
+	void BitImm64(std::uint8_t op, const X86Mem& dst, std::uint8_t bit);
+
+	// 8 bit arithmetic
+	void Alu8(std::uint8_t op, const X86Mem& dst, X86Reg src);
+	void Alu8(std::uint8_t op, X86Reg dst, X86Reg src);
+	void AluImm8(std::uint8_t op, const X86Mem& dst, std::uint8_t imm);
+	void AluImm8(std::uint8_t op, X86Reg dst, std::uint8_t imm);
+	void Test8(X86Reg reg1, X86Reg reg2);
+	void Test64(X86Reg reg1, X86Reg reg2);
+	void Setcc(X86Cond cond, X86Reg dst);
+
+	// scalar double operations
+	// (movsd load: 0x10, add: 0x58, mul: 0x59, sub: 0x5c, div: 0x5e)
+	void Sse(std::uint8_t op, std::uint8_t xmm, const X86Mem& src);
+	void Sse(std::uint8_t op, std::uint8_t xmm, std::uint8_t xmm_src);
+	void MovsdStore(const X86Mem& dst, std::uint8_t xmm);
+	void Ucomisd(std::uint8_t xmm1, std::uint8_t xmm2);
+	void Cvtsi2sd(std::uint8_t xmm, const X86Mem& src);
+	void Cvttsd2si(X86Reg dst, const X86Mem& src);
+	void MovqToXmm(std::uint8_t xmm, X86Reg src);
+	void MovqFromXmm(X86Reg dst, std::uint8_t xmm);
+
+	// control flow
+	t_label Jcc(X86Cond cond);
+	t_label Jmp();
+	void Bind(t_label label);
+	void Bind(t_label label, std::size_t target);
+	void CallReg(X86Reg reg);
+	void Push(X86Reg reg);
+	void Pop(X86Reg reg);
+	void Ret();
+
+	// patch a previously emitted 32 bit value
+	void Patch32(std::size_t pos, std::int32_t val);
+
+
+protected:
+	void Emit(t_byte byte) { m_code.push_back(byte); }
+	void Emit32(std::int32_t val);
+	void Emit64(std::int64_t val);
+
+	void Rex(bool w, std::uint8_t reg, std::uint8_t rm, std::uint8_t index, bool force = false);
+	void Op(std::optional<t_byte> prefix, bool w, std::initializer_list<t_byte> opcode,
+		std::uint8_t reg, const X86Mem& mem, bool byte_reg = false);
+	void Op(std::optional<t_byte> prefix, bool w, std::initializer_list<t_byte> opcode,
+		std::uint8_t reg, std::uint8_t rm, bool byte_reg = false);
+
+
+private:
+	std::vector<t_byte> m_code{};
+};
+
+
+
+/**
+ * executable memory regions holding the generated code
+ */
+class JitMemory
+{
+public:
+	using t_byte = std::uint8_t;
+
+
+public:
+	JitMemory() = default;
+	~JitMemory();
+
+	JitMemory(const JitMemory&) = delete;
+	JitMemory& operator=(const JitMemory&) = delete;
+
+	/**
+	 * copy code into executable memory and get its address
+	 */
+	const t_byte* Add(const std::vector<t_byte>& code);
+
+	/**
+	 * free all code
+	 */
+	void Clear();
+
+
+private:
+	struct Region
+	{
+		t_byte* mem{nullptr};
+		std::size_t size{0};
+		std::size_t used{0};
+	};
+
+	std::vector<Region> m_regions{};
+};
+
+
+#endif
@@ -0,0 +1,304 @@
+/**
+ * reserved, lazily committed memory of the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "memory.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#if LR1_VM_MMAP != 0
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+
+#if LR1_VM_MMAP != 0
+/**
+ * map fresh anonymous pages, their physical memory is not reserved
+ */
+static void* map_pages(void* addr, std::size_t size)
+{
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+	flags |= MAP_NORESERVE;
+#endif
+	if(addr)
+		flags |= MAP_FIXED;
+
+	return ::mmap(addr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+}
+#endif
+
+
+/**
+ * reserve the address range
+ */
+VMMemory::VMMemory(std::size_t size) : m_size{size}
+{
+	if(!m_size)
+		return;
+
+#if LR1_VM_MMAP != 0
+	void* mem = map_pages(nullptr, m_size);
+	if(mem == MAP_FAILED)
+		throw std::runtime_error("Cannot reserve the vm memory.");
+	m_mem = static_cast<t_vm_byte*>(mem);
+#else
+	m_mem = new t_vm_byte[m_size]{};
+#endif
+}
+
+
+/**
+ * create a memory whose pages are copied from the layer when they are touched
+ */
+VMMemory::VMMemory(std::shared_ptr<const VMMemoryLayer> base)
+	: VMMemory(base ? base->mem.GetSize() : 0)
+{
+	if(!base)
+		return;
+
+	m_base = base;
+	m_present.assign((m_size + m_pagesize - 1) / m_pagesize, false);
+}
+
+
+VMMemory::~VMMemory()
+{
+	Release();
+}
+
+
+VMMemory::VMMemory(VMMemory&& mem) noexcept
+	: m_mem{mem.m_mem}, m_size{mem.m_size},
+		m_base{std::move(mem.m_base)}, m_present{std::move(mem.m_present)},
+		m_num_present{mem.m_num_present}, m_num_copied{mem.m_num_copied}
+{
+	mem.m_mem = nullptr;
+	mem.Release();
+}
+
+
+VMMemory& VMMemory::operator=(VMMemory&& mem) noexcept
+{
+	if(this != &mem)
+	{
+		Release();
+		m_mem = mem.m_mem;
+		m_size = mem.m_size;
+		m_base = std::move(mem.m_base);
+		m_present = std::move(mem.m_present);
+		m_num_present = mem.m_num_present;
+		m_num_copied = mem.m_num_copied;
+
+		mem.m_mem = nullptr;
+		mem.Release();
+	}
+
+	return *this;
+}
+
+
+void VMMemory::Release()
+{
+	if(m_mem)
+	{
+#if LR1_VM_MMAP != 0
+		::munmap(m_mem, m_size);
+#else
+		delete[] m_mem;
+#endif
+	}
+
+	m_mem = nullptr;
+	m_size = 0;
+	m_base.reset();
+	m_present.clear();
+	m_num_present = 0;
+	m_num_copied = 0;
+}
+
+
+/**
+ * zero the range [begin, end), its whole pages are replaced by
+ * fresh ones, which gives their physical memory back to the system
+ */
+void VMMemory::Zero(std::size_t begin, std::size_t end)
+{
+	end = std::min(end, m_size);
+	if(begin >= end)
+		return;
+
+	if(m_base)
+	{
+		// pages which are only partly zeroed keep the rest of their contents
+		Touch(begin, 1);
+		Touch(end - 1, 1);
+
+		for(std::size_t page = begin / m_pagesize; page < (end + m_pagesize - 1) / m_pagesize; ++page)
+		{
+			if(!m_present[page])
+			{
+				m_present[page] = true;
+				++m_num_present;
+			}
+		}
+
+		ReleaseBase();
+	}
+
+#if LR1_VM_MMAP != 0
+	// for small ranges a memset is cheaper than the system call
+	const std::size_t page_size = GetPageSize();
+	const std::size_t pages_begin = (begin + page_size - 1) / page_size * page_size;
+	const std::size_t pages_end = end / page_size * page_size;
+
+	if(pages_begin < pages_end && pages_end - pages_begin >= 4*page_size &&
+		map_pages(m_mem + pages_begin, pages_end - pages_begin) != MAP_FAILED)
+	{
+		std::memset(m_mem + begin, 0, pages_begin - begin);
+		std::memset(m_mem + pages_end, 0, end - pages_end);
+		return;
+	}
+#endif
+
+	std::memset(m_mem + begin, 0, end - begin);
+}
+
+
+/**
+ * map a file range copy-on-write to [begin, begin + size),
+ * returns false if it has to be copied instead
+ */
+bool VMMemory::MapFile([[maybe_unused]] std::size_t begin, [[maybe_unused]] int fd,
+	[[maybe_unused]] std::uint64_t file_offs, [[maybe_unused]] std::size_t size)
+{
+#if LR1_VM_MMAP != 0
+	const std::size_t page_size = GetPageSize();
+	if(fd < 0 || begin % page_size || file_offs % page_size || size % page_size
+		|| begin + size > m_size || !size)
+		return false;
+
+	// the mapped pages replace the shared ones
+	if(m_base)
+		Zero(begin, begin + size);
+
+	int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_NORESERVE
+	flags |= MAP_NORESERVE;
+#endif
+	return ::mmap(m_mem + begin, size, PROT_READ | PROT_WRITE, flags,
+		fd, static_cast<off_t>(file_offs)) != MAP_FAILED;
+#else
+	return false;
+#endif
+}
+
+
+/**
+ * zero the whole memory and stop sharing pages
+ */
+void VMMemory::Clear()
+{
+	if(m_base)
+		*this = VMMemory(m_size);
+	else
+		Zero(0, m_size);
+}
+
+
+/**
+ * copy the pages [begin, end) from the topmost layer holding them
+ */
+void VMMemory::CopyPages(std::size_t begin, std::size_t end) const
+{
+	end = std::min(end, m_present.size());
+
+	for(std::size_t page=begin; page<end; ++page)
+	{
+		if(m_present[page])
+			continue;
+
+		m_present[page] = true;
+		++m_num_present;
+
+		for(const VMMemoryLayer* layer = m_base.get(); layer; layer = layer->base.get())
+		{
+			if(!layer->present.empty() && !layer->present[page])
+				continue;
+
+			// zero pages are not copied, so that they are not committed
+			const std::size_t offs = page * m_pagesize;
+			const std::size_t size = std::min(m_pagesize, m_size - offs);
+			const t_vm_byte* src = layer->mem.Get() + offs;
+			if(!std::all_of(src, src + size, [](t_vm_byte b) -> bool { return b == 0; }))
+			{
+				std::memcpy(m_mem + offs, src, size);
+				++m_num_copied;
+			}
+			break;
+		}
+	}
+
+	ReleaseBase();
+}
+
+
+/**
+ * the layers are not needed anymore once all pages have been copied
+ */
+void VMMemory::ReleaseBase() const
+{
+	if(m_base && m_num_present == m_present.size())
+	{
+		m_base.reset();
+		m_present.clear();
+		m_num_present = 0;
+	}
+}
+
+
+/**
+ * freeze the current contents into a layer, which is shared
+ * copy-on-write by this memory and the ones created from it
+ */
+std::shared_ptr<const VMMemoryLayer> VMMemory::Freeze()
+{
+	// nothing has been copied or written since the last freeze
+	if(m_base && m_num_present == 0)
+		return m_base;
+
+	// merge deep layers by copying the remaining pages
+	if(m_base && m_base->depth + 1 >= m_max_depth)
+		Touch(0, m_size);
+
+	// the layer takes over the memory, without copying it
+	auto layer = std::make_shared<VMMemoryLayer>();
+	layer->depth = m_base ? m_base->depth + 1 : 0;
+	layer->base = std::move(m_base);
+	layer->present = std::move(m_present);
+	layer->mem.m_mem = m_mem;
+	layer->mem.m_size = m_size;
+
+	m_mem = nullptr;
+	Release();
+
+	*this = VMMemory(layer);
+	return layer;
+}
+
+
+std::size_t VMMemory::GetPageSize()
+{
+#if LR1_VM_MMAP != 0
+	static const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	return page_size;
+#else
+	return 0x1000;
+#endif
+}
@@ -0,0 +1,145 @@
+/**
+ * reserved, lazily committed memory of the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_MEMORY_H__
+#define __LR1_0ACVM_MEMORY_H__
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+
+
+// without mmap the whole memory is allocated at once
+#if __has_include(<sys/mman.h>)
+	#define LR1_VM_MMAP 1
+#else
+	#define LR1_VM_MMAP 0
+#endif
+
+
+
+struct VMMemoryLayer;
+
+
+
+/**
+ * an address range which is reserved at once, but whose pages are only
+ * committed by the system when they are first touched, so that large
+ * address spaces only cost the memory which is actually used;
+ * untouched memory reads as zero
+ *
+ * the contents can be frozen into a layer, which is shared by several
+ * memories, each of them copying a page from the layer when the page is
+ * first touched; the users have to call Touch before accessing a range
+ */
+class VMMemory
+{
+public:
+	// granularity of the shared pages
+	static constexpr const std::size_t m_pagesize = 0x1000;
+
+	// layers deeper than this are merged
+	static constexpr const std::size_t m_max_depth = 8;
+
+
+public:
+	VMMemory() = default;
+	explicit VMMemory(std::size_t size);
+	explicit VMMemory(std::shared_ptr<const VMMemoryLayer> base);
+	~VMMemory();
+
+	VMMemory(const VMMemory&) = delete;
+	VMMemory& operator=(const VMMemory&) = delete;
+
+	VMMemory(VMMemory&& mem) noexcept;
+	VMMemory& operator=(VMMemory&& mem) noexcept;
+
+	t_vm_byte* Get() const { return m_mem; }
+	std::size_t GetSize() const { return m_size; }
+
+	operator bool() const { return m_mem != nullptr; }
+
+	void Zero(std::size_t begin, std::size_t end);
+
+	/**
+	 * zero the whole memory and stop sharing pages
+	 */
+	void Clear();
+
+	/**
+	 * map a file range copy-on-write to [begin, begin + size),
+	 * returns false if it has to be copied instead
+	 */
+	bool MapFile(std::size_t begin, int fd, std::uint64_t file_offs, std::size_t size);
+
+	/**
+	 * are there pages which have not been copied from the shared layers yet?
+	 */
+	bool IsShared() const { return m_base != nullptr; }
+
+	/**
+	 * copy the not yet copied pages of the range [begin, begin + size)
+	 */
+	void Touch(std::size_t begin, std::size_t size) const
+	{
+		if(m_base)
+			CopyPages(begin / m_pagesize, (begin + size + m_pagesize - 1) / m_pagesize);
+	}
+
+	/**
+	 * freeze the current contents into a layer, which is shared
+	 * copy-on-write by this memory and the ones created from it
+	 */
+	std::shared_ptr<const VMMemoryLayer> Freeze();
+
+	/**
+	 * get the number of pages copied from the shared layers
+	 */
+	std::size_t GetNumCopiedPages() const { return m_num_copied; }
+
+	static std::size_t GetPageSize();
+
+
+protected:
+	void Release();
+
+	void CopyPages(std::size_t begin, std::size_t end) const;
+	void ReleaseBase() const;
+
+
+private:
+	t_vm_byte* m_mem{nullptr};
+	std::size_t m_size{0};
+
+	// layers holding the pages which have not been copied yet
+	mutable std::shared_ptr<const VMMemoryLayer> m_base{};
+	// pages which have been copied or written
+	mutable std::vector<bool> m_present{};
+	mutable std::size_t m_num_present{0};
+	mutable std::size_t m_num_copied{0};
+};
+
+
+
+/**
+ * frozen memory contents, pages which a layer does not
+ * hold are found in the layers below it
+ */
+struct VMMemoryLayer
+{
+	VMMemory mem{};
+	std::vector<bool> present{};     // pages held by this layer, all if empty
+	std::shared_ptr<const VMMemoryLayer> base{};
+	std::size_t depth{0};
+};
+
+
+#endif
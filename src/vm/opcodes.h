@@ -22,6 +22,9 @@ enum class OpCode : t_vm_byte
 	PUSH     = 0x10,  // push direct data
 	WRMEM    = 0x11,  // write memory
 	RDMEM    = 0x12,  // read memory
+	LDR      = 0x13,  // push register
+	STR      = 0x14,  // pop value into register
+	OPR      = 0x15,  // binary operation with a register as second operand
 
 	// arithmetic operations
 	USUB     = 0x20,  // unary -
@@ -59,6 +62,11 @@ enum class OpCode : t_vm_byte
 	CALL     = 0x70,  // call function
 	RET      = 0x71,  // return from function
 	EXTCALL  = 0x72,  // call system function
+	EXTCALLI = 0x73,  // call system function via its index
+	ICALL    = 0x74,  // call interrupt service routine
+	IRET     = 0x75,  // return from interrupt service routine
+	FRAME    = 0x76,  // set the size of the function's stack frame
+	TAILCALL = 0x77,  // call function in place of the current one
 
 	// binary operations
 	BINAND   = 0x80,  // &
@@ -69,6 +77,46 @@ enum class OpCode : t_vm_byte
 	SHR      = 0x85,  // >>
 	ROTL     = 0x86,  // rotate left
 	ROTR     = 0x87,  // rotate right
+
+	// type descriptors of the values used by the untagged operations
+	UNTAGI   = 0x90,  // remove the type descriptor of an int
+	UNTAGF   = 0x91,  // remove the type descriptor of a real
+	TAGI     = 0x92,  // add the type descriptor of an int
+	TAGF     = 0x93,  // add the type descriptor of a real
+	PUSHI    = 0x94,  // push direct int data without a type descriptor
+	PUSHF    = 0x95,  // push direct real data without a type descriptor
+
+	// arithmetic operations on untagged ints
+	IUSUB    = 0xa0,  // unary -
+	IADD     = 0xa1,  // +
+	ISUB     = 0xa2,  // -
+	IMUL     = 0xa3,  // *
+	IDIV     = 0xa4,  // /
+	IMOD     = 0xa5,  // %
+
+	// arithmetic operations on untagged reals
+	FUSUB    = 0xb0,  // unary -
+	FADD     = 0xb1,  // +
+	FSUB     = 0xb2,  // -
+	FMUL     = 0xb3,  // *
+	FDIV     = 0xb4,  // /
+	FMOD     = 0xb5,  // %
+
+	// comparisons of untagged ints
+	IGT      = 0xc0,  // >
+	ILT      = 0xc1,  // <
+	IGEQU    = 0xc2,  // >=
+	ILEQU    = 0xc3,  // <=
+	IEQU     = 0xc4,  // ==
+	INEQU    = 0xc5,  // !=
+
+	// comparisons of untagged reals
+	FGT      = 0xd0,  // >
+	FLT      = 0xd1,  // <
+	FGEQU    = 0xd2,  // >=
+	FLEQU    = 0xd3,  // <=
+	FEQU     = 0xd4,  // ==
+	FNEQU    = 0xd5,  // !=
 };
 
 
@@ -87,6 +135,9 @@ constexpr t_str get_vm_opcode_name(OpCode op)
 		case OpCode::PUSH:      return "push";
 		case OpCode::WRMEM:     return "wrmem";
 		case OpCode::RDMEM:     return "rdmem";
+		case OpCode::LDR:       return "ldr";
+		case OpCode::STR:       return "str";
+		case OpCode::OPR:       return "opr";
 		case OpCode::USUB:      return "usub";
 		case OpCode::ADD:       return "add";
 		case OpCode::SUB:       return "sub";
@@ -112,6 +163,11 @@ constexpr t_str get_vm_opcode_name(OpCode op)
 		case OpCode::CALL:      return "call";
 		case OpCode::RET:       return "ret";
 		case OpCode::EXTCALL:   return "extcall";
+		case OpCode::EXTCALLI:  return "extcalli";
+		case OpCode::ICALL:     return "icall";
+		case OpCode::IRET:      return "iret";
+		case OpCode::FRAME:     return "frame";
+		case OpCode::TAILCALL:  return "tailcall";
 		case OpCode::BINAND:    return "binand";
 		case OpCode::BINOR:     return "binor";
 		case OpCode::BINXOR:    return "binxor";
@@ -120,9 +176,105 @@ constexpr t_str get_vm_opcode_name(OpCode op)
 		case OpCode::SHR:       return "shr";
 		case OpCode::ROTL:      return "rotl";
 		case OpCode::ROTR:      return "rotr";
+		case OpCode::UNTAGI:    return "untagi";
+		case OpCode::UNTAGF:    return "untagf";
+		case OpCode::TAGI:      return "tagi";
+		case OpCode::TAGF:      return "tagf";
+		case OpCode::PUSHI:     return "pushi";
+		case OpCode::PUSHF:     return "pushf";
+		case OpCode::IUSUB:     return "iusub";
+		case OpCode::IADD:      return "iadd";
+		case OpCode::ISUB:      return "isub";
+		case OpCode::IMUL:      return "imul";
+		case OpCode::IDIV:      return "idiv";
+		case OpCode::IMOD:      return "imod";
+		case OpCode::FUSUB:     return "fusub";
+		case OpCode::FADD:      return "fadd";
+		case OpCode::FSUB:      return "fsub";
+		case OpCode::FMUL:      return "fmul";
+		case OpCode::FDIV:      return "fdiv";
+		case OpCode::FMOD:      return "fmod";
+		case OpCode::IGT:       return "igt";
+		case OpCode::ILT:       return "ilt";
+		case OpCode::IGEQU:     return "igequ";
+		case OpCode::ILEQU:     return "ilequ";
+		case OpCode::IEQU:      return "iequ";
+		case OpCode::INEQU:     return "inequ";
+		case OpCode::FGT:       return "fgt";
+		case OpCode::FLT:       return "flt";
+		case OpCode::FGEQU:     return "fgequ";
+		case OpCode::FLEQU:     return "flequ";
+		case OpCode::FEQU:      return "fequ";
+		case OpCode::FNEQU:     return "fnequ";
 		default:                return "<unknown>";
 	}
 }
 
 
+/**
+ * can the operator be applied with a register as its second operand?
+ */
+constexpr bool is_vm_register_op(OpCode op)
+{
+	switch(op)
+	{
+		case OpCode::ADD: case OpCode::SUB: case OpCode::MUL:
+		case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+		case OpCode::GT: case OpCode::LT: case OpCode::GEQU:
+		case OpCode::LEQU: case OpCode::EQU: case OpCode::NEQU:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+/**
+ * get the form of an arithmetic operator or a comparison which works
+ * on untagged ints or reals, INVALID if there is none
+ */
+constexpr OpCode get_vm_untagged_op(OpCode op, bool real)
+{
+	const t_vm_byte idx = static_cast<t_vm_byte>(op) & 0x0f;
+
+	switch(op)
+	{
+		case OpCode::USUB: case OpCode::ADD: case OpCode::SUB:
+		case OpCode::MUL: case OpCode::DIV: case OpCode::MOD:
+			return static_cast<OpCode>((real ? 0xb0 : 0xa0) | idx);
+		case OpCode::GT: case OpCode::LT: case OpCode::GEQU:
+		case OpCode::LEQU: case OpCode::EQU: case OpCode::NEQU:
+			return static_cast<OpCode>((real ? 0xd0 : 0xc0) | idx);
+		default:
+			return OpCode::INVALID;
+	}
+}
+
+
+/**
+ * get the regular form of an operator working on untagged values,
+ * INVALID if it is not such an operator
+ */
+constexpr OpCode get_vm_tagged_op(OpCode op)
+{
+	const t_vm_byte idx = static_cast<t_vm_byte>(op) & 0x0f;
+
+	switch(op)
+	{
+		case OpCode::IUSUB: case OpCode::IADD: case OpCode::ISUB:
+		case OpCode::IMUL: case OpCode::IDIV: case OpCode::IMOD:
+		case OpCode::FUSUB: case OpCode::FADD: case OpCode::FSUB:
+		case OpCode::FMUL: case OpCode::FDIV: case OpCode::FMOD:
+			return static_cast<OpCode>(0x20 | idx);
+		case OpCode::IGT: case OpCode::ILT: case OpCode::IGEQU:
+		case OpCode::ILEQU: case OpCode::IEQU: case OpCode::INEQU:
+		case OpCode::FGT: case OpCode::FLT: case OpCode::FGEQU:
+		case OpCode::FLEQU: case OpCode::FEQU: case OpCode::FNEQU:
+			return static_cast<OpCode>(0x60 | idx);
+		default:
+			return OpCode::INVALID;
+	}
+}
+
+
 #endif
@@ -0,0 +1,271 @@
+/**
+ * execution profile of the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <sstream>
+
+
+/**
+ * write a string as json
+ */
+static void write_json_str(std::ostream& ostr, const std::string& str)
+{
+	ostr << '"';
+	for(char c : str)
+	{
+		if(c == '"' || c == '\\')
+			ostr << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20)
+			ostr << ' ';
+		else
+			ostr << c;
+	}
+	ostr << '"';
+}
+
+
+
+VMProfiler::VMProfiler()
+{
+	Clear();
+}
+
+
+/**
+ * remove the collected data
+ */
+void VMProfiler::Clear()
+{
+	m_num_instrs = 0;
+	m_ops.fill(0);
+	m_ips.clear();
+	m_max_stack = 0;
+
+	m_funcs.clear();
+	m_nodes.clear();
+	m_nodes.emplace_back(CallNode{});
+	m_frames.clear();
+}
+
+
+std::string VMProfiler::GetFunctionName(t_addr addr) const
+{
+	if(auto iter = m_names.find(addr); iter != m_names.end())
+		return iter->second;
+
+	std::ostringstream ostr;
+	ostr << "0x" << std::hex << addr;
+	return ostr.str();
+}
+
+
+std::uint64_t VMProfiler::GetNumInstructions(t_addr ip) const
+{
+	if(ip < 0 || static_cast<std::size_t>(ip) >= m_ips.size())
+		return 0;
+	return m_ips[static_cast<std::size_t>(ip)];
+}
+
+
+/**
+ * attribute the time since the last event to the running call
+ */
+void VMProfiler::Charge(t_clock::time_point now)
+{
+	if(!m_running)
+		return;
+
+	const t_duration dur = now - m_last;
+	m_last = now;
+
+	if(m_frames.empty())
+	{
+		m_nodes[0].self += dur;
+		return;
+	}
+
+	const CallFrame& frame = m_frames.back();
+	m_nodes[frame.node].self += dur;
+	m_funcs[frame.addr].self += dur;
+}
+
+
+void VMProfiler::Start()
+{
+	m_last = t_clock::now();
+	m_running = true;
+}
+
+
+void VMProfiler::Stop()
+{
+	Charge(t_clock::now());
+	m_running = false;
+}
+
+
+/**
+ * a function or interrupt service routine is entered
+ */
+void VMProfiler::Call(t_addr addr)
+{
+	const t_clock::time_point now = t_clock::now();
+	Charge(now);
+
+	// find or add the node of the call stack, deep recursions stay in the last one
+	const std::size_t parent = m_frames.empty() ? 0 : m_frames.back().node;
+	std::size_t node = parent;
+	if(m_frames.size() < m_max_depth)
+	{
+		if(auto iter = m_nodes[parent].children.find(addr); iter != m_nodes[parent].children.end())
+		{
+			node = iter->second;
+		}
+		else
+		{
+			node = m_nodes.size();
+			m_nodes[parent].children.emplace(addr, node);
+			m_nodes.emplace_back(CallNode{ .addr = addr, .parent = parent });
+		}
+	}
+
+	FuncInfo& func = m_funcs[addr];
+	++func.calls;
+	++func.active;
+
+	m_frames.emplace_back(CallFrame{ .addr = addr, .node = node, .start = now });
+}
+
+
+/**
+ * a function or interrupt service routine is left
+ */
+void VMProfiler::Return()
+{
+	if(m_frames.empty())
+		return;
+
+	const t_clock::time_point now = t_clock::now();
+	Charge(now);
+
+	const CallFrame frame = m_frames.back();
+	m_frames.pop_back();
+
+	// only the outermost of recursive calls counts for the total time
+	FuncInfo& func = m_funcs[frame.addr];
+	if(func.active && --func.active == 0)
+		func.total += now - frame.start;
+}
+
+
+/**
+ * the vm has been reset, the running calls are dropped
+ */
+void VMProfiler::ClearCalls()
+{
+	Charge(t_clock::now());
+
+	m_frames.clear();
+	for(auto& [addr, func] : m_funcs)
+		func.active = 0;
+}
+
+
+/**
+ * write the counts and timings as json
+ */
+void VMProfiler::WriteJson(std::ostream& ostr) const
+{
+	ostr << "{\n";
+	ostr << "\t\"instructions\": " << m_num_instrs << ",\n";
+	ostr << "\t\"max_stack_size\": " << m_max_stack << ",\n";
+	ostr << "\t\"global_time\": " << m_nodes[0].self.count() << ",\n";
+
+	ostr << "\t\"opcodes\": {";
+	bool first = true;
+	for(std::size_t op=0; op<m_ops.size(); ++op)
+	{
+		if(!m_ops[op])
+			continue;
+
+		ostr << (first ? "\n" : ",\n") << "\t\t";
+		write_json_str(ostr, get_vm_opcode_name(static_cast<OpCode>(op)));
+		ostr << ": " << m_ops[op];
+		first = false;
+	}
+	ostr << "\n\t},\n";
+
+	ostr << "\t\"addresses\": {";
+	first = true;
+	for(std::size_t ip=0; ip<m_ips.size(); ++ip)
+	{
+		if(!m_ips[ip])
+			continue;
+
+		ostr << (first ? "\n" : ",\n") << "\t\t\"" << ip << "\": " << m_ips[ip];
+		first = false;
+	}
+	ostr << "\n\t},\n";
+
+	// functions sorted by their own time
+	std::vector<std::pair<t_addr, const FuncInfo*>> funcs;
+	funcs.reserve(m_funcs.size());
+	for(const auto& [addr, func] : m_funcs)
+		funcs.emplace_back(addr, &func);
+	std::stable_sort(funcs.begin(), funcs.end(), [](const auto& func1, const auto& func2) -> bool
+	{
+		if(func1.second->self != func2.second->self)
+			return func1.second->self > func2.second->self;
+		return func1.first < func2.first;
+	});
+
+	ostr << "\t\"functions\": [";
+	first = true;
+	for(const auto& [addr, func] : funcs)
+	{
+		ostr << (first ? "\n" : ",\n") << "\t\t{ \"name\": ";
+		write_json_str(ostr, GetFunctionName(addr));
+		ostr << ", \"address\": " << addr
+			<< ", \"calls\": " << func->calls
+			<< ", \"total_time\": " << func->total.count()
+			<< ", \"self_time\": " << func->self.count()
+			<< " }";
+		first = false;
+	}
+	ostr << "\n\t]\n";
+	ostr << "}" << std::endl;
+}
+
+
+/**
+ * write the time spent in the call stacks in nanoseconds,
+ * in the folded format of the flame graph tools
+ */
+void VMProfiler::WriteFolded(std::ostream& ostr) const
+{
+	for(std::size_t idx=0; idx<m_nodes.size(); ++idx)
+	{
+		const CallNode& node = m_nodes[idx];
+		const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(node.self).count();
+		if(ns <= 0)
+			continue;
+
+		// names of the calling functions, starting with the global code
+		std::vector<std::string> names;
+		for(std::size_t cur = idx; cur != 0; cur = m_nodes[cur].parent)
+			names.push_back(GetFunctionName(m_nodes[cur].addr));
+		names.push_back("global");
+
+		for(auto iter = names.rbegin(); iter != names.rend(); ++iter)
+			ostr << (iter == names.rbegin() ? "" : ";") << *iter;
+		ostr << " " << ns << "\n";
+	}
+
+	ostr.flush();
+}
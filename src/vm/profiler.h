@@ -0,0 +1,170 @@
+/**
+ * execution profile of the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://www.brendangregg.com/flamegraphs.html
+ */
+
+#ifndef __LR1_0ACVM_PROFILER_H__
+#define __LR1_0ACVM_PROFILER_H__
+
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <ostream>
+#include <chrono>
+#include <cstdint>
+
+#include "types.h"
+#include "opcodes.h"
+
+
+
+/**
+ * counts the executed instructions per opcode and per address, measures
+ * the time spent in the called functions and the largest stack size
+ */
+class VMProfiler
+{
+public:
+	using t_addr = t_vm_addr;
+	using t_byte = t_vm_byte;
+	using t_clock = std::chrono::steady_clock;
+	using t_duration = std::chrono::duration<double>;
+
+	// deeper calls are merged into the call stacks of this depth
+	static constexpr const std::size_t m_max_depth = 256;
+
+	/**
+	 * accumulated calls of a function
+	 */
+	struct FuncInfo
+	{
+		std::uint64_t calls{0};
+		t_duration total{};          // including the called functions
+		t_duration self{};           // without the called functions
+		std::size_t active{0};       // number of running, e.g. recursive, calls
+	};
+
+
+public:
+	VMProfiler();
+
+	/**
+	 * remove the collected data
+	 */
+	void Clear();
+
+	/**
+	 * names of the functions at the given addresses,
+	 * e.g. from the code generator's symbol table
+	 */
+	void SetFunctionNames(const std::unordered_map<t_addr, std::string>& names) { m_names = names; }
+	std::string GetFunctionName(t_addr addr) const;
+
+	/**
+	 * count an instruction read at the given address, with the stack
+	 * having the given size
+	 */
+	void Instruction(t_addr ip, OpCode op, t_addr stack_size)
+	{
+		++m_num_instrs;
+		++m_ops[static_cast<t_byte>(op)];
+
+		if(ip >= 0)
+		{
+			const std::size_t idx = static_cast<std::size_t>(ip);
+			if(idx >= m_ips.size()) [[unlikely]]
+				m_ips.resize(std::max(idx + 1, 2*m_ips.size()));
+			++m_ips[idx];
+		}
+
+		if(stack_size > m_max_stack)
+			m_max_stack = stack_size;
+	}
+
+	/**
+	 * start and stop the clock while the vm is running
+	 */
+	void Start();
+	void Stop();
+
+	/**
+	 * a function or interrupt service routine is entered or left
+	 */
+	void Call(t_addr addr);
+	void Return();
+
+	/**
+	 * the vm has been reset, the running calls are dropped
+	 */
+	void ClearCalls();
+
+	std::uint64_t GetNumInstructions() const { return m_num_instrs; }
+	std::uint64_t GetNumInstructions(OpCode op) const { return m_ops[static_cast<t_byte>(op)]; }
+	std::uint64_t GetNumInstructions(t_addr ip) const;
+	t_addr GetMaxStackSize() const { return m_max_stack; }
+	const std::unordered_map<t_addr, FuncInfo>& GetFunctions() const { return m_funcs; }
+
+	/**
+	 * write the counts and timings as json
+	 */
+	void WriteJson(std::ostream& ostr) const;
+
+	/**
+	 * write the time spent in the call stacks in nanoseconds,
+	 * in the folded format of the flame graph tools
+	 */
+	void WriteFolded(std::ostream& ostr) const;
+
+
+protected:
+	/**
+	 * node of the call tree, the root is the global code
+	 */
+	struct CallNode
+	{
+		t_addr addr{-1};
+		std::size_t parent{0};
+		t_duration self{};
+		std::unordered_map<t_addr, std::size_t> children{};
+	};
+
+	/**
+	 * running call
+	 */
+	struct CallFrame
+	{
+		t_addr addr{};
+		std::size_t node{0};
+		t_clock::time_point start{};
+	};
+
+	/**
+	 * attribute the time since the last event to the running call
+	 */
+	void Charge(t_clock::time_point now);
+
+
+private:
+	std::uint64_t m_num_instrs{0};
+	std::array<std::uint64_t, 256> m_ops{};
+	std::vector<std::uint64_t> m_ips{};     // counts indexed by address
+	t_addr m_max_stack{0};
+
+	std::unordered_map<t_addr, std::string> m_names{};
+	std::unordered_map<t_addr, FuncInfo> m_funcs{};
+	std::vector<CallNode> m_nodes{};
+	std::vector<CallFrame> m_frames{};
+
+	bool m_running{false};
+	t_clock::time_point m_last{};           // time of the last event
+};
+
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * runtime executing many isolated vm instances on a pool of worker threads
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "runtime.h"
+
+
+VMRuntime::VMRuntime(std::size_t num_threads, t_addr memsize,
+	std::optional<t_addr> framesize)
+	: m_memsize{memsize}, m_framesize{framesize}
+{
+	if(num_threads == 0)
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_threads.reserve(num_threads);
+	for(std::size_t i=0; i<num_threads; ++i)
+		m_threads.emplace_back(&VMRuntime::WorkerFunc, this);
+}
+
+
+VMRuntime::~VMRuntime()
+{
+	{
+		std::lock_guard<std::mutex> lock{m_mtx};
+		m_stop = true;
+	}
+	m_cond_session.notify_all();
+
+	for(std::thread& thread : m_threads)
+		thread.join();
+}
+
+
+std::future<bool> VMRuntime::Submit(std::shared_ptr<const VMCode> code,
+	const t_session_func& setup, const t_session_func& finish)
+{
+	if(!code)
+		throw std::runtime_error("No code given for the session.");
+
+	auto session = std::make_unique<Session>();
+	session->code = code;
+	session->setup = setup;
+	session->finish = finish;
+
+	std::future<bool> future = session->result.get_future();
+	{
+		std::lock_guard<std::mutex> lock{m_mtx};
+		m_sessions.emplace_back(std::move(session));
+	}
+	m_cond_session.notify_one();
+
+	return future;
+}
+
+
+/**
+ * run a time slice of the session, returns true if it has finished
+ */
+bool VMRuntime::RunSession(Session& session)
+{
+	if(!session.vm)
+	{
+		session.vm = std::make_unique<VM>(m_memsize, m_framesize);
+		session.vm->SetCode(session.code);
+		session.vm->SetJit(m_jit);
+
+		if(session.setup)
+			session.setup(*session.vm);
+	}
+
+	VM::RunState state = VM::RunState::HALTED;
+	if(m_timeslice)
+		state = session.vm->RunFor(m_timeslice);
+	else if(!session.vm->Run())
+		state = VM::RunState::FAILED;
+
+	if(state == VM::RunState::SUSPENDED)
+		return false;
+
+	if(session.finish)
+		session.finish(*session.vm);
+	session.result.set_value(state == VM::RunState::HALTED);
+
+	// free the session's memory right away
+	session.vm.reset();
+	return true;
+}
+
+
+void VMRuntime::Wait()
+{
+	std::unique_lock<std::mutex> lock{m_mtx};
+	m_cond_idle.wait(lock, [this]() -> bool
+	{
+		return m_sessions.empty() && m_num_running == 0;
+	});
+}
+
+
+void VMRuntime::WorkerFunc()
+{
+	while(true)
+	{
+		std::unique_ptr<Session> session;
+
+		{
+			std::unique_lock<std::mutex> lock{m_mtx};
+			m_cond_session.wait(lock, [this]() -> bool
+			{
+				return m_stop || !m_sessions.empty();
+			});
+
+			// the remaining sessions are still run before stopping
+			if(m_sessions.empty())
+				break;
+
+			session = std::move(m_sessions.front());
+			m_sessions.pop_front();
+			++m_num_running;
+		}
+
+		bool finished = true;
+		try
+		{
+			finished = RunSession(*session);
+		}
+		catch(...)
+		{
+			// exceptions end up in the session's future
+			session->result.set_exception(std::current_exception());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{m_mtx};
+
+			// suspended sessions are put at the end of the queue
+			if(!finished)
+				m_sessions.emplace_back(std::move(session));
+			--m_num_running;
+		}
+
+		if(finished)
+			m_cond_idle.notify_all();
+		else
+			m_cond_session.notify_one();
+	}
+}
@@ -0,0 +1,120 @@
+/**
+ * runtime executing many isolated vm instances on a pool of worker threads
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_RUNTIME_H__
+#define __LR1_0ACVM_RUNTIME_H__
+
+
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <optional>
+
+#include "vm.h"
+
+
+
+/**
+ * each submitted session gets its own vm with private data and stack
+ * memory, while the code image is shared between all sessions using it;
+ * the sessions are run round-robin in time slices of a given number
+ * of instructions, so a long-running script cannot starve the others
+ */
+class VMRuntime
+{
+public:
+	using t_addr = VM::t_addr;
+
+	// called before (setup) and after (finish) running a session's vm,
+	// e.g. to register external functions or to fetch results
+	using t_session_func = std::function<void(VM& vm)>;
+
+
+public:
+	/**
+	 * create the worker threads, by default one per hardware thread
+	 */
+	VMRuntime(std::size_t num_threads = 0, t_addr memsize = 0x1000,
+		std::optional<t_addr> framesize = std::nullopt);
+
+	/**
+	 * finish all submitted sessions and stop the worker threads
+	 */
+	~VMRuntime();
+
+	VMRuntime(const VMRuntime&) = delete;
+	VMRuntime& operator=(const VMRuntime&) = delete;
+
+	/**
+	 * queue a session running the given code, the future gets the result of VM::Run
+	 * or the exception thrown by the vm or by the setup/finish functions
+	 */
+	std::future<bool> Submit(std::shared_ptr<const VMCode> code,
+		const t_session_func& setup = nullptr,
+		const t_session_func& finish = nullptr);
+
+	/**
+	 * wait until all submitted sessions have finished
+	 */
+	void Wait();
+
+	std::size_t GetNumThreads() const { return m_threads.size(); }
+
+	void SetJit(bool b) { m_jit = b; }
+
+	/**
+	 * set the number of instructions per time slice, 0: run sessions to completion
+	 */
+	void SetTimeSlice(std::uint64_t num_instrs) { m_timeslice = num_instrs; }
+
+
+protected:
+	/**
+	 * a script session with its own vm
+	 */
+	struct Session
+	{
+		std::shared_ptr<const VMCode> code{};
+		t_session_func setup{}, finish{};
+
+		std::unique_ptr<VM> vm{};        // created when the session first runs
+		std::promise<bool> result{};
+	};
+
+	void WorkerFunc();
+
+	/**
+	 * run a time slice of the session, returns true if it has finished
+	 */
+	bool RunSession(Session& session);
+
+
+private:
+	t_addr m_memsize{0x1000};
+	std::optional<t_addr> m_framesize{};
+	bool m_jit{false};
+	std::uint64_t m_timeslice{0x10000};
+
+	std::vector<std::thread> m_threads{};
+
+	// queued and suspended sessions
+	std::deque<std::unique_ptr<Session>> m_sessions{};
+	std::size_t m_num_running{0};
+	bool m_stop{false};
+
+	std::mutex m_mtx{};
+	std::condition_variable m_cond_session{};   // a session was queued
+	std::condition_variable m_cond_idle{};      // a session has finished
+};
+
+
+#endif
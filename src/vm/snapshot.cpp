@@ -0,0 +1,286 @@
+/**
+ * captured state of a vm for restarting from it
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "snapshot.h"
+
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#if LR1_VM_MMAP != 0
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+// identifies snapshot files and their layout
+static constexpr const char g_snapshot_magic[8] = { 'L', 'R', '1', 'S', 'N', 'A', 'P', '2' };
+
+
+template<class t_val>
+static void write_raw(std::ostream& ostr, const t_val& val)
+{
+	ostr.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+
+template<class t_val>
+static void write_vec(std::ostream& ostr, const std::vector<t_val>& vec)
+{
+	write_raw<std::uint64_t>(ostr, vec.size());
+	ostr.write(reinterpret_cast<const char*>(vec.data()), vec.size()*sizeof(t_val));
+}
+
+
+template<class t_val>
+static void read_raw(std::istream& istr, t_val& val)
+{
+	istr.read(reinterpret_cast<char*>(&val), sizeof(val));
+	if(!istr)
+		throw std::runtime_error("Invalid snapshot file.");
+}
+
+
+template<class t_val>
+static void read_vec(std::istream& istr, std::vector<t_val>& vec,
+	std::uint64_t max_size = 0x1000000)
+{
+	std::uint64_t size = 0;
+	read_raw(istr, size);
+	if(size > max_size)
+		throw std::runtime_error("Invalid snapshot file.");
+
+	vec.resize(size);
+	istr.read(reinterpret_cast<char*>(vec.data()), size*sizeof(t_val));
+	if(!istr)
+		throw std::runtime_error("Invalid snapshot file.");
+}
+
+
+
+VMSnapshot::~VMSnapshot()
+{
+#if LR1_VM_MMAP != 0
+	if(m_fd >= 0)
+		::close(m_fd);
+#endif
+}
+
+
+std::size_t VMSnapshot::GetStoredSize() const
+{
+	std::size_t size = 0;
+	for(const Extent& extent : m_extents)
+		size += extent.size;
+	return size;
+}
+
+
+/**
+ * store the non-zero pages of the memory [0, size),
+ * except for the ones lying completely in the free range
+ */
+void VMSnapshot::AddMemory(const t_byte* mem, std::size_t size,
+	std::size_t free_begin, std::size_t free_end)
+{
+	// free pages
+	const std::size_t skip_begin = (free_begin + m_pagesize - 1) / m_pagesize * m_pagesize;
+	const std::size_t skip_end = free_end / m_pagesize * m_pagesize;
+
+	for(std::size_t page=0; page<size; page+=m_pagesize)
+	{
+		if(page >= skip_begin && page < skip_end)
+		{
+			page = skip_end - m_pagesize;
+			continue;
+		}
+
+		const std::size_t page_size = std::min(m_pagesize, size - page);
+		const t_byte* data = mem + page;
+		if(std::all_of(data, data + page_size, [](t_byte b) -> bool { return b == 0; }))
+			continue;
+
+		// continue the last range or start a new one,
+		// whose data begins at a page boundary to be able to map it
+		if(m_extents.empty() || m_extents.back().begin + m_extents.back().size != page)
+		{
+			m_data.resize((m_data.size() + m_pagesize - 1) / m_pagesize * m_pagesize);
+			m_extents.emplace_back(Extent{ .begin = page, .size = 0, .data = m_data.size() });
+		}
+
+		m_extents.back().size += page_size;
+		m_data.insert(m_data.end(), data, data + page_size);
+	}
+}
+
+
+/**
+ * write the stored pages into a memory, the rest is cleared
+ */
+void VMSnapshot::WriteMemory(VMMemory& mem, std::size_t size) const
+{
+	mem.Clear();
+
+	const std::size_t max_size = std::min(size, mem.GetSize());
+	for(const Extent& extent : m_extents)
+	{
+		if(extent.begin > max_size || extent.size > max_size - extent.begin)
+			throw std::runtime_error("Snapshot does not fit into memory.");
+
+		// map the whole pages of a file, their memory is only copied when it is written to
+		std::size_t mapped = 0;
+		if(m_fd >= 0)
+		{
+			const std::size_t page_size = VMMemory::GetPageSize();
+			mapped = extent.size / page_size * page_size;
+			if(!mem.MapFile(extent.begin, m_fd, m_fileoffs + extent.data, mapped))
+				mapped = 0;
+		}
+
+		ReadData(extent, mapped, mem.Get() + extent.begin + mapped);
+	}
+}
+
+
+/**
+ * copy the stored data of a range, starting at the given offset
+ */
+void VMSnapshot::ReadData(const Extent& extent, std::size_t offs, t_byte* dst) const
+{
+	if(m_fd < 0)
+	{
+		std::memcpy(dst, m_data.data() + extent.data + offs, extent.size - offs);
+		return;
+	}
+
+#if LR1_VM_MMAP != 0
+	for(std::size_t pos = offs; pos < extent.size;)
+	{
+		ssize_t len = ::pread(m_fd, dst + (pos - offs), extent.size - pos,
+			static_cast<off_t>(m_fileoffs + extent.data + pos));
+		if(len <= 0)
+			throw std::runtime_error("Cannot read snapshot file.");
+		pos += static_cast<std::size_t>(len);
+	}
+#endif
+}
+
+
+/**
+ * write the snapshot to a file
+ */
+void VMSnapshot::Save(const std::string& filename) const
+{
+	std::ofstream ostr(filename, std::ios_base::binary);
+	if(!ostr)
+		throw std::runtime_error("Cannot open snapshot file \"" + filename + "\".");
+
+	ostr.write(g_snapshot_magic, sizeof(g_snapshot_magic));
+	write_raw<std::uint32_t>(ostr, sizeof(t_addr));
+	write_raw<std::uint32_t>(ostr, sizeof(t_real));
+	write_raw(ostr, m_state);
+
+	write_vec(ostr, m_isrs);
+	write_vec(ostr, m_irq_frames);
+	write_vec(ostr, m_regs);
+	m_strheap.Save(ostr);
+	write_vec(ostr, m_strslots);
+	write_vec(ostr, m_strlits);
+	write_vec(ostr, m_extents);
+
+	// the pages start at an aligned position, so that they can be mapped
+	std::uint64_t pos = static_cast<std::uint64_t>(ostr.tellp());
+	const std::uint64_t fileoffs = (pos + m_filealign - 1) / m_filealign * m_filealign;
+
+	for(const Extent& extent : m_extents)
+	{
+		std::vector<char> padding(fileoffs + extent.data - pos, 0);
+		ostr.write(padding.data(), padding.size());
+
+		if(m_fd < 0)
+		{
+			ostr.write(reinterpret_cast<const char*>(m_data.data() + extent.data), extent.size);
+		}
+		else
+		{
+			// re-save a loaded snapshot
+			std::vector<t_byte> buf(extent.size);
+			ReadData(extent, 0, buf.data());
+			ostr.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+		}
+
+		pos = fileoffs + extent.data + extent.size;
+	}
+
+	if(!ostr)
+		throw std::runtime_error("Cannot write snapshot file \"" + filename + "\".");
+}
+
+
+/**
+ * load a snapshot from a file, its memory pages are mapped on restoring,
+ * so the file must not be changed while the snapshot is in use
+ */
+std::shared_ptr<const VMSnapshot> VMSnapshot::Load(const std::string& filename)
+{
+	std::ifstream istr(filename, std::ios_base::binary);
+	if(!istr)
+		throw std::runtime_error("Cannot open snapshot file \"" + filename + "\".");
+
+	char magic[sizeof(g_snapshot_magic)]{};
+	std::uint32_t addrsize = 0, realsize = 0;
+	istr.read(magic, sizeof(magic));
+	read_raw(istr, addrsize);
+	read_raw(istr, realsize);
+
+	if(std::memcmp(magic, g_snapshot_magic, sizeof(magic)) != 0
+		|| addrsize != sizeof(t_addr) || realsize != sizeof(t_real))
+		throw std::runtime_error("\"" + filename + "\" is not a compatible snapshot file.");
+
+	auto snapshot = std::make_shared<VMSnapshot>();
+	read_raw(istr, snapshot->m_state);
+	if(snapshot->m_state.memsize > snapshot->m_state.maxmemsize)
+		throw std::runtime_error("Invalid snapshot file.");
+	read_vec(istr, snapshot->m_isrs);
+	read_vec(istr, snapshot->m_irq_frames);
+	read_vec(istr, snapshot->m_regs);
+	snapshot->m_strheap.Load(istr);
+	read_vec(istr, snapshot->m_strslots);
+	read_vec(istr, snapshot->m_strlits);
+	read_vec(istr, snapshot->m_extents);
+
+	std::uint64_t pos = static_cast<std::uint64_t>(istr.tellg());
+	std::uint64_t fileoffs = (pos + m_filealign - 1) / m_filealign * m_filealign;
+
+	std::uint64_t data_size = 0;
+	for(const Extent& extent : snapshot->m_extents)
+	{
+		if(extent.data < data_size || extent.data % m_pagesize || extent.begin % m_pagesize)
+			throw std::runtime_error("Invalid snapshot file.");
+		data_size = extent.data + extent.size;
+	}
+
+#if LR1_VM_MMAP != 0
+	// keep the file open for mapping its pages
+	snapshot->m_fd = ::open(filename.c_str(), O_RDONLY);
+	if(snapshot->m_fd < 0)
+		throw std::runtime_error("Cannot open snapshot file \"" + filename + "\".");
+	snapshot->m_fileoffs = fileoffs;
+
+	if(static_cast<std::uint64_t>(::lseek(snapshot->m_fd, 0, SEEK_END)) < fileoffs + data_size)
+		throw std::runtime_error("Invalid snapshot file.");
+#else
+	snapshot->m_data.resize(data_size);
+	istr.seekg(static_cast<std::streamoff>(fileoffs));
+	istr.read(reinterpret_cast<char*>(snapshot->m_data.data()), data_size);
+	if(!istr)
+		throw std::runtime_error("Invalid snapshot file.");
+#endif
+
+	return snapshot;
+}
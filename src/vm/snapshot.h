@@ -0,0 +1,127 @@
+/**
+ * captured state of a vm for restarting from it
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_SNAPSHOT_H__
+#define __LR1_0ACVM_SNAPSHOT_H__
+
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "types.h"
+#include "strheap.h"
+#include "memory.h"
+
+
+
+/**
+ * immutable image of the registers, the interrupt state, the strings and
+ * the vm's own memory, of which only the non-zero pages are stored;
+ * a snapshot loaded from a file maps these pages copy-on-write
+ * into the memory of the vms restoring it
+ */
+class VMSnapshot
+{
+public:
+	using t_byte = t_vm_byte;
+	using t_addr = t_vm_addr;
+	using t_real = t_vm_real;
+
+	// granularity of the stored memory
+	static constexpr const std::size_t m_pagesize = 0x1000;
+
+	// alignment of the memory pages in a file, a multiple of the system's page size
+	static constexpr const std::size_t m_filealign = 0x10000;
+
+	friend class VM;
+
+
+public:
+	VMSnapshot() = default;
+	~VMSnapshot();
+
+	VMSnapshot(const VMSnapshot&) = delete;
+	VMSnapshot& operator=(const VMSnapshot&) = delete;
+
+	/**
+	 * write the snapshot to a file
+	 */
+	void Save(const std::string& filename) const;
+
+	/**
+	 * load a snapshot from a file, its memory pages are mapped on restoring,
+	 * so the file must not be changed while the snapshot is in use
+	 */
+	static std::shared_ptr<const VMSnapshot> Load(const std::string& filename);
+
+	/**
+	 * get the number of bytes of stored memory
+	 */
+	std::size_t GetStoredSize() const;
+
+
+protected:
+	// registers and memory layout
+	struct State
+	{
+		t_addr ip{}, sp{}, bp{}, gbp{};
+		t_addr memsize{}, maxmemsize{}, framesize{}, stacklimit{};
+		t_addr data_begin{};
+		t_addr code_range[2]{-1, -1};
+		t_addr irq_level{};
+		t_real eps{};
+	};
+
+	// range of non-zero memory pages
+	struct Extent
+	{
+		std::uint64_t begin{};   // offset in the vm's own memory
+		std::uint64_t size{};
+		std::uint64_t data{};    // offset in the stored data
+	};
+
+	/**
+	 * store the non-zero pages of the memory [0, size),
+	 * except for the ones lying completely in the free range
+	 */
+	void AddMemory(const t_byte* mem, std::size_t size,
+		std::size_t free_begin, std::size_t free_end);
+
+	/**
+	 * write the stored pages into a memory, the rest is cleared
+	 */
+	void WriteMemory(VMMemory& mem, std::size_t size) const;
+
+	/**
+	 * copy the stored data of a range, starting at the given offset
+	 */
+	void ReadData(const Extent& extent, std::size_t offs, t_byte* dst) const;
+
+
+private:
+	State m_state{};
+
+	std::vector<t_addr> m_isrs{};    // -1 for unused interrupts
+	std::vector<std::array<t_addr, 2>> m_irq_frames{};   // base pointer and level
+	std::vector<t_byte> m_regs{};    // register file, then the ones of the interrupt frames
+
+	VMStrHeap m_strheap{};
+	std::vector<std::array<t_addr, 2>> m_strslots{};     // address and handle
+	std::vector<std::array<t_addr, 2>> m_strlits{};      // address and handle
+
+	std::vector<Extent> m_extents{};
+	std::vector<t_byte> m_data{};    // stored pages, if not loaded from a file
+
+	int m_fd{-1};                    // file holding the stored pages
+	std::uint64_t m_fileoffs{0};     // offset of the stored pages in the file
+};
+
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * string heap for the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "strheap.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+
+
+VMStrHeap::VMStrHeap(const VMStrHeap& heap)
+	: m_entries{heap.m_entries}, m_free{heap.m_free}
+{
+	RebuildIndex();
+}
+
+
+VMStrHeap& VMStrHeap::operator=(const VMStrHeap& heap)
+{
+	if(this != &heap)
+	{
+		m_entries = heap.m_entries;
+		m_free = heap.m_free;
+		RebuildIndex();
+	}
+
+	return *this;
+}
+
+
+/**
+ * re-create the string index after the entries have been copied
+ */
+void VMStrHeap::RebuildIndex()
+{
+	m_index.clear();
+
+	for(std::size_t idx=0; idx<m_entries.size(); ++idx)
+	{
+		const Entry& entry = m_entries[idx];
+		if(entry.refs > 0)
+			m_index.emplace(entry.str, static_cast<t_handle>(idx));
+	}
+}
+
+
+void VMStrHeap::CheckHandle(t_handle handle) const
+{
+	if(handle < 0 || static_cast<std::size_t>(handle) >= m_entries.size()
+		|| m_entries[handle].refs <= 0)
+	{
+		std::ostringstream msg;
+		msg << "Invalid string handle " << handle << ".";
+		throw std::runtime_error(msg.str());
+	}
+}
+
+
+/**
+ * get the handle of a string, the caller owns one reference to it
+ */
+VMStrHeap::t_handle VMStrHeap::Intern(std::string_view str)
+{
+	// string already known?
+	if(auto iter = m_index.find(str); iter != m_index.end())
+	{
+		++m_entries[iter->second].refs;
+		return iter->second;
+	}
+
+	t_handle handle = 0;
+	if(m_free.size())
+	{
+		// recycle an unused entry, this re-uses its allocated buffer
+		handle = m_free.back();
+		m_free.pop_back();
+	}
+	else
+	{
+		handle = static_cast<t_handle>(m_entries.size());
+		m_entries.emplace_back();
+	}
+
+	Entry& entry = m_entries[handle];
+	entry.str.assign(str.data(), str.size());
+	entry.refs = 1;
+
+	m_index.emplace(entry.str, handle);
+	return handle;
+}
+
+
+/**
+ * concatenate two strings, the caller owns one reference to the result
+ */
+VMStrHeap::t_handle VMStrHeap::Concat(t_handle handle1, t_handle handle2)
+{
+	const t_str& str1 = Get(handle1);
+	const t_str& str2 = Get(handle2);
+
+	// concatenating an empty string gives the other one
+	if(str2.empty())
+	{
+		AddRef(handle1);
+		return handle1;
+	}
+	if(str1.empty())
+	{
+		AddRef(handle2);
+		return handle2;
+	}
+
+	// the buffer keeps its capacity between concatenations
+	m_buf.clear();
+	m_buf.reserve(str1.size() + str2.size());
+	m_buf += str1;
+	m_buf += str2;
+
+	return Intern(m_buf);
+}
+
+
+/**
+ * get the string belonging to a handle
+ */
+const VMStrHeap::t_str& VMStrHeap::Get(t_handle handle) const
+{
+	CheckHandle(handle);
+	return m_entries[handle].str;
+}
+
+
+void VMStrHeap::AddRef(t_handle handle)
+{
+	CheckHandle(handle);
+	++m_entries[handle].refs;
+}
+
+
+void VMStrHeap::Release(t_handle handle)
+{
+	CheckHandle(handle);
+
+	Entry& entry = m_entries[handle];
+	if(--entry.refs > 0)
+		return;
+
+	// string not referenced anymore, put the entry on the free list
+	m_index.erase(entry.str);
+	entry.str.clear();
+	m_free.push_back(handle);
+}
+
+
+void VMStrHeap::Clear()
+{
+	m_index.clear();
+	m_entries.clear();
+	m_free.clear();
+}
+
+
+/**
+ * write the strings with their handles and reference counts
+ */
+void VMStrHeap::Save(std::ostream& ostr) const
+{
+	std::uint64_t num_entries = m_entries.size();
+	ostr.write(reinterpret_cast<const char*>(&num_entries), sizeof(num_entries));
+
+	for(const Entry& entry : m_entries)
+	{
+		std::uint64_t len = entry.str.size();
+		ostr.write(reinterpret_cast<const char*>(&entry.refs), sizeof(entry.refs));
+		ostr.write(reinterpret_cast<const char*>(&len), sizeof(len));
+		ostr.write(entry.str.data(), entry.str.size());
+	}
+
+	std::uint64_t num_free = m_free.size();
+	ostr.write(reinterpret_cast<const char*>(&num_free), sizeof(num_free));
+	ostr.write(reinterpret_cast<const char*>(m_free.data()), num_free*sizeof(t_handle));
+}
+
+
+/**
+ * get the number of bytes left in a stream, the maximum if it is unknown
+ */
+static std::uint64_t get_remaining_size(std::istream& istr)
+{
+	const std::istream::pos_type pos = istr.tellg();
+	if(pos == std::istream::pos_type(-1))
+		return std::numeric_limits<std::uint64_t>::max();
+
+	istr.seekg(0, std::ios_base::end);
+	const std::istream::pos_type end = istr.tellg();
+	istr.seekg(pos);
+
+	if(end == std::istream::pos_type(-1) || end < pos)
+		return std::numeric_limits<std::uint64_t>::max();
+	return static_cast<std::uint64_t>(end - pos);
+}
+
+
+/**
+ * read the strings written by Save, the lengths and handles are
+ * checked before they are used, so invalid data can't allocate
+ * more than the stream holds or corrupt the free list
+ */
+void VMStrHeap::Load(std::istream& istr)
+{
+	Clear();
+
+	// the lengths have to fit into the rest of the stream
+	std::uint64_t remaining = get_remaining_size(istr);
+	bool valid = true;
+
+	std::uint64_t num_entries = 0;
+	istr.read(reinterpret_cast<char*>(&num_entries), sizeof(num_entries));
+
+	for(std::uint64_t idx=0; idx<num_entries && istr; ++idx)
+	{
+		Entry& entry = m_entries.emplace_back();
+		std::uint64_t len = 0;
+		istr.read(reinterpret_cast<char*>(&entry.refs), sizeof(entry.refs));
+		istr.read(reinterpret_cast<char*>(&len), sizeof(len));
+		if(!istr)
+			break;
+
+		// bytes read so far, i.e. the counts and this entry's header
+		const std::uint64_t read_size = sizeof(num_entries)
+			+ (idx + 1)*(sizeof(entry.refs) + sizeof(len));
+		if(entry.refs < 0 || read_size > remaining || len > remaining - read_size)
+		{
+			valid = false;
+			break;
+		}
+		remaining -= len;
+
+		entry.str.resize(len);
+		istr.read(entry.str.data(), len);
+	}
+
+	std::uint64_t num_free = 0;
+	istr.read(reinterpret_cast<char*>(&num_free), sizeof(num_free));
+	if(valid && istr && num_free <= m_entries.size())
+	{
+		m_free.resize(num_free);
+		istr.read(reinterpret_cast<char*>(m_free.data()), num_free*sizeof(t_handle));
+	}
+
+	// the free entries have to exist, be unreferenced and be listed only once
+	std::vector<bool> is_free(m_entries.size(), false);
+	for(t_handle handle : m_free)
+	{
+		if(handle < 0 || static_cast<std::uint64_t>(handle) >= m_entries.size()
+			|| m_entries[handle].refs != 0 || is_free[handle])
+		{
+			valid = false;
+			break;
+		}
+		is_free[handle] = true;
+	}
+
+	if(!valid || !istr || m_entries.size() != num_entries || m_free.size() != num_free)
+	{
+		Clear();
+		throw std::runtime_error("Invalid string heap data.");
+	}
+
+	RebuildIndex();
+}
@@ -0,0 +1,97 @@
+/**
+ * string heap for the vm
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_0ACVM_STRHEAP_H__
+#define __LR1_0ACVM_STRHEAP_H__
+
+
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <iostream>
+
+#include "types.h"
+
+
+/**
+ * immutable, interned and reference-counted strings,
+ * only their handles are stored in the vm memory
+ */
+class VMStrHeap
+{
+public:
+	using t_addr = ::t_vm_addr;
+	using t_str = ::t_vm_str;
+	using t_handle = ::t_vm_addr;
+
+
+public:
+	VMStrHeap() = default;
+	~VMStrHeap() = default;
+
+	// the index refers to the entries, so it has to be rebuilt on copying
+	VMStrHeap(const VMStrHeap& heap);
+	VMStrHeap& operator=(const VMStrHeap& heap);
+
+	/**
+	 * get the handle of a string, the caller owns one reference to it
+	 */
+	t_handle Intern(std::string_view str);
+
+	/**
+	 * concatenate two strings, the caller owns one reference to the result
+	 */
+	t_handle Concat(t_handle handle1, t_handle handle2);
+
+	/**
+	 * get the string belonging to a handle
+	 */
+	const t_str& Get(t_handle handle) const;
+
+	void AddRef(t_handle handle);
+	void Release(t_handle handle);
+
+	void Clear();
+
+	/**
+	 * write or read the strings with their handles and reference counts
+	 */
+	void Save(std::ostream& ostr) const;
+	void Load(std::istream& istr);
+
+	std::size_t GetNumStrings() const { return m_index.size(); }
+
+
+private:
+	struct Entry
+	{
+		t_str str{};
+		t_addr refs{0};
+	};
+
+	void CheckHandle(t_handle handle) const;
+	void RebuildIndex();
+
+
+private:
+	// the deque keeps the string objects in place when growing
+	std::deque<Entry> m_entries{};
+
+	// unused entries that can be recycled
+	std::vector<t_handle> m_free{};
+
+	// maps string contents to their handles
+	std::unordered_map<std::string_view, t_handle> m_index{};
+
+	// buffer for building concatenated strings
+	t_str m_buf{};
+};
+
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * hierarchical timer wheel delivering periodic timer events from a single thread
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "timerwheel.h"
+
+#include <algorithm>
+
+
+VMTimerWheel::VMTimerWheel(t_duration resolution)
+	: m_resolution{std::max(resolution, t_duration{1})}, m_start{t_clock::now()}
+{
+}
+
+
+VMTimerWheel::~VMTimerWheel()
+{
+	{
+		std::lock_guard<std::mutex> lock{m_mtx};
+		m_stop = true;
+	}
+	m_cond.notify_all();
+
+	if(m_thread.joinable())
+		m_thread.join();
+}
+
+
+/**
+ * get the process-wide timer wheel
+ */
+VMTimerWheel& VMTimerWheel::GetInstance()
+{
+	static VMTimerWheel wheel{};
+	return wheel;
+}
+
+
+/**
+ * add a periodic timer and get its id
+ */
+VMTimerWheel::t_id VMTimerWheel::Add(t_duration period, const t_callback& callback)
+{
+	std::lock_guard<std::mutex> lock{m_mtx};
+
+	// the wheel is not advanced while it is empty, so catch up
+	if(m_timers.empty())
+	{
+		for(auto& wheel : m_wheels)
+			for(t_slot& slot : wheel)
+				slot.clear();
+		m_now = GetClockTick();
+	}
+
+	// period in ticks, rounded up
+	t_tick ticks = static_cast<t_tick>(
+		(period.count() + m_resolution.count() - 1) / m_resolution.count());
+	ticks = std::max<t_tick>(ticks, 1);
+
+	t_id id = m_next_id++;
+	Timer& timer = m_timers[id];
+	timer.period = ticks;
+	timer.expiry = m_now + ticks;
+	timer.callback = callback;
+	Insert(id, timer.expiry);
+
+	// the timer thread is only started when it is needed
+	if(!m_thread.joinable())
+		m_thread = std::thread(&VMTimerWheel::ThreadFunc, this);
+
+	m_cond.notify_all();
+	return id;
+}
+
+
+/**
+ * remove a timer, its entries in the slots are skipped when they are reached
+ */
+bool VMTimerWheel::Remove(t_id id)
+{
+	std::lock_guard<std::mutex> lock{m_mtx};
+	return m_timers.erase(id) != 0;
+}
+
+
+std::size_t VMTimerWheel::GetNumTimers() const
+{
+	std::lock_guard<std::mutex> lock{m_mtx};
+	return m_timers.size();
+}
+
+
+/**
+ * get the current tick according to the clock
+ */
+VMTimerWheel::t_tick VMTimerWheel::GetClockTick() const
+{
+	return static_cast<t_tick>((t_clock::now() - m_start) / m_resolution);
+}
+
+
+/**
+ * sort a timer into the slot corresponding to its expiry:
+ * wheel n holds the timers expiring within 2^(bits*(n+1)) ticks,
+ * the slot index is given by the expiry's bits of this wheel
+ */
+void VMTimerWheel::Insert(t_id id, t_tick expiry)
+{
+	t_tick delta = expiry > m_now ? expiry - m_now : 0;
+
+	for(std::size_t level=0; level<m_num_wheels; ++level)
+	{
+		const unsigned shift = level * m_slot_bits;
+		const t_tick range = t_tick(1) << (shift + m_slot_bits);
+		const bool last_level = (level == m_num_wheels - 1);
+
+		if(delta >= range && !last_level)
+			continue;
+
+		// timers beyond the last wheel are re-sorted when their slot is reached
+		t_tick slot_expiry = std::max(expiry, m_now);
+		if(delta >= range)
+			slot_expiry = m_now + range - 1;
+
+		std::size_t slot = (slot_expiry >> shift) & (m_num_slots - 1);
+		m_wheels[level][slot].emplace_back(SlotEntry{ .id = id, .expiry = expiry });
+		break;
+	}
+}
+
+
+/**
+ * advance by one tick and run the expired timers
+ */
+void VMTimerWheel::Tick()
+{
+	++m_now;
+
+	// move the timers of the coarser wheels to the finer ones,
+	// beginning with the coarsest to not miss any cascading timers
+	for(std::size_t level=m_num_wheels-1; level>0; --level)
+	{
+		const unsigned shift = level * m_slot_bits;
+		if((m_now & ((t_tick(1) << shift) - 1)) != 0)
+			continue;
+
+		std::size_t slot_idx = (m_now >> shift) & (m_num_slots - 1);
+		t_slot slot = std::move(m_wheels[level][slot_idx]);
+		m_wheels[level][slot_idx].clear();
+
+		for(const SlotEntry& entry : slot)
+		{
+			auto iter = m_timers.find(entry.id);
+			if(iter != m_timers.end() && iter->second.expiry == entry.expiry)
+				Insert(entry.id, entry.expiry);
+		}
+	}
+
+	// run the expired timers and re-insert them
+	std::size_t slot_idx = m_now & (m_num_slots - 1);
+	t_slot slot = std::move(m_wheels[0][slot_idx]);
+	m_wheels[0][slot_idx].clear();
+
+	for(const SlotEntry& entry : slot)
+	{
+		auto iter = m_timers.find(entry.id);
+		if(iter == m_timers.end() || iter->second.expiry != entry.expiry)
+			continue;
+
+		Timer& timer = iter->second;
+		if(timer.callback)
+			timer.callback();
+
+		timer.expiry = m_now + timer.period;
+		Insert(entry.id, timer.expiry);
+	}
+}
+
+
+/**
+ * get the next tick at which timers expire or are moved to the finer wheels,
+ * i.e. the next non-empty slot of the finest wheel or the end of this wheel's turn
+ */
+VMTimerWheel::t_tick VMTimerWheel::GetNextEventTick() const
+{
+	const t_tick cascade = (m_now / m_num_slots + 1) * m_num_slots;
+
+	for(t_tick tick = m_now + 1; tick < cascade; ++tick)
+	{
+		if(!m_wheels[0][tick & (m_num_slots - 1)].empty())
+			return tick;
+	}
+
+	return cascade;
+}
+
+
+/**
+ * function for the timer thread
+ */
+void VMTimerWheel::ThreadFunc()
+{
+	std::unique_lock<std::mutex> lock{m_mtx};
+
+	while(!m_stop)
+	{
+		if(m_timers.empty())
+		{
+			m_cond.wait(lock, [this]() -> bool
+			{
+				return m_stop || !m_timers.empty();
+			});
+			continue;
+		}
+
+		// process all ticks up to now, also catching up in case the thread
+		// was not scheduled in time, ticks without any events are skipped
+		for(t_tick now = GetClockTick(); m_now < now;)
+		{
+			m_now = std::min(now, GetNextEventTick()) - 1;
+			Tick();
+		}
+
+		m_cond.wait_until(lock, m_start + GetNextEventTick() * m_resolution);
+	}
+}
@@ -0,0 +1,139 @@
+/**
+ * hierarchical timer wheel delivering periodic timer events from a single thread
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * References:
+ * 	- https://doi.org/10.1145/41457.37504
+ */
+
+#ifndef __LR1_0ACVM_TIMERWHEEL_H__
+#define __LR1_0ACVM_TIMERWHEEL_H__
+
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+
+
+/**
+ * timers are sorted into slots of several wheels with increasing
+ * granularity and are moved to the finer wheels while their expiry
+ * approaches, so adding, removing and expiring timers needs constant time
+ */
+class VMTimerWheel
+{
+public:
+	using t_id = std::uint64_t;
+	using t_tick = std::uint64_t;
+	using t_clock = std::chrono::steady_clock;
+	using t_duration = std::chrono::nanoseconds;
+
+	// called from the timer thread while the wheel is locked,
+	// so it must not call back into the timer wheel
+	using t_callback = std::function<void()>;
+
+
+public:
+	/**
+	 * create a timer wheel with the given resolution
+	 */
+	explicit VMTimerWheel(t_duration resolution = std::chrono::milliseconds{1});
+
+	/**
+	 * stop the timer thread
+	 */
+	~VMTimerWheel();
+
+	VMTimerWheel(const VMTimerWheel&) = delete;
+	VMTimerWheel& operator=(const VMTimerWheel&) = delete;
+
+	/**
+	 * get the process-wide timer wheel
+	 */
+	static VMTimerWheel& GetInstance();
+
+	/**
+	 * add a periodic timer and get its id
+	 */
+	t_id Add(t_duration period, const t_callback& callback);
+
+	/**
+	 * remove a timer, its callback is not called anymore after this returns
+	 */
+	bool Remove(t_id id);
+
+	std::size_t GetNumTimers() const;
+	t_duration GetResolution() const { return m_resolution; }
+
+
+protected:
+	// slots per wheel and number of wheels
+	static constexpr const unsigned m_slot_bits = 6;
+	static constexpr const t_tick m_num_slots = t_tick(1) << m_slot_bits;
+	static constexpr const std::size_t m_num_wheels = 4;
+
+	struct Timer
+	{
+		t_tick expiry{};            // absolute tick of the next expiry
+		t_tick period{};            // in ticks
+		t_callback callback{};
+	};
+
+	// slot entry, stale if the timer was removed or has another expiry
+	struct SlotEntry
+	{
+		t_id id{};
+		t_tick expiry{};
+	};
+
+	using t_slot = std::vector<SlotEntry>;
+
+	void ThreadFunc();
+
+	/**
+	 * sort a timer into the slot corresponding to its expiry
+	 */
+	void Insert(t_id id, t_tick expiry);
+
+	/**
+	 * advance by one tick and run the expired timers
+	 */
+	void Tick();
+
+	/**
+	 * get the next tick at which timers expire or cascade
+	 */
+	t_tick GetNextEventTick() const;
+
+	/**
+	 * get the current tick according to the clock
+	 */
+	t_tick GetClockTick() const;
+
+
+private:
+	t_duration m_resolution{};
+	t_clock::time_point m_start{};
+	t_tick m_now{0};                   // last processed tick
+
+	std::array<std::array<t_slot, m_num_slots>, m_num_wheels> m_wheels{};
+	std::unordered_map<t_id, Timer> m_timers{};
+	t_id m_next_id{1};
+
+	bool m_stop{false};
+	mutable std::mutex m_mtx{};
+	std::condition_variable m_cond{};  // timers were added or the wheel is stopped
+	std::thread m_thread{};
+};
+
+
+#endif
@@ -15,8 +15,18 @@
 
 using t_vm_int = ::t_int;
 using t_vm_real = ::t_real;
-//using t_vm_addr = std::int16_t;
-using t_vm_addr = std::int32_t;
+// address width, can be set to 64 bits for memories beyond 2 GB
+#ifndef LR1_VM_ADDR_BITS
+	#define LR1_VM_ADDR_BITS 32
+#endif
+
+#if LR1_VM_ADDR_BITS == 64
+	using t_vm_addr = std::int64_t;
+#elif LR1_VM_ADDR_BITS == 32
+	using t_vm_addr = std::int32_t;
+#else
+	#error "Unsupported vm address width."
+#endif
 using t_vm_byte = std::uint8_t;
 using t_vm_bool = t_vm_byte;
 using t_vm_str = std::string;
@@ -24,6 +34,9 @@ using t_vm_str = std::string;
 // maximum size to reserve for static variables
 constexpr const t_vm_addr g_vm_longest_size = 64;
 
+// number of registers which can hold ints or reals
+constexpr const t_vm_addr g_vm_num_regs = 16;
+
 
 
 /**
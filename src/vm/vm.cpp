@@ -15,7 +15,14 @@
 VM::VM(t_addr memsize, std::optional<t_addr> framesize)
 	: m_memsize{memsize}, m_framesize{framesize ? *framesize : memsize/16}
 {
-	m_mem.reset(new t_byte[m_memsize]);
+	// the frame has to hold at least its own size
+	m_framesize = std::max(m_framesize, m_addrsize);
+	m_maxmemsize = std::max(m_maxmemsize, m_memsize);
+
+	// the address space up to the maximum size is reserved at once,
+	// memory is only committed when the stack or the program touches it
+	m_mem = VMMemory(static_cast<std::size_t>(m_maxmemsize)*m_bytesize);
+	RegisterBuiltins();
 	Reset();
 }
 
@@ -26,34 +33,57 @@ VM::~VM()
 }
 
 
+/**
+ * start or restart the timer interrupt with the current period
+ */
 void VM::StartTimer()
 {
-	if(!m_timer_running)
+	StopTimer();
+
+	m_timer = GetTimerWheel().Add(m_timer_period, [this]()
 	{
-		m_timer_running = true;
-		m_timer_thread = std::thread(&VM::TimerFunc, this);
-	}
+		RequestInterrupt(m_timer_interrupt);
+	});
 }
 
 
 void VM::StopTimer()
 {
-	m_timer_running = false;
-	if(m_timer_thread.joinable())
-		m_timer_thread.join();
+	if(m_timer)
+	{
+		GetTimerWheel().Remove(*m_timer);
+		m_timer.reset();
+	}
 }
 
 
 /**
- * function for timer thread
+ * start the timer interrupt with the given period, or stop it
  */
-void VM::TimerFunc()
+void VM::SetTimer(std::optional<VMTimerWheel::t_duration> period)
 {
-	while(m_timer_running)
+	if(!period)
 	{
-		std::this_thread::sleep_for(m_timer_ticks);
-		RequestInterrupt(m_timer_interrupt);
+		StopTimer();
+		return;
 	}
+
+	m_timer_period = *period;
+	StartTimer();
+}
+
+
+/**
+ * use another timer wheel, a running timer is moved to it
+ */
+void VM::SetTimerWheel(std::shared_ptr<VMTimerWheel> wheel)
+{
+	const bool running = m_timer.has_value();
+	StopTimer();
+
+	m_timerwheel = wheel;
+	if(running)
+		StartTimer();
 }
 
 
@@ -62,7 +92,275 @@ void VM::TimerFunc()
  */
 void VM::RequestInterrupt(t_addr num)
 {
-	m_irqs[num] = true;
+	if(num < 0 || num >= m_num_interrupts)
+		throw std::runtime_error("Invalid interrupt number.");
+
+	m_irqs_pending.fetch_or(std::uint32_t(1) << num, std::memory_order_release);
+}
+
+
+/**
+ * get the highest-priority pending interrupt which may interrupt the running code
+ */
+std::optional<VM::t_addr> VM::NextInterrupt()
+{
+	// only interrupts with a higher priority than the running one
+	const std::uint32_t allowed = (std::uint32_t(1) << m_irq_level) - 1;
+
+	std::uint32_t pending = m_irqs_pending.load(std::memory_order_acquire) & allowed;
+	while(pending)
+	{
+		t_addr irq = static_cast<t_addr>(std::countr_zero(pending));
+		std::uint32_t bit = std::uint32_t(1) << irq;
+
+		m_irqs_pending.fetch_and(~bit, std::memory_order_acq_rel);
+		if(m_isrs[irq])
+			return irq;
+
+		pending &= ~bit;
+	}
+
+	return std::nullopt;
+}
+
+
+/**
+ * call an interrupt service routine, its stack frame is the same as for
+ * functions, the priority of the interrupted code is kept separately
+ */
+void VM::CallInterrupt(t_addr irq, t_addr addr)
+{
+	if(irq < 0 || irq >= m_num_interrupts)
+		throw std::runtime_error("Invalid interrupt number.");
+
+	EnterFrame();
+	m_ip = addr;
+
+	m_irq_frames.emplace_back(IrqFrame{ .bp = m_bp, .level = m_irq_level, .regs = m_regfile });
+	m_irq_level = irq;
+	if(m_profiler)
+		m_profiler->Call(addr);
+
+	if(m_debug)
+	{
+		std::cout << "calling service routine " << addr
+			<< " for interrupt " << irq << "."
+			<< std::endl;
+	}
+}
+
+
+/**
+ * return from an interrupt service routine to the interrupted code,
+ * discarding any return value
+ */
+void VM::ReturnFromInterrupt()
+{
+	if(m_irq_frames.empty() || m_irq_frames.back().bp != m_bp)
+		throw std::runtime_error("Not in an interrupt service routine.");
+
+	// release the strings held by the stack frame
+	ReleaseStrSlots(m_sp, m_bp);
+	if(m_zeropoppedvals)
+		std::memset(DataPtr(m_sp, (m_bp-m_sp)*m_bytesize), 0, (m_bp-m_sp)*m_bytesize);
+
+	m_sp = m_bp;
+	m_bp = PopAddress();
+	m_ip = PopAddress();
+
+	m_irq_level = m_irq_frames.back().level;
+	m_regfile = m_irq_frames.back().regs;
+	m_irq_frames.pop_back();
+	if(m_profiler)
+		m_profiler->Return();
+}
+
+
+/**
+ * save the instruction and base pointers and set up a stack frame
+ */
+void VM::EnterFrame()
+{
+	// make room beforehand, the stack would otherwise
+	// move while the base pointer is being saved
+	EnsureStack(2*(m_bytesize + m_addrsize) + m_framesize);
+
+	PushAddress(m_ip, VMType::ADDR_MEM);
+	PushAddress(m_bp, VMType::ADDR_MEM);
+	m_bp = m_sp;
+
+	SetFrameSize(m_framesize);
+}
+
+
+/**
+ * replace the current stack frame and the function's arguments by a new
+ * frame for a tail call, the arguments of the called function are kept
+ */
+void VM::ReplaceFrame(t_addr num_args, t_addr num_callee_args)
+{
+	// take the called function's arguments from the stack,
+	// string arguments keep their references
+	struct Arg
+	{
+		VMType ty{VMType::UNKNOWN};
+		t_data val{};
+		t_addr handle{0};
+	};
+
+	std::vector<Arg> args;
+	args.reserve(num_callee_args);
+	for(t_addr arg=0; arg<num_callee_args; ++arg)
+	{
+		VMType ty = static_cast<VMType>(TopRaw<t_byte, m_bytesize>());
+		if(ty == VMType::STR)
+		{
+			PopRaw<t_byte, m_bytesize>();
+			args.emplace_back(Arg{ .ty = ty, .handle = PopStrHandle() });
+		}
+		else
+		{
+			args.emplace_back(Arg{ .ty = ty, .val = PopData() });
+		}
+	}
+
+	// remove the current function's stack frame and arguments, see RET
+	ReleaseStrSlots(m_sp, m_bp);
+	if(m_zeropoppedvals)
+		std::memset(DataPtr(m_sp, (m_bp-m_sp)*m_bytesize), 0, (m_bp-m_sp)*m_bytesize);
+
+	m_sp = m_bp;
+	m_bp = PopAddress();
+	m_ip = PopAddress();
+	if(m_profiler)
+		m_profiler->Return();
+
+	for(t_addr arg=0; arg<num_args; ++arg)
+		PopData();
+
+	// push the called function's arguments in their original order
+	for(auto iter = args.rbegin(); iter != args.rend(); ++iter)
+	{
+		if(iter->ty == VMType::STR)
+		{
+			PushStrHandle(iter->handle);
+			PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+		}
+		else
+		{
+			PushData(iter->val, iter->ty);
+		}
+	}
+
+	// the called function returns to the current function's caller
+	EnterFrame();
+}
+
+
+/**
+ * resize the current stack frame, the local variables start below its size
+ */
+void VM::SetFrameSize(t_addr size)
+{
+	if(size < m_addrsize)
+		throw std::runtime_error("Invalid stack frame size.");
+
+	if(m_bp - size < m_stacklimit)
+		GrowStack(m_stacklimit - (m_bp - size));
+
+	m_sp = m_bp - size;
+	*reinterpret_cast<t_addr*>(DataPtr(m_bp - m_addrsize)) = size;
+}
+
+
+/**
+ * enlarge the memory and move the stack to its new top
+ */
+void VM::GrowStack(t_addr missing)
+{
+	// at least double the memory size
+	std::int64_t memsize = std::max<std::int64_t>(
+		std::int64_t(m_memsize) * 2, std::int64_t(m_memsize) + missing + m_framesize);
+	memsize = std::min<std::int64_t>(memsize, m_maxmemsize);
+
+	const t_addr delta = static_cast<t_addr>(memsize - m_memsize);
+	if(delta < missing)
+		throw std::runtime_error("Stack overflow.");
+
+	// everything from the stack limit to the end of the memory is moved up
+	const t_addr stack_begin = m_stacklimit;
+	auto move = [stack_begin, delta](t_addr addr) -> t_addr
+	{
+		return addr >= stack_begin ? addr + delta : addr;
+	};
+
+	const std::size_t stack_offs = static_cast<std::size_t>(stack_begin - m_data_begin)*m_bytesize;
+	const std::size_t stack_size = static_cast<std::size_t>(m_memsize - stack_begin)*m_bytesize;
+	const std::size_t gap_size = static_cast<std::size_t>(delta)*m_bytesize;
+
+	// copy the shared pages of the moved range
+	m_mem.Touch(stack_offs, stack_size + gap_size);
+
+	if(static_cast<std::size_t>(memsize - m_data_begin)*m_bytesize > m_mem.GetSize())
+	{
+		// the maximum size has been raised beyond the reserved range
+		m_mem.Touch(0, stack_offs);
+		VMMemory mem(static_cast<std::size_t>(m_maxmemsize - m_data_begin)*m_bytesize);
+		std::memcpy(mem.Get(), m_mem.Get(), stack_offs);
+		std::memcpy(mem.Get() + stack_offs + gap_size, m_mem.Get() + stack_offs, stack_size);
+		m_mem = std::move(mem);
+	}
+	else
+	{
+		// move the stack within the reserved range and clear the gap (HALT == 0)
+		std::memmove(m_mem.Get() + stack_offs + gap_size, m_mem.Get() + stack_offs, stack_size);
+		m_mem.Zero(stack_offs, stack_offs + std::min(gap_size, stack_size));
+	}
+
+	t_byte* mem = m_mem.Get();
+
+	// follow the chain of saved base pointers up to the global frame
+	for(t_addr bp = m_bp; bp != m_gbp && bp >= stack_begin && bp < m_memsize;)
+	{
+		t_addr *saved_bp = reinterpret_cast<t_addr*>(
+			mem + (bp + delta + m_bytesize - m_data_begin));
+		if(static_cast<VMType>(mem[bp + delta - m_data_begin]) != VMType::ADDR_MEM
+			|| *saved_bp <= bp)
+			break;
+
+		bp = *saved_bp;
+		*saved_bp = move(bp);
+	}
+
+	for(IrqFrame& frame : m_irq_frames)
+		frame.bp = move(frame.bp);
+
+	// the string slots are counted from the top of the memory,
+	// only the ones below the moved stack change their positions
+	std::vector<t_addr> strslots;
+	ForEachStrSlot(0, stack_begin, [this, &strslots](t_addr addr)
+	{
+		strslots.push_back(addr);
+		SetStrSlot(addr, false);
+	});
+
+	m_sp = move(m_sp);
+	m_bp = move(m_bp);
+	m_gbp = move(m_gbp);
+
+	m_memsize = static_cast<t_addr>(memsize);
+	for(t_addr addr : strslots)
+		SetStrSlot(addr, true);
+
+	if(m_debug)
+	{
+		std::cout << "grew memory to " << m_memsize
+			<< " bytes, moved stack by " << delta
+			<< "." << std::endl;
+	}
+
+	// the compiled code uses the old memory layout
+	JitReset();
 }
 
 
@@ -71,19 +369,88 @@ void VM::RequestInterrupt(t_addr num)
  */
 void VM::SetISR(t_addr num, t_addr addr)
 {
+	if(num < 0 || num >= m_num_interrupts)
+		throw std::runtime_error("Invalid interrupt number.");
+
 	m_isrs[num] = addr;
 
+	// only the routines known to the verifier may run without checks
+	if(m_verified && !m_verified_isrs.contains(addr))
+		ResetVerification();
+
 	if(m_debug)
 		std::cout << "Set isr " << num << " to address " << addr << "." << std::endl;
 }
 
 
+/**
+ * run the program until it halts
+ */
 bool VM::Run()
 {
+	return Execute(std::nullopt, std::nullopt) != RunState::FAILED;
+}
+
+
+/**
+ * run at most the given number of instructions
+ */
+VM::RunState VM::RunFor(std::uint64_t num_instrs)
+{
+	return Execute(num_instrs, std::nullopt);
+}
+
+
+/**
+ * run until the given point in time
+ */
+VM::RunState VM::RunUntil(const t_time& deadline)
+{
+	return Execute(std::nullopt, deadline);
+}
+
+
+/**
+ * run the program until it halts, its instruction budget
+ * is used up or the deadline has passed
+ */
+VM::RunState VM::Execute(std::optional<std::uint64_t> max_instrs,
+	std::optional<t_time> deadline)
+{
+	// native code is not used while debugging or profiling
+	const bool use_jit = m_jit && !m_debug && !m_drawmemimages && !m_zeropoppedvals && !m_profiler;
+
+	// the time between the runs is not profiled
+	struct ProfilerClock
+	{
+		VM& vm;
+		ProfilerClock(VM& _vm) : vm{_vm} { if(vm.m_profiler) vm.m_profiler->Start(); }
+		~ProfilerClock() { if(vm.m_profiler) vm.m_profiler->Stop(); }
+	} profiler_clock{*this};
+
+	// native code accesses the memory directly, so copy all shared pages
+	if(use_jit)
+		m_mem.Touch(0, static_cast<std::size_t>(m_memsize - m_data_begin)*m_bytesize);
+
+	std::uint64_t num_instrs = 0;
+	std::uint64_t next_deadline_check = 0;
+
 	bool running = true;
 	while(running)
 	{
-		CheckPointerBounds();
+		// give up the time slice
+		if(max_instrs && num_instrs >= *max_instrs)
+			return RunState::SUSPENDED;
+		if(deadline && num_instrs >= next_deadline_check)
+		{
+			// only look at the clock every few instructions
+			next_deadline_check = num_instrs + m_deadline_check;
+			if(t_clock::now() >= *deadline)
+				return RunState::SUSPENDED;
+		}
+
+		if(m_checks_active)
+			CheckPointerBounds();
 		if(m_drawmemimages)
 			DrawMemoryImage();
 
@@ -91,32 +458,34 @@ bool VM::Run()
 		bool irq_active = false;
 
 		// tests for interrupt requests
-		for(t_addr irq=0; irq<m_num_interrupts; ++irq)
+		if(m_irqs_pending.load(std::memory_order_relaxed)) [[unlikely]]
 		{
-			if(!m_irqs[irq])
-				continue;
-
-			m_irqs[irq] = false;
-			if(!m_isrs[irq])
-				continue;
-
-			irq_active = true;
-
-			// call interrupt service routine
-			PushAddress(*m_isrs[irq], VMType::ADDR_MEM);
-			op = OpCode::CALL;
+			if(std::optional<t_addr> irq = NextInterrupt(); irq)
+			{
+				irq_active = true;
 
-			// TODO: add specialised ICALL and IRET instructions
-			// in case of additional registers that might need saving
-			break;
+				// call interrupt service routine
+				PushData(t_data{std::in_place_index<m_intidx>, *irq});
+				PushAddress(*m_isrs[*irq], VMType::ADDR_MEM);
+				op = OpCode::ICALL;
+				++num_instrs;
+			}
 		}
 
 		if(!irq_active)
 		{
-			t_byte _op = m_mem[m_ip++];
+			// run natively compiled code if possible
+			if(use_jit && RunJit(num_instrs))
+				continue;
+
+			t_byte _op = *MemPtr(m_ip++);
+			++num_instrs;
 			op = static_cast<OpCode>(_op);
 		}
 
+		if(m_profiler) [[unlikely]]
+			m_profiler->Instruction(irq_active ? -1 : m_ip - 1, op, m_memsize - m_sp);
+
 		if(m_debug)
 		{
 			std::cout << "*** read instruction at ip = " << t_int(m_ip)
@@ -146,6 +515,19 @@ bool VM::Run()
 			// push direct data onto stack
 			case OpCode::PUSH:
 			{
+				// string literals are interned once and pushed as handles
+				if(static_cast<VMType>(ReadMemRaw<t_byte>(m_ip)) == VMType::STR)
+				{
+					t_addr handle = GetStrLiteral(m_ip);
+					t_addr len = ReadMemRaw<t_addr>(m_ip + m_bytesize);
+					m_ip += m_bytesize + m_addrsize + len;
+
+					m_strheap.AddRef(handle);
+					PushStrHandle(handle);
+					PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+					break;
+				}
+
 				auto [ty, val] = ReadMemData(m_ip);
 				m_ip += GetDataSize(val) + m_bytesize;
 				PushData(val, ty);
@@ -157,6 +539,14 @@ bool VM::Run()
 				// variable address
 				t_addr addr = PopAddress();
 
+				// move a string handle to memory
+				if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) == VMType::STR)
+				{
+					PopRaw<t_byte, m_bytesize>();
+					WriteMemStrHandle(addr, PopStrHandle());
+					break;
+				}
+
 				// pop data and write it to memory
 				t_data val = PopData();
 				WriteMemData(addr, val);
@@ -168,12 +558,51 @@ bool VM::Run()
 				// variable address
 				t_addr addr = PopAddress();
 
+				// copy a string handle to the stack
+				if(static_cast<VMType>(ReadMemRaw<t_byte>(addr)) == VMType::STR)
+				{
+					t_addr handle = ReadMemRaw<t_addr>(addr + m_bytesize);
+					m_strheap.AddRef(handle);
+					PushStrHandle(handle);
+					PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+					break;
+				}
+
 				// read and push data from memory
 				auto [ty, val] = ReadMemData(addr);
 				PushData(val, ty);
 				break;
 			}
 
+			case OpCode::LDR:
+			{
+				t_addr reg = ReadMemRaw<t_byte>(m_ip);
+				m_ip += m_bytesize;
+
+				PushRegister(reg);
+				break;
+			}
+
+			case OpCode::STR:
+			{
+				t_addr reg = ReadMemRaw<t_byte>(m_ip);
+				m_ip += m_bytesize;
+
+				PopRegister(reg);
+				break;
+			}
+
+			case OpCode::OPR:
+			{
+				// operator and register
+				OpCode regop = static_cast<OpCode>(ReadMemRaw<t_byte>(m_ip));
+				t_addr reg = ReadMemRaw<t_byte>(m_ip + m_bytesize);
+				m_ip += 2*m_bytesize;
+
+				OpRegister(regop, reg);
+				break;
+			}
+
 			case OpCode::USUB:
 			{
 				t_data val = PopData();
@@ -246,137 +675,329 @@ bool VM::Run()
 				break;
 			}
 
-			case OpCode::XOR:
+			case OpCode::XOR:
+			{
+				OpLogical<'^'>();
+				break;
+			}
+
+			case OpCode::NOT:
+			{
+				// might also use PopData and PushData in case ints
+				// should also be allowed in boolean expressions
+				t_bool val = PopRaw<t_bool, m_boolsize>();
+				PushRaw<t_bool, m_boolsize>(!val);
+				break;
+			}
+
+			case OpCode::BINAND:
+			{
+				OpBinary<'&'>();
+				break;
+			}
+
+			case OpCode::BINOR:
+			{
+				OpBinary<'|'>();
+				break;
+			}
+
+			case OpCode::BINXOR:
+			{
+				OpBinary<'^'>();
+				break;
+			}
+
+			case OpCode::BINNOT:
+			{
+				t_data val = PopData();
+				if(val.index() == m_intidx)
+				{
+					t_int newval = ~std::get<m_intidx>(val);
+					PushData(t_data{std::in_place_index<m_intidx>, newval});
+				}
+				else
+				{
+					throw std::runtime_error("Invalid data type for binary not.");
+				}
+
+				break;
+			}
+
+			case OpCode::SHL:
+			{
+				OpBinary<'<'>();
+				break;
+			}
+
+			case OpCode::SHR:
+			{
+				OpBinary<'>'>();
+				break;
+			}
+
+			case OpCode::ROTL:
+			{
+				OpBinary<'l'>();
+				break;
+			}
+
+			case OpCode::ROTR:
+			{
+				OpBinary<'r'>();
+				break;
+			}
+
+			case OpCode::GT:
+			{
+				OpComparison<OpCode::GT>();
+				break;
+			}
+
+			case OpCode::LT:
+			{
+				OpComparison<OpCode::LT>();
+				break;
+			}
+
+			case OpCode::GEQU:
+			{
+				OpComparison<OpCode::GEQU>();
+				break;
+			}
+
+			case OpCode::LEQU:
+			{
+				OpComparison<OpCode::LEQU>();
+				break;
+			}
+
+			case OpCode::EQU:
+			{
+				OpComparison<OpCode::EQU>();
+				break;
+			}
+
+			case OpCode::NEQU:
+			{
+				OpComparison<OpCode::NEQU>();
+				break;
+			}
+
+			case OpCode::TOI: // converts value to t_int
+			{
+				OpCast<m_intidx>();
+				break;
+			}
+
+			case OpCode::TOF: // converts value to t_real
+			{
+				OpCast<m_realidx>();
+				break;
+			}
+
+			case OpCode::TOS: // converts value to t_str
+			{
+				OpCast<m_stridx>();
+				break;
+			}
+
+			case OpCode::UNTAGI:
+			{
+				OpUntag<VMType::INT>();
+				break;
+			}
+
+			case OpCode::UNTAGF:
+			{
+				OpUntag<VMType::REAL>();
+				break;
+			}
+
+			case OpCode::TAGI:
+			{
+				PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::INT));
+				break;
+			}
+
+			case OpCode::TAGF:
+			{
+				PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::REAL));
+				break;
+			}
+
+			case OpCode::PUSHI:
+			{
+				t_int val = ReadMemRaw<t_int>(m_ip);
+				m_ip += m_intsize;
+				PushRaw<t_int, m_intsize>(val);
+				break;
+			}
+
+			case OpCode::PUSHF:
+			{
+				t_real val = ReadMemRaw<t_real>(m_ip);
+				m_ip += m_realsize;
+				PushRaw<t_real, m_realsize>(val);
+				break;
+			}
+
+			case OpCode::IUSUB:
+			{
+				t_int val = PopRaw<t_int, m_intsize>();
+				PushRaw<t_int, m_intsize>(-val);
+				break;
+			}
+
+			case OpCode::IADD:
+			{
+				OpUntaggedArithmetic<t_int, '+'>();
+				break;
+			}
+
+			case OpCode::ISUB:
+			{
+				OpUntaggedArithmetic<t_int, '-'>();
+				break;
+			}
+
+			case OpCode::IMUL:
+			{
+				OpUntaggedArithmetic<t_int, '*'>();
+				break;
+			}
+
+			case OpCode::IDIV:
+			{
+				OpUntaggedArithmetic<t_int, '/'>();
+				break;
+			}
+
+			case OpCode::IMOD:
 			{
-				OpLogical<'^'>();
+				OpUntaggedArithmetic<t_int, '%'>();
 				break;
 			}
 
-			case OpCode::NOT:
+			case OpCode::FUSUB:
 			{
-				// might also use PopData and PushData in case ints
-				// should also be allowed in boolean expressions
-				t_bool val = PopRaw<t_bool, m_boolsize>();
-				PushRaw<t_bool, m_boolsize>(!val);
+				t_real val = PopRaw<t_real, m_realsize>();
+				PushRaw<t_real, m_realsize>(-val);
 				break;
 			}
 
-			case OpCode::BINAND:
+			case OpCode::FADD:
 			{
-				OpBinary<'&'>();
+				OpUntaggedArithmetic<t_real, '+'>();
 				break;
 			}
 
-			case OpCode::BINOR:
+			case OpCode::FSUB:
 			{
-				OpBinary<'|'>();
+				OpUntaggedArithmetic<t_real, '-'>();
 				break;
 			}
 
-			case OpCode::BINXOR:
+			case OpCode::FMUL:
 			{
-				OpBinary<'^'>();
+				OpUntaggedArithmetic<t_real, '*'>();
 				break;
 			}
 
-			case OpCode::BINNOT:
+			case OpCode::FDIV:
 			{
-				t_data val = PopData();
-				if(val.index() == m_intidx)
-				{
-					t_int newval = ~std::get<m_intidx>(val);
-					PushData(t_data{std::in_place_index<m_intidx>, newval});
-				}
-				else
-				{
-					throw std::runtime_error("Invalid data type for binary not.");
-				}
-
+				OpUntaggedArithmetic<t_real, '/'>();
 				break;
 			}
 
-			case OpCode::SHL:
+			case OpCode::FMOD:
 			{
-				OpBinary<'<'>();
+				OpUntaggedArithmetic<t_real, '%'>();
 				break;
 			}
 
-			case OpCode::SHR:
+			case OpCode::IGT:
 			{
-				OpBinary<'>'>();
+				OpUntaggedComparison<t_int, OpCode::GT>();
 				break;
 			}
 
-			case OpCode::ROTL:
+			case OpCode::ILT:
 			{
-				OpBinary<'l'>();
+				OpUntaggedComparison<t_int, OpCode::LT>();
 				break;
 			}
 
-			case OpCode::ROTR:
+			case OpCode::IGEQU:
 			{
-				OpBinary<'r'>();
+				OpUntaggedComparison<t_int, OpCode::GEQU>();
 				break;
 			}
 
-			case OpCode::GT:
+			case OpCode::ILEQU:
 			{
-				OpComparison<OpCode::GT>();
+				OpUntaggedComparison<t_int, OpCode::LEQU>();
 				break;
 			}
 
-			case OpCode::LT:
+			case OpCode::IEQU:
 			{
-				OpComparison<OpCode::LT>();
+				OpUntaggedComparison<t_int, OpCode::EQU>();
 				break;
 			}
 
-			case OpCode::GEQU:
+			case OpCode::INEQU:
 			{
-				OpComparison<OpCode::GEQU>();
+				OpUntaggedComparison<t_int, OpCode::NEQU>();
 				break;
 			}
 
-			case OpCode::LEQU:
+			case OpCode::FGT:
 			{
-				OpComparison<OpCode::LEQU>();
+				OpUntaggedComparison<t_real, OpCode::GT>();
 				break;
 			}
 
-			case OpCode::EQU:
+			case OpCode::FLT:
 			{
-				OpComparison<OpCode::EQU>();
+				OpUntaggedComparison<t_real, OpCode::LT>();
 				break;
 			}
 
-			case OpCode::NEQU:
+			case OpCode::FGEQU:
 			{
-				OpComparison<OpCode::NEQU>();
+				OpUntaggedComparison<t_real, OpCode::GEQU>();
 				break;
 			}
 
-			case OpCode::TOI: // converts value to t_int
+			case OpCode::FLEQU:
 			{
-				OpCast<m_intidx>();
+				OpUntaggedComparison<t_real, OpCode::LEQU>();
 				break;
 			}
 
-			case OpCode::TOF: // converts value to t_real
+			case OpCode::FEQU:
 			{
-				OpCast<m_realidx>();
+				OpUntaggedComparison<t_real, OpCode::EQU>();
 				break;
 			}
 
-			case OpCode::TOS: // converts value to t_str
+			case OpCode::FNEQU:
 			{
-				OpCast<m_stridx>();
+				OpUntaggedComparison<t_real, OpCode::NEQU>();
 				break;
 			}
 
 			case OpCode::JMP: // jump to direct address
 			{
 				// get address from stack and set ip
-				m_ip = PopAddress();
+				t_addr addr = PopAddress();
+
+				// count backward jumps, i.e. loops, for the jit
+				if(addr < m_ip)
+					JitCount(addr, m_ip);
+
+				m_ip = addr;
 				break;
 			}
 
@@ -390,7 +1011,11 @@ bool VM::Run()
 
 				// set instruction pointer
 				if(cond)
+				{
+					if(addr < m_ip)
+						JitCount(addr, m_ip);
 					m_ip = addr;
+				}
 				break;
 			}
 
@@ -402,10 +1027,12 @@ bool VM::Run()
 			 *  --------------------      |
 			 * |      ...           |     |
 			 *  --------------------      |
-			 * |  local var 2       |     |  m_framesize
-			 *  --------------------      |
+			 * |  local var 2       |     |  frame size, m_framesize
+			 *  --------------------      |  or set by the function
 			 * |  local var 1       |     |
 			 *  --------------------      |
+			 * |  frame size        |     |
+			 *  --------------------
 			 * |  old m_bp          |  <-- m_bp (= previous m_sp)
 			 *  --------------------
 			 * |  old m_ip for ret  |
@@ -423,22 +1050,22 @@ bool VM::Run()
 			{
 				t_addr funcaddr = PopAddress();
 
-				// save instruction and base pointer and
-				// set up the function's stack frame for local variables
-				PushAddress(m_ip, VMType::ADDR_MEM);
-				PushAddress(m_bp, VMType::ADDR_MEM);
-
 				if(m_debug)
 				{
-					std::cout << "saved base pointer "
+					std::cout << "saving base pointer "
 						<< m_bp << "."
 						<< std::endl;
 				}
-				m_bp = m_sp;
-				m_sp -= m_framesize;
+
+				// save instruction and base pointer and
+				// set up the function's stack frame for local variables
+				EnterFrame();
 
 				// jump to function
 				m_ip = funcaddr;
+				JitCount(funcaddr, -1);
+				if(m_profiler)
+					m_profiler->Call(funcaddr);
 				if(m_debug)
 				{
 					std::cout << "calling function "
@@ -453,20 +1080,45 @@ bool VM::Run()
 				// get number of function arguments
 				t_int num_args = std::get<m_intidx>(PopData());
 
+				// end of an interrupt service routine
+				if(!m_irq_frames.empty() && m_irq_frames.back().bp == m_bp)
+				{
+					ReturnFromInterrupt();
+					break;
+				}
+
 				// if there's still a value on the stack, use it as return value
+				t_addr framesize = ReadMemRaw<t_addr>(m_bp - m_addrsize);
 				t_data retval;
-				if(m_sp + m_framesize < m_bp)
-					retval = PopData();
+				std::optional<t_addr> retstr;
+				if(m_sp + framesize < m_bp)
+				{
+					if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) == VMType::STR)
+					{
+						// keep string return values as handles
+						PopRaw<t_byte, m_bytesize>();
+						retstr = PopStrHandle();
+					}
+					else
+					{
+						retval = PopData();
+					}
+				}
+
+				// release the strings held by the stack frame
+				ReleaseStrSlots(m_sp, m_bp);
 
 				// zero the stack frame
 				if(m_zeropoppedvals)
-					std::memset(m_mem.get()+m_sp, 0, (m_bp-m_sp)*m_bytesize);
+					std::memset(DataPtr(m_sp, (m_bp-m_sp)*m_bytesize), 0, (m_bp-m_sp)*m_bytesize);
 
 				// remove the function's stack frame
 				m_sp = m_bp;
 
 				m_bp = PopAddress();
 				m_ip = PopAddress();  // jump back
+				if(m_profiler)
+					m_profiler->Return();
 
 				if(m_debug)
 				{
@@ -479,17 +1131,94 @@ bool VM::Run()
 				for(t_int arg=0; arg<num_args; ++arg)
 					PopData();
 
-				PushData(retval, VMType::UNKNOWN, false);
+				if(retstr)
+				{
+					PushStrHandle(*retstr);
+					PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+				}
+				else
+				{
+					PushData(retval, VMType::UNKNOWN, false);
+				}
+				break;
+			}
+
+			case OpCode::TAILCALL: // call a function in place of the current one
+			{
+				t_addr funcaddr = PopAddress();
+
+				// numbers of arguments of the current and of the called function
+				t_addr num_args = ReadMemRaw<t_addr>(m_ip);
+				m_ip += m_addrsize;
+				t_addr num_callee_args = ReadMemRaw<t_addr>(m_ip);
+				m_ip += m_addrsize;
+
+				// interrupt service routines have to return via their own
+				// frame, so the function is called normally and the following
+				// return instruction is executed afterwards
+				if(!m_irq_frames.empty() && m_irq_frames.back().bp == m_bp)
+					EnterFrame();
+				else
+					ReplaceFrame(num_args, num_callee_args);
+
+				// jump to function
+				m_ip = funcaddr;
+				JitCount(funcaddr, -1);
+				if(m_profiler)
+					m_profiler->Call(funcaddr);
+				if(m_debug)
+				{
+					std::cout << "tail-calling function "
+						<< funcaddr << "."
+						<< std::endl;
+				}
+				break;
+			}
+
+			case OpCode::FRAME: // resize the function's stack frame
+			{
+				t_addr framesize = ReadMemRaw<t_addr>(m_ip);
+				m_ip += m_addrsize;
+
+				SetFrameSize(framesize);
+				break;
+			}
+
+			case OpCode::ICALL: // interrupt service routine call
+			{
+				t_addr addr = PopAddress();
+				t_int irq = std::get<m_intidx>(PopData());
+
+				CallInterrupt(static_cast<t_addr>(irq), addr);
+				break;
+			}
+
+			case OpCode::IRET: // return from interrupt service routine
+			{
+				ReturnFromInterrupt();
 				break;
 			}
 
 			case OpCode::EXTCALL: // external function call
 			{
 				// get function name
-				const t_str/*&*/ funcname = std::get<m_stridx>(PopData());
+				if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) != VMType::STR)
+					throw std::runtime_error("Invalid data type for external function name.");
+				PopRaw<t_byte, m_bytesize>();
+				t_addr funcname = PopStrHandle();
+
+				CallExternal(m_strheap.Get(funcname));
+				m_strheap.Release(funcname);
+				break;
+			}
 
-				t_data retval = CallExternal(funcname);
-				PushData(retval, VMType::UNKNOWN, false);
+			case OpCode::EXTCALLI: // external function call via index
+			{
+				// get function index
+				t_addr funcidx = ReadMemRaw<t_addr>(m_ip);
+				m_ip += m_addrsize;
+
+				CallExternal(funcidx);
 				break;
 			}
 
@@ -498,7 +1227,7 @@ bool VM::Run()
 				std::cerr << "Error: Invalid instruction " << std::hex
 					<< static_cast<t_addr>(op) << std::dec
 					<< std::endl;
-				return false;
+				return RunState::FAILED;
 			}
 		}
 
@@ -507,7 +1236,7 @@ bool VM::Run()
 			m_ip %= m_memsize;
 	}
 
-	return true;
+	return RunState::HALTED;
 }
 
 
@@ -561,20 +1290,14 @@ void VM::PushAddress(t_addr addr, VMType ty)
 
 /**
  * pop a string from the stack
- * a string consists of an t_addr giving the length
- * following by the string (without 0-termination)
+ * a string is stored as a handle into the string heap
  */
 VM::t_str VM::PopString()
 {
-	t_addr len = PopRaw<t_addr, m_addrsize>();
-	CheckMemoryBounds(m_sp, len);
+	t_addr handle = PopStrHandle();
 
-	t_char* begin = reinterpret_cast<t_char*>(m_mem.get() + m_sp);
-	t_str str(begin, len);
-	m_sp += len;
-
-	if(m_zeropoppedvals)
-		std::memset(begin, 0, len*m_bytesize);
+	t_str str = m_strheap.Get(handle);
+	m_strheap.Release(handle);
 
 	return str;
 }
@@ -585,14 +1308,8 @@ VM::t_str VM::PopString()
  */
 VM::t_str VM::TopString(t_addr sp_offs) const
 {
-	t_addr len = TopRaw<t_addr, m_addrsize>(sp_offs);
-	t_addr addr = m_sp + sp_offs + m_addrsize;
-
-	CheckMemoryBounds(addr, len);
-	t_char* begin = reinterpret_cast<t_char*>(m_mem.get() + addr);
-	t_str str(begin, len);
-
-	return str;
+	t_addr handle = TopRaw<t_addr, m_addrsize>(sp_offs);
+	return m_strheap.Get(handle);
 }
 
 
@@ -601,14 +1318,206 @@ VM::t_str VM::TopString(t_addr sp_offs) const
  */
 void VM::PushString(const VM::t_str& str)
 {
-	t_addr len = static_cast<t_addr>(str.length());
-	CheckMemoryBounds(m_sp, len);
+	PushStrHandle(m_strheap.Intern(str));
+}
+
+
+/**
+ * push a string handle to the stack, the stack takes over its reference
+ */
+void VM::PushStrHandle(t_addr handle)
+{
+	PushRaw<t_addr, m_addrsize>(handle);
+	SetStrSlot(m_sp, true);
+}
+
+
+/**
+ * pop a string handle from the stack, the caller takes over its reference
+ */
+VM::t_addr VM::PopStrHandle()
+{
+	// the reference must belong to the stack
+	if(!IsStrSlot(m_sp))
+		throw std::runtime_error("No string handle on the stack.");
+
+	SetStrSlot(m_sp, false);
+	return PopRaw<t_addr, m_addrsize>();
+}
+
+
+/**
+ * release the string references held in the memory range [begin, end),
+ * the handles are read from the marked addresses
+ */
+void VM::ReleaseStrSlots(t_addr begin, t_addr end)
+{
+	ForEachStrSlot(begin, end, [this](t_addr addr)
+	{
+		SetStrSlot(addr, false);
+		m_strheap.Release(ReadMemRaw<t_addr>(addr));
+	});
+}
+
+
+/**
+ * are there string handles in the memory range [begin, end)?
+ */
+bool VM::HasStrSlots(t_addr begin, t_addr end) const
+{
+	bool found = false;
+	ForEachStrSlot(begin, end, [&found](t_addr) { found = true; });
+	return found;
+}
+
+
+/**
+ * push the value of a register
+ */
+void VM::PushRegister(t_addr reg)
+{
+	if(reg < 0 || reg >= m_num_regs)
+		throw std::runtime_error("Invalid register.");
+
+	const t_byte* slot = m_regfile.data() + reg*m_regsize;
+	VMType ty = static_cast<VMType>(slot[0]);
+
+	if(ty == VMType::REAL)
+	{
+		t_real val{};
+		std::memcpy(&val, slot + m_bytesize, m_realsize);
+		PushRaw<t_real, m_realsize>(val);
+	}
+	else if(ty == VMType::INT)
+	{
+		t_int val{};
+		std::memcpy(&val, slot + m_bytesize, m_intsize);
+		PushRaw<t_int, m_intsize>(val);
+	}
+	else
+	{
+		throw std::runtime_error("Register " + std::to_string(reg) + " has not been assigned.");
+	}
+
+	PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(ty));
+}
+
+
+/**
+ * pop a value into a register, only ints and reals can be held in registers
+ */
+void VM::PopRegister(t_addr reg)
+{
+	if(reg < 0 || reg >= m_num_regs)
+		throw std::runtime_error("Invalid register.");
+
+	t_byte* slot = m_regfile.data() + reg*m_regsize;
+	VMType ty = static_cast<VMType>(TopRaw<t_byte, m_bytesize>());
+
+	if(ty == VMType::REAL)
+	{
+		PopRaw<t_byte, m_bytesize>();
+		t_real val = PopRaw<t_real, m_realsize>();
+		std::memcpy(slot + m_bytesize, &val, m_realsize);
+	}
+	else if(ty == VMType::INT)
+	{
+		PopRaw<t_byte, m_bytesize>();
+		t_int val = PopRaw<t_int, m_intsize>();
+		std::memcpy(slot + m_bytesize, &val, m_intsize);
+	}
+	else
+	{
+		throw std::runtime_error("Only ints and reals can be held in registers.");
+	}
+
+	slot[0] = static_cast<t_byte>(ty);
+}
+
+
+/**
+ * apply a binary operator to the top value and a register,
+ * which is the same as pushing the register and running the operator
+ */
+void VM::OpRegister(OpCode op, t_addr reg)
+{
+	if(!is_vm_register_op(op))
+		throw std::runtime_error("Invalid operator for a register operand.");
+
+	PushRegister(reg);
+
+	switch(op)
+	{
+		case OpCode::ADD: OpArithmetic<'+'>(); break;
+		case OpCode::SUB: OpArithmetic<'-'>(); break;
+		case OpCode::MUL: OpArithmetic<'*'>(); break;
+		case OpCode::DIV: OpArithmetic<'/'>(); break;
+		case OpCode::MOD: OpArithmetic<'%'>(); break;
+		case OpCode::POW: OpArithmetic<'^'>(); break;
+		case OpCode::GT: OpComparison<OpCode::GT>(); break;
+		case OpCode::LT: OpComparison<OpCode::LT>(); break;
+		case OpCode::GEQU: OpComparison<OpCode::GEQU>(); break;
+		case OpCode::LEQU: OpComparison<OpCode::LEQU>(); break;
+		case OpCode::EQU: OpComparison<OpCode::EQU>(); break;
+		case OpCode::NEQU: OpComparison<OpCode::NEQU>(); break;
+		default: break;
+	}
+}
+
+
+/**
+ * get the value held by a register
+ */
+VM::t_data VM::GetRegister(t_addr reg) const
+{
+	if(reg < 0 || reg >= m_num_regs)
+		throw std::runtime_error("Invalid register.");
+
+	const t_byte* slot = m_regfile.data() + reg*m_regsize;
+	VMType ty = static_cast<VMType>(slot[0]);
+
+	if(ty == VMType::REAL)
+	{
+		t_real val{};
+		std::memcpy(&val, slot + m_bytesize, m_realsize);
+		return t_data{std::in_place_index<m_realidx>, val};
+	}
+	else if(ty == VMType::INT)
+	{
+		t_int val{};
+		std::memcpy(&val, slot + m_bytesize, m_intsize);
+		return t_data{std::in_place_index<m_intidx>, val};
+	}
+
+	return t_data{};
+}
+
+
+/**
+ * get the handle of a string literal in the code,
+ * the string is only interned the first time it is encountered
+ */
+VM::t_addr VM::GetStrLiteral(t_addr addr)
+{
+	if(auto iter = m_strlits.find(addr); iter != m_strlits.end())
+		return iter->second;
+
+	// the literal cache keeps one reference
+	t_addr handle = m_strheap.Intern(ReadMemRaw<t_str>(addr + m_bytesize));
+	m_strlits.emplace(addr, handle);
+
+	return handle;
+}
 
-	m_sp -= len;
-	t_char* begin = reinterpret_cast<t_char*>(m_mem.get() + m_sp);
-	std::memcpy(begin, str.data(), len*sizeof(t_char));
 
-	PushRaw<t_addr, m_addrsize>(len);
+/**
+ * drop the cached string literals, e.g. when the code is replaced
+ */
+void VM::ReleaseStrLiterals()
+{
+	for(const auto& [addr, handle] : m_strlits)
+		m_strheap.Release(handle);
+	m_strlits.clear();
 }
 
 
@@ -858,11 +1767,8 @@ VM::t_addr VM::GetArgAddr(VM::t_addr addr, VM::t_addr arg_num) const
 				addr += m_addrsize;
 				break;
 			case VMType::STR:
-			{
-				t_addr len = ReadMemRaw<t_addr>(addr);
-				addr += m_addrsize + len;
+				addr += m_addrsize;
 				break;
-			}
 			default:
 			{
 				std::ostringstream msg;
@@ -960,7 +1866,7 @@ std::tuple<VMType, VM::t_data> VM::ReadMemData(VM::t_addr addr)
 
 		case VMType::STR:
 		{
-			t_str str = ReadMemRaw<t_str>(addr);
+			const t_str& str = m_strheap.Get(ReadMemRaw<t_addr>(addr));
 			dat = t_data{std::in_place_index<m_stridx>, str};
 
 			if(m_debug)
@@ -992,6 +1898,9 @@ std::tuple<VMType, VM::t_data> VM::ReadMemData(VM::t_addr addr)
  */
 void VM::WriteMemData(VM::t_addr addr, const VM::t_data& data)
 {
+	// the old value is overwritten
+	ReleaseStrSlots(addr, addr + m_bytesize + GetDataSize(data));
+
 	if(data.index() == m_realidx)
 	{
 		if(m_debug)
@@ -1053,12 +1962,7 @@ void VM::WriteMemData(VM::t_addr addr, const VM::t_data& data)
 				<< "." << std::endl;
 		}
 
-		// write descriptor prefix
-		WriteMemRaw<t_byte>(addr, static_cast<t_byte>(VMType::STR));
-		addr += m_bytesize;
-
-		// write the actual data
-		WriteMemRaw<t_str>(addr, std::get<m_stridx>(data));
+		WriteMemStrHandle(addr, m_strheap.Intern(std::get<m_stridx>(data)));
 	}
 	else
 	{
@@ -1067,6 +1971,24 @@ void VM::WriteMemData(VM::t_addr addr, const VM::t_data& data)
 }
 
 
+/**
+ * write a string handle to memory, the memory takes over its reference
+ */
+void VM::WriteMemStrHandle(VM::t_addr addr, VM::t_addr handle)
+{
+	// the old value is overwritten
+	ReleaseStrSlots(addr, addr + m_bytesize + m_addrsize);
+
+	// write descriptor prefix
+	WriteMemRaw<t_byte>(addr, static_cast<t_byte>(VMType::STR));
+	addr += m_bytesize;
+
+	// write the handle
+	WriteMemRaw<t_addr>(addr, handle);
+	SetStrSlot(addr, true);
+}
+
+
 VM::t_addr VM::GetDataSize(const t_data& data) const
 {
 	if(data.index() == m_realidx)
@@ -1076,23 +1998,59 @@ VM::t_addr VM::GetDataSize(const t_data& data) const
 	else if(data.index() == m_addridx)
 		return m_addrsize;
 	else if(data.index() == m_stridx)
-		return m_addrsize /*len*/ + std::get<m_stridx>(data).length();
+		return m_addrsize /*handle*/;
 
 	throw std::runtime_error("GetDataSize: Data type not yet implemented.");
 	return 0;
 }
 
 
+/**
+ * count the executed instructions and time the function calls
+ */
+void VM::SetProfiling(bool b)
+{
+	if(b && !m_profiler)
+		m_profiler = std::make_unique<VMProfiler>();
+	else if(!b)
+		m_profiler.reset();
+}
+
+
 void VM::Reset()
 {
 	m_ip = 0;
-	m_sp = m_memsize - m_framesize;
 	m_bp = m_memsize;
 	m_bp -= sizeof(t_data) + 1; // padding of max. data type size to avoid writing beyond memory size
 	m_gbp = m_bp;
 
-	std::memset(m_mem.get(), static_cast<t_byte>(OpCode::HALT), m_memsize*m_bytesize);
+	// fresh memory reads as zero, which is the halt instruction
+	static_assert(static_cast<t_byte>(OpCode::HALT) == 0, "Memory has to be cleared with halt instructions.");
+	m_mem.Clear();
 	m_code_range[0] = m_code_range[1] = -1;
+	m_stacklimit = m_data_begin;
+
+	// a shared code image stays in place
+	if(m_code)
+		UpdateCodeRange(0, m_data_begin);
+
+	m_irqs_pending = 0;
+	m_irq_level = m_num_interrupts;
+	m_irq_frames.clear();
+	m_regfile.fill(0);
+
+	m_strslots.clear();
+	m_strlits.clear();
+	m_native_strs.clear();
+	m_strheap.Clear();
+	ResetVerification();
+	if(m_profiler)
+		m_profiler->ClearCalls();
+
+	// stack frame for the global variables, programs can resize it
+	SetFrameSize(m_framesize);
+
+	JitReset();
 }
 
 
@@ -1113,21 +2071,52 @@ void VM::UpdateCodeRange(t_addr begin, t_addr end)
 		m_code_range[0] = std::min(m_code_range[0], begin);
 		m_code_range[1] = std::max(m_code_range[1], end);
 	}
+
+	// the stack must not grow into the code
+	m_stacklimit = std::max(m_code_range[1], m_data_begin);
 }
 
 
 void VM::SetMem(t_addr addr, VM::t_byte data)
 {
-	CheckMemoryBounds(addr, sizeof(t_byte));
+	// writes from outside are also checked for verified code
+	if(m_checks)
+		CheckMemoryRange(addr, sizeof(t_byte));
+	if(m_verified && addr >= m_code_range[0] && addr < m_code_range[1])
+		ResetVerification();
+
+	*DataPtr(addr % m_memsize) = data;
+}
+
+
+/**
+ * use a shared code image at the addresses [0, code size)
+ */
+void VM::SetCode(std::shared_ptr<const VMCode> code)
+{
+	t_addr data_begin = code ? code->GetSize() : 0;
+	if(data_begin >= m_memsize)
+		throw std::runtime_error("Code image does not fit into memory.");
+
+	// only the memory after the code belongs to this vm
+	if(data_begin != m_data_begin || !m_mem)
+		m_mem = VMMemory(static_cast<std::size_t>(m_maxmemsize - data_begin)*m_bytesize);
 
-	m_mem[addr % m_memsize] = data;
+	m_code = code;
+	m_data_begin = data_begin;
+	Reset();
 }
 
 
 void VM::SetMem(t_addr addr, const t_str& data, bool is_code)
 {
 	if(is_code)
+	{
+		ResetVerification();
 		UpdateCodeRange(addr, addr + data.size());
+		ReleaseStrLiterals();
+		JitReset();
+	}
 
 	for(std::size_t i=0; i<data.size(); ++i)
 		SetMem(addr + (t_addr)(i), static_cast<t_byte>(data[i]));
@@ -1137,7 +2126,12 @@ void VM::SetMem(t_addr addr, const t_str& data, bool is_code)
 void VM::SetMem(t_addr addr, const VM::t_byte* data, std::size_t size, bool is_code)
 {
 	if(is_code)
+	{
+		ResetVerification();
 		UpdateCodeRange(addr, addr + size);
+		ReleaseStrLiterals();
+		JitReset();
+	}
 
 	for(std::size_t i=0; i<size; ++i)
 		SetMem(addr + t_addr(i), data[i]);
@@ -1158,21 +2152,19 @@ const char* VM::GetDataTypeName(const t_data& dat)
 }
 
 
-void VM::CheckMemoryBounds(t_addr addr, std::size_t size) const
+void VM::CheckMemoryRange(t_addr addr, std::size_t size) const
 {
-	if(!m_checks)
-		return;
-
 	if(std::size_t(addr) + size > std::size_t(m_memsize) || addr < 0)
 		throw std::runtime_error("Tried to access out of memory bounds.");
+
+	// values must not cross the end of a shared code image
+	if(addr < m_data_begin && std::size_t(addr) + size > std::size_t(m_data_begin))
+		throw std::runtime_error("Tried to access beyond the shared code.");
 }
 
 
 void VM::CheckPointerBounds() const
 {
-	if(!m_checks)
-		return;
-
 	// check code range?
 	bool chk_c = (m_code_range[0] >= 0 && m_code_range[1] >= 0);
 
@@ -10,8 +10,12 @@
 
 
 #include <type_traits>
+#include <algorithm>
 #include <memory>
 #include <array>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <optional>
 #include <variant>
 #include <iostream>
@@ -21,12 +25,24 @@
 #include <chrono>
 #include <atomic>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <tuple>
+#include <functional>
 #include <cstring>
 #include <cmath>
 
 //#include "../codegen/lval.h"
 #include "opcodes.h"
+#include "extfuncs.h"
 #include "helpers.h"
+#include "strheap.h"
+#include "code.h"
+#include "timerwheel.h"
+#include "memory.h"
+#include "snapshot.h"
+#include "profiler.h"
+#include "jit_x86.h"
 
 
 class VM
@@ -62,36 +78,194 @@ public:
 	static constexpr const t_addr m_intsize = sizeof(t_int);
 	static constexpr const t_addr m_boolsize = sizeof(t_bool);
 
+	// largest size of memory accessed at once, except for strings
+	static constexpr const std::size_t m_touchsize = 16;
+	static_assert(m_bytesize + std::max({ m_realsize, m_intsize, m_addrsize })
+		+ 2*m_bytesize <= m_touchsize, "Memory access size is too small.");
+
+	// registers hold an int or a real prefixed by its type descriptor, as in memory
+	static constexpr const t_addr m_num_regs = g_vm_num_regs;
+	static constexpr const t_addr m_regsize = m_touchsize;
+	static_assert(m_bytesize + std::max(m_realsize, m_intsize) <= m_regsize,
+		"Register size is too small.");
+	using t_regfile = std::array<t_byte, m_num_regs*m_regsize>;
+
 	static constexpr const t_addr m_num_interrupts = 16;
+	static_assert(m_num_interrupts <= 32, "Interrupt mask is too small.");
 	static constexpr const t_addr m_timer_interrupt = 0;
 
+	// result of running a time slice
+	enum class RunState : t_byte
+	{
+		HALTED,      // the program has finished
+		SUSPENDED,   // the instruction budget or the time is used up
+		FAILED,      // an invalid instruction was encountered
+	};
+
+	using t_clock = std::chrono::steady_clock;
+	using t_time = t_clock::time_point;
+
+	// external functions get their arguments cast to the registered types
+	using t_extargs = std::vector<t_data>;
+	using t_extfunc = std::function<t_data(VM& vm, const t_extargs& args)>;
+
+	/**
+	 * entry in the registry of external functions
+	 */
+	struct ExtFuncInfo
+	{
+		t_str name{};                         // function name
+		std::vector<VMType> args{};           // argument types
+		VMType ret{VMType::UNKNOWN};          // return type
+
+		// pops the arguments and pushes the return value
+		std::function<void(VM& vm)> call{};
+	};
+
 
 public:
+	/**
+	 * create a vm with the given initial memory size, the memory grows with the stack
+	 */
 	VM(t_addr memsize = 0x1000, std::optional<t_addr> framesize = std::nullopt);
 	~VM();
 
 	void SetDebug(bool b) { m_debug = b; }
 	void SetDrawMemImages(bool b) { m_drawmemimages = b; }
-	void SetChecks(bool b) { m_checks = b; }
+	void SetChecks(bool b) { m_checks = b; m_checks_active = b && !m_verified; }
 	void SetZeroPoppedVals(bool b) { m_zeropoppedvals = b; }
+	void SetJit(bool b) { m_jit = b; }
+	void SetJitThreshold(t_addr num) { m_jit_threshold = num; }
 	static const char* GetDataTypeName(const t_data& dat);
 
+	/**
+	 * count the executed instructions and time the function calls,
+	 * native code is not used while profiling
+	 */
+	void SetProfiling(bool b);
+	VMProfiler* GetProfiler() { return m_profiler.get(); }
+	const VMProfiler* GetProfiler() const { return m_profiler.get(); }
+
+	/**
+	 * deliver the timer interrupts from the given timer wheel, e.g. one with a
+	 * finer resolution, instead of from the process-wide one if it is null
+	 */
+	void SetTimerWheel(std::shared_ptr<VMTimerWheel> wheel);
+
+	/**
+	 * start the timer interrupt with the given period, which is rounded up
+	 * to the resolution of the timer wheel, or stop it if no period is given
+	 */
+	void SetTimer(std::optional<VMTimerWheel::t_duration> period);
+	VMTimerWheel::t_duration GetTimerPeriod() const { return m_timer_period; }
+
 	void Reset();
+
+	/**
+	 * verify the loaded code, throws if it is invalid,
+	 * verified code runs without memory bounds checks
+	 */
+	void Verify();
+	bool IsVerified() const { return m_verified; }
+
+	/**
+	 * write a listing of the instructions in the code
+	 */
+	static void Disassemble(std::ostream& ostr, const t_byte* code, t_addr size);
+
+	/**
+	 * run the program until it halts, returns false on an invalid instruction
+	 */
 	bool Run();
 
+	/**
+	 * run a time slice of the program, it is resumed by the next call
+	 */
+	RunState RunFor(std::uint64_t num_instrs);
+	RunState RunUntil(const t_time& deadline);
+
 	void SetMem(t_addr addr, t_byte data);
 	void SetMem(t_addr addr, const t_byte* data, std::size_t size, bool is_code = false);
 	void SetMem(t_addr addr, const std::string& data, bool is_code = false);
 
+	/**
+	 * use a shared code image at the addresses [0, code size),
+	 * the vm's own memory then only holds the data and the stack
+	 */
+	void SetCode(std::shared_ptr<const VMCode> code);
+	std::shared_ptr<const VMCode> GetCode() const { return m_code; }
+
+	/**
+	 * capture the state of the vm, e.g. after running a script's prelude,
+	 * the free memory between the code and the stack pointer is not stored
+	 */
+	std::shared_ptr<const VMSnapshot> Snapshot() const;
+
+	/**
+	 * continue from a captured state, the shared code image and
+	 * the external functions are not part of it and have to match
+	 */
+	void Restore(const VMSnapshot& snapshot);
+
+	/**
+	 * create a vm continuing from the current state, both vms share the
+	 * memory pages, which are only copied when a vm first touches them
+	 */
+	std::unique_ptr<VM> Fork();
+
+	/**
+	 * get the value held by a register, which is empty if it was not yet assigned
+	 */
+	t_data GetRegister(t_addr reg) const;
+
 	t_addr GetSP() const { return m_sp; }
 	t_addr GetBP() const { return m_bp; }
 	t_addr GetGBP() const { return m_gbp; }
 	t_addr GetIP() const { return m_ip; }
 
-	void SetSP(t_addr sp) { m_sp = sp; }
-	void SetBP(t_addr bp) { m_bp = bp; }
-	void SetGBP(t_addr bp) { m_gbp = bp; }
-	void SetIP(t_addr ip) { m_ip = ip; }
+	/**
+	 * get the size of the current stack frame
+	 */
+	t_addr GetFrameSize() const { return ReadMemRaw<t_addr>(m_bp - m_addrsize); }
+
+	t_addr GetMemSize() const { return m_memsize; }
+
+	/**
+	 * the memory grows with the stack up to this size
+	 */
+	void SetMaxMemSize(t_addr size) { m_maxmemsize = std::max(size, m_memsize); }
+	t_addr GetMaxMemSize() const { return m_maxmemsize; }
+
+	/**
+	 * get the vm's own memory, which starts at the address GetDataBegin()
+	 */
+	const t_byte* GetMem() const
+	{
+		m_mem.Touch(0, static_cast<std::size_t>(m_memsize - m_data_begin)*m_bytesize);
+		return m_mem.Get();
+	}
+	t_addr GetDataBegin() const { return m_data_begin; }
+
+	/**
+	 * get the number of memory pages copied from a parent or child vm
+	 */
+	std::size_t GetNumCopiedPages() const { return m_mem.GetNumCopiedPages(); }
+
+	/**
+	 * get the number of strings referenced by the memory and the stack
+	 */
+	std::size_t GetNumStrings() const { return m_strheap.GetNumStrings(); }
+
+	/**
+	 * get the number of natively compiled code blocks
+	 */
+	std::size_t GetNumJitBlocks() const;
+
+	// changing the registers directly leaves the verified code
+	void SetSP(t_addr sp) { m_sp = sp; ResetVerification(); }
+	void SetBP(t_addr bp) { m_bp = bp; ResetVerification(); }
+	void SetGBP(t_addr bp) { m_gbp = bp; ResetVerification(); }
+	void SetIP(t_addr ip) { m_ip = ip; ResetVerification(); }
 
 	/**
 	 * get top data from the stack
@@ -108,6 +282,75 @@ public:
 	 */
 	void RequestInterrupt(t_addr num);
 
+	/**
+	 * sets the address of an interrupt service routine,
+	 * lower interrupt numbers have higher priorities
+	 */
+	void SetISR(t_addr num, t_addr addr);
+
+	/**
+	 * register an external function and get its index,
+	 * an already registered function of the same name is replaced
+	 */
+	t_addr RegisterExternal(const t_str& name,
+		const std::vector<VMType>& args, VMType ret,
+		const t_extfunc& func);
+
+	/**
+	 * register a native function, its argument and return types are deduced
+	 * and the arguments are read directly from the stack
+	 */
+	template<class t_ret, class... t_args>
+	t_addr Register(const t_str& name, t_ret (*func)(t_args...))
+	{
+		return RegisterNative<t_ret, t_args...>(name, func);
+	}
+
+	/**
+	 * register a native function object with the given signature
+	 */
+	template<class t_ret, class... t_args, class t_func>
+	t_addr RegisterNative(const t_str& name, t_func func)
+	{
+		ExtFuncInfo info
+		{
+			.name = name,
+			.args = { GetNativeType<std::decay_t<t_args>>()... },
+			.ret = GetNativeType<std::decay_t<t_ret>>(),
+
+			.call = [func](VM& vm)
+			{
+				// string views refer to the heap until the call is finished,
+				// also if popping the arguments or the function throws
+				NativeStrScope str_scope{vm};
+
+				// the first argument is on top of the stack,
+				// braced initialisation keeps the evaluation order
+				std::tuple<std::decay_t<t_args>...> args{
+					vm.PopNative<std::decay_t<t_args>>()... };
+
+				if constexpr(std::is_void_v<t_ret>)
+				{
+					std::apply(func, args);
+				}
+				else
+				{
+					t_ret retval = std::apply(func, args);
+					vm.PushNative<std::decay_t<t_ret>>(retval);
+				}
+			},
+		};
+
+		return AddExternal(std::move(info));
+	}
+
+	/**
+	 * get the index of a registered external function
+	 */
+	std::optional<t_addr> GetExternalIndex(const t_str& name) const;
+
+	const std::vector<ExtFuncInfo>& GetExternals() const { return m_extfuncs; }
+
 	/**
 	 * visualises vm memory utilisation
 	 */
@@ -115,6 +358,11 @@ public:
 
 
 protected:
+	/**
+	 * create a forked vm using the given memory layer
+	 */
+	VM(const VM& vm, std::shared_ptr<const VMMemoryLayer> mem);
+
 	/**
 	 * return the size of the held data
 	 */
@@ -122,9 +370,47 @@ protected:
 
 
 	/**
-	 * call external function
+	 * call external function by its name
+	 */
+	void CallExternal(const t_str& func_name);
+
+	/**
+	 * call external function by its index
+	 */
+	void CallExternal(t_addr func_idx);
+
+	/**
+	 * pop an external function argument and cast it to the given type
+	 */
+	t_data PopExternalArg(VMType ty);
+
+	/**
+	 * add an entry to the registry of external functions
+	 */
+	t_addr AddExternal(ExtFuncInfo&& info);
+
+	/**
+	 * register a built-in function and check its index
+	 */
+	void RegisterBuiltin(ExtFunc func,
+		const std::vector<VMType>& args, VMType ret,
+		const t_extfunc& impl);
+
+	/**
+	 * register a native built-in function and check its index
+	 */
+	template<class t_ret, class... t_args>
+	void RegisterBuiltin(ExtFunc func, t_ret (*impl)(t_args...))
+	{
+		CheckBuiltinIndex(func, Register(get_vm_extfunc_name(func), impl));
+	}
+
+	void CheckBuiltinIndex(ExtFunc func, t_addr idx) const;
+
+	/**
+	 * register the built-in external functions
 	 */
-	t_data CallExternal(const t_str& func_name);
+	void RegisterBuiltins();
 
 
 	/**
@@ -153,6 +439,101 @@ protected:
 	 */
 	void PushString(const t_str& str);
 
+	/**
+	 * push a string handle to the stack, the stack takes over its reference
+	 */
+	void PushStrHandle(t_addr handle);
+
+	/**
+	 * pop a string handle from the stack, the caller takes over its reference
+	 */
+	t_addr PopStrHandle();
+
+	/**
+	 * release the string references held in the given memory range
+	 */
+	void ReleaseStrSlots(t_addr begin, t_addr end);
+
+	/**
+	 * are there string handles in the memory range [begin, end)?
+	 */
+	bool HasStrSlots(t_addr begin, t_addr end) const;
+
+	/**
+	 * call func(addr) for the addresses of the string handles in [begin, end)
+	 */
+	template<class t_func>
+	void ForEachStrSlot(t_addr begin, t_addr end, t_func&& func) const
+	{
+		// the bits are counted from the top of the memory
+		const std::size_t idx_begin = GetStrSlotIndex(std::min(end, m_memsize) - 1);
+		const std::size_t idx_end = std::min(GetStrSlotIndex(std::max(begin, t_addr{0}) - 1),
+			m_strslots.size()*64);
+
+		for(std::size_t word = idx_begin / 64; word*64 < idx_end; ++word)
+		{
+			std::uint64_t bits = m_strslots[word];
+			if(idx_begin > word*64)
+				bits &= ~std::uint64_t{0} << (idx_begin - word*64);
+			if(idx_end - word*64 < 64)
+				bits &= (std::uint64_t{1} << (idx_end - word*64)) - 1;
+
+			for(; bits; bits &= bits - 1)
+				func(m_memsize - 1 - static_cast<t_addr>(word*64 + std::countr_zero(bits)));
+		}
+	}
+
+	/**
+	 * get the position of an address in the string slot bitmap, which
+	 * starts at the top of the memory and only grows as far as the stack
+	 */
+	std::size_t GetStrSlotIndex(t_addr addr) const
+	{
+		return static_cast<std::size_t>(m_memsize - 1 - addr);
+	}
+
+	/**
+	 * mark or unmark the memory address of a string handle
+	 */
+	void SetStrSlot(t_addr addr, bool slot)
+	{
+		const std::size_t idx = GetStrSlotIndex(addr);
+		const std::uint64_t bit = std::uint64_t{1} << (idx % 64);
+
+		if(slot)
+		{
+			// the bitmap is enlarged once the stack reaches deeper than before
+			if(idx / 64 >= m_strslots.size()) [[unlikely]]
+				m_strslots.resize(std::max(idx / 64 + 1, m_strslots.size() * 2), 0);
+			m_strslots[idx / 64] |= bit;
+		}
+		else if(idx / 64 < m_strslots.size())
+		{
+			m_strslots[idx / 64] &= ~bit;
+		}
+	}
+
+	/**
+	 * is a string handle stored at the memory address?
+	 */
+	bool IsStrSlot(t_addr addr) const
+	{
+		const std::size_t idx = GetStrSlotIndex(addr);
+		return idx / 64 < m_strslots.size()
+			&& (m_strslots[idx / 64] & (std::uint64_t{1} << (idx % 64)));
+	}
+
+	/**
+	 * push the value of a register, pop a value into a register
+	 */
+	void PushRegister(t_addr reg);
+	void PopRegister(t_addr reg);
+
+	/**
+	 * apply a binary operator to the top value and a register
+	 */
+	void OpRegister(OpCode op, t_addr reg);
+
 	/**
 	 * push data onto the stack
 	 */
@@ -175,6 +556,52 @@ protected:
 	 */
 	void WriteMemData(t_addr addr, const t_data& data);
 
+	/**
+	 * write a string handle to memory, the memory takes over its reference
+	 */
+	void WriteMemStrHandle(t_addr addr, t_addr handle);
+
+	/**
+	 * get the handle of a string literal in the code
+	 */
+	t_addr GetStrLiteral(t_addr addr);
+
+	/**
+	 * release the references held by the string literal cache
+	 */
+	void ReleaseStrLiterals();
+
+
+	/**
+	 * get a pointer to the memory at the given address for reading,
+	 * which is either in the shared code or in the vm's own memory
+	 */
+	const t_byte* MemPtr(t_addr addr, std::size_t size = m_touchsize) const
+	{
+		if(addr < m_data_begin)
+			return m_code->GetData() + addr;
+
+		// pages shared with a forked vm are copied on their first use
+		if(m_mem.IsShared()) [[unlikely]]
+			m_mem.Touch(static_cast<std::size_t>(addr - m_data_begin), size);
+		return m_mem.Get() + (addr - m_data_begin);
+	}
+
+
+	/**
+	 * get a pointer to the vm's own memory at the given address,
+	 * the shared code cannot be written to
+	 */
+	t_byte* DataPtr(t_addr addr, std::size_t size = m_touchsize) const
+	{
+		if(addr < m_data_begin)
+			throw std::runtime_error("Tried to write to the shared code.");
+
+		if(m_mem.IsShared()) [[unlikely]]
+			m_mem.Touch(static_cast<std::size_t>(addr - m_data_begin), size);
+		return m_mem.Get() + (addr - m_data_begin);
+	}
+
 
 	/**
 	 * read a raw value from memory
@@ -189,7 +616,7 @@ protected:
 			addr += m_addrsize;
 
 			CheckMemoryBounds(addr, len);
-			t_char* begin = reinterpret_cast<t_char*>(&m_mem[addr]);
+			const t_char* begin = reinterpret_cast<const t_char*>(MemPtr(addr, len));
 
 			t_str str(begin, len);
 			return str;
@@ -199,7 +626,7 @@ protected:
 		else
 		{
 			CheckMemoryBounds(addr, sizeof(t_val));
-			t_val val = *reinterpret_cast<t_val*>(&m_mem[addr]);
+			t_val val = *reinterpret_cast<const t_val*>(MemPtr(addr));
 
 			return val;
 		}
@@ -223,7 +650,7 @@ protected:
 			addr += m_addrsize;
 
 			// write string
-			t_char* begin = reinterpret_cast<t_char*>(&m_mem[addr]);
+			t_char* begin = reinterpret_cast<t_char*>(DataPtr(addr, len));
 			std::memcpy(begin, val.data(), len*sizeof(t_char));
 		}
 
@@ -232,7 +659,7 @@ protected:
 		{
 			CheckMemoryBounds(addr, sizeof(t_val));
 
-			*reinterpret_cast<t_val*>(&m_mem[addr]) = val;
+			*reinterpret_cast<t_val*>(DataPtr(addr)) = val;
 		}
 	}
 
@@ -246,7 +673,7 @@ protected:
 		t_addr addr = m_sp + sp_offs;
 		CheckMemoryBounds(addr, valsize);
 
-		return *reinterpret_cast<t_val*>(m_mem.get() + addr);
+		return *reinterpret_cast<const t_val*>(MemPtr(addr));
 	}
 
 
@@ -258,7 +685,7 @@ protected:
 	{
 		CheckMemoryBounds(m_sp, valsize);
 
-		t_val *valptr = reinterpret_cast<t_val*>(m_mem.get() + m_sp);
+		t_val *valptr = reinterpret_cast<t_val*>(DataPtr(m_sp));
 		t_val val = *valptr;
 
 		if(m_zeropoppedvals)
@@ -276,10 +703,159 @@ protected:
 	template<class t_val, t_addr valsize = sizeof(t_val)>
 	void PushRaw(const t_val& val)
 	{
+		EnsureStack(valsize);
 		CheckMemoryBounds(m_sp, valsize);
 
 		m_sp -= valsize;	// stack grows to lower addresses
-		*reinterpret_cast<t_val*>(m_mem.get() + m_sp) = val;
+		*reinterpret_cast<t_val*>(DataPtr(m_sp)) = val;
+	}
+
+
+	/**
+	 * releases the strings borrowed by a native function call when it is left
+	 */
+	class NativeStrScope
+	{
+	public:
+		NativeStrScope(VM& vm) : m_vm{vm}, m_num_strs{vm.m_native_strs.size()}
+		{}
+
+		~NativeStrScope()
+		{
+			while(m_vm.m_native_strs.size() > m_num_strs)
+			{
+				m_vm.m_strheap.Release(m_vm.m_native_strs.back());
+				m_vm.m_native_strs.pop_back();
+			}
+		}
+
+		NativeStrScope(const NativeStrScope&) = delete;
+		NativeStrScope& operator=(const NativeStrScope&) = delete;
+
+
+	private:
+		VM& m_vm;
+		std::size_t m_num_strs{};
+	};
+
+
+	/**
+	 * get the vm type corresponding to a native type
+	 */
+	template<class t_val>
+	static constexpr VMType GetNativeType()
+	{
+		if constexpr(std::is_floating_point_v<t_val>)
+			return VMType::REAL;
+		else if constexpr(std::is_integral_v<t_val>)
+			return VMType::INT;
+		else if constexpr(std::is_same_v<t_val, t_str> ||
+			std::is_same_v<t_val, std::string_view>)
+			return VMType::STR;
+		else
+			return VMType::UNKNOWN;
+	}
+
+
+	/**
+	 * pop a native function argument without constructing a t_data variant
+	 */
+	template<class t_val>
+	t_val PopNative()
+	{
+		VMType ty = static_cast<VMType>(TopRaw<t_byte, m_bytesize>());
+
+		// numeric arguments
+		if constexpr(std::is_arithmetic_v<t_val>)
+		{
+			if(ty == VMType::REAL)
+			{
+				PopRaw<t_byte, m_bytesize>();
+				return static_cast<t_val>(PopRaw<t_real, m_realsize>());
+			}
+			else if(ty == VMType::INT)
+			{
+				PopRaw<t_byte, m_bytesize>();
+				return static_cast<t_val>(PopRaw<t_int, m_intsize>());
+			}
+
+			// convert strings, other values would not have the expected size
+			if(ty != VMType::STR)
+				throw std::runtime_error("Invalid type of native function argument.");
+
+			if constexpr(std::is_floating_point_v<t_val>)
+			{
+				OpCast<m_realidx>();
+				PopRaw<t_byte, m_bytesize>();
+				return static_cast<t_val>(PopRaw<t_real, m_realsize>());
+			}
+			else
+			{
+				OpCast<m_intidx>();
+				PopRaw<t_byte, m_bytesize>();
+				return static_cast<t_val>(PopRaw<t_int, m_intsize>());
+			}
+		}
+
+		// string arguments
+		else if constexpr(std::is_same_v<t_val, t_str> ||
+			std::is_same_v<t_val, std::string_view>)
+		{
+			if(ty != VMType::STR)
+				OpCast<m_stridx>();
+
+			PopRaw<t_byte, m_bytesize>();
+			t_addr handle = PopStrHandle();
+
+			if constexpr(std::is_same_v<t_val, std::string_view>)
+			{
+				// keep the string alive until the call is finished
+				m_native_strs.push_back(handle);
+				return std::string_view{m_strheap.Get(handle)};
+			}
+			else
+			{
+				t_str str = m_strheap.Get(handle);
+				m_strheap.Release(handle);
+				return str;
+			}
+		}
+
+		else
+		{
+			static_assert(!std::is_same_v<t_val, t_val>,
+				"Unsupported native argument type.");
+		}
+	}
+
+
+	/**
+	 * push a native function return value without constructing a t_data variant
+	 */
+	template<class t_val>
+	void PushNative(const t_val& val)
+	{
+		if constexpr(std::is_floating_point_v<t_val>)
+		{
+			PushRaw<t_real, m_realsize>(static_cast<t_real>(val));
+			PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::REAL));
+		}
+		else if constexpr(std::is_integral_v<t_val>)
+		{
+			PushRaw<t_int, m_intsize>(static_cast<t_int>(val));
+			PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::INT));
+		}
+		else if constexpr(std::is_same_v<t_val, t_str> ||
+			std::is_same_v<t_val, std::string_view>)
+		{
+			PushStrHandle(m_strheap.Intern(val));
+			PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+		}
+		else
+		{
+			static_assert(!std::is_same_v<t_val, t_val>,
+				"Unsupported native return type.");
+		}
 	}
 
 
@@ -290,14 +866,14 @@ protected:
 	void OpCast()
 	{
 		using t_to = std::variant_alternative_t<toidx, t_data>;
-		t_data data = TopData();
+		VMType ty = static_cast<VMType>(TopRaw<t_byte, m_bytesize>());
 
-		if(data.index() == m_realidx)
+		if(ty == VMType::REAL)
 		{
 			if constexpr(std::is_same_v<std::decay_t<t_to>, t_real>)
 				return;  // don't need to cast to the same type
 
-			t_real val = std::get<m_realidx>(data);
+			t_real val = TopRaw<t_real, m_realsize>(m_bytesize);
 
 			// convert to string
 			if constexpr(std::is_same_v<std::decay_t<t_to>, t_str>)
@@ -317,12 +893,12 @@ protected:
 					static_cast<t_to>(val)});
 			}
 		}
-		else if(data.index() == m_intidx)
+		else if(ty == VMType::INT)
 		{
 			if constexpr(std::is_same_v<std::decay_t<t_to>, t_int>)
 				return;  // don't need to cast to the same type
 
-			t_int val = std::get<m_intidx>(data);
+			t_int val = TopRaw<t_int, m_intsize>(m_bytesize);
 
 			// convert to string
 			if constexpr(std::is_same_v<std::decay_t<t_to>, t_str>)
@@ -342,16 +918,19 @@ protected:
 					static_cast<t_to>(val)});
 			}
 		}
-		else if(data.index() == m_stridx)
+		else if(ty == VMType::STR)
 		{
 			if constexpr(std::is_same_v<std::decay_t<t_to>, t_str>)
 				return;  // don't need to cast to the same type
 
-			const t_str& val = std::get<m_stridx>(data);
+			// parse the string directly from the heap
+			PopRaw<t_byte, m_bytesize>();
+			t_addr handle = PopStrHandle();
 
 			t_to conv_val{};
-			std::istringstream{val} >> conv_val;
-			PopData();
+			std::istringstream{m_strheap.Get(handle)} >> conv_val;
+			m_strheap.Release(handle);
+
 			PushData(t_data{std::in_place_index<toidx>,
 				conv_val});
 		}
@@ -402,6 +981,13 @@ protected:
 	template<char op>
 	void OpArithmetic()
 	{
+		// string operation, only the handles are touched
+		if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) == VMType::STR)
+		{
+			OpStrArithmetic<op>();
+			return;
+		}
+
 		t_data val2 = PopData();
 		t_data val1 = PopData();
 
@@ -438,6 +1024,38 @@ protected:
 	}
 
 
+	/**
+	 * arithmetic operation on string handles
+	 */
+	template<char op>
+	void OpStrArithmetic()
+	{
+		if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>(
+			m_bytesize + m_addrsize)) != VMType::STR)
+		{
+			throw std::runtime_error("Type mismatch in arithmetic operation. "
+				"Type indices: " + std::to_string(m_stridx) + " and other.");
+		}
+
+		PopRaw<t_byte, m_bytesize>();
+		t_addr handle2 = PopStrHandle();
+		PopRaw<t_byte, m_bytesize>();
+		t_addr handle1 = PopStrHandle();
+
+		t_addr result = 0;
+		if constexpr(op == '+')
+			result = m_strheap.Concat(handle1, handle2);
+		else
+			result = m_strheap.Intern("");
+
+		m_strheap.Release(handle1);
+		m_strheap.Release(handle2);
+
+		PushStrHandle(result);
+		PushRaw<t_byte, m_bytesize>(static_cast<t_byte>(VMType::STR));
+	}
+
+
 	/**
 	 * logical operation
 	 */
@@ -579,6 +1197,29 @@ protected:
 	template<OpCode op>
 	void OpComparison()
 	{
+		// string comparison, interned strings are equal if their handles are
+		if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) == VMType::STR &&
+			static_cast<VMType>(TopRaw<t_byte, m_bytesize>(
+				m_bytesize + m_addrsize)) == VMType::STR)
+		{
+			PopRaw<t_byte, m_bytesize>();
+			t_addr handle2 = PopStrHandle();
+			PopRaw<t_byte, m_bytesize>();
+			t_addr handle1 = PopStrHandle();
+
+			t_bool result = 0;
+			if constexpr(op == OpCode::EQU)
+				result = (handle1 == handle2);
+			else if constexpr(op == OpCode::NEQU)
+				result = (handle1 != handle2);
+
+			m_strheap.Release(handle1);
+			m_strheap.Release(handle2);
+
+			PushRaw<t_bool, m_boolsize>(result);
+			return;
+		}
+
 		t_data val2 = PopData();
 		t_data val1 = PopData();
 
@@ -616,50 +1257,272 @@ protected:
 
 
 	/**
-	 * sets the address of an interrupt service routine
+	 * remove the type descriptor of the value on top of the stack,
+	 * which has to be of the given type
 	 */
-	void SetISR(t_addr num, t_addr addr);
+	template<VMType ty>
+	void OpUntag()
+	{
+		if(static_cast<VMType>(TopRaw<t_byte, m_bytesize>()) != ty)
+		{
+			throw std::runtime_error(std::string("Type mismatch in untagged operation, expected ")
+				+ get_vm_type_name(ty) + ".");
+		}
+
+		PopRaw<t_byte, m_bytesize>();
+	}
+
+
+	/**
+	 * arithmetic operation on untagged ints or reals
+	 */
+	template<class t_val, char op>
+	void OpUntaggedArithmetic()
+	{
+		t_val val2 = PopRaw<t_val, sizeof(t_val)>();
+		t_val val1 = PopRaw<t_val, sizeof(t_val)>();
+		PushRaw<t_val, sizeof(t_val)>(OpArithmetic<t_val, op>(val1, val2));
+	}
+
+
+	/**
+	 * comparison of untagged ints or reals
+	 */
+	template<class t_val, OpCode op>
+	void OpUntaggedComparison()
+	{
+		t_val val2 = PopRaw<t_val, sizeof(t_val)>();
+		t_val val1 = PopRaw<t_val, sizeof(t_val)>();
+		PushRaw<t_bool, m_boolsize>(OpComparison<t_val, op>(val1, val2));
+	}
+
 
 	void StartTimer();
 	void StopTimer();
 
+	VMTimerWheel& GetTimerWheel()
+	{
+		return m_timerwheel ? *m_timerwheel : VMTimerWheel::GetInstance();
+	}
+
+
+	/**
+	 * natively compiled code block
+	 */
+	struct JitBlock
+	{
+		t_vm_jitfunc func{nullptr};        // native code, null if not compilable
+		bool compiled{false};              // was compilation tried?
+		t_addr counter{0};                 // how often was this address jumped to?
+		t_addr num_instrs{0};              // number of translated instructions
+	};
+
+	/**
+	 * count a jump or call from the interpreter to a target address
+	 * and promote the code region [target, end) once it becomes hot,
+	 * a negative end denotes the end of the function starting at the target
+	 */
+	void JitCount(t_addr target, t_addr end)
+	{
+		if(!m_jit || m_jit_threshold <= 0 || target < 0
+			|| static_cast<std::size_t>(target) >= m_jitblocks.size())
+			return;
+
+		if(++m_jitblocks[target].counter == m_jit_threshold)
+			JitPromote(target, end);
+	}
+
+	/**
+	 * mark a region as hot, its blocks are compiled when they are reached
+	 * (on-stack replacement happens at the next block start, e.g. the loop header)
+	 */
+	void JitPromote(t_addr begin, t_addr end);
+
+	/**
+	 * is the address part of a hot code region?
+	 */
+	bool JitIsHot(t_addr addr) const;
+
+	/**
+	 * get the end of the function starting at the given address
+	 */
+	t_addr JitFuncEnd(t_addr addr) const;
+
+	/**
+	 * run the native code block at the instruction pointer,
+	 * returns false if the interpreter has to run the next instruction
+	 */
+	bool RunJit(std::uint64_t& num_instrs);
+
+	/**
+	 * translate the code block starting at the given address
+	 */
+	t_vm_jitfunc JitCompile(t_addr addr, t_addr& num_instrs);
+
+	/**
+	 * remove all compiled code
+	 */
+	void JitReset();
+
+	/**
+	 * are there string handles in the memory range [begin, end)?
+	 */
+	static bool JitHasStrSlots(VM* vm, t_addr begin, t_addr end);
+
+
+	/**
+	 * stack frame of a running interrupt service routine
+	 */
+	struct IrqFrame
+	{
+		t_addr bp{};                       // base pointer of the routine
+		t_addr level{};                    // priority of the interrupted code
+		t_regfile regs{};                  // registers of the interrupted code
+	};
+
+	/**
+	 * get the highest-priority pending interrupt which may interrupt the
+	 * running code and has a service routine, the others without
+	 * service routine are dropped
+	 */
+	std::optional<t_addr> NextInterrupt();
+
+	/**
+	 * call and return from an interrupt service routine
+	 */
+	void CallInterrupt(t_addr irq, t_addr addr);
+	void ReturnFromInterrupt();
+
+	/**
+	 * save the instruction and base pointers and set up a stack frame of the
+	 * default size for a function or interrupt service routine
+	 */
+	void EnterFrame();
+
+	/**
+	 * replace the current stack frame and the function's arguments by a new
+	 * frame for a tail call, the arguments of the called function are kept
+	 */
+	void ReplaceFrame(t_addr num_args, t_addr num_callee_args);
+
+	/**
+	 * resize the current stack frame, its size is kept at its top
+	 */
+	void SetFrameSize(t_addr size);
+
+	/**
+	 * make sure that the given number of bytes can be pushed onto the stack
+	 */
+	void EnsureStack(t_addr size)
+	{
+		if(m_sp - size < m_stacklimit) [[unlikely]]
+			GrowStack(m_stacklimit - (m_sp - size));
+	}
+
+	/**
+	 * enlarge the memory by at least the given number of bytes and move the
+	 * stack to its new top, the addresses pointing into the stack are adjusted
+	 */
+	void GrowStack(t_addr missing);
+
+	/**
+	 * run until the program halts, the budget is used up or the deadline has passed
+	 */
+	RunState Execute(std::optional<std::uint64_t> max_instrs, std::optional<t_time> deadline);
+
+
+	/**
+	 * run the code with bounds checks again
+	 */
+	void ResetVerification();
+
 
 private:
-	void CheckMemoryBounds(t_addr addr, std::size_t size = 1) const;
+	/**
+	 * check a memory access unless the code has been verified
+	 */
+	void CheckMemoryBounds(t_addr addr, std::size_t size = 1) const
+	{
+		if(m_checks_active)
+			CheckMemoryRange(addr, size);
+	}
+
+	void CheckMemoryRange(t_addr addr, std::size_t size) const;
 	void CheckPointerBounds() const;
 	void UpdateCodeRange(t_addr begin, t_addr end);
 
-	void TimerFunc();
 
 
 private:
 	bool m_debug{false};               // write debug messages
 	bool m_checks{true};               // do memory boundary checks
+	bool m_verified{false};            // has the code passed the verifier?
+	bool m_checks_active{true};        // checks enabled and code not verified
 	bool m_drawmemimages{false};       // write memory dump images
 	bool m_zeropoppedvals{false};      // zero memory of popped values
+	bool m_jit{false};                 // run natively compiled code
+	t_addr m_jit_threshold{64};        // jumps needed for compiling a region, 0: compile all
+	std::uint64_t m_deadline_check{1024}; // instructions between looking at the clock
 	t_real m_eps{std::numeric_limits<t_real>::epsilon()};
 
-	std::unique_ptr<t_byte[]> m_mem{}; // ram
+	VMMemory m_mem{};                  // ram, starting at m_data_begin
+	std::shared_ptr<const VMCode> m_code{}; // shared code, if used
+	t_addr m_data_begin{0};            // start address of the vm's own memory
 	t_addr m_code_range[2]{-1, -1};    // address range where the code resides
 
+	// strings, only their handles are stored in memory
+	VMStrHeap m_strheap{};
+	// bitmap of the memory addresses holding string handles, each owning a reference,
+	// see GetStrSlotIndex
+	std::vector<std::uint64_t> m_strslots{};
+	// handles of the string literals, indexed by their code address
+	std::unordered_map<t_addr, t_addr> m_strlits{};
+
 	// registers
 	t_addr m_ip{};                     // instruction pointer
 	t_addr m_sp{};                     // stack pointer
 	t_addr m_bp{};                     // base pointer for local variables
 	t_addr m_gbp{};                    // global base pointer
+	alignas(8) t_regfile m_regfile{};  // registers holding local variables
 
 	// memory sizes and ranges
 	t_addr m_memsize = 0x1000;         // total memory size
-	t_addr m_framesize = 0x100;        // size per function stack frame
-
-	// signals interrupt requests
-	std::array<std::atomic_bool, m_num_interrupts> m_irqs{};
+	t_addr m_maxmemsize = 0x4000000;   // size up to which the memory grows
+	t_addr m_framesize = 0x100;        // default stack frame size, functions can resize it
+	t_addr m_stacklimit{0};            // lowest address the stack may use
+
+	// bit mask of the requested interrupts
+	std::atomic<std::uint32_t> m_irqs_pending{0};
+	// priority of the running interrupt service routine (lower is higher),
+	// m_num_interrupts if none is running
+	t_addr m_irq_level{m_num_interrupts};
+	// stack frames of the running, possibly nested, interrupt service routines
+	std::vector<IrqFrame> m_irq_frames{};
 	// addresses of the interrupt service routines
 	std::array<std::optional<t_addr>, m_num_interrupts> m_isrs{};
-
-	std::thread m_timer_thread{};
-	bool m_timer_running{false};
-	std::chrono::milliseconds m_timer_ticks{250};
+	// verified entries which can be used as interrupt service routines
+	std::unordered_set<t_addr> m_verified_isrs{};
+
+	// registry of external functions
+	std::vector<ExtFuncInfo> m_extfuncs{};
+	std::unordered_map<t_str, t_addr> m_extfunc_indices{};
+	// string handles held by arguments of a native function call
+	std::vector<t_addr> m_native_strs{};
+
+	// natively compiled code blocks, indexed by their code address
+	std::vector<JitBlock> m_jitblocks{};
+	// hot code regions [begin, end) whose blocks are compiled
+	std::vector<std::array<t_addr, 2>> m_jithot{};
+	JitMemory m_jitmem{};
+	VMJitRegs m_jitregs{};
+
+	// execution profile, if enabled
+	std::unique_ptr<VMProfiler> m_profiler{};
+
+	// periodic timer interrupt, registered with the given or the process-wide timer wheel
+	std::shared_ptr<VMTimerWheel> m_timerwheel{};
+	std::optional<VMTimerWheel::t_id> m_timer{};
+	VMTimerWheel::t_duration m_timer_period{std::chrono::milliseconds{250}};
 };
 
 
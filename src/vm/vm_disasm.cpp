@@ -0,0 +1,202 @@
+/**
+ * listing of the vm code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "vm.h"
+
+#include <iomanip>
+
+
+/**
+ * read an operand, nullopt if the code ends before it
+ */
+template<class t_val>
+static std::optional<t_val> read_operand(const VM::t_byte* code, VM::t_addr size, VM::t_addr addr)
+{
+	if(addr < 0 || addr + VM::t_addr(sizeof(t_val)) > size)
+		return std::nullopt;
+
+	t_val val{};
+	std::memcpy(&val, code + addr, sizeof(t_val));
+	return val;
+}
+
+
+/**
+ * write the instructions of the code with their addresses and operands
+ */
+void VM::Disassemble(std::ostream& ostr, const t_byte* code, t_addr size)
+{
+	const std::ios_base::fmtflags flags = ostr.flags();
+
+	for(t_addr addr=0; addr<size;)
+	{
+		const OpCode op = static_cast<OpCode>(code[addr]);
+		ostr << std::right << std::setw(8) << addr << ": " << get_vm_opcode_name(op);
+
+		t_addr len = m_bytesize;
+		bool complete = true;
+
+		switch(op)
+		{
+			case OpCode::PUSH:
+			{
+				std::optional<t_byte> ty = read_operand<t_byte>(code, size, addr + len);
+				if(!(complete = ty.has_value()))
+					break;
+				len += m_bytesize;
+
+				switch(static_cast<VMType>(*ty))
+				{
+					case VMType::INT:
+					{
+						std::optional<t_int> val = read_operand<t_int>(code, size, addr + len);
+						if((complete = val.has_value()))
+							ostr << " int " << *val;
+						len += m_intsize;
+						break;
+					}
+					case VMType::REAL:
+					{
+						std::optional<t_real> val = read_operand<t_real>(code, size, addr + len);
+						if((complete = val.has_value()))
+							ostr << " real " << *val;
+						len += m_realsize;
+						break;
+					}
+					case VMType::BOOLEAN:
+					{
+						std::optional<t_bool> val = read_operand<t_bool>(code, size, addr + len);
+						if((complete = val.has_value()))
+							ostr << " bool " << int(*val);
+						len += m_boolsize;
+						break;
+					}
+					case VMType::STR:
+					{
+						std::optional<t_addr> strlen = read_operand<t_addr>(code, size, addr + len);
+						len += m_addrsize;
+						if(!(complete = (strlen && *strlen >= 0 && addr + len + *strlen <= size)))
+							break;
+
+						// one line per instruction
+						ostr << " string \"";
+						for(t_addr idx=0; idx<*strlen; ++idx)
+						{
+							const char c = static_cast<char>(code[addr + len + idx]);
+							if(c == '\n')
+								ostr << "\\n";
+							else if(c == '\t')
+								ostr << "\\t";
+							else
+								ostr << c;
+						}
+						ostr << "\"";
+						len += *strlen;
+						break;
+					}
+					case VMType::ADDR_MEM:
+					case VMType::ADDR_IP:
+					case VMType::ADDR_SP:
+					case VMType::ADDR_BP:
+					case VMType::ADDR_GBP:
+					case VMType::ADDR_BP_ARG:
+					{
+						std::optional<t_addr> offs = read_operand<t_addr>(code, size, addr + len);
+						if((complete = offs.has_value()))
+						{
+							ostr << " " << get_vm_base_reg(static_cast<VMType>(*ty))
+								<< " " << *offs;
+						}
+						len += m_addrsize;
+						break;
+					}
+					default:
+						ostr << " " << get_vm_type_name(static_cast<VMType>(*ty));
+						break;
+				}
+				break;
+			}
+
+			case OpCode::PUSHI:
+			{
+				std::optional<t_int> val = read_operand<t_int>(code, size, addr + len);
+				if((complete = val.has_value()))
+					ostr << " " << *val;
+				len += m_intsize;
+				break;
+			}
+
+			case OpCode::PUSHF:
+			{
+				std::optional<t_real> val = read_operand<t_real>(code, size, addr + len);
+				if((complete = val.has_value()))
+					ostr << " " << *val;
+				len += m_realsize;
+				break;
+			}
+
+			case OpCode::LDR:
+			case OpCode::STR:
+			{
+				std::optional<t_byte> reg = read_operand<t_byte>(code, size, addr + len);
+				if((complete = reg.has_value()))
+					ostr << " r" << int(*reg);
+				len += m_bytesize;
+				break;
+			}
+
+			case OpCode::OPR:
+			{
+				std::optional<t_byte> regop = read_operand<t_byte>(code, size, addr + len);
+				std::optional<t_byte> reg = read_operand<t_byte>(code, size, addr + len + m_bytesize);
+				if((complete = (regop && reg)))
+				{
+					ostr << " " << get_vm_opcode_name(static_cast<OpCode>(*regop))
+						<< ", r" << int(*reg);
+				}
+				len += 2*m_bytesize;
+				break;
+			}
+
+			case OpCode::FRAME:
+			case OpCode::EXTCALLI:
+			{
+				std::optional<t_addr> val = read_operand<t_addr>(code, size, addr + len);
+				if((complete = val.has_value()))
+					ostr << " " << *val;
+				len += m_addrsize;
+				break;
+			}
+
+			case OpCode::TAILCALL:
+			{
+				// numbers of arguments of the current and of the called function
+				std::optional<t_addr> num_args = read_operand<t_addr>(code, size, addr + len);
+				std::optional<t_addr> num_callee_args = read_operand<t_addr>(
+					code, size, addr + len + m_addrsize);
+				if((complete = (num_args && num_callee_args)))
+					ostr << " " << *num_args << ", " << *num_callee_args;
+				len += 2*m_addrsize;
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		if(!complete)
+		{
+			ostr << " <incomplete>\n";
+			break;
+		}
+
+		ostr << "\n";
+		addr += len;
+	}
+
+	ostr.flags(flags);
+}
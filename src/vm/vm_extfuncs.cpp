@@ -9,127 +9,258 @@
 
 
 /**
- * call external function
+ * register an external function and get its index,
+ * an already registered function of the same name is replaced
  */
-VM::t_data VM::CallExternal(const t_str& func_name)
+VM::t_addr VM::RegisterExternal(const t_str& name,
+	const std::vector<VMType>& args, VMType ret,
+	const t_extfunc& func)
 {
-	t_data retval;
+	ExtFuncInfo info
+	{
+		.name = name,
+		.args = args,
+		.ret = ret,
+
+		// cast and pop the arguments, call the function and push its result
+		.call = [args, ret, func](VM& vm)
+		{
+			t_extargs argvals;
+			argvals.reserve(args.size());
+
+			for(VMType argty : args)
+				argvals.emplace_back(vm.PopExternalArg(argty));
+
+			// only functions with a return type push a value,
+			// the verifier relies on this
+			t_data retval = func(vm, argvals);
+			if(ret != VMType::UNKNOWN)
+				vm.PushData(retval, ret);
+		},
+	};
+
+	return AddExternal(std::move(info));
+}
+
+
+/**
+ * add an entry to the registry of external functions
+ */
+VM::t_addr VM::AddExternal(ExtFuncInfo&& info)
+{
+	// the verified code might call the function with other arguments
+	ResetVerification();
+
+	// replace an existing function
+	if(auto iter = m_extfunc_indices.find(info.name); iter != m_extfunc_indices.end())
+	{
+		m_extfuncs[iter->second] = std::move(info);
+		return iter->second;
+	}
+
+	t_addr idx = static_cast<t_addr>(m_extfuncs.size());
+	m_extfunc_indices.emplace(info.name, idx);
+	m_extfuncs.emplace_back(std::move(info));
+
+	return idx;
+}
+
+
+/**
+ * get the index of a registered external function
+ */
+std::optional<VM::t_addr> VM::GetExternalIndex(const t_str& name) const
+{
+	if(auto iter = m_extfunc_indices.find(name); iter != m_extfunc_indices.end())
+		return iter->second;
+
+	return std::nullopt;
+}
+
+
+/**
+ * pop an external function argument and cast it to the given type
+ */
+VM::t_data VM::PopExternalArg(VMType ty)
+{
+	switch(ty)
+	{
+		case VMType::REAL:
+			OpCast<m_realidx>();
+			break;
+		case VMType::INT:
+			OpCast<m_intidx>();
+			break;
+		case VMType::STR:
+			OpCast<m_stridx>();
+			break;
+		case VMType::ADDR_MEM:
+		case VMType::ADDR_IP:
+		case VMType::ADDR_SP:
+		case VMType::ADDR_BP:
+		case VMType::ADDR_GBP:
+			return t_data{std::in_place_index<m_addridx>, PopAddress()};
+		default:
+			break;
+	}
+
+	return PopData();
+}
+
+
+/**
+ * call external function by its name
+ */
+void VM::CallExternal(const t_str& func_name)
+{
+	std::optional<t_addr> func_idx = GetExternalIndex(func_name);
+	if(!func_idx)
+		throw std::runtime_error("Unknown external function \"" + func_name + "\".");
+
+	CallExternal(*func_idx);
+}
+
+
+/**
+ * call external function by its index
+ */
+void VM::CallExternal(t_addr func_idx)
+{
+	if(func_idx < 0 || func_idx >= static_cast<t_addr>(m_extfuncs.size()))
+	{
+		std::ostringstream msg;
+		msg << "Invalid external function index " << func_idx << ".";
+		throw std::runtime_error(msg.str());
+	}
+
+	const ExtFuncInfo& func = m_extfuncs[func_idx];
 
 	if(m_debug)
 	{
-		std::cout << "Calling external function \"" << func_name << "\""
-			//<< " with " << num_args << " arguments."
+		std::cout << "Calling external function \"" << func.name << "\""
+			<< " (index " << func_idx << ")"
+			<< " with " << func.args.size() << " arguments."
 			<< std::endl;
 	}
 
-	if(func_name == "sqrt")
+	func.call(*this);
+}
+
+
+/**
+ * register a built-in function and check its index
+ */
+void VM::RegisterBuiltin(ExtFunc func,
+	const std::vector<VMType>& args, VMType ret,
+	const t_extfunc& impl)
+{
+	CheckBuiltinIndex(func, RegisterExternal(
+		get_vm_extfunc_name(func), args, ret, impl));
+}
+
+
+void VM::CheckBuiltinIndex(ExtFunc func, t_addr idx) const
+{
+	if(idx != static_cast<t_addr>(func))
+		throw std::logic_error("Mismatching index of built-in function.");
+}
+
+
+/**
+ * register the built-in external functions,
+ * their order has to match the indices in extfuncs.h
+ */
+void VM::RegisterBuiltins()
+{
+	RegisterBuiltin(ExtFunc::SQRT, +[](t_real val) -> t_real
 	{
-		OpCast<m_realidx>();
-		t_real arg = std::get<m_realidx>(PopData());
+		return std::sqrt(val);
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>, std::sqrt(arg)};
-	}
-	else if(func_name == "pow")
+	RegisterBuiltin(ExtFunc::POW, +[](t_real base, t_real exp) -> t_real
 	{
-		OpCast<m_realidx>();
-		t_real arg1 = std::get<m_realidx>(PopData());
-		OpCast<m_realidx>();
-		t_real arg2 = std::get<m_realidx>(PopData());
+		return std::pow(base, exp);
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>,
-			std::pow(arg1, arg2)};
-	}
-	else if(func_name == "sin")
+	RegisterBuiltin(ExtFunc::SIN, +[](t_real val) -> t_real
 	{
-		OpCast<m_realidx>();
-		t_real arg = std::get<m_realidx>(PopData());
+		return std::sin(val);
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>,
-			std::sin(arg)};
-	}
-	else if(func_name == "cos")
+	RegisterBuiltin(ExtFunc::COS, +[](t_real val) -> t_real
 	{
-		OpCast<m_realidx>();
-		t_real arg = std::get<m_realidx>(PopData());
+		return std::cos(val);
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>,
-			std::cos(arg)};
-	}
-	else if(func_name == "tan")
+	RegisterBuiltin(ExtFunc::TAN, +[](t_real val) -> t_real
 	{
-		OpCast<m_realidx>();
-		t_real arg = std::get<m_realidx>(PopData());
+		return std::tan(val);
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>,
-			std::tan(arg)};
-	}
-	else if(func_name == "set_eps")
+	RegisterBuiltin(ExtFunc::SET_EPS, { VMType::REAL }, VMType::UNKNOWN,
+		[](VM& vm, const t_extargs& args) -> t_data
 	{
-		OpCast<m_realidx>();
-		m_eps = std::get<m_realidx>(PopData());
-	}
-	else if(func_name == "get_eps")
+		vm.m_eps = std::get<m_realidx>(args[0]);
+		return t_data{};
+	});
+
+	RegisterBuiltin(ExtFunc::GET_EPS, {}, VMType::REAL,
+		[](VM& vm, const t_extargs&) -> t_data
 	{
-		retval = t_data{std::in_place_index<m_realidx>, m_eps};
-	}
-	else if(func_name == "print")
+		return t_data{std::in_place_index<m_realidx>, vm.m_eps};
+	});
+
+	RegisterBuiltin(ExtFunc::PRINT, +[](std::string_view str) -> void
 	{
-		OpCast<m_stridx>();
-		const t_str/*&*/ arg = std::get<m_stridx>(PopData());
-		std::cout << arg;
+		std::cout << str;
 		std::cout.flush();
-	}
-	else if(func_name == "println")
+	});
+
+	RegisterBuiltin(ExtFunc::PRINTLN, +[](std::string_view str) -> void
 	{
-		OpCast<m_stridx>();
-		const t_str/*&*/ arg = std::get<m_stridx>(PopData());
-		std::cout << arg << std::endl;
-	}
-	else if(func_name == "input_real")
+		std::cout << str << std::endl;
+	});
+
+	RegisterBuiltin(ExtFunc::INPUT_REAL, +[]() -> t_real
 	{
 		t_real val{};
 		std::cin >> val;
+		return val;
+	});
 
-		retval = t_data{std::in_place_index<m_realidx>, val};
-	}
-	else if(func_name == "input_int")
+	RegisterBuiltin(ExtFunc::INPUT_INT, +[]() -> t_int
 	{
 		t_int val{};
 		std::cin >> val;
+		return val;
+	});
 
-		retval = t_data{std::in_place_index<m_intidx>, val};
-	}
-	else if(func_name == "set_isr")
+	RegisterBuiltin(ExtFunc::SET_ISR, { VMType::INT, VMType::ADDR_MEM }, VMType::UNKNOWN,
+		[](VM& vm, const t_extargs& args) -> t_data
 	{
-		OpCast<m_intidx>();
-		t_addr num = static_cast<t_addr>(std::get<m_intidx>(PopData()));
-		t_addr addr = PopAddress();
+		t_addr num = static_cast<t_addr>(std::get<m_intidx>(args[0]));
+		t_addr addr = std::get<m_addridx>(args[1]);
 
-		SetISR(num, addr);
-	}
-	else if(func_name == "sleep")
-	{
-		OpCast<m_intidx>();
-		t_int num = std::get<m_intidx>(PopData());
+		vm.SetISR(num, addr);
+		return t_data{};
+	});
 
-		std::chrono::milliseconds ms{num};
+	RegisterBuiltin(ExtFunc::SLEEP, +[](t_int delay) -> void
+	{
+		std::chrono::milliseconds ms{delay};
 		std::this_thread::sleep_for(ms);
-	}
-	else if(func_name == "set_timer")
+	});
+
+	RegisterBuiltin(ExtFunc::SET_TIMER, { VMType::INT }, VMType::UNKNOWN,
+		[](VM& vm, const t_extargs& args) -> t_data
 	{
-		OpCast<m_intidx>();
-		t_int delay = std::get<m_intidx>(PopData());
+		t_int delay = std::get<m_intidx>(args[0]);
 
 		if(delay < 0)
-		{
-			StopTimer();
-		}
+			vm.SetTimer(std::nullopt);
 		else
-		{
-			m_timer_ticks = std::chrono::milliseconds{delay};
-			StartTimer();
-		}
-	}
+			vm.SetTimer(std::chrono::milliseconds{delay});
 
-	return retval;
+		return t_data{};
+	});
 }
@@ -0,0 +1,1686 @@
+/**
+ * baseline jit compiler translating vm code blocks to x86-64 machine code
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * A block starts at a given code address and extends up to the first
+ * jump, call, return or unsupported instruction. The vm stack stays in
+ * the vm memory with the same layout as in the interpreter, so the native
+ * code can leave to the interpreter before any instruction: if an operand
+ * has a type which is not handled natively (e.g. a string) the block
+ * stores the current registers and returns, and the interpreter
+ * continues at this instruction. The operations on untagged ints and
+ * reals need no such guards, only the removal of a type descriptor does.
+ *
+ * Only hot code is compiled: the interpreter counts backward jumps
+ * (loops) and calls per target address. Once a target reaches the
+ * threshold, the loop body or function becomes a hot region and its
+ * blocks are compiled when they are next reached, so a running loop
+ * switches to native code at its header.
+ *
+ * Register assignment in the native code:
+ *   rbx: VMJitRegs*,  r12: memory,  r13: sp,  r14: bp,  r15: gbp
+ */
+
+#include "vm.h"
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+
+#if LR1_VM_JIT_X86 != 0
+
+namespace {
+
+using t_addr = VM::t_addr;
+using t_int = VM::t_int;
+using t_real = VM::t_real;
+using t_byte = VM::t_byte;
+using t_label = X86Emitter::t_label;
+
+
+// register assignment
+constexpr const X86Reg g_reg_regs = X86Reg::RBX;
+constexpr const X86Reg g_reg_mem = X86Reg::R12;
+constexpr const X86Reg g_reg_sp = X86Reg::R13;
+constexpr const X86Reg g_reg_bp = X86Reg::R14;
+constexpr const X86Reg g_reg_gbp = X86Reg::R15;
+
+// opcode extensions of the x86 arithmetic instructions
+constexpr const std::uint8_t g_alu_add = 0;
+constexpr const std::uint8_t g_alu_or = 1;
+constexpr const std::uint8_t g_alu_and = 4;
+constexpr const std::uint8_t g_alu_sub = 5;
+constexpr const std::uint8_t g_alu_xor = 6;
+constexpr const std::uint8_t g_alu_cmp = 7;
+
+constexpr const std::uint8_t g_shift_rol = 0;
+constexpr const std::uint8_t g_shift_ror = 1;
+constexpr const std::uint8_t g_shift_shl = 4;
+constexpr const std::uint8_t g_shift_sar = 7;
+
+constexpr const std::uint8_t g_bit_btr = 6;
+constexpr const std::uint8_t g_bit_btc = 7;
+
+// opcodes of the scalar double instructions
+constexpr const std::uint8_t g_sse_movsd = 0x10;
+constexpr const std::uint8_t g_sse_add = 0x58;
+constexpr const std::uint8_t g_sse_mul = 0x59;
+constexpr const std::uint8_t g_sse_sub = 0x5c;
+constexpr const std::uint8_t g_sse_div = 0x5e;
+
+// size of an int or real value including its type descriptor
+constexpr const t_addr g_valsize = VM::m_bytesize + VM::m_intsize;
+static_assert(VM::m_intsize == VM::m_realsize, "Int and real need to have the same size.");
+
+// size of an address including its type descriptor
+constexpr const t_addr g_addrsize = VM::m_bytesize + VM::m_addrsize;
+
+// maximum number of arguments handled natively
+constexpr const t_addr g_max_args = 16;
+
+// maximum number of instructions per block
+constexpr const std::size_t g_max_instrs = 1024;
+
+
+constexpr t_byte vm_type(VMType ty)
+{
+	return static_cast<t_byte>(ty);
+}
+
+
+constexpr bool is_addr_type(VMType ty)
+{
+	switch(ty)
+	{
+		case VMType::ADDR_MEM:
+		case VMType::ADDR_IP:
+		case VMType::ADDR_SP:
+		case VMType::ADDR_BP:
+		case VMType::ADDR_GBP:
+		case VMType::ADDR_BP_ARG:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+
+/**
+ * compiles a single block of vm code
+ */
+class JitBlockCompiler
+{
+public:
+	using t_helper = bool (*)(VM* vm, t_addr begin, t_addr end);
+
+
+public:
+	JitBlockCompiler(const t_byte* code, t_addr codesize,
+		t_addr membegin, t_addr memsize, t_addr framesize,
+		t_addr start, t_helper has_str_slots)
+		: m_code{code}, m_codesize{codesize},
+			m_membegin{membegin}, m_memsize{memsize}, m_framesize{framesize},
+			m_start{start}, m_has_str_slots{has_str_slots}
+	{}
+
+	JitBlockCompiler(const JitBlockCompiler&) = delete;
+	JitBlockCompiler& operator=(const JitBlockCompiler&) = delete;
+
+
+	/**
+	 * compile the block, returns false if not even
+	 * its first instruction could be translated
+	 */
+	bool Compile()
+	{
+		EmitPrologue();
+
+		t_addr ip = m_start;
+		while(CompileInstruction(ip))
+		{
+			// limit the block size
+			if(++m_num_instrs >= g_max_instrs)
+			{
+				EndBlockAt(ip);
+				break;
+			}
+		}
+
+		if(m_empty)
+			return false;
+
+		EmitExits();
+		EmitEpilogue();
+
+		// the stack is accessed in the range [sp + minoff, sp + maxoff)
+		m_x.Patch32(m_minoff_pos, m_minoff);
+		m_x.Patch32(m_maxoff_pos, m_maxoff);
+
+		return true;
+	}
+
+
+	std::size_t GetNumInstrs() const
+	{
+		return m_num_instrs;
+	}
+
+
+	const std::vector<t_byte>& GetCode() const
+	{
+		return m_x.GetCode();
+	}
+
+
+protected:
+	/**
+	 * stack operand relative to the current stack pointer
+	 */
+	X86Mem Stack(t_addr offs) const
+	{
+		return X86Mem{g_reg_mem, g_reg_sp, m_spoff + offs};
+	}
+
+
+	/**
+	 * memory operand at an address held in a register
+	 */
+	static X86Mem Mem(X86Reg addr, t_addr offs = 0)
+	{
+		return X86Mem{g_reg_mem, addr, offs};
+	}
+
+
+	/**
+	 * operand in the shared register structure
+	 */
+	static X86Mem Regs(std::size_t offs)
+	{
+		return X86Mem{g_reg_regs, std::nullopt, static_cast<std::int32_t>(offs)};
+	}
+
+
+	/**
+	 * read from the code
+	 */
+	template<class t_val>
+	std::optional<t_val> ReadCode(t_addr addr) const
+	{
+		if(addr < 0 || addr + static_cast<t_addr>(sizeof(t_val)) > m_codesize)
+			return std::nullopt;
+
+		t_val val{};
+		std::memcpy(&val, m_code + addr, sizeof(t_val));
+		return val;
+	}
+
+
+	std::optional<OpCode> ReadOp(t_addr addr) const
+	{
+		std::optional<t_byte> op = ReadCode<t_byte>(addr);
+		if(!op)
+			return std::nullopt;
+		return static_cast<OpCode>(*op);
+	}
+
+
+	/**
+	 * the current instruction accesses the stack range [sp + begin, sp + end)
+	 */
+	void Access(t_addr begin, t_addr end)
+	{
+		m_minoff = std::min(m_minoff, m_spoff + begin);
+		m_maxoff = std::max(m_maxoff, m_spoff + end);
+	}
+
+
+	/**
+	 * leave the native code and continue in the interpreter at the given address
+	 */
+	void ExitIf(X86Cond cond, t_addr ip)
+	{
+		m_exits.emplace_back(Exit{m_x.Jcc(cond), ip, m_exit_spoff.value_or(m_spoff)});
+	}
+
+
+	void ExitTo(t_addr ip)
+	{
+		m_exits.emplace_back(Exit{m_x.Jmp(), ip, m_exit_spoff.value_or(m_spoff)});
+	}
+
+
+	/**
+	 * write the deferred stack pointer changes to the sp register
+	 */
+	void MaterialiseSP()
+	{
+		if(m_spoff != 0)
+			m_x.Lea64(g_reg_sp, X86Mem{g_reg_sp, std::nullopt, m_spoff});
+		m_spoff = 0;
+	}
+
+
+	/**
+	 * end the block with the next instruction pointer already set
+	 */
+	void EndBlock()
+	{
+		MaterialiseSP();
+		m_x.MovImm64(X86Reg::RAX, 1);
+		m_to_epilogue.push_back(m_x.Jmp());
+	}
+
+
+	/**
+	 * end the block, continuing in the interpreter at the given address
+	 */
+	void EndBlockAt(t_addr ip)
+	{
+		// not even the first instruction could be compiled?
+		if(ip == m_start)
+			m_empty = true;
+
+		m_x.MovImm32(Regs(offsetof(VMJitRegs, ip)), ip);
+		EndBlock();
+	}
+
+
+	void EmitPrologue()
+	{
+		m_x.Push(X86Reg::RBX);
+		m_x.Push(X86Reg::R12);
+		m_x.Push(X86Reg::R13);
+		m_x.Push(X86Reg::R14);
+		m_x.Push(X86Reg::R15);
+
+		// load the vm registers
+		m_x.Mov64(g_reg_regs, X86Reg::RDI);
+		m_x.Mov64(g_reg_mem, Regs(offsetof(VMJitRegs, mem)));
+		m_x.Movsxd(g_reg_sp, Regs(offsetof(VMJitRegs, sp)));
+		m_x.Movsxd(g_reg_bp, Regs(offsetof(VMJitRegs, bp)));
+		m_x.Movsxd(g_reg_gbp, Regs(offsetof(VMJitRegs, gbp)));
+
+		// check the stack range used by the block, the offsets are patched later
+		m_x.Lea64(X86Reg::RAX, X86Mem{g_reg_sp, std::nullopt, 0});
+		m_minoff_pos = m_x.GetPos() - sizeof(std::int32_t);
+		m_x.Movsxd(X86Reg::RCX, Regs(offsetof(VMJitRegs, stacklimit)));
+		m_x.Alu64(g_alu_cmp, X86Reg::RAX, X86Reg::RCX);
+		ExitIf(X86Cond::L, m_start);
+
+		m_x.Lea64(X86Reg::RAX, X86Mem{g_reg_sp, std::nullopt, 0});
+		m_maxoff_pos = m_x.GetPos() - sizeof(std::int32_t);
+		m_x.AluImm64(g_alu_cmp, X86Reg::RAX, m_memsize);
+		ExitIf(X86Cond::G, m_start);
+	}
+
+
+	void EmitEpilogue()
+	{
+		for(t_label label : m_to_epilogue)
+			m_x.Bind(label);
+
+		// store the vm registers, the instruction pointer is already set
+		m_x.Mov32(Regs(offsetof(VMJitRegs, sp)), g_reg_sp);
+		m_x.Mov32(Regs(offsetof(VMJitRegs, bp)), g_reg_bp);
+
+		m_x.Pop(X86Reg::R15);
+		m_x.Pop(X86Reg::R14);
+		m_x.Pop(X86Reg::R13);
+		m_x.Pop(X86Reg::R12);
+		m_x.Pop(X86Reg::RBX);
+		m_x.Ret();
+	}
+
+
+	/**
+	 * emit the code for leaving the block to the interpreter
+	 */
+	void EmitExits()
+	{
+		std::sort(m_exits.begin(), m_exits.end(), [](const Exit& exit1, const Exit& exit2)
+		{
+			return std::tie(exit1.ip, exit1.spoff) < std::tie(exit2.ip, exit2.spoff);
+		});
+
+		for(std::size_t idx=0; idx<m_exits.size(); ++idx)
+		{
+			const Exit& exit = m_exits[idx];
+			m_x.Bind(exit.label);
+
+			// exits to the same state share their code
+			if(idx+1 < m_exits.size() && m_exits[idx+1].ip == exit.ip &&
+				m_exits[idx+1].spoff == exit.spoff)
+				continue;
+
+			m_spoff = exit.spoff;
+			MaterialiseSP();
+
+			m_x.MovImm32(Regs(offsetof(VMJitRegs, ip)), exit.ip);
+			// leaving at the first instruction means no progress was made
+			m_x.MovImm64(X86Reg::RAX, exit.ip == m_start ? 0 : 1);
+			m_to_epilogue.push_back(m_x.Jmp());
+		}
+	}
+
+
+	/**
+	 * can the address be handled natively?
+	 */
+	static bool IsSupportedAddress(VMType ty, t_addr offs)
+	{
+		if(ty == VMType::ADDR_BP_ARG)
+			return offs >= 0 && offs <= g_max_args;
+		return is_addr_type(ty);
+	}
+
+
+	/**
+	 * get the absolute address of a memory operand in rcx
+	 * @param ip address to continue at in case of errors
+	 * @param ip_next instruction pointer after the instruction using the address
+	 */
+	void LoadAddress(VMType ty, t_addr offs, t_addr ip, t_addr ip_next)
+	{
+		switch(ty)
+		{
+			case VMType::ADDR_MEM:
+				m_x.MovImm64(X86Reg::RCX, offs);
+				break;
+			case VMType::ADDR_IP:
+				m_x.MovImm64(X86Reg::RCX, offs + ip_next);
+				break;
+			case VMType::ADDR_SP:
+				m_x.Lea64(X86Reg::RCX, X86Mem{g_reg_sp, std::nullopt, m_spoff + offs});
+				break;
+			case VMType::ADDR_BP:
+				m_x.Lea64(X86Reg::RCX, X86Mem{g_reg_bp, std::nullopt, offs});
+				break;
+			case VMType::ADDR_GBP:
+				m_x.Lea64(X86Reg::RCX, X86Mem{g_reg_gbp, std::nullopt, offs});
+				break;
+			case VMType::ADDR_BP_ARG:
+			{
+				// skip the given number of values, see VM::GetArgAddr
+				m_x.Mov64(X86Reg::RCX, g_reg_bp);
+				for(t_addr arg=0; arg<offs; ++arg)
+				{
+					CheckAddress(X86Reg::RCX, 1, ip);
+
+					m_x.Movzx8(X86Reg::RAX, Mem(X86Reg::RCX));
+					m_x.Movzx8(X86Reg::RDX, X86Mem{g_reg_regs, X86Reg::RAX,
+						static_cast<std::int32_t>(offsetof(VMJitRegs, argsizes))});
+					m_x.Test64(X86Reg::RDX, X86Reg::RDX);
+					ExitIf(X86Cond::E, ip);
+					m_x.Alu64(g_alu_add, X86Reg::RCX, X86Reg::RDX);
+				}
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+
+	/**
+	 * check that the value at the address in rcx is within the memory bounds
+	 */
+	void CheckValueBounds(t_addr ip)
+	{
+		CheckAddress(X86Reg::RCX, g_valsize, ip);
+	}
+
+
+	/**
+	 * leave the block if a value of the given size at the address in
+	 * the register is not within the vm's own memory (i.e. not in a shared code)
+	 */
+	void CheckAddress(X86Reg reg, t_addr size, t_addr ip)
+	{
+		if(m_membegin == 0)
+		{
+			m_x.AluImm64(g_alu_cmp, reg, m_memsize - size);
+		}
+		else
+		{
+			m_x.Lea64(X86Reg::R11, X86Mem{reg, std::nullopt, -m_membegin});
+			m_x.AluImm64(g_alu_cmp, X86Reg::R11, m_memsize - m_membegin - size);
+		}
+
+		ExitIf(X86Cond::A, ip);
+	}
+
+
+	/**
+	 * guard that the top stack value is an int or a real, its type ends up in al
+	 */
+	void GuardNumeric(t_addr offs, t_addr ip)
+	{
+		m_x.Movzx8(X86Reg::RAX, Stack(offs));
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+		t_label is_int = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+		m_x.Bind(is_int);
+	}
+
+
+	/**
+	 * guard that the two top stack values have the same type, which ends up in al
+	 */
+	void GuardSameTypes(t_addr ip)
+	{
+		Access(0, 2*g_valsize);
+		m_x.Movzx8(X86Reg::RAX, Stack(0));
+		m_x.Alu8(g_alu_cmp, Stack(g_valsize), X86Reg::RAX);
+		ExitIf(X86Cond::NE, ip);
+	}
+
+
+	/**
+	 * compile an instruction and advance the instruction pointer,
+	 * returns false at the end of the block
+	 */
+	bool CompileInstruction(t_addr& ip)
+	{
+		std::optional<OpCode> op = ReadOp(ip);
+		if(!op)
+			return false;
+
+		switch(*op)
+		{
+			case OpCode::NOP:
+				++ip;
+				return true;
+
+			case OpCode::PUSH:
+				return CompilePush(ip);
+
+			case OpCode::USUB:
+				CompileNegation(ip);
+				++ip;
+				return true;
+
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+			case OpCode::DIV:
+			case OpCode::MOD:
+				CompileArithmetic(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::GT:
+			case OpCode::LT:
+			case OpCode::GEQU:
+			case OpCode::LEQU:
+			case OpCode::EQU:
+			case OpCode::NEQU:
+				CompileComparison(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::AND:
+			case OpCode::OR:
+			case OpCode::XOR:
+			case OpCode::NOT:
+				CompileLogical(*op);
+				++ip;
+				return true;
+
+			case OpCode::BINAND:
+			case OpCode::BINOR:
+			case OpCode::BINXOR:
+			case OpCode::BINNOT:
+			case OpCode::SHL:
+			case OpCode::SHR:
+			case OpCode::ROTL:
+			case OpCode::ROTR:
+				CompileBinary(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::TOI:
+			case OpCode::TOF:
+				CompileCast(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::UNTAGI:
+			case OpCode::UNTAGF:
+				CompileUntag(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::TAGI:
+			case OpCode::TAGF:
+				CompileTag(*op);
+				++ip;
+				return true;
+
+			case OpCode::PUSHI:
+			case OpCode::PUSHF:
+				return CompileUntaggedPush(ip);
+
+			case OpCode::IUSUB:
+			case OpCode::FUSUB:
+				CompileUntaggedNegation(*op);
+				++ip;
+				return true;
+
+			// the real remainder is calculated by the interpreter
+			case OpCode::IADD: case OpCode::ISUB: case OpCode::IMUL:
+			case OpCode::IDIV: case OpCode::IMOD:
+			case OpCode::FADD: case OpCode::FSUB: case OpCode::FMUL:
+			case OpCode::FDIV:
+				CompileUntaggedArithmetic(*op, ip);
+				++ip;
+				return true;
+
+			case OpCode::IGT: case OpCode::ILT: case OpCode::IGEQU:
+			case OpCode::ILEQU: case OpCode::IEQU: case OpCode::INEQU:
+			case OpCode::FGT: case OpCode::FLT: case OpCode::FGEQU:
+			case OpCode::FLEQU: case OpCode::FEQU: case OpCode::FNEQU:
+				CompileUntaggedComparison(*op);
+				++ip;
+				return true;
+
+			case OpCode::FRAME:
+				return CompileFrame(ip);
+
+			case OpCode::LDR:
+			case OpCode::STR:
+			case OpCode::OPR:
+				return CompileRegister(*op, ip);
+
+			default:
+				// not supported natively, continue in the interpreter
+				EndBlockAt(ip);
+				return false;
+		}
+	}
+
+
+	/**
+	 * push immediate data onto the stack, fusing address
+	 * pushes with the instructions using the address
+	 */
+	bool CompilePush(t_addr& ip)
+	{
+		std::optional<t_byte> _ty = ReadCode<t_byte>(ip + VM::m_bytesize);
+		if(!_ty)
+		{
+			EndBlockAt(ip);
+			return false;
+		}
+
+		VMType ty = static_cast<VMType>(*_ty);
+		t_addr data_addr = ip + 2*VM::m_bytesize;
+
+		if(ty == VMType::INT || ty == VMType::REAL)
+		{
+			std::optional<std::int64_t> val = ReadCode<std::int64_t>(data_addr);
+			if(!val)
+			{
+				EndBlockAt(ip);
+				return false;
+			}
+			t_addr ip_next = data_addr + VM::m_intsize;
+
+			// push int followed by ret
+			if(ty == VMType::INT && ReadOp(ip_next) == OpCode::RET &&
+				*val >= 0 && *val <= g_max_args)
+			{
+				CompileRet(static_cast<t_addr>(*val), ip);
+				return false;
+			}
+
+			Access(-g_valsize, 0);
+			m_x.MovImm64(X86Reg::RAX, *val);
+			m_x.Mov64(Stack(-VM::m_intsize), X86Reg::RAX);
+			m_x.MovImm8(Stack(-g_valsize), vm_type(ty));
+			m_spoff -= g_valsize;
+
+			ip = ip_next;
+			return true;
+		}
+
+		else if(is_addr_type(ty))
+		{
+			std::optional<t_addr> offs = ReadCode<t_addr>(data_addr);
+			if(!offs || !IsSupportedAddress(ty, *offs))
+			{
+				EndBlockAt(ip);
+				return false;
+			}
+
+			t_addr op_addr = data_addr + VM::m_addrsize;
+			std::optional<OpCode> next_op = ReadOp(op_addr);
+
+			switch(next_op ? *next_op : OpCode::INVALID)
+			{
+				case OpCode::RDMEM:
+					CompileReadMem(ty, *offs, ip, op_addr);
+					ip = op_addr + VM::m_bytesize;
+					return true;
+
+				case OpCode::WRMEM:
+					CompileWriteMem(ty, *offs, ip, op_addr);
+					ip = op_addr + VM::m_bytesize;
+					return true;
+
+				case OpCode::JMP:
+				case OpCode::JMPCND:
+				case OpCode::CALL:
+					CompileJump(*next_op, ty, *offs, ip, op_addr);
+					return false;
+
+				default:
+					break;
+			}
+
+			// push the address
+			Access(-g_addrsize, 0);
+			if(ty == VMType::ADDR_BP_ARG)
+			{
+				// argument addresses are pushed relative to the base pointer
+				LoadAddress(ty, *offs, ip, op_addr);
+				m_x.Alu64(g_alu_sub, X86Reg::RCX, g_reg_bp);
+				m_x.Mov32(Stack(-VM::m_addrsize), X86Reg::RCX);
+				m_x.MovImm8(Stack(-g_addrsize), vm_type(VMType::ADDR_BP));
+			}
+			else
+			{
+				m_x.MovImm32(Stack(-VM::m_addrsize), *offs);
+				m_x.MovImm8(Stack(-g_addrsize), vm_type(ty));
+			}
+			m_spoff -= g_addrsize;
+
+			ip = op_addr;
+			return true;
+		}
+
+		// strings are handled by the interpreter
+		EndBlockAt(ip);
+		return false;
+	}
+
+
+	/**
+	 * push address + rdmem
+	 */
+	void CompileReadMem(VMType ty, t_addr offs, t_addr ip, t_addr op_addr)
+	{
+		LoadAddress(ty, offs, ip, op_addr + VM::m_bytesize);
+		CheckValueBounds(ip);
+
+		// only ints and reals are read natively
+		m_x.Movzx8(X86Reg::RAX, Mem(X86Reg::RCX));
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+		t_label is_int = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+		m_x.Bind(is_int);
+
+		Access(-g_valsize, 0);
+		m_x.Mov64(X86Reg::RDX, Mem(X86Reg::RCX, VM::m_bytesize));
+		m_x.Mov64(Stack(-VM::m_intsize), X86Reg::RDX);
+		m_x.Mov8(Stack(-g_valsize), X86Reg::RAX);
+		m_spoff -= g_valsize;
+	}
+
+
+	/**
+	 * push address + wrmem
+	 */
+	void CompileWriteMem(VMType ty, t_addr offs, t_addr ip, t_addr op_addr)
+	{
+		LoadAddress(ty, offs, ip, op_addr + VM::m_bytesize);
+		CheckValueBounds(ip);
+
+		// strings that are overwritten have to be released by the interpreter
+		m_x.AluImm8(g_alu_cmp, Mem(X86Reg::RCX), vm_type(VMType::STR));
+		ExitIf(X86Cond::E, ip);
+
+		// only ints and reals are written natively
+		Access(0, g_valsize);
+		GuardNumeric(0, ip);
+
+		m_x.Mov64(X86Reg::RDX, Stack(VM::m_bytesize));
+		m_x.Mov64(Mem(X86Reg::RCX, VM::m_bytesize), X86Reg::RDX);
+		m_x.Mov8(Mem(X86Reg::RCX), X86Reg::RAX);
+		m_spoff += g_valsize;
+	}
+
+
+	/**
+	 * register access or binary operation with a register operand
+	 */
+	bool CompileRegister(OpCode op, t_addr& ip)
+	{
+		std::optional<OpCode> regop = OpCode::NOP;
+		t_addr reg_addr = ip + VM::m_bytesize;
+		if(op == OpCode::OPR)
+		{
+			regop = ReadOp(reg_addr);
+			reg_addr += VM::m_bytesize;
+		}
+
+		// the power is calculated by the interpreter
+		std::optional<t_byte> reg = ReadCode<t_byte>(reg_addr);
+		if(!reg || *reg >= VM::m_num_regs || !regop || (op == OpCode::OPR &&
+			(!is_vm_register_op(*regop) || *regop == OpCode::POW)))
+		{
+			EndBlockAt(ip);
+			return false;
+		}
+
+		const std::int32_t slot = static_cast<std::int32_t>(*reg * VM::m_regsize);
+		m_x.Mov64(X86Reg::RCX, Regs(offsetof(VMJitRegs, regfile)));
+
+		if(op == OpCode::STR)
+		{
+			// only ints and reals are held in registers
+			Access(0, g_valsize);
+			GuardNumeric(0, ip);
+
+			m_x.Mov64(X86Reg::RDX, Stack(VM::m_bytesize));
+			m_x.Mov64(X86Mem{X86Reg::RCX, std::nullopt, slot + VM::m_bytesize}, X86Reg::RDX);
+			m_x.Mov8(X86Mem{X86Reg::RCX, std::nullopt, slot}, X86Reg::RAX);
+			m_spoff += g_valsize;
+		}
+		else
+		{
+			// registers which have not yet been assigned are reported by the interpreter
+			m_x.Movzx8(X86Reg::RAX, X86Mem{X86Reg::RCX, std::nullopt, slot});
+			m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+			t_label is_int = m_x.Jcc(X86Cond::E);
+			m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+			ExitIf(X86Cond::NE, ip);
+			m_x.Bind(is_int);
+
+			Access(-g_valsize, 0);
+			m_x.Mov64(X86Reg::RDX, X86Mem{X86Reg::RCX, std::nullopt, slot + VM::m_bytesize});
+			m_x.Mov64(Stack(-VM::m_intsize), X86Reg::RDX);
+			m_x.Mov8(Stack(-g_valsize), X86Reg::RAX);
+			m_spoff -= g_valsize;
+
+			if(op == OpCode::OPR)
+			{
+				// the interpreter runs the whole instruction again,
+				// so it is left without the pushed register value
+				m_exit_spoff = m_spoff + g_valsize;
+				if(*regop >= OpCode::GT && *regop <= OpCode::NEQU)
+					CompileComparison(*regop, ip);
+				else
+					CompileArithmetic(*regop, ip);
+				m_exit_spoff.reset();
+			}
+		}
+
+		ip = reg_addr + VM::m_bytesize;
+		return true;
+	}
+
+
+	/**
+	 * push address + jmp, jmpcnd or call
+	 */
+	void CompileJump(OpCode op, VMType ty, t_addr offs, t_addr ip, t_addr op_addr)
+	{
+		const t_addr ip_next = op_addr + VM::m_bytesize;
+		const X86Mem reg_ip = Regs(offsetof(VMJitRegs, ip));
+
+		// the target address is known for absolute and ip-relative jumps
+		std::optional<t_addr> target;
+		if(ty == VMType::ADDR_MEM)
+			target = offs;
+		else if(ty == VMType::ADDR_IP)
+			target = offs + ip_next;
+		else
+			LoadAddress(ty, offs, ip, ip_next);
+
+		auto set_target = [this, &target, &reg_ip]()
+		{
+			if(target)
+				m_x.MovImm32(reg_ip, *target);
+			else
+				m_x.Mov32(reg_ip, X86Reg::RCX);
+		};
+
+		if(op == OpCode::JMP)
+		{
+			set_target();
+		}
+		else if(op == OpCode::JMPCND)
+		{
+			// get the boolean condition
+			Access(0, VM::m_boolsize);
+			m_x.Movzx8(X86Reg::RAX, Stack(0));
+			m_spoff += VM::m_boolsize;
+
+			m_x.MovImm32(reg_ip, ip_next);
+			m_x.Test8(X86Reg::RAX, X86Reg::RAX);
+			t_label no_jump = m_x.Jcc(X86Cond::E);
+			set_target();
+			m_x.Bind(no_jump);
+		}
+		else if(op == OpCode::CALL)
+		{
+			// save the instruction and base pointers, see the interpreter,
+			// the new stack frame has to fit in, too
+			Access(-2*g_addrsize - m_framesize, 0);
+			m_x.MovImm32(Stack(-VM::m_addrsize), ip_next);
+			m_x.MovImm8(Stack(-g_addrsize), vm_type(VMType::ADDR_MEM));
+			m_x.Mov32(Stack(-g_addrsize - VM::m_addrsize), g_reg_bp);
+			m_x.MovImm8(Stack(-2*g_addrsize), vm_type(VMType::ADDR_MEM));
+			m_spoff -= 2*g_addrsize;
+			MaterialiseSP();
+
+			// set up the stack frame, its size is kept at its top
+			m_x.Mov64(g_reg_bp, g_reg_sp);
+			m_x.AluImm64(g_alu_sub, g_reg_sp, m_framesize);
+			m_x.MovImm32(Mem(g_reg_bp, -VM::m_addrsize), m_framesize);
+
+			set_target();
+		}
+
+		EndBlock();
+	}
+
+
+	/**
+	 * resize the stack frame, ending the block as the stack pointer is reset
+	 */
+	bool CompileFrame(t_addr& ip)
+	{
+		std::optional<t_addr> size = ReadCode<t_addr>(ip + VM::m_bytesize);
+		if(!size || *size < VM::m_addrsize)
+		{
+			EndBlockAt(ip);
+			return false;
+		}
+
+		// growing the stack is left to the interpreter
+		CheckAddress(g_reg_bp, 0, ip);
+		m_x.Lea64(X86Reg::RAX, X86Mem{g_reg_bp, std::nullopt, -*size});
+		m_x.Movsxd(X86Reg::RCX, Regs(offsetof(VMJitRegs, stacklimit)));
+		m_x.Alu64(g_alu_cmp, X86Reg::RAX, X86Reg::RCX);
+		ExitIf(X86Cond::L, ip);
+
+		m_x.Mov64(g_reg_sp, X86Reg::RAX);
+		m_spoff = 0;
+		m_x.MovImm32(Mem(g_reg_bp, -VM::m_addrsize), *size);
+
+		EndBlockAt(ip + VM::m_bytesize + VM::m_addrsize);
+		return false;
+	}
+
+
+	/**
+	 * push int + ret
+	 */
+	void CompileRet(t_addr num_args, t_addr ip)
+	{
+		// returns from interrupt service routines are left to the interpreter
+		m_x.Movsxd(X86Reg::RAX, Regs(offsetof(VMJitRegs, irqbp)));
+		m_x.Alu64(g_alu_cmp, g_reg_bp, X86Reg::RAX);
+		ExitIf(X86Cond::E, ip);
+
+		// string values in the stack frame have to be released by the interpreter
+		m_x.Mov64(X86Reg::RDI, Regs(offsetof(VMJitRegs, vm)));
+		m_x.Lea64(X86Reg::RSI, X86Mem{g_reg_sp, std::nullopt, m_spoff});
+		m_x.Mov64(X86Reg::RDX, g_reg_bp);
+		m_x.MovImm64(X86Reg::RAX, reinterpret_cast<std::int64_t>(m_has_str_slots));
+		m_x.CallReg(X86Reg::RAX);
+		m_x.Test8(X86Reg::RAX, X86Reg::RAX);
+		ExitIf(X86Cond::NE, ip);
+
+		// saved base and instruction pointers
+		CheckAddress(g_reg_bp, 2*g_addrsize, ip);
+		m_x.AluImm8(g_alu_cmp, Mem(g_reg_bp), vm_type(VMType::ADDR_MEM));
+		ExitIf(X86Cond::NE, ip);
+		m_x.AluImm8(g_alu_cmp, Mem(g_reg_bp, g_addrsize), vm_type(VMType::ADDR_MEM));
+		ExitIf(X86Cond::NE, ip);
+
+		// find the end of the function arguments
+		m_x.Lea64(X86Reg::RCX, X86Mem{g_reg_bp, std::nullopt, 2*g_addrsize});
+		for(t_addr arg=0; arg<num_args; ++arg)
+		{
+			CheckAddress(X86Reg::RCX, 1, ip);
+
+			m_x.Movzx8(X86Reg::RAX, Mem(X86Reg::RCX));
+			m_x.Movzx8(X86Reg::RDX, X86Mem{g_reg_regs, X86Reg::RAX,
+				static_cast<std::int32_t>(offsetof(VMJitRegs, popsizes))});
+			m_x.Test64(X86Reg::RDX, X86Reg::RDX);
+			ExitIf(X86Cond::E, ip);
+			m_x.Alu64(g_alu_add, X86Reg::RCX, X86Reg::RDX);
+		}
+		CheckAddress(X86Reg::RCX, 0, ip);
+
+		// frame size
+		m_x.Lea64(X86Reg::RSI, X86Mem{g_reg_bp, std::nullopt, -VM::m_addrsize});
+		CheckAddress(X86Reg::RSI, VM::m_addrsize, ip);
+		m_x.Movsxd(X86Reg::RAX, Mem(X86Reg::RSI));
+
+		// is there a return value? it has to be an int or a real
+		// r8: return value type, rdx: return value
+		Access(0, g_valsize);
+		m_x.MovImm64(X86Reg::R8, 0);
+		m_x.Lea64(X86Reg::RSI, X86Mem{g_reg_sp, std::nullopt, m_spoff});
+		m_x.Alu64(g_alu_add, X86Reg::RAX, X86Reg::RSI);
+		m_x.Alu64(g_alu_cmp, X86Reg::RAX, g_reg_bp);
+		t_label no_retval = m_x.Jcc(X86Cond::GE);
+		GuardNumeric(0, ip);
+		m_x.Mov64(X86Reg::R8, X86Reg::RAX);
+		m_x.Mov64(X86Reg::RDX, Stack(VM::m_bytesize));
+		m_x.Bind(no_retval);
+
+		// restore the base and instruction pointers
+		m_x.Movsxd(X86Reg::RAX, Mem(g_reg_bp, VM::m_bytesize));
+		m_x.Movsxd(X86Reg::RSI, Mem(g_reg_bp, g_addrsize + VM::m_bytesize));
+		m_x.Mov32(Regs(offsetof(VMJitRegs, ip)), X86Reg::RSI);
+		m_x.Mov64(g_reg_bp, X86Reg::RAX);
+
+		// remove the stack frame and the arguments
+		m_spoff = 0;
+		m_x.Mov64(g_reg_sp, X86Reg::RCX);
+
+		// push the return value
+		m_x.Test8(X86Reg::R8, X86Reg::R8);
+		t_label no_push = m_x.Jcc(X86Cond::E);
+		m_x.AluImm64(g_alu_sub, g_reg_sp, g_valsize);
+		m_x.Mov64(Mem(g_reg_sp, VM::m_bytesize), X86Reg::RDX);
+		m_x.Mov8(Mem(g_reg_sp), X86Reg::R8);
+		m_x.Bind(no_push);
+
+		EndBlock();
+	}
+
+
+	/**
+	 * unary minus
+	 */
+	void CompileNegation(t_addr ip)
+	{
+		Access(0, g_valsize);
+		m_x.Movzx8(X86Reg::RAX, Stack(0));
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+		t_label is_int = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+
+		// flip the sign bit of the real
+		m_x.BitImm64(g_bit_btc, Stack(VM::m_bytesize), 63);
+		t_label done = m_x.Jmp();
+
+		m_x.Bind(is_int);
+		m_x.Neg64(Stack(VM::m_bytesize));
+		m_x.Bind(done);
+	}
+
+
+	/**
+	 * unary minus of an untagged int or real
+	 */
+	void CompileUntaggedNegation(OpCode op)
+	{
+		Access(0, VM::m_intsize);
+		if(op == OpCode::FUSUB)
+			m_x.BitImm64(g_bit_btc, Stack(0), 63);
+		else
+			m_x.Neg64(Stack(0));
+	}
+
+
+	/**
+	 * remove the type descriptor of the top stack value, which has to match
+	 */
+	void CompileUntag(OpCode op, t_addr ip)
+	{
+		Access(0, g_valsize);
+		m_x.AluImm8(g_alu_cmp, Stack(0),
+			vm_type(op == OpCode::UNTAGI ? VMType::INT : VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+		m_spoff += VM::m_bytesize;
+	}
+
+
+	/**
+	 * add the type descriptor to the top stack value
+	 */
+	void CompileTag(OpCode op)
+	{
+		Access(-VM::m_bytesize, 0);
+		m_x.MovImm8(Stack(-VM::m_bytesize),
+			vm_type(op == OpCode::TAGI ? VMType::INT : VMType::REAL));
+		m_spoff -= VM::m_bytesize;
+	}
+
+
+	/**
+	 * push an int or a real without a type descriptor, both have 64 bits
+	 */
+	bool CompileUntaggedPush(t_addr& ip)
+	{
+		std::optional<std::int64_t> val = ReadCode<std::int64_t>(ip + VM::m_bytesize);
+		if(!val)
+		{
+			EndBlockAt(ip);
+			return false;
+		}
+
+		Access(-VM::m_intsize, 0);
+		m_x.MovImm64(X86Reg::RAX, *val);
+		m_x.Mov64(Stack(-VM::m_intsize), X86Reg::RAX);
+		m_spoff -= VM::m_intsize;
+
+		ip += VM::m_bytesize + VM::m_intsize;
+		return true;
+	}
+
+
+	/**
+	 * arithmetic operations on two ints or two reals
+	 */
+	void CompileArithmetic(OpCode op, t_addr ip)
+	{
+		// the first operand is below the second one
+		const X86Mem val1 = Stack(g_valsize + VM::m_bytesize);
+		const X86Mem val2 = Stack(VM::m_bytesize);
+
+		GuardSameTypes(ip);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+		t_label is_int = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+
+		// real operation
+		if(op == OpCode::MOD)
+			ExitTo(ip);
+		else
+			EmitRealArithmetic(op, val1, val2);
+		t_label done = m_x.Jmp();
+
+		// int operation
+		m_x.Bind(is_int);
+		EmitIntArithmetic(op, val1, val2, ip);
+
+		m_x.Bind(done);
+		m_spoff += g_valsize;
+	}
+
+
+	/**
+	 * arithmetic operations on two untagged ints or reals, whose types are known
+	 */
+	void CompileUntaggedArithmetic(OpCode op, t_addr ip)
+	{
+		const X86Mem val1 = Stack(VM::m_intsize);
+		const X86Mem val2 = Stack(0);
+		Access(0, 2*VM::m_intsize);
+
+		if(op >= OpCode::FUSUB && op <= OpCode::FMOD)
+			EmitRealArithmetic(get_vm_tagged_op(op), val1, val2);
+		else
+			EmitIntArithmetic(get_vm_tagged_op(op), val1, val2, ip);
+
+		m_spoff += VM::m_intsize;
+	}
+
+
+	/**
+	 * real operation, the result replaces the first operand
+	 */
+	void EmitRealArithmetic(OpCode op, const X86Mem& val1, const X86Mem& val2)
+	{
+		std::uint8_t sse_op = 0;
+		switch(op)
+		{
+			case OpCode::ADD: sse_op = g_sse_add; break;
+			case OpCode::SUB: sse_op = g_sse_sub; break;
+			case OpCode::MUL: sse_op = g_sse_mul; break;
+			case OpCode::DIV: sse_op = g_sse_div; break;
+			default: break;
+		}
+
+		m_x.Sse(g_sse_movsd, 0, val1);
+		m_x.Sse(sse_op, 0, val2);
+		m_x.MovsdStore(val1, 0);
+	}
+
+
+	/**
+	 * int operation, the result replaces the first operand
+	 */
+	void EmitIntArithmetic(OpCode op, const X86Mem& val1, const X86Mem& val2, t_addr ip)
+	{
+		if(op == OpCode::DIV || op == OpCode::MOD)
+		{
+			// let the interpreter deal with invalid divisions
+			m_x.Mov64(X86Reg::RCX, val2);
+			m_x.Test64(X86Reg::RCX, X86Reg::RCX);
+			ExitIf(X86Cond::E, ip);
+			m_x.AluImm64(g_alu_cmp, X86Reg::RCX, -1);
+			ExitIf(X86Cond::E, ip);
+
+			m_x.Mov64(X86Reg::RAX, val1);
+			m_x.Cqo();
+			m_x.Idiv64(X86Reg::RCX);
+			m_x.Mov64(val1, op == OpCode::DIV ? X86Reg::RAX : X86Reg::RDX);
+		}
+		else
+		{
+			m_x.Mov64(X86Reg::RAX, val1);
+			if(op == OpCode::ADD)
+				m_x.Alu64(g_alu_add, X86Reg::RAX, val2);
+			else if(op == OpCode::SUB)
+				m_x.Alu64(g_alu_sub, X86Reg::RAX, val2);
+			else if(op == OpCode::MUL)
+				m_x.Imul64(X86Reg::RAX, val2);
+			m_x.Mov64(val1, X86Reg::RAX);
+		}
+	}
+
+
+	/**
+	 * comparison of two ints or two reals
+	 */
+	void CompileComparison(OpCode op, t_addr ip)
+	{
+		const X86Mem val1 = Stack(g_valsize + VM::m_bytesize);
+		const X86Mem val2 = Stack(VM::m_bytesize);
+
+		GuardSameTypes(ip);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::INT));
+		t_label is_int = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(VMType::REAL));
+		ExitIf(X86Cond::NE, ip);
+
+		// real comparison
+		EmitRealComparison(op, val1, val2);
+		t_label done = m_x.Jmp();
+
+		// int comparison
+		m_x.Bind(is_int);
+		EmitIntComparison(op, val1, val2);
+
+		// replace the operands with the boolean result
+		m_x.Bind(done);
+		m_x.Mov8(Stack(2*g_valsize - VM::m_boolsize), X86Reg::RDX);
+		m_spoff += 2*g_valsize - VM::m_boolsize;
+	}
+
+
+	/**
+	 * comparison of two untagged ints or reals, whose types are known
+	 */
+	void CompileUntaggedComparison(OpCode op)
+	{
+		const X86Mem val1 = Stack(VM::m_intsize);
+		const X86Mem val2 = Stack(0);
+		Access(0, 2*VM::m_intsize);
+
+		if(op >= OpCode::FGT && op <= OpCode::FNEQU)
+			EmitRealComparison(get_vm_tagged_op(op), val1, val2);
+		else
+			EmitIntComparison(get_vm_tagged_op(op), val1, val2);
+
+		m_x.Mov8(Stack(2*VM::m_intsize - VM::m_boolsize), X86Reg::RDX);
+		m_spoff += 2*VM::m_intsize - VM::m_boolsize;
+	}
+
+
+	/**
+	 * real comparison with the result in dl,
+	 * unordered values compare as false, see the interpreter
+	 */
+	void EmitRealComparison(OpCode op, const X86Mem& val1, const X86Mem& val2)
+	{
+		m_x.Sse(g_sse_movsd, 0, val1);
+		m_x.Sse(g_sse_movsd, 1, val2);
+		switch(op)
+		{
+			case OpCode::GT:
+				m_x.Ucomisd(0, 1);
+				m_x.Setcc(X86Cond::A, X86Reg::RDX);
+				break;
+			case OpCode::LT:
+				m_x.Ucomisd(1, 0);
+				m_x.Setcc(X86Cond::A, X86Reg::RDX);
+				break;
+			case OpCode::GEQU:
+				m_x.Ucomisd(0, 1);
+				m_x.Setcc(X86Cond::AE, X86Reg::RDX);
+				break;
+			case OpCode::LEQU:
+				m_x.Ucomisd(1, 0);
+				m_x.Setcc(X86Cond::AE, X86Reg::RDX);
+				break;
+			case OpCode::EQU:
+			case OpCode::NEQU:
+			{
+				// compare |val1 - val2| with epsilon
+				m_x.Sse(g_sse_sub, 0, 1);
+				m_x.MovqFromXmm(X86Reg::RAX, 0);
+				m_x.BitImm64(g_bit_btr, X86Reg::RAX, 63);
+				m_x.MovqToXmm(0, X86Reg::RAX);
+				m_x.Sse(g_sse_movsd, 1, Regs(offsetof(VMJitRegs, eps)));
+
+				if(op == OpCode::EQU)
+				{
+					m_x.Ucomisd(1, 0);
+					m_x.Setcc(X86Cond::AE, X86Reg::RDX);
+				}
+				else
+				{
+					m_x.Ucomisd(0, 1);
+					m_x.Setcc(X86Cond::A, X86Reg::RDX);
+				}
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+
+	/**
+	 * int comparison with the result in dl
+	 */
+	void EmitIntComparison(OpCode op, const X86Mem& val1, const X86Mem& val2)
+	{
+		m_x.Mov64(X86Reg::RAX, val1);
+		m_x.Alu64(g_alu_cmp, X86Reg::RAX, val2);
+		switch(op)
+		{
+			case OpCode::GT: m_x.Setcc(X86Cond::G, X86Reg::RDX); break;
+			case OpCode::LT: m_x.Setcc(X86Cond::L, X86Reg::RDX); break;
+			case OpCode::GEQU: m_x.Setcc(X86Cond::GE, X86Reg::RDX); break;
+			case OpCode::LEQU: m_x.Setcc(X86Cond::LE, X86Reg::RDX); break;
+			case OpCode::EQU: m_x.Setcc(X86Cond::E, X86Reg::RDX); break;
+			case OpCode::NEQU: m_x.Setcc(X86Cond::NE, X86Reg::RDX); break;
+			default: break;
+		}
+	}
+
+
+	/**
+	 * logical operations on booleans
+	 */
+	void CompileLogical(OpCode op)
+	{
+		if(op == OpCode::NOT)
+		{
+			Access(0, VM::m_boolsize);
+			m_x.AluImm8(g_alu_cmp, Stack(0), 0);
+			m_x.Setcc(X86Cond::E, X86Reg::RAX);
+			m_x.Mov8(Stack(0), X86Reg::RAX);
+			return;
+		}
+
+		const X86Mem val1 = Stack(VM::m_boolsize);
+		const X86Mem val2 = Stack(0);
+		Access(0, 2*VM::m_boolsize);
+
+		if(op == OpCode::XOR)
+		{
+			m_x.Movzx8(X86Reg::RAX, val2);
+			m_x.Alu8(g_alu_xor, val1, X86Reg::RAX);
+		}
+		else
+		{
+			m_x.AluImm8(g_alu_cmp, val2, 0);
+			m_x.Setcc(X86Cond::NE, X86Reg::RAX);
+			m_x.AluImm8(g_alu_cmp, val1, 0);
+			m_x.Setcc(X86Cond::NE, X86Reg::RDX);
+			m_x.Alu8(op == OpCode::AND ? g_alu_and : g_alu_or, X86Reg::RDX, X86Reg::RAX);
+			m_x.Mov8(val1, X86Reg::RDX);
+		}
+
+		m_spoff += VM::m_boolsize;
+	}
+
+
+	/**
+	 * binary operations on ints
+	 */
+	void CompileBinary(OpCode op, t_addr ip)
+	{
+		if(op == OpCode::BINNOT)
+		{
+			Access(0, g_valsize);
+			m_x.AluImm8(g_alu_cmp, Stack(0), vm_type(VMType::INT));
+			ExitIf(X86Cond::NE, ip);
+			m_x.Not64(Stack(VM::m_bytesize));
+			return;
+		}
+
+		const X86Mem val1 = Stack(g_valsize + VM::m_bytesize);
+		const X86Mem val2 = Stack(VM::m_bytesize);
+
+		Access(0, 2*g_valsize);
+		m_x.AluImm8(g_alu_cmp, Stack(0), vm_type(VMType::INT));
+		ExitIf(X86Cond::NE, ip);
+		m_x.AluImm8(g_alu_cmp, Stack(g_valsize), vm_type(VMType::INT));
+		ExitIf(X86Cond::NE, ip);
+
+		m_x.Mov64(X86Reg::RAX, val1);
+		switch(op)
+		{
+			case OpCode::BINAND: m_x.Alu64(g_alu_and, X86Reg::RAX, val2); break;
+			case OpCode::BINOR: m_x.Alu64(g_alu_or, X86Reg::RAX, val2); break;
+			case OpCode::BINXOR: m_x.Alu64(g_alu_xor, X86Reg::RAX, val2); break;
+			case OpCode::SHL:
+			case OpCode::SHR:
+			case OpCode::ROTL:
+			case OpCode::ROTR:
+			{
+				std::uint8_t shift_op = g_shift_shl;
+				if(op == OpCode::SHR)
+					shift_op = g_shift_sar;
+				else if(op == OpCode::ROTL)
+					shift_op = g_shift_rol;
+				else if(op == OpCode::ROTR)
+					shift_op = g_shift_ror;
+
+				m_x.Mov64(X86Reg::RCX, val2);
+				m_x.Shift64(shift_op, X86Reg::RAX);
+				break;
+			}
+			default:
+				break;
+		}
+		m_x.Mov64(val1, X86Reg::RAX);
+
+		m_spoff += g_valsize;
+	}
+
+
+	/**
+	 * conversions between ints and reals
+	 */
+	void CompileCast(OpCode op, t_addr ip)
+	{
+		const VMType ty_to = (op == OpCode::TOI ? VMType::INT : VMType::REAL);
+		const VMType ty_from = (op == OpCode::TOI ? VMType::REAL : VMType::INT);
+
+		Access(0, g_valsize);
+		m_x.Movzx8(X86Reg::RAX, Stack(0));
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(ty_to));
+		t_label done = m_x.Jcc(X86Cond::E);
+		m_x.AluImm8(g_alu_cmp, X86Reg::RAX, vm_type(ty_from));
+		ExitIf(X86Cond::NE, ip);
+
+		if(op == OpCode::TOI)
+		{
+			m_x.Cvttsd2si(X86Reg::RAX, Stack(VM::m_bytesize));
+			m_x.Mov64(Stack(VM::m_bytesize), X86Reg::RAX);
+		}
+		else
+		{
+			m_x.Cvtsi2sd(0, Stack(VM::m_bytesize));
+			m_x.MovsdStore(Stack(VM::m_bytesize), 0);
+		}
+		m_x.MovImm8(Stack(0), vm_type(ty_to));
+
+		m_x.Bind(done);
+	}
+
+
+private:
+	/**
+	 * jump to the interpreter
+	 */
+	struct Exit
+	{
+		t_label label{};
+		t_addr ip{};       // address to continue at
+		t_addr spoff{};    // deferred stack pointer change
+	};
+
+
+	X86Emitter m_x{};
+
+	const t_byte* m_code{nullptr};     // code to compile
+	t_addr m_codesize{0};
+	t_addr m_membegin{0};              // start of the vm's own memory
+	t_addr m_memsize{0};
+	t_addr m_framesize{0};
+	t_addr m_start{0};
+	t_helper m_has_str_slots{nullptr};
+
+	std::size_t m_num_instrs{0};
+	bool m_empty{false};
+
+	// deferred changes to the stack pointer register
+	t_addr m_spoff{0};
+	// stack pointer change to leave with, if it differs from the current one
+	std::optional<t_addr> m_exit_spoff{};
+
+	// stack range accessed by the block relative to its initial stack pointer
+	t_addr m_minoff{0}, m_maxoff{0};
+	std::size_t m_minoff_pos{0}, m_maxoff_pos{0};
+
+	std::vector<Exit> m_exits{};
+	std::vector<t_label> m_to_epilogue{};
+};
+
+}  // anonymous namespace
+
+#endif  // LR1_VM_JIT_X86
+
+
+
+/**
+ * run the native code block at the instruction pointer,
+ * returns false if the interpreter has to run the next instruction
+ */
+bool VM::RunJit(std::uint64_t& num_instrs)
+{
+	if(m_ip < 0 || static_cast<std::size_t>(m_ip) >= m_jitblocks.size())
+		return false;
+
+	JitBlock& block = m_jitblocks[m_ip];
+	if(!block.compiled)
+	{
+		// only compile hot code, the rest stays with the interpreter
+		if(m_jit_threshold > 0 && block.counter < m_jit_threshold && !JitIsHot(m_ip))
+			return false;
+
+		block.func = JitCompile(m_ip, block.num_instrs);
+		block.compiled = true;
+	}
+
+	if(!block.func)
+		return false;
+
+	m_jitregs.ip = m_ip;
+	m_jitregs.sp = m_sp;
+	m_jitregs.bp = m_bp;
+	m_jitregs.gbp = m_gbp;
+	m_jitregs.eps = m_eps;
+	m_jitregs.irqbp = m_irq_frames.empty() ? -1 : m_irq_frames.back().bp;
+
+	// the stack must not grow into the code, it is enlarged by the interpreter
+	m_jitregs.stacklimit = m_stacklimit;
+
+	bool progress = block.func(&m_jitregs);
+
+	// side exits are not tracked, so count the whole block
+	if(progress)
+		num_instrs += block.num_instrs;
+
+	m_ip = m_jitregs.ip;
+	m_sp = m_jitregs.sp;
+	m_bp = m_jitregs.bp;
+
+	// jumps and calls from native code into code that has not
+	// been compiled yet are counted like the interpreter's
+	if(progress && m_ip >= 0 && static_cast<std::size_t>(m_ip) < m_jitblocks.size()
+		&& !m_jitblocks[m_ip].compiled)
+		JitCount(m_ip, -1);
+
+	return progress;
+}
+
+
+/**
+ * mark a region as hot, its blocks are compiled when they are reached
+ */
+void VM::JitPromote(t_addr begin, t_addr end)
+{
+	if(end < 0)
+		end = JitFuncEnd(begin);
+	end = std::min(std::max(end, begin + 1), m_memsize);
+
+	for(const auto& region : m_jithot)
+	{
+		if(begin >= region[0] && end <= region[1])
+			return;
+	}
+
+	m_jithot.push_back(std::array<t_addr, 2>{{ begin, end }});
+
+	if(m_debug)
+	{
+		std::cout << "code region [" << begin << ", " << end
+			<< ") is hot." << std::endl;
+	}
+}
+
+
+/**
+ * is the address part of a hot code region?
+ */
+bool VM::JitIsHot(t_addr addr) const
+{
+	for(const auto& region : m_jithot)
+	{
+		if(addr >= region[0] && addr < region[1])
+			return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * get the end of the function starting at the given address,
+ * ASTAsm precedes each function with a jump over its body
+ * (push addr_ip <function size>, jmp), if this is not found,
+ * only the block at the given address is regarded
+ */
+VM::t_addr VM::JitFuncEnd(t_addr addr) const
+{
+	constexpr t_addr jmp_size = 2*m_bytesize + m_addrsize + 1;
+	if(addr < jmp_size || addr >= m_memsize)
+		return addr + 1;
+
+	const t_byte* jmp = MemPtr(addr - jmp_size);
+	if(static_cast<OpCode>(jmp[0]) != OpCode::PUSH ||
+		static_cast<VMType>(jmp[1]) != VMType::ADDR_IP ||
+		static_cast<OpCode>(jmp[jmp_size - 1]) != OpCode::JMP)
+		return addr + 1;
+
+	t_addr size = 0;
+	std::memcpy(&size, jmp + 2*m_bytesize, sizeof(size));
+	if(size <= 0)
+		return addr + 1;
+
+	return addr + size;
+}
+
+
+/**
+ * translate the code block starting at the given address
+ */
+t_vm_jitfunc VM::JitCompile([[maybe_unused]] t_addr addr,
+	[[maybe_unused]] t_addr& num_instrs)
+{
+#if LR1_VM_JIT_X86 != 0
+	// shared code is only readable up to its end
+	JitBlockCompiler compiler{MemPtr(0), m_code ? m_data_begin : m_memsize,
+		m_data_begin, m_memsize, m_framesize, addr, &VM::JitHasStrSlots};
+	if(!compiler.Compile())
+		return nullptr;
+
+	const t_byte* code = m_jitmem.Add(compiler.GetCode());
+	// including the instruction ending the block
+	num_instrs = static_cast<t_addr>(compiler.GetNumInstrs()) + 1;
+
+	if(m_debug)
+	{
+		std::cout << "compiled block at address " << addr
+			<< " to " << compiler.GetCode().size() << " bytes of native code."
+			<< std::endl;
+	}
+
+	return reinterpret_cast<t_vm_jitfunc>(const_cast<t_byte*>(code));
+
+#else
+	return nullptr;
+#endif
+}
+
+
+/**
+ * get the number of natively compiled code blocks
+ */
+std::size_t VM::GetNumJitBlocks() const
+{
+	return std::count_if(m_jitblocks.begin(), m_jitblocks.end(),
+		[](const JitBlock& block) -> bool { return block.func != nullptr; });
+}
+
+
+/**
+ * remove all compiled code, e.g. because the code has changed
+ */
+void VM::JitReset()
+{
+	// only the code below the stack can be compiled
+	m_jitblocks.clear();
+	m_jitblocks.resize(m_stacklimit);
+	m_jithot.clear();
+	m_jitmem.Clear();
+
+	// the native code uses absolute addresses, which start at m_data_begin
+	m_jitregs.mem = reinterpret_cast<t_byte*>(
+		reinterpret_cast<std::uintptr_t>(m_mem.Get()) - m_data_begin);
+	m_jitregs.vm = this;
+	m_jitregs.regfile = m_regfile.data();
+
+	// sizes of the values on the stack including their descriptor,
+	// only string arguments need to be released when popped
+	const VMType addr_types[] = { VMType::ADDR_MEM, VMType::ADDR_IP,
+		VMType::ADDR_SP, VMType::ADDR_BP, VMType::ADDR_GBP };
+
+	std::memset(m_jitregs.argsizes, 0, sizeof(m_jitregs.argsizes));
+	std::memset(m_jitregs.popsizes, 0, sizeof(m_jitregs.popsizes));
+
+	for(VMType ty : addr_types)
+	{
+		m_jitregs.argsizes[static_cast<t_byte>(ty)] = m_bytesize + m_addrsize;
+		m_jitregs.popsizes[static_cast<t_byte>(ty)] = m_bytesize + m_addrsize;
+	}
+
+	m_jitregs.argsizes[static_cast<t_byte>(VMType::REAL)] = m_bytesize + m_realsize;
+	m_jitregs.popsizes[static_cast<t_byte>(VMType::REAL)] = m_bytesize + m_realsize;
+	m_jitregs.argsizes[static_cast<t_byte>(VMType::INT)] = m_bytesize + m_intsize;
+	m_jitregs.popsizes[static_cast<t_byte>(VMType::INT)] = m_bytesize + m_intsize;
+	m_jitregs.argsizes[static_cast<t_byte>(VMType::STR)] = m_bytesize + m_addrsize;
+}
+
+
+/**
+ * are there string handles in the memory range [begin, end)?
+ * called from the native code
+ */
+bool VM::JitHasStrSlots(VM* vm, t_addr begin, t_addr end)
+{
+	return vm->HasStrSlots(begin, end);
+}
@@ -0,0 +1,214 @@
+/**
+ * zero-address code vm -- snapshots and forks of the vm state
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#include "vm.h"
+
+
+/**
+ * capture the state of the vm
+ */
+std::shared_ptr<const VMSnapshot> VM::Snapshot() const
+{
+	// the arguments of a running native call are only held by the host
+	if(m_native_strs.size())
+		throw std::runtime_error("Cannot take a snapshot during an external call.");
+
+	auto snapshot = std::make_shared<VMSnapshot>();
+
+	VMSnapshot::State& state = snapshot->m_state;
+	state.ip = m_ip;
+	state.sp = m_sp;
+	state.bp = m_bp;
+	state.gbp = m_gbp;
+	state.memsize = m_memsize;
+	state.maxmemsize = m_maxmemsize;
+	state.framesize = m_framesize;
+	state.stacklimit = m_stacklimit;
+	state.data_begin = m_data_begin;
+	state.code_range[0] = m_code_range[0];
+	state.code_range[1] = m_code_range[1];
+	state.irq_level = m_irq_level;
+	state.eps = m_eps;
+
+	for(const std::optional<t_addr>& isr : m_isrs)
+		snapshot->m_isrs.push_back(isr ? *isr : -1);
+	for(const IrqFrame& frame : m_irq_frames)
+		snapshot->m_irq_frames.push_back({ frame.bp, frame.level });
+
+	// the registers, followed by the ones saved by the interrupt frames
+	snapshot->m_regs.assign(m_regfile.begin(), m_regfile.end());
+	for(const IrqFrame& frame : m_irq_frames)
+		snapshot->m_regs.insert(snapshot->m_regs.end(), frame.regs.begin(), frame.regs.end());
+
+	snapshot->m_strheap = m_strheap;
+	ForEachStrSlot(0, m_memsize, [this, &snapshot](t_addr addr)
+	{
+		snapshot->m_strslots.push_back({ addr, ReadMemRaw<t_addr>(addr) });
+	});
+	for(const auto& [addr, handle] : m_strlits)
+		snapshot->m_strlits.push_back({ addr, handle });
+
+	// the memory between the code and the stack pointer is free and not
+	// looked at, so that the pages of a large memory are not committed
+	const std::size_t mem_size = static_cast<std::size_t>(m_memsize - m_data_begin)*m_bytesize;
+	const std::size_t free_begin = static_cast<std::size_t>(m_stacklimit - m_data_begin)*m_bytesize;
+	const std::size_t free_end = static_cast<std::size_t>(std::max(m_sp, m_stacklimit) - m_data_begin)*m_bytesize;
+
+	m_mem.Touch(0, free_begin);
+	m_mem.Touch(free_end, mem_size - free_end);
+	snapshot->AddMemory(m_mem.Get(), mem_size, free_begin, free_end);
+
+	return snapshot;
+}
+
+
+/**
+ * continue from a captured state
+ */
+void VM::Restore(const VMSnapshot& snapshot)
+{
+	const VMSnapshot::State& state = snapshot.m_state;
+
+	if(state.data_begin != m_data_begin)
+		throw std::runtime_error("Snapshot does not match the code image.");
+
+	// the memory layout has to be consistent, also for snapshots loaded from a file
+	if(state.memsize <= m_data_begin || state.memsize > state.maxmemsize)
+		throw std::runtime_error("Snapshot has an invalid memory size.");
+	if(state.stacklimit < m_data_begin || state.sp < state.stacklimit ||
+		state.bp < state.sp || state.bp > state.memsize ||
+		state.gbp < state.stacklimit || state.gbp > state.memsize)
+		throw std::runtime_error("Snapshot has an invalid stack.");
+	if(state.code_range[0] >= 0 || state.code_range[1] >= 0)
+	{
+		if(state.code_range[0] < 0 || state.code_range[0] > state.code_range[1] ||
+			state.code_range[1] > state.stacklimit ||
+			state.ip < state.code_range[0] || state.ip > state.code_range[1])
+			throw std::runtime_error("Snapshot has an invalid code range.");
+	}
+	else if(state.ip < 0 || state.ip >= state.memsize)
+	{
+		throw std::runtime_error("Snapshot has an invalid instruction pointer.");
+	}
+	for(const auto& [bp, level] : snapshot.m_irq_frames)
+	{
+		if(bp < state.sp || bp > state.memsize)
+			throw std::runtime_error("Snapshot has an invalid interrupt frame.");
+	}
+	if(snapshot.m_isrs.size() != m_isrs.size())
+		throw std::runtime_error("Snapshot has an invalid number of interrupts.");
+	if(snapshot.m_regs.size() != (snapshot.m_irq_frames.size() + 1)*m_regfile.size())
+		throw std::runtime_error("Snapshot has an invalid number of registers.");
+	for(const auto& [addr, handle] : snapshot.m_strslots)
+	{
+		if(addr < m_data_begin || addr + m_addrsize > state.memsize)
+			throw std::runtime_error("Snapshot has an invalid string address.");
+	}
+
+	// the memory is reserved again if the snapshot does not fit
+	m_maxmemsize = std::max({ m_maxmemsize, state.maxmemsize, state.memsize });
+	const std::size_t memsize = static_cast<std::size_t>(state.memsize - m_data_begin)*m_bytesize;
+	if(memsize > m_mem.GetSize())
+		m_mem = VMMemory(static_cast<std::size_t>(m_maxmemsize - m_data_begin)*m_bytesize);
+
+	snapshot.WriteMemory(m_mem, memsize);
+
+	m_ip = state.ip;
+	m_sp = state.sp;
+	m_bp = state.bp;
+	m_gbp = state.gbp;
+	m_memsize = state.memsize;
+	m_framesize = state.framesize;
+	m_stacklimit = state.stacklimit;
+	m_code_range[0] = state.code_range[0];
+	m_code_range[1] = state.code_range[1];
+	m_irq_level = state.irq_level;
+	m_eps = state.eps;
+
+	for(std::size_t irq=0; irq<m_isrs.size(); ++irq)
+	{
+		if(snapshot.m_isrs[irq] >= 0)
+			m_isrs[irq] = snapshot.m_isrs[irq];
+		else
+			m_isrs[irq].reset();
+	}
+
+	m_irqs_pending = 0;
+	m_irq_frames.clear();
+	for(const auto& [bp, level] : snapshot.m_irq_frames)
+		m_irq_frames.emplace_back(IrqFrame{ .bp = bp, .level = level });
+
+	auto regs = snapshot.m_regs.begin();
+	std::copy_n(regs, m_regfile.size(), m_regfile.begin());
+	for(IrqFrame& frame : m_irq_frames)
+	{
+		regs += m_regfile.size();
+		std::copy_n(regs, frame.regs.size(), frame.regs.begin());
+	}
+
+	m_strheap = snapshot.m_strheap;
+	m_strslots.clear();
+	for(const auto& [addr, handle] : snapshot.m_strslots)
+		SetStrSlot(addr, true);
+	m_strlits.clear();
+	for(const auto& [addr, handle] : snapshot.m_strlits)
+		m_strlits.emplace(addr, handle);
+	m_native_strs.clear();
+	if(m_profiler)
+		m_profiler->ClearCalls();
+
+	ResetVerification();
+	JitReset();
+}
+
+
+/**
+ * create a vm continuing from the current state, sharing the memory pages
+ */
+std::unique_ptr<VM> VM::Fork()
+{
+	if(m_native_strs.size())
+		throw std::runtime_error("Cannot fork during an external call.");
+
+	// the current memory becomes a layer shared by both vms
+	const t_byte* mem = m_mem.Get();
+	std::shared_ptr<const VMMemoryLayer> layer = m_mem.Freeze();
+
+	// the compiled code refers to the previous memory
+	if(m_mem.Get() != mem)
+		JitReset();
+
+	return std::unique_ptr<VM>(new VM(*this, layer));
+}
+
+
+/**
+ * create a forked vm using the given memory layer
+ */
+VM::VM(const VM& vm, std::shared_ptr<const VMMemoryLayer> mem)
+	: m_debug{vm.m_debug}, m_checks{vm.m_checks},
+		m_verified{vm.m_verified}, m_checks_active{vm.m_checks_active},
+		m_drawmemimages{vm.m_drawmemimages}, m_zeropoppedvals{vm.m_zeropoppedvals},
+		m_jit{vm.m_jit}, m_jit_threshold{vm.m_jit_threshold},
+		m_deadline_check{vm.m_deadline_check}, m_eps{vm.m_eps},
+		m_mem{mem}, m_code{vm.m_code}, m_data_begin{vm.m_data_begin},
+		m_strheap{vm.m_strheap}, m_strslots{vm.m_strslots}, m_strlits{vm.m_strlits},
+		m_ip{vm.m_ip}, m_sp{vm.m_sp}, m_bp{vm.m_bp}, m_gbp{vm.m_gbp},
+		m_regfile{vm.m_regfile},
+		m_memsize{vm.m_memsize}, m_maxmemsize{vm.m_maxmemsize},
+		m_framesize{vm.m_framesize}, m_stacklimit{vm.m_stacklimit},
+		m_irq_level{vm.m_irq_level}, m_irq_frames{vm.m_irq_frames},
+		m_isrs{vm.m_isrs}, m_verified_isrs{vm.m_verified_isrs},
+		m_extfuncs{vm.m_extfuncs}, m_extfunc_indices{vm.m_extfunc_indices},
+		m_timerwheel{vm.m_timerwheel}, m_timer_period{vm.m_timer_period}
+{
+	m_code_range[0] = vm.m_code_range[0];
+	m_code_range[1] = vm.m_code_range[1];
+
+	// the timer interrupt of the parent is not started
+	JitReset();
+}
@@ -0,0 +1,1014 @@
+/**
+ * load-time bytecode verifier
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * The verifier decodes the code once, follows the control flow of the main
+ * program and of every function and tracks the kinds of the values on the
+ * stack. Verified code only accesses memory inside its stack frames and never
+ * pops more values than it has pushed, so it can run without bounds checks.
+ */
+
+#include "vm.h"
+
+#include <deque>
+#include <unordered_set>
+#include <algorithm>
+
+
+namespace {
+
+using t_addr = VM::t_addr;
+using t_byte = VM::t_byte;
+using t_int = VM::t_int;
+
+
+/**
+ * kinds of stack values
+ */
+enum class Slot : t_byte
+{
+	BOOL,     // raw boolean without a type descriptor
+	INT,      // raw int without a type descriptor
+	REAL,     // raw real without a type descriptor
+	VAL,      // value prefixed by its type descriptor
+	ANY,      // any number, also none, of values of any kind
+};
+
+
+/**
+ * description of a stack value for the error messages
+ */
+constexpr const char* get_slot_name(Slot slot)
+{
+	switch(slot)
+	{
+		case Slot::BOOL: return "a boolean";
+		case Slot::INT: return "an untagged int";
+		case Slot::REAL: return "an untagged real";
+		case Slot::VAL: return "a typed value";
+		default: return "unknown values";
+	}
+}
+
+// stack layout, beginning at the bottom of the stack frame
+using t_stack = std::vector<Slot>;
+
+
+/**
+ * values returned by a function
+ */
+enum class Ret : t_byte
+{
+	NONE,     // no return has been reached yet
+	NO_VAL,   // no return value
+	VAL,      // one return value
+	MAYBE,    // a return value on some of the paths
+};
+
+
+/**
+ * decoded instruction, an address, number or function name pushed
+ * right before a jump, call, memory access, return or external call
+ * is part of the instruction
+ */
+struct Instr
+{
+	OpCode op{OpCode::INVALID};
+	t_addr len{0};                     // length in bytes
+	bool fused{false};                 // is the operand pushed by this instruction?
+
+	VMType ty{VMType::UNKNOWN};        // type of the pushed operand
+	t_addr addr{0};                    // address, frame size or external function index
+	t_int num{0};                      // pushed integer
+	t_int callee_args{0};              // number of arguments passed by a tail call
+	OpCode regop{OpCode::NOP};         // operator applied to a register
+	VM::t_str name{};                  // pushed string
+
+	t_addr ctx{-1};                    // entry of the function containing the instruction
+	std::optional<t_stack> stack{};    // stack layout before the instruction
+	std::size_t visits{0};             // number of changes of the stack layout
+	bool queued{false};
+};
+
+
+/**
+ * main program, function or interrupt service routine
+ */
+struct Context
+{
+	bool main{false};                  // main program with the global variables
+	t_addr framesize{0};               // size of the stack frame
+	std::optional<t_int> num_args{};   // known from the returns
+	bool uses_args{false};             // are the arguments accessed?
+	Ret ret{Ret::NONE};
+};
+
+
+class VMVerifier
+{
+public:
+	VMVerifier(std::vector<t_byte>&& code,
+		const std::vector<VM::ExtFuncInfo>& extfuncs, t_addr framesize)
+		: m_code{std::move(code)}, m_extfuncs{extfuncs}, m_framesize{framesize}
+	{
+		for(std::size_t idx=0; idx<m_extfuncs.size(); ++idx)
+			m_extfunc_indices.emplace(m_extfuncs[idx].name, static_cast<t_addr>(idx));
+	}
+
+
+	/**
+	 * verify the code and get the entries usable as interrupt service routines
+	 */
+	std::unordered_set<t_addr> Verify(const std::vector<t_addr>& isrs)
+	{
+		Decode();
+
+		// the main program is run first, the functions are reached via
+		// calls, the interrupt service routines via their pushed addresses
+		m_pending.push_back(0);
+		for(t_addr isr : isrs)
+			m_pending.push_back(isr);
+		FindContexts();
+
+		CheckOperands();
+		Propagate();
+
+		std::unordered_set<t_addr> isr_entries;
+		for(const auto& [entry, ctx] : m_contexts)
+		{
+			if(!ctx.main && !ctx.uses_args)
+				isr_entries.insert(entry);
+		}
+
+		for(t_addr isr : isrs)
+		{
+			if(!isr_entries.contains(isr))
+				Fail(isr, "Interrupt service routine accesses function arguments");
+		}
+
+		return isr_entries;
+	}
+
+
+	/**
+	 * size of the global variables' stack frame
+	 */
+	t_addr GetGlobalFrameSize() const
+	{
+		return m_contexts.at(0).framesize;
+	}
+
+
+protected:
+	[[noreturn]] static void Fail(t_addr addr, const std::string& msg)
+	{
+		std::ostringstream ostr;
+		ostr << "Verifier: " << msg << " at address " << addr << ".";
+		throw std::runtime_error(ostr.str());
+	}
+
+
+	t_addr GetSize() const
+	{
+		return static_cast<t_addr>(m_code.size());
+	}
+
+
+	template<class t_val>
+	t_val Read(t_addr addr, t_addr instr_addr) const
+	{
+		if(addr < 0 || addr + t_addr(sizeof(t_val)) > GetSize())
+			Fail(instr_addr, "Incomplete instruction");
+
+		t_val val{};
+		std::memcpy(&val, m_code.data() + addr, sizeof(t_val));
+		return val;
+	}
+
+
+	/**
+	 * get the instruction starting at the given address
+	 */
+	Instr* GetInstr(t_addr addr)
+	{
+		if(addr < 0 || addr >= GetSize() || m_index[addr] < 0)
+			return nullptr;
+		return &m_instrs[m_index[addr]];
+	}
+
+
+	/**
+	 * decode an instruction
+	 */
+	Instr DecodeAt(t_addr addr) const
+	{
+		Instr instr{};
+		instr.op = static_cast<OpCode>(m_code[addr]);
+		instr.len = VM::m_bytesize;
+
+		switch(instr.op)
+		{
+			case OpCode::PUSH:
+			{
+				instr.ty = static_cast<VMType>(Read<t_byte>(addr + 1, addr));
+				instr.len += VM::m_bytesize;
+
+				switch(instr.ty)
+				{
+					case VMType::INT:
+						instr.num = Read<t_int>(addr + instr.len, addr);
+						instr.len += VM::m_intsize;
+						break;
+					case VMType::REAL:
+						instr.len += VM::m_realsize;
+						break;
+					case VMType::STR:
+					{
+						t_addr strlen = Read<t_addr>(addr + instr.len, addr);
+						instr.len += VM::m_addrsize;
+						if(strlen < 0 || addr + instr.len + strlen > GetSize())
+							Fail(addr, "Invalid string length");
+
+						instr.name = VM::t_str(reinterpret_cast<const VM::t_char*>(
+							m_code.data() + addr + instr.len), strlen);
+						instr.len += strlen;
+						break;
+					}
+					case VMType::ADDR_MEM:
+					case VMType::ADDR_IP:
+					case VMType::ADDR_SP:
+					case VMType::ADDR_BP:
+					case VMType::ADDR_GBP:
+					case VMType::ADDR_BP_ARG:
+						instr.addr = Read<t_addr>(addr + instr.len, addr);
+						instr.len += VM::m_addrsize;
+						break;
+					default:
+						Fail(addr, "Invalid type of pushed data");
+				}
+
+				// does the next instruction consume the pushed operand?
+				if(addr + instr.len >= GetSize())
+					break;
+
+				OpCode next = static_cast<OpCode>(m_code[addr + instr.len]);
+				bool is_addr = (static_cast<t_byte>(instr.ty) & static_cast<t_byte>(VMType::ADDR_MEM));
+				if((is_addr && (next == OpCode::JMP || next == OpCode::JMPCND ||
+					next == OpCode::CALL || next == OpCode::TAILCALL ||
+					next == OpCode::RDMEM || next == OpCode::WRMEM))
+					|| (instr.ty == VMType::INT && next == OpCode::RET)
+					|| (instr.ty == VMType::STR && next == OpCode::EXTCALL))
+				{
+					instr.op = next;
+					instr.fused = true;
+					instr.len += VM::m_bytesize;
+				}
+
+				// the numbers of arguments of the current and the called function
+				if(instr.op == OpCode::TAILCALL)
+				{
+					instr.num = Read<t_addr>(addr + instr.len, addr);
+					instr.len += VM::m_addrsize;
+					instr.callee_args = Read<t_addr>(addr + instr.len, addr);
+					instr.len += VM::m_addrsize;
+				}
+				break;
+			}
+
+			case OpCode::LDR:
+			case OpCode::STR:
+			case OpCode::OPR:
+			{
+				if(instr.op == OpCode::OPR)
+				{
+					instr.regop = static_cast<OpCode>(Read<t_byte>(addr + instr.len, addr));
+					instr.len += VM::m_bytesize;
+					if(!is_vm_register_op(instr.regop))
+						Fail(addr, "Invalid operator for a register operand");
+				}
+
+				// register number
+				instr.addr = Read<t_byte>(addr + instr.len, addr);
+				instr.len += VM::m_bytesize;
+				if(instr.addr >= VM::m_num_regs)
+					Fail(addr, "Invalid register");
+				break;
+			}
+
+			case OpCode::FRAME:
+			case OpCode::EXTCALLI:
+			{
+				instr.addr = Read<t_addr>(addr + instr.len, addr);
+				instr.len += VM::m_addrsize;
+				break;
+			}
+
+			case OpCode::PUSHI:
+			{
+				instr.num = Read<t_int>(addr + instr.len, addr);
+				instr.len += VM::m_intsize;
+				break;
+			}
+
+			case OpCode::PUSHF:
+			{
+				Read<VM::t_real>(addr + instr.len, addr);
+				instr.len += VM::m_realsize;
+				break;
+			}
+
+			case OpCode::JMP:
+			case OpCode::JMPCND:
+			case OpCode::CALL:
+			case OpCode::TAILCALL:
+			case OpCode::RDMEM:
+			case OpCode::WRMEM:
+				Fail(addr, "Address not pushed right before its use");
+			case OpCode::RET:
+				Fail(addr, "Number of arguments not pushed right before the return");
+			case OpCode::EXTCALL:
+				Fail(addr, "Function name not pushed right before the external call");
+
+			case OpCode::HALT: case OpCode::NOP:
+			case OpCode::USUB: case OpCode::ADD: case OpCode::SUB:
+			case OpCode::MUL: case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+			case OpCode::TOI: case OpCode::TOF: case OpCode::TOS:
+			case OpCode::AND: case OpCode::OR: case OpCode::XOR: case OpCode::NOT:
+			case OpCode::GT: case OpCode::LT: case OpCode::GEQU:
+			case OpCode::LEQU: case OpCode::EQU: case OpCode::NEQU:
+			case OpCode::BINAND: case OpCode::BINOR: case OpCode::BINXOR:
+			case OpCode::BINNOT: case OpCode::SHL: case OpCode::SHR:
+			case OpCode::ROTL: case OpCode::ROTR:
+			case OpCode::UNTAGI: case OpCode::UNTAGF:
+			case OpCode::TAGI: case OpCode::TAGF:
+			case OpCode::IUSUB: case OpCode::IADD: case OpCode::ISUB:
+			case OpCode::IMUL: case OpCode::IDIV: case OpCode::IMOD:
+			case OpCode::FUSUB: case OpCode::FADD: case OpCode::FSUB:
+			case OpCode::FMUL: case OpCode::FDIV: case OpCode::FMOD:
+			case OpCode::IGT: case OpCode::ILT: case OpCode::IGEQU:
+			case OpCode::ILEQU: case OpCode::IEQU: case OpCode::INEQU:
+			case OpCode::FGT: case OpCode::FLT: case OpCode::FGEQU:
+			case OpCode::FLEQU: case OpCode::FEQU: case OpCode::FNEQU:
+			case OpCode::IRET:
+				break;
+
+			// interrupt service routines are only called by the vm itself
+			default:
+				Fail(addr, "Invalid instruction");
+		}
+
+		return instr;
+	}
+
+
+	/**
+	 * split the code into instructions
+	 */
+	void Decode()
+	{
+		m_index.assign(m_code.size(), -1);
+
+		for(t_addr addr=0; addr<GetSize();)
+		{
+			m_index[addr] = static_cast<t_addr>(m_instrs.size());
+			m_instrs.emplace_back(DecodeAt(addr));
+			addr += m_instrs.back().len;
+		}
+	}
+
+
+	/**
+	 * get the target address of a jump or call or of a pushed code address
+	 */
+	t_addr GetTarget(t_addr addr, const Instr& instr) const
+	{
+		// relative addresses are resolved after the instruction has been read
+		std::int64_t base = 0;
+		if(instr.ty == VMType::ADDR_IP)
+			base = std::int64_t(addr) + instr.len;
+
+		// the offset is arbitrary, so it is checked before it is added
+		if(instr.addr < -base || instr.addr >= std::int64_t(GetSize()) - base)
+			Fail(addr, "Jump or call target outside of the code");
+		return static_cast<t_addr>(base + instr.addr);
+	}
+
+
+	/**
+	 * assign all instructions to the main program and the functions
+	 */
+	void FindContexts()
+	{
+		while(!m_pending.empty() || !m_candidates.empty())
+		{
+			// entries of possible interrupt service routines are only
+			// considered once all called functions are known
+			if(!m_pending.empty())
+			{
+				t_addr entry = m_pending.front();
+				m_pending.pop_front();
+				AddContext(entry, entry == 0);
+			}
+			else
+			{
+				t_addr entry = m_candidates.front();
+				m_candidates.pop_front();
+
+				const Instr* instr = GetInstr(entry);
+				if(instr && (instr->ctx < 0 || instr->ctx == entry))
+					AddContext(entry, false);
+			}
+		}
+	}
+
+
+	/**
+	 * follow the control flow of a function and collect its instructions
+	 */
+	void AddContext(t_addr entry, bool main)
+	{
+		if(m_contexts.contains(entry))
+			return;
+
+		Instr* entry_instr = GetInstr(entry);
+		if(!entry_instr)
+			Fail(entry, "Function does not start at an instruction");
+		if(entry_instr->ctx >= 0)
+			Fail(entry, "Function starts inside of other code");
+
+		Context& ctx = m_contexts[entry];
+		ctx.main = main;
+		ctx.framesize = m_framesize;
+		if(entry_instr->op == OpCode::FRAME)
+			ctx.framesize = entry_instr->addr;
+
+		std::vector<t_addr> todo{ entry };
+		while(!todo.empty())
+		{
+			t_addr addr = todo.back();
+			todo.pop_back();
+
+			Instr* instr = GetInstr(addr);
+			if(!instr)
+				Fail(addr, "Jump target is not an instruction");
+			if(instr->ctx == entry)
+				continue;
+			if(instr->ctx >= 0)
+			{
+				std::ostringstream msg;
+				msg << "Code shared by the functions at " << instr->ctx << " and " << entry;
+				Fail(addr, msg.str());
+			}
+			instr->ctx = entry;
+
+			bool falls_through = true;
+			switch(instr->op)
+			{
+				case OpCode::HALT:
+				case OpCode::IRET:
+					falls_through = false;
+					if(main && instr->op == OpCode::IRET)
+						Fail(addr, "Interrupt return outside of a service routine");
+					break;
+
+				case OpCode::RET:
+					falls_through = false;
+					if(main)
+						Fail(addr, "Return outside of a function");
+					if(instr->num < 0 || (ctx.num_args && *ctx.num_args != instr->num))
+						Fail(addr, "Inconsistent number of function arguments");
+					ctx.num_args = instr->num;
+					break;
+
+				case OpCode::FRAME:
+					if(addr != entry)
+						Fail(addr, "Stack frame not set up at the start of the function");
+					if(instr->addr < VM::m_addrsize)
+						Fail(addr, "Invalid stack frame size");
+					break;
+
+				case OpCode::JMP:
+				case OpCode::JMPCND:
+					if(instr->ty != VMType::ADDR_MEM && instr->ty != VMType::ADDR_IP)
+						Fail(addr, "Jump address is not a code address");
+					todo.push_back(GetTarget(addr, *instr));
+					falls_through = (instr->op == OpCode::JMPCND);
+					break;
+
+				case OpCode::TAILCALL:
+					// the current function is left like by a return
+					if(main)
+						Fail(addr, "Tail call outside of a function");
+					if(instr->num < 0 || (ctx.num_args && *ctx.num_args != instr->num))
+						Fail(addr, "Inconsistent number of function arguments");
+					ctx.num_args = instr->num;
+					[[fallthrough]];
+
+				case OpCode::CALL:
+				{
+					if(instr->ty != VMType::ADDR_MEM && instr->ty != VMType::ADDR_IP)
+						Fail(addr, "Function address is not a code address");
+					t_addr target = GetTarget(addr, *instr);
+					if(target == 0)
+						Fail(addr, "Call of the main program");
+					m_pending.push_back(target);
+					m_callers[target].push_back(addr);
+					break;
+				}
+
+				case OpCode::RDMEM:
+				case OpCode::WRMEM:
+					if(instr->ty != VMType::ADDR_BP && instr->ty != VMType::ADDR_GBP &&
+						instr->ty != VMType::ADDR_BP_ARG)
+						Fail(addr, "Memory access outside of the stack frames");
+					break;
+
+				case OpCode::PUSH:
+					// code addresses pushed as values might be used for interrupts
+					if(instr->ty == VMType::ADDR_MEM)
+						m_candidates.push_back(instr->addr);
+					break;
+
+				default:
+					break;
+			}
+
+			if(main && instr->ty == VMType::ADDR_BP_ARG)
+				Fail(addr, "Function argument accessed outside of a function");
+
+			if(falls_through)
+			{
+				if(addr + instr->len >= GetSize())
+					Fail(addr, "Code ends without a halt or a jump");
+				todo.push_back(addr + instr->len);
+			}
+		}
+	}
+
+
+	/**
+	 * check the variable addresses against the stack frames
+	 */
+	void CheckOperands()
+	{
+		// the value with the longest size including its type descriptor
+		constexpr t_addr max_valsize = VM::m_bytesize + std::max(VM::m_realsize, VM::m_intsize);
+
+		const Context& main_ctx = m_contexts.at(0);
+
+		for(t_addr addr=0; addr<GetSize(); ++addr)
+		{
+			Instr* instr = GetInstr(addr);
+			if(!instr || instr->ctx < 0)
+				continue;
+
+			Context& ctx = m_contexts.at(instr->ctx);
+			bool is_mem = (instr->op == OpCode::RDMEM || instr->op == OpCode::WRMEM);
+			if(!is_mem && instr->op != OpCode::PUSH)
+				continue;
+
+			switch(instr->ty)
+			{
+				case VMType::ADDR_BP:
+				case VMType::ADDR_GBP:
+				{
+					if(!is_mem)
+						break;
+
+					// the local variables are below the frame size,
+					// which is stored right below the base pointer,
+					// in the main program the base pointer is the global one
+					t_addr framesize = instr->ty == VMType::ADDR_BP
+						? ctx.framesize : main_ctx.framesize;
+					if(instr->addr < -framesize || instr->addr + max_valsize > -VM::m_addrsize)
+						Fail(addr, "Variable address outside of the stack frame");
+					break;
+				}
+
+				case VMType::ADDR_BP_ARG:
+				{
+					// index 0 is the saved base pointer and 1 the return address
+					ctx.uses_args = true;
+					if(!ctx.num_args || instr->addr < 2 || instr->addr >= 2 + *ctx.num_args)
+						Fail(addr, "Invalid function argument index");
+					break;
+				}
+
+				default:
+					break;
+			}
+		}
+	}
+
+
+	/**
+	 * join the stack layouts of two paths, the common bottom and top
+	 * values are kept and the differing ones in between are replaced
+	 */
+	static t_stack Join(const t_stack& stack1, const t_stack& stack2)
+	{
+		if(stack1 == stack2)
+			return stack1;
+
+		std::size_t bottom = 0;
+		while(bottom < stack1.size() && bottom < stack2.size() &&
+			stack1[bottom] == stack2[bottom])
+			++bottom;
+
+		std::size_t top = 0;
+		while(top < stack1.size() - bottom && top < stack2.size() - bottom &&
+			stack1[stack1.size() - top - 1] == stack2[stack2.size() - top - 1])
+			++top;
+
+		// the differing values are replaced by unknown ones
+		t_stack stack(stack1.begin(), stack1.begin() + bottom);
+		if(stack.empty() || stack.back() != Slot::ANY)
+			stack.push_back(Slot::ANY);
+
+		for(std::size_t idx = stack1.size() - top; idx < stack1.size(); ++idx)
+		{
+			if(stack1[idx] == Slot::ANY && stack.back() == Slot::ANY)
+				continue;
+			stack.push_back(stack1[idx]);
+		}
+
+		return stack;
+	}
+
+
+	/**
+	 * merge a stack layout into the one before an instruction
+	 */
+	void Merge(t_addr addr, const t_stack& stack)
+	{
+		Instr* instr = GetInstr(addr);
+
+		if(instr->stack)
+		{
+			t_stack joined = Join(*instr->stack, stack);
+			if(joined == *instr->stack)
+				return;
+
+			// joined layouts only become less specific
+			if(++instr->visits > m_max_visits)
+				Fail(addr, "Stack layout does not converge");
+			instr->stack = std::move(joined);
+		}
+		else
+		{
+			instr->stack = stack;
+		}
+
+		if(!instr->queued)
+		{
+			instr->queued = true;
+			m_worklist.push_back(addr);
+		}
+	}
+
+
+	/**
+	 * get the external function called by an instruction
+	 */
+	const VM::ExtFuncInfo& GetExtFunc(t_addr addr, const Instr& instr) const
+	{
+		t_addr idx = instr.addr;
+		if(instr.op == OpCode::EXTCALL)
+		{
+			auto iter = m_extfunc_indices.find(instr.name);
+			if(iter == m_extfunc_indices.end())
+				Fail(addr, "Unknown external function \"" + instr.name + "\"");
+			idx = iter->second;
+		}
+
+		if(idx < 0 || idx >= static_cast<t_addr>(m_extfuncs.size()))
+			Fail(addr, "Invalid external function index");
+		return m_extfuncs[idx];
+	}
+
+
+	/**
+	 * track the stack layouts through all functions until they don't change anymore
+	 */
+	void Propagate()
+	{
+		for(const auto& [entry, ctx] : m_contexts)
+			Merge(entry, t_stack{});
+
+		while(!m_worklist.empty())
+		{
+			t_addr addr = m_worklist.front();
+			m_worklist.pop_front();
+
+			Instr& instr = *GetInstr(addr);
+			instr.queued = false;
+			Step(addr, instr, *instr.stack);
+		}
+	}
+
+
+	/**
+	 * apply an instruction to the stack layout
+	 */
+	void Step(t_addr addr, const Instr& instr, t_stack stack)
+	{
+		auto pop = [addr, &stack](Slot kind)
+		{
+			if(stack.empty())
+				Fail(addr, "Stack underflow");
+			if(stack.back() == Slot::ANY)
+				Fail(addr, "Unknown values on the stack");
+			if(stack.back() != kind)
+				Fail(addr, std::string("Expected ") + get_slot_name(kind) + " on the stack");
+			stack.pop_back();
+		};
+
+		const t_addr next = addr + instr.len;
+
+		switch(instr.op)
+		{
+			case OpCode::HALT:
+			case OpCode::IRET:
+				return;
+
+			case OpCode::PUSH:
+			case OpCode::RDMEM:
+			case OpCode::LDR:
+				stack.push_back(Slot::VAL);
+				break;
+
+			case OpCode::WRMEM:
+			case OpCode::STR:
+				pop(Slot::VAL);
+				break;
+
+			case OpCode::OPR:
+			{
+				// the register is the second operand
+				pop(Slot::VAL);
+				bool is_cmp = (instr.regop >= OpCode::GT && instr.regop <= OpCode::NEQU);
+				stack.push_back(is_cmp ? Slot::BOOL : Slot::VAL);
+				break;
+			}
+
+			case OpCode::USUB:
+			case OpCode::BINNOT:
+			case OpCode::TOI:
+			case OpCode::TOF:
+			case OpCode::TOS:
+				pop(Slot::VAL);
+				stack.push_back(Slot::VAL);
+				break;
+
+			case OpCode::ADD: case OpCode::SUB: case OpCode::MUL:
+			case OpCode::DIV: case OpCode::MOD: case OpCode::POW:
+			case OpCode::BINAND: case OpCode::BINOR: case OpCode::BINXOR:
+			case OpCode::SHL: case OpCode::SHR: case OpCode::ROTL: case OpCode::ROTR:
+				pop(Slot::VAL);
+				pop(Slot::VAL);
+				stack.push_back(Slot::VAL);
+				break;
+
+			case OpCode::GT: case OpCode::LT: case OpCode::GEQU:
+			case OpCode::LEQU: case OpCode::EQU: case OpCode::NEQU:
+				pop(Slot::VAL);
+				pop(Slot::VAL);
+				stack.push_back(Slot::BOOL);
+				break;
+
+			case OpCode::UNTAGI:
+			case OpCode::UNTAGF:
+				pop(Slot::VAL);
+				stack.push_back(instr.op == OpCode::UNTAGI ? Slot::INT : Slot::REAL);
+				break;
+
+			case OpCode::TAGI:
+			case OpCode::TAGF:
+				pop(instr.op == OpCode::TAGI ? Slot::INT : Slot::REAL);
+				stack.push_back(Slot::VAL);
+				break;
+
+			case OpCode::PUSHI:
+			case OpCode::PUSHF:
+				stack.push_back(instr.op == OpCode::PUSHI ? Slot::INT : Slot::REAL);
+				break;
+
+			case OpCode::IUSUB:
+			case OpCode::FUSUB:
+			{
+				const Slot kind = (instr.op == OpCode::IUSUB ? Slot::INT : Slot::REAL);
+				pop(kind);
+				stack.push_back(kind);
+				break;
+			}
+
+			case OpCode::IADD: case OpCode::ISUB: case OpCode::IMUL:
+			case OpCode::IDIV: case OpCode::IMOD:
+				pop(Slot::INT);
+				pop(Slot::INT);
+				stack.push_back(Slot::INT);
+				break;
+
+			case OpCode::FADD: case OpCode::FSUB: case OpCode::FMUL:
+			case OpCode::FDIV: case OpCode::FMOD:
+				pop(Slot::REAL);
+				pop(Slot::REAL);
+				stack.push_back(Slot::REAL);
+				break;
+
+			case OpCode::IGT: case OpCode::ILT: case OpCode::IGEQU:
+			case OpCode::ILEQU: case OpCode::IEQU: case OpCode::INEQU:
+				pop(Slot::INT);
+				pop(Slot::INT);
+				stack.push_back(Slot::BOOL);
+				break;
+
+			case OpCode::FGT: case OpCode::FLT: case OpCode::FGEQU:
+			case OpCode::FLEQU: case OpCode::FEQU: case OpCode::FNEQU:
+				pop(Slot::REAL);
+				pop(Slot::REAL);
+				stack.push_back(Slot::BOOL);
+				break;
+
+			case OpCode::AND:
+			case OpCode::OR:
+			case OpCode::XOR:
+				pop(Slot::BOOL);
+				pop(Slot::BOOL);
+				stack.push_back(Slot::BOOL);
+				break;
+
+			case OpCode::NOT:
+				pop(Slot::BOOL);
+				stack.push_back(Slot::BOOL);
+				break;
+
+			case OpCode::JMP:
+				Merge(GetTarget(addr, instr), stack);
+				return;
+
+			case OpCode::JMPCND:
+				pop(Slot::BOOL);
+				Merge(GetTarget(addr, instr), stack);
+				break;
+
+			case OpCode::CALL:
+			case OpCode::TAILCALL:
+			{
+				// the arguments are removed by the return
+				const Context& callee = m_contexts.at(GetTarget(addr, instr));
+				if(!callee.num_args)
+					return;
+				if(instr.op == OpCode::TAILCALL && instr.callee_args != *callee.num_args)
+					Fail(addr, "Inconsistent number of function arguments");
+				for(t_int arg=0; arg<*callee.num_args; ++arg)
+					pop(Slot::VAL);
+
+				// the called function's return value is returned directly
+				// (or by the following return in interrupt service routines),
+				// so no other values may remain in the frame
+				if(instr.op == OpCode::TAILCALL && !stack.empty())
+					Fail(addr, "Values left on the stack before a tail call");
+
+				if(callee.ret == Ret::NONE)
+					return;
+				else if(callee.ret == Ret::VAL)
+					stack.push_back(Slot::VAL);
+				else if(callee.ret == Ret::MAYBE && (stack.empty() || stack.back() != Slot::ANY))
+					stack.push_back(Slot::ANY);
+				break;
+			}
+
+			case OpCode::RET:
+			{
+				// the topmost value is returned, see VM::Execute
+				Ret ret = Ret::NO_VAL;
+				if(!stack.empty())
+				{
+					if(stack.back() == Slot::BOOL)
+						Fail(addr, "Boolean without type descriptor returned");
+					if(stack.back() == Slot::INT || stack.back() == Slot::REAL)
+						Fail(addr, "Number without type descriptor returned");
+					bool any = std::all_of(stack.begin(), stack.end(),
+						[](Slot slot) -> bool { return slot == Slot::ANY; });
+					ret = any ? Ret::MAYBE : Ret::VAL;
+				}
+
+				Context& ctx = m_contexts.at(instr.ctx);
+				if(ctx.ret != Ret::NONE && ctx.ret != ret)
+					ret = Ret::MAYBE;
+				if(ret == ctx.ret)
+					return;
+
+				// the calls of the function have to be looked at again
+				ctx.ret = ret;
+				for(t_addr caller : m_callers[instr.ctx])
+				{
+					Instr* call = GetInstr(caller);
+					if(call->stack && !call->queued)
+					{
+						call->queued = true;
+						m_worklist.push_back(caller);
+					}
+				}
+				return;
+			}
+
+			case OpCode::FRAME:
+				// resizing the frame removes all values
+				stack.clear();
+				break;
+
+			case OpCode::EXTCALL:
+			case OpCode::EXTCALLI:
+			{
+				const VM::ExtFuncInfo& func = GetExtFunc(addr, instr);
+				for(std::size_t arg=0; arg<func.args.size(); ++arg)
+					pop(Slot::VAL);
+				if(func.ret != VMType::UNKNOWN)
+					stack.push_back(Slot::VAL);
+				break;
+			}
+
+			default:
+				break;
+		}
+
+		Merge(next, stack);
+	}
+
+
+private:
+	std::vector<t_byte> m_code{};
+	const std::vector<VM::ExtFuncInfo>& m_extfuncs;
+	std::unordered_map<VM::t_str, t_addr> m_extfunc_indices{};
+	t_addr m_framesize{};                 // default stack frame size
+
+	std::vector<Instr> m_instrs{};
+	std::vector<t_addr> m_index{};        // instruction index for each address
+
+	std::map<t_addr, Context> m_contexts{};
+	std::unordered_map<t_addr, std::vector<t_addr>> m_callers{}; // calls of each function
+	std::deque<t_addr> m_pending{};       // entries of called functions
+	std::deque<t_addr> m_candidates{};    // pushed code addresses
+
+	std::deque<t_addr> m_worklist{};
+	static constexpr const std::size_t m_max_visits = 64;
+};
+
+} // anonymous namespace
+
+
+/**
+ * verify the loaded code, verified code runs without memory bounds checks
+ */
+void VM::Verify()
+{
+	ResetVerification();
+
+	if(m_code_range[0] != 0 || m_code_range[1] <= 0)
+		throw std::runtime_error("Verifier: The code has to start at address 0.");
+
+	// the code might be split between a shared image and the vm's own memory
+	std::vector<t_byte> code(m_code_range[1]);
+	for(t_addr addr=0; addr<m_code_range[1]; ++addr)
+		code[addr] = *MemPtr(addr);
+
+	std::vector<t_addr> isrs;
+	for(const std::optional<t_addr>& isr : m_isrs)
+	{
+		if(isr)
+			isrs.push_back(*isr);
+	}
+
+	VMVerifier verifier{std::move(code), m_extfuncs, m_framesize};
+	std::unordered_set<t_addr> isr_entries = verifier.Verify(isrs);
+
+	// the global variables are addressed up to the main program's frame size,
+	// so set up its frame right away if the program has not yet started
+	t_addr glob_framesize = verifier.GetGlobalFrameSize();
+	t_addr cur_framesize = ReadMemRaw<t_addr>(m_gbp - m_addrsize);
+	if(cur_framesize < glob_framesize)
+	{
+		if(m_ip != 0 || m_bp != m_gbp || m_sp != m_gbp - cur_framesize)
+			throw std::runtime_error("Verifier: The global stack frame is too small.");
+		SetFrameSize(glob_framesize);
+	}
+
+	m_verified_isrs = std::move(isr_entries);
+	m_verified = true;
+	m_checks_active = false;
+}
+
+
+/**
+ * return to running the code with bounds checks
+ */
+void VM::ResetVerification()
+{
+	m_verified = false;
+	m_checks_active = m_checks;
+	m_verified_isrs.clear();
+}
@@ -0,0 +1,63 @@
+/**
+ * construction of syntax trees for the code generator tests
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_TEST_AST_BUILD_H__
+#define __LR1_TEST_AST_BUILD_H__
+
+#include "codegen/ast.h"
+
+#include <string>
+#include <memory>
+
+
+static inline t_astbaseptr make_int(t_int val)
+{
+	auto tok = std::make_shared<ASTToken<t_int>>(0, 0, val, 1);
+	tok->SetDataType(VMType::INT);
+	return tok;
+}
+
+
+static inline t_astbaseptr make_real(t_real val)
+{
+	auto tok = std::make_shared<ASTToken<t_real>>(0, 0, val, 1);
+	tok->SetDataType(VMType::REAL);
+	return tok;
+}
+
+
+static inline t_astbaseptr make_str(const std::string& val)
+{
+	auto tok = std::make_shared<ASTToken<std::string>>(0, 0, val, 1);
+	tok->SetDataType(VMType::STR);
+	return tok;
+}
+
+
+static inline t_astbaseptr make_var(const std::string& name, VMType ty, bool lval = false)
+{
+	auto tok = std::make_shared<ASTToken<std::string>>(0, 0, name, 1);
+	tok->SetIdent(true);
+	tok->SetLValue(lval);
+	tok->SetDataType(ty);
+	return tok;
+}
+
+
+static inline t_astbaseptr make_bin(std::size_t op, const t_astbaseptr& arg1, const t_astbaseptr& arg2)
+{
+	return std::make_shared<ASTBinary>(0, 0, arg1, arg2, op);
+}
+
+
+static inline t_astbaseptr make_un(std::size_t op, const t_astbaseptr& arg)
+{
+	return std::make_shared<ASTUnary>(0, 0, arg, op);
+}
+
+
+#endif
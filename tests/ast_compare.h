@@ -0,0 +1,57 @@
+/**
+ * comparison of syntax trees for the parser tests
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ */
+
+#ifndef __LR1_TEST_AST_COMPARE_H__
+#define __LR1_TEST_AST_COMPARE_H__
+
+#include "codegen/ast.h"
+
+#include <string>
+#include <memory>
+
+
+/**
+ * compare two syntax trees including their positions, data types and token attributes
+ */
+static inline bool same_tree(const t_astbaseptr& ast1, const t_astbaseptr& ast2)
+{
+	if(!ast1 || !ast2)
+		return ast1 == ast2;
+
+	if(ast1->GetType() != ast2->GetType() || ast1->GetId() != ast2->GetId() ||
+		ast1->GetTableIdx() != ast2->GetTableIdx() ||
+		ast1->GetSourceRange() != ast2->GetSourceRange() ||
+		ast1->GetLineRange() != ast2->GetLineRange() ||
+		ast1->GetDataType() != ast2->GetDataType() ||
+		ast1->NumChildren() != ast2->NumChildren())
+		return false;
+
+	if(auto tok1 = std::dynamic_pointer_cast<ASTToken<std::string>>(ast1); tok1)
+	{
+		auto tok2 = std::dynamic_pointer_cast<ASTToken<std::string>>(ast2);
+		if(!tok2 || tok1->GetLexerValue() != tok2->GetLexerValue() ||
+			tok1->IsLValue() != tok2->IsLValue() || tok1->IsIdent() != tok2->IsIdent())
+			return false;
+	}
+	else if(auto tok1 = std::dynamic_pointer_cast<ASTToken<t_int>>(ast1); tok1)
+	{
+		auto tok2 = std::dynamic_pointer_cast<ASTToken<t_int>>(ast2);
+		if(!tok2 || tok1->GetLexerValue() != tok2->GetLexerValue())
+			return false;
+	}
+
+	for(std::size_t childidx=0; childidx<ast1->NumChildren(); ++childidx)
+	{
+		if(!same_tree(ast1->GetChild(childidx), ast2->GetChild(childidx)))
+			return false;
+	}
+
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * test of the constant folding and algebraic simplification
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Compiles expressions with and without simplifying their syntax trees,
+ * runs both in the vm and compares the results.
+ */
+
+#include "codegen/ast.h"
+#include "codegen/ast_opt.h"
+#include "codegen/ast_ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+#include "ast_build.h"
+
+#include <iostream>
+#include <functional>
+
+
+using t_ops = std::unordered_map<std::size_t, std::tuple<std::string, OpCode>>;
+static constexpr std::size_t shl_id = 1000;
+
+
+/**
+ * program which sets x = 7 and y = 2.5 and leaves the expression on the stack
+ */
+static t_astbaseptr make_program(const std::function<t_astbaseptr()>& make_expr)
+{
+	auto prog = std::make_shared<ASTList>(0, 0);
+	prog->AddChild(make_bin('=', make_int(7), make_var("x", VMType::INT, true)));
+	prog->AddChild(make_bin('=', make_real(2.5), make_var("y", VMType::REAL, true)));
+	prog->AddChild(make_expr());
+	prog->DeriveDataType();
+	return prog;
+}
+
+
+/**
+ * compile and run a program, returns the value on top of the stack
+ */
+static VM::t_data run(const t_astbaseptr& ast, t_ops& ops, std::size_t& num_instrs)
+{
+	ASTIR astir{&ops};
+	ast->accept(&astir);
+	astir.FinishCodegen();
+	IRProgram& ir = astir.GetProgram();
+	ir_optimise(ir);
+	num_instrs = ir.NumInstructions();
+
+	CodeBuilder code;
+	IRAsm irasm{code};
+	irasm.Emit(ir);
+
+	VM vm(0x1000);
+	vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+	vm.Run();
+	return vm.TopData();
+}
+
+
+int main()
+{
+	t_ops ops
+	{{
+		std::make_pair('+', std::make_tuple("add", OpCode::ADD)),
+		std::make_pair('-', std::make_tuple("sub", OpCode::SUB)),
+		std::make_pair('*', std::make_tuple("mul", OpCode::MUL)),
+		std::make_pair('/', std::make_tuple("div", OpCode::DIV)),
+		std::make_pair('%', std::make_tuple("mod", OpCode::MOD)),
+		std::make_pair('^', std::make_tuple("pow", OpCode::POW)),
+		std::make_pair('=', std::make_tuple("wrmem", OpCode::WRMEM)),
+		std::make_pair('&', std::make_tuple("binand", OpCode::BINAND)),
+		std::make_pair('~', std::make_tuple("binnot", OpCode::BINNOT)),
+		std::make_pair(shl_id, std::make_tuple("shl", OpCode::SHL)),
+	}};
+
+	auto x = []() { return make_var("x", VMType::INT); };
+	auto y = []() { return make_var("y", VMType::REAL); };
+
+	// expression, number of folded constants and of simplified operations
+	std::vector<std::tuple<std::string, std::function<t_astbaseptr()>, std::size_t, std::size_t>> tests
+	{{
+		{ "2*3 + x", [&]() { return make_bin('+', make_bin('*', make_int(2), make_int(3)), x()); }, 1, 0 },
+		{ "x*1 + 0", [&]() { return make_bin('+', make_bin('*', x(), make_int(1)), make_int(0)); }, 0, 2 },
+		{ "x*8", [&]() { return make_bin('*', x(), make_int(8)); }, 0, 1 },
+		{ "4*x - 0", [&]() { return make_bin('-', make_bin('*', make_int(4), x()), make_int(0)); }, 0, 2 },
+		{ "x/1 + 7/2", [&]() { return make_bin('+', make_bin('/', x(), make_int(1)),
+			make_bin('/', make_int(7), make_int(2))); }, 1, 1 },
+		{ "2.5*2", [&]() { return make_bin('*', make_real(2.5), make_int(2)); }, 1, 0 },
+		{ "\"n=\" + 5", [&]() { return make_bin('+', make_str("n="), make_int(5)); }, 1, 0 },
+		{ "-3 + x", [&]() { return make_bin('+', make_un('-', make_int(3)), x()); }, 1, 0 },
+		{ "~5 & x", [&]() { return make_bin('&', make_un('~', make_int(5)), x()); }, 1, 0 },
+		{ "+x", [&]() { return make_un('+', x()); }, 0, 1 },
+		{ "y^1.0 * 1", [&]() { return make_bin('*', make_bin('^', y(), make_real(1.)), make_int(1)); }, 0, 2 },
+		{ "y + 0", [&]() { return make_bin('+', y(), make_real(0.)); }, 0, 0 },
+		{ "x*3", [&]() { return make_bin('*', x(), make_int(3)); }, 0, 0 },
+	}};
+
+	bool ok = true;
+	for(const auto& [name, make_expr, num_folded, num_simplified] : tests)
+	{
+		try
+		{
+			std::size_t num_instrs = 0, num_instrs_opt = 0;
+			VM::t_data result = run(make_program(make_expr), ops, num_instrs);
+
+			ASTOpt astopt{&ops};
+			t_astbaseptr ast = astopt.Optimise(make_program(make_expr));
+			VM::t_data result_opt = run(ast, ops, num_instrs_opt);
+
+			bool same = result == result_opt;
+			bool counts = astopt.GetNumFolded() == num_folded &&
+				astopt.GetNumSimplified() == num_simplified;
+			// shifts and unary plus do not save instructions
+			bool shorter = num_folded > 0
+				? num_instrs_opt < num_instrs : num_instrs_opt <= num_instrs;
+
+			std::cout << name << ": " << num_instrs << " -> " << num_instrs_opt
+				<< " instructions, folded " << astopt.GetNumFolded()
+				<< ", simplified " << astopt.GetNumSimplified() << "." << std::endl;
+
+			if(!same || !counts || !shorter)
+			{
+				std::cerr << "Failed: " << name
+					<< (same ? "" : ", different results")
+					<< (counts ? "" : ", unexpected simplifications")
+					<< (shorter ? "" : ", unexpected code size")
+					<< "." << std::endl;
+				ok = false;
+			}
+		}
+		catch(const std::exception& err)
+		{
+			std::cerr << "Error in " << name << ": " << err.what() << std::endl;
+			ok = false;
+		}
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
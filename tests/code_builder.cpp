@@ -0,0 +1,142 @@
+/**
+ * test of the in-memory code builder
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds a program with forward and backward jumps and calls using
+ * labels, lists and runs it in the vm without writing it to a stream.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+
+/**
+ * the program counts to 10 in a loop, calls f() and g() defined behind it
+ * and returns the sum, i.e. 10 + 3 + 4
+ */
+static void create_program(CodeBuilder& code)
+{
+	CodeBuilder::Label loop = code.NewLabel();
+	CodeBuilder::Label skip = code.NewLabel();
+	CodeBuilder::Label f = code.NewLabel();
+	CodeBuilder::Label g = code.NewLabel();
+
+	// counter in global memory
+	code.PushInt(0);
+	code.PushAddr(VMType::ADDR_MEM, 0x800);
+	code.Op(OpCode::WRMEM);
+
+	// loop while the counter is smaller than 10
+	code.Bind(loop);
+	code.PushAddr(VMType::ADDR_MEM, 0x800);
+	code.Op(OpCode::RDMEM);
+	code.PushInt(1);
+	code.Op(OpCode::ADD);
+	code.PushAddr(VMType::ADDR_MEM, 0x800);
+	code.Op(OpCode::WRMEM);
+
+	code.PushAddr(VMType::ADDR_MEM, 0x800);
+	code.Op(OpCode::RDMEM);
+	code.PushInt(10);
+	code.Op(OpCode::LT);
+	code.Jump(OpCode::JMPCND, loop);
+
+	// skip over unused code
+	code.Jump(OpCode::JMP, skip);
+	code.PushInt(100);
+	code.Op(OpCode::ADD);
+	code.Bind(skip);
+
+	code.PushAddr(VMType::ADDR_MEM, 0x800);
+	code.Op(OpCode::RDMEM);
+	code.PushLabel(f, true);
+	code.Op(OpCode::CALL);
+	code.Op(OpCode::ADD);
+	code.PushLabel(g, false);
+	code.Op(OpCode::CALL);
+	code.Op(OpCode::ADD);
+	code.Op(OpCode::HALT);
+
+	code.Bind(f);
+	code.PushInt(3);
+	code.PushInt(0);
+	code.Op(OpCode::RET);
+
+	code.Bind(g);
+	code.PushInt(4);
+	code.PushInt(0);
+	code.Op(OpCode::RET);
+
+	code.Resolve();
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		CodeBuilder code;
+		create_program(code);
+		check(code.GetCode().size() > 0 && code.GetCode()[0] == static_cast<VM::t_byte>(OpCode::PUSH),
+			"code");
+
+		// listing with one line per instruction
+		std::ostringstream ostrListing;
+		VM::Disassemble(ostrListing, code.GetCode().data(),
+			static_cast<VM::t_addr>(code.GetCode().size()));
+		const std::string listing = ostrListing.str();
+		std::cout << listing;
+		check(std::count(listing.begin(), listing.end(), '\n') == 34, "number of listed instructions");
+		check(listing.starts_with("       0: push int 0\n"), "first listed instruction");
+		check(listing.ends_with(": ret\n"), "last listed instruction");
+
+		// the vm takes over the built code
+		VM vm(0x1000);
+		vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+		vm.Run();
+
+		VM::t_data result = vm.TopData();
+		check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == 17, "result");
+
+		// labels which are used, but never bound
+		CodeBuilder code_unbound;
+		CodeBuilder::Label label = code_unbound.NewLabel();
+		code_unbound.Jump(OpCode::JMP, label);
+		check(!code_unbound.GetAddr(label), "unbound label");
+
+		bool thrown = false;
+		try
+		{
+			code_unbound.Resolve();
+		}
+		catch(const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		check(thrown, "unresolved label");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,120 @@
+/**
+ * test of the compiled programs cache
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Hashes compilation inputs, stores programs with their symbol tables
+ * and loads them again.
+ */
+
+#include "codegen/compile_cache.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+
+int main()
+{
+	namespace fs = std::filesystem;
+
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	const fs::path dir = fs::temp_directory_path() / "lr1_compile_cache_test";
+	fs::remove_all(dir);
+
+	try
+	{
+		// keys of the inputs
+		auto get_hash = [](const std::string& src1, const std::string& src2,
+			bool opt, const t_vecIdx& vec) -> CompileCache::t_hash
+		{
+			CompileCache::Key key;
+			key.Add(src1);
+			key.Add(src2);
+			key.Add(opt);
+			key.Add(vec);
+			return key.GetHash();
+		};
+
+		const CompileCache::t_hash hash = get_hash("a = 1;", "", true, { 1, 2, 3 });
+		check(hash == get_hash("a = 1;", "", true, { 1, 2, 3 }), "same key");
+		check(hash != get_hash("a = 2;", "", true, { 1, 2, 3 }), "key of a different source");
+		check(hash != get_hash("a = 1;", "", false, { 1, 2, 3 }), "key of a different option");
+		check(hash != get_hash("a = 1;", "", true, { 1, 2, 4 }), "key of different tables");
+		check(hash != get_hash("a = ", "1;", true, { 1, 2, 3 }), "key of split strings");
+
+		using t_rows = std::vector<std::vector<std::size_t>>;
+		t_table tab1{t_rows(2, std::vector<std::size_t>(3, 0))};
+		t_table tab2{t_rows(3, std::vector<std::size_t>(2, 0))};
+		CompileCache::Key key1, key2;
+		key1.Add(tab1);
+		key2.Add(tab2);
+		check(key1.GetHash() != key2.GetHash(), "key of differently shaped tables");
+
+		// store and load a program
+		CompileCache cache{dir.string()};
+		check(!cache.Load(hash), "program not in the cache");
+
+		const std::vector<t_vm_byte> code{ 0x10, 0x20, 0x00, 0xff, 0x01 };
+		SymTab symtab;
+		symtab.AddSymbol("f", 12, VMType::ADDR_MEM, VMType::UNKNOWN, true, 2, 69);
+		symtab.AddSymbol("f/n", 2, VMType::ADDR_BP, VMType::INT);
+		symtab.AddSymbol("x", -69, VMType::ADDR_GBP, VMType::REAL);
+		cache.Store(hash, code, symtab);
+
+		std::optional<CompileCache::Entry> entry = cache.Load(hash);
+		check(entry.has_value(), "program in the cache");
+		if(entry)
+		{
+			check(entry->code == code, "cached code");
+			check(entry->symtab.GetSymbols().size() == 3, "number of cached symbols");
+
+			const SymInfo* func = entry->symtab.GetSymbol("f");
+			check(func && func->is_func && func->addr == 12 && func->loc == VMType::ADDR_MEM
+				&& func->num_args == 2 && func->frame_size == 69, "cached function");
+			const SymInfo* var = entry->symtab.GetSymbol("x");
+			check(var && !var->is_func && var->addr == -69 && var->loc == VMType::ADDR_GBP
+				&& var->ty == VMType::REAL, "cached variable");
+		}
+
+		// replace the program
+		cache.Store(hash, std::vector<t_vm_byte>{ 0x00 }, SymTab{});
+		entry = cache.Load(hash);
+		check(entry && entry->code.size() == 1 && entry->symtab.GetSymbols().empty(), "replaced program");
+		check(std::distance(fs::directory_iterator{dir}, fs::directory_iterator{}) == 1, "files in the cache");
+
+		// truncated file
+		fs::resize_file(cache.GetFilename(hash), 20);
+		bool invalid = false;
+		try
+		{
+			cache.Load(hash);
+		}
+		catch(const std::exception& err)
+		{
+			std::cout << err.what() << std::endl;
+			invalid = true;
+		}
+		check(invalid, "truncated file");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	fs::remove_all(dir);
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,154 @@
+/**
+ * test of the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds a program in the intermediate representation, simplifies its
+ * control flow, lowers it to vm code and runs it.
+ */
+
+#include "codegen/ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+
+#include <iostream>
+
+
+/**
+ * the global code stores 5 in x and returns f(x*2), with f(a) = a + 1
+ */
+static void create_program(IRProgram& prog)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+	t_vm_addr glob_stack = vm_type_size<VMType::ADDR_MEM, false> + vm_type_size<VMType::INT, true>;
+	const SymInfo sym_x = *symtab.AddSymbol("x", -glob_stack, VMType::ADDR_GBP, VMType::INT);
+	const SymInfo sym_a = *symtab.AddSymbol("f/a", 2, VMType::ADDR_BP_ARG, VMType::UNKNOWN);
+	symtab.AddSymbol("f", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 1);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = glob_stack;
+	glob.blocks.resize(5);
+
+	t_ir_reg five = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::FUNC, .name = "f", .func = 1 },
+		IRInstr{ .op = IROp::CONST, .dst = five, .val = t_vm_int{5} },
+		IRInstr{ .op = IROp::STORE, .args = { five }, .name = "x", .sym = sym_x },
+		IRInstr{ .op = IROp::JMP, .targets = { 1, 0 } },
+	};
+
+	// jump chain
+	glob.blocks[1].instrs = { IRInstr{ .op = IROp::JMP, .targets = { 3, 0 } } };
+
+	// unreachable block
+	t_ir_reg unused = reg();
+	glob.blocks[2].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = unused, .val = t_vm_int{100} },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	t_ir_reg x = reg(), two = reg(), prod = reg(), result = reg();
+	glob.blocks[3].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = x, .name = "x", .sym = sym_x },
+		IRInstr{ .op = IROp::CONST, .dst = two, .val = t_vm_int{2} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL, .dst = prod, .args = { x, two } },
+		IRInstr{ .op = IROp::CALL, .dst = result, .args = { prod }, .name = "f" },
+		IRInstr{ .op = IROp::JMP, .targets = { 4, 0 } },
+	};
+
+	glob.blocks[4].instrs = { IRInstr{ .op = IROp::HALT } };
+
+	// function
+	IRFunc func{ .name = "f", .num_args = 1, .frame_size = vm_type_size<VMType::ADDR_MEM, false> };
+	t_ir_reg a = reg(), one = reg(), sum = reg();
+	func.blocks.resize(1);
+	func.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = a, .name = "a", .sym = sym_a },
+		IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum, .args = { a, one } },
+		IRInstr{ .op = IROp::RET, .args = { sum } },
+	};
+	prog.GetFunctions().emplace_back(std::move(func));
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		IRProgram prog;
+		create_program(prog);
+		prog.Check();
+
+		// f is kept as a function, it would otherwise be inlined
+		std::size_t num_instrs = prog.NumInstructions();
+		ir_optimise(prog, 0, g_vm_num_regs, true, false);
+		std::cout << prog << std::endl;
+
+		check(prog.GetGlobal().blocks.size() == 2, "removed blocks");
+		check(prog.NumInstructions() == num_instrs - 4, "removed instructions");
+		check(prog.GetGlobal().blocks[1].GetTerminator().op == IROp::HALT, "copied halt");
+
+		CodeBuilder code;
+		IRAsm irasm{code};
+		irasm.Emit(prog);
+		check(prog.GetSymbolTable().GetSymbol("f")->addr > 0, "function address");
+
+		VM vm(0x1000);
+		vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+		vm.Run();
+
+		VM::t_data result = vm.TopData();
+		check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == 11, "result");
+
+		// the arguments have to be on top of the stack
+		IRProgram invalid;
+		t_ir_reg reg1 = invalid.NewRegister(), reg2 = invalid.NewRegister();
+		invalid.GetGlobal().blocks.resize(1);
+		invalid.GetGlobal().blocks[0].instrs =
+		{
+			IRInstr{ .op = IROp::CONST, .dst = reg1, .val = t_vm_int{1} },
+			IRInstr{ .op = IROp::CONST, .dst = reg2, .val = t_vm_int{2} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::USUB, .args = { reg1 } },
+			IRInstr{ .op = IROp::HALT },
+		};
+
+		bool thrown = false;
+		try
+		{
+			invalid.Check();
+		}
+		catch(const std::runtime_error& err)
+		{
+			std::cout << err.what() << std::endl;
+			thrown = true;
+		}
+		check(thrown, "stack discipline");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,266 @@
+/**
+ * test of the function inlining and the tail calls
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds a program with a small function, a tail-recursive one and two
+ * mutually recursive ones, optimises, verifies and runs it and checks
+ * that the stack size does not depend on the depth of the recursion.
+ */
+
+#include "codegen/ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+
+#include <iostream>
+
+
+/**
+ * add1(a) = a + 1
+ * sum(n, acc) = n <= 0 ? acc : sum(n - 1, acc + n)
+ * even(n, s) = n == 0 ? s + "even" : odd(n - 1, s)
+ * odd(n, s) = n == 0 ? s + "odd" : even(n - 1, s)
+ *
+ * the global code computes even(num_even, "") + (add1(5) + add1(7)) + sum(num_sum, 0)
+ */
+static void create_program(IRProgram& prog, t_vm_int num_sum, t_vm_int num_even)
+{
+	constexpr t_vm_addr addrsize = vm_type_size<VMType::ADDR_MEM, false>;
+
+	SymTab& symtab = prog.GetSymbolTable();
+	t_vm_addr glob_stack = addrsize + 2*vm_type_size<VMType::INT, true>;
+	const SymInfo sym_r = *symtab.AddSymbol("r", -addrsize - vm_type_size<VMType::INT, true>,
+		VMType::ADDR_GBP, VMType::UNKNOWN);
+	const SymInfo sym_t = *symtab.AddSymbol("t", -glob_stack, VMType::ADDR_GBP, VMType::UNKNOWN);
+
+	// arguments
+	const SymInfo sym_a = *symtab.AddSymbol("add1/a", 2, VMType::ADDR_BP_ARG);
+	const SymInfo sym_n = *symtab.AddSymbol("sum/n", 2, VMType::ADDR_BP_ARG);
+	const SymInfo sym_acc = *symtab.AddSymbol("sum/acc", 3, VMType::ADDR_BP_ARG);
+	for(const char* func : { "even", "odd" })
+	{
+		symtab.AddSymbol(std::string(func) + "/n", 2, VMType::ADDR_BP_ARG);
+		symtab.AddSymbol(std::string(func) + "/s", 3, VMType::ADDR_BP_ARG);
+	}
+	const SymInfo sym_s = *symtab.GetSymbol("even/s");
+
+	symtab.AddSymbol("add1", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 1);
+	symtab.AddSymbol("sum", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 2);
+	symtab.AddSymbol("even", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 2);
+	symtab.AddSymbol("odd", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 2);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	// global code
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = glob_stack;
+	glob.blocks.resize(1);
+
+	t_ir_reg five = reg(), res1 = reg(), seven = reg(), res2 = reg(), sum = reg();
+	t_ir_reg acc = reg(), n = reg(), res3 = reg();
+	t_ir_reg str = reg(), n_even = reg(), res4 = reg();
+	t_ir_reg r = reg(), r_str = reg(), cat1 = reg(), t = reg(), t_str = reg(), cat2 = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::FUNC, .name = "add1", .func = 1 },
+		IRInstr{ .op = IROp::FUNC, .name = "sum", .func = 2 },
+		IRInstr{ .op = IROp::FUNC, .name = "even", .func = 3 },
+		IRInstr{ .op = IROp::FUNC, .name = "odd", .func = 4 },
+
+		IRInstr{ .op = IROp::CONST, .dst = five, .val = t_vm_int{5} },
+		IRInstr{ .op = IROp::CALL, .dst = res1, .args = { five }, .name = "add1" },
+		IRInstr{ .op = IROp::CONST, .dst = seven, .val = t_vm_int{7} },
+		IRInstr{ .op = IROp::CALL, .dst = res2, .args = { seven }, .name = "add1" },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum, .args = { res1, res2 } },
+		IRInstr{ .op = IROp::STORE, .args = { sum }, .name = "r", .sym = sym_r },
+
+		// the last argument is pushed first
+		IRInstr{ .op = IROp::CONST, .dst = acc, .val = t_vm_int{0} },
+		IRInstr{ .op = IROp::CONST, .dst = n, .val = num_sum },
+		IRInstr{ .op = IROp::CALL, .dst = res3, .args = { acc, n }, .name = "sum" },
+		IRInstr{ .op = IROp::STORE, .args = { res3 }, .name = "t", .sym = sym_t },
+
+		IRInstr{ .op = IROp::CONST, .dst = str, .val = t_vm_str{""} },
+		IRInstr{ .op = IROp::CONST, .dst = n_even, .val = num_even },
+		IRInstr{ .op = IROp::CALL, .dst = res4, .args = { str, n_even }, .name = "even" },
+		IRInstr{ .op = IROp::LOAD, .dst = r, .name = "r", .sym = sym_r },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = r_str, .args = { r } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = cat1, .args = { res4, r_str } },
+		IRInstr{ .op = IROp::LOAD, .dst = t, .name = "t", .sym = sym_t },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = t_str, .args = { t } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = cat2, .args = { cat1, t_str } },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	// add1
+	{
+		IRFunc func{ .name = "add1", .num_args = 1, .frame_size = addrsize };
+		t_ir_reg a = reg(), one = reg(), res = reg();
+		func.blocks.resize(1);
+		func.blocks[0].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = a, .name = "a", .sym = sym_a },
+			IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = res, .args = { a, one } },
+			IRInstr{ .op = IROp::RET, .args = { res } },
+		};
+		prog.GetFunctions().emplace_back(std::move(func));
+	}
+
+	// sum
+	{
+		IRFunc func{ .name = "sum", .num_args = 2, .frame_size = addrsize };
+		t_ir_reg n1 = reg(), zero = reg(), cond = reg(), acc1 = reg();
+		t_ir_reg acc2 = reg(), n2 = reg(), acc_new = reg(), n3 = reg(), one = reg(), n_new = reg(), res = reg();
+		func.blocks.resize(3);
+		func.blocks[0].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = n1, .name = "n", .sym = sym_n },
+			IRInstr{ .op = IROp::CONST, .dst = zero, .val = t_vm_int{0} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::LEQU, .dst = cond, .args = { n1, zero } },
+			IRInstr{ .op = IROp::BRANCH, .args = { cond }, .targets = { 1, 2 } },
+		};
+		func.blocks[1].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = acc1, .name = "acc", .sym = sym_acc },
+			IRInstr{ .op = IROp::RET, .args = { acc1 } },
+		};
+		func.blocks[2].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = acc2, .name = "acc", .sym = sym_acc },
+			IRInstr{ .op = IROp::LOAD, .dst = n2, .name = "n", .sym = sym_n },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = acc_new, .args = { acc2, n2 } },
+			IRInstr{ .op = IROp::LOAD, .dst = n3, .name = "n", .sym = sym_n },
+			IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::SUB, .dst = n_new, .args = { n3, one } },
+			IRInstr{ .op = IROp::CALL, .dst = res, .args = { acc_new, n_new }, .name = "sum" },
+			IRInstr{ .op = IROp::RET, .args = { res } },
+		};
+		prog.GetFunctions().emplace_back(std::move(func));
+	}
+
+	// even and odd
+	for(const auto& [name, other] : { std::make_pair("even", "odd"), std::make_pair("odd", "even") })
+	{
+		IRFunc func{ .name = name, .num_args = 2, .frame_size = addrsize };
+		t_ir_reg n1 = reg(), zero = reg(), cond = reg(), s1 = reg(), suffix = reg(), cat = reg();
+		t_ir_reg s2 = reg(), n2 = reg(), one = reg(), n_new = reg(), res = reg();
+		func.blocks.resize(3);
+		func.blocks[0].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = n1, .name = "n", .sym = sym_n },
+			IRInstr{ .op = IROp::CONST, .dst = zero, .val = t_vm_int{0} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::EQU, .dst = cond, .args = { n1, zero } },
+			IRInstr{ .op = IROp::BRANCH, .args = { cond }, .targets = { 1, 2 } },
+		};
+		func.blocks[1].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = s1, .name = "s", .sym = sym_s },
+			IRInstr{ .op = IROp::CONST, .dst = suffix, .val = t_vm_str{name} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = cat, .args = { s1, suffix } },
+			IRInstr{ .op = IROp::RET, .args = { cat } },
+		};
+		func.blocks[2].instrs =
+		{
+			IRInstr{ .op = IROp::LOAD, .dst = s2, .name = "s", .sym = sym_s },
+			IRInstr{ .op = IROp::LOAD, .dst = n2, .name = "n", .sym = sym_n },
+			IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+			IRInstr{ .op = IROp::OP, .vmop = OpCode::SUB, .dst = n_new, .args = { n2, one } },
+			IRInstr{ .op = IROp::CALL, .dst = res, .args = { s2, n_new }, .name = other },
+			IRInstr{ .op = IROp::RET, .args = { res } },
+		};
+		prog.GetFunctions().emplace_back(std::move(func));
+	}
+}
+
+
+/**
+ * count the instructions of a kind in a function
+ */
+static std::size_t count_instrs(const IRFunc& func, IROp op)
+{
+	std::size_t num = 0;
+	for(const IRBlock& block : func.blocks)
+	{
+		for(const IRInstr& instr : block.instrs)
+		{
+			if(instr.op == op)
+				++num;
+		}
+	}
+	return num;
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		std::optional<VM::t_addr> stack_size;
+
+		for(t_vm_int depth : { 10, 1000, 10000 })
+		{
+			IRProgram prog;
+			create_program(prog, depth, depth + 1);
+			prog.Check();
+			ir_optimise(prog);
+			if(depth == 10)
+				std::cout << prog << std::endl;
+
+			// add1 is inlined and removed
+			const std::vector<IRFunc>& funcs = prog.GetFunctions();
+			check(funcs.size() == 4, "removed function");
+			check(count_instrs(funcs[0], IROp::CALL) == 2, "inlined calls");
+			check(prog.GetSymbolTable().GetSymbol("add1") == nullptr, "removed symbol");
+
+			// sum jumps back to its start, even and odd call each other in place
+			check(count_instrs(funcs[1], IROp::CALL) == 0 &&
+				count_instrs(funcs[1], IROp::STORE) == 2, "recursive tail call");
+			check(count_instrs(funcs[2], IROp::TAILCALL) == 1 &&
+				count_instrs(funcs[3], IROp::TAILCALL) == 1, "tail calls");
+
+			CodeBuilder code;
+			IRAsm irasm{code};
+			irasm.Emit(prog);
+
+			VM vm(0x1000);
+			vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+			vm.Verify();
+			vm.SetProfiling(true);
+			vm.Run();
+
+			VM::t_data result = vm.TopData();
+			std::string expected = "odd14" + std::to_string(depth*(depth + 1)/2);
+			check(result.index() == VM::m_stridx && std::get<VM::m_stridx>(result) == expected,
+				"result for depth " + std::to_string(depth));
+
+			// the recursion runs in constant stack space
+			VM::t_addr max_stack = vm.GetProfiler()->GetMaxStackSize();
+			std::cout << "Depth " << depth << ": maximum stack size "
+				<< max_stack << " bytes." << std::endl;
+			if(stack_size)
+				check(*stack_size == max_stack, "stack size for depth " + std::to_string(depth));
+			stack_size = max_stack;
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
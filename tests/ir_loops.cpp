@@ -0,0 +1,234 @@
+/**
+ * test of the loop optimisations on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds a loop with invariant expressions and multiples and casts of its
+ * counter, optimises it and compares the results and executed operations.
+ */
+
+#include "codegen/ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_types.h"
+#include "codegen/ir_loops.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+
+#include <iostream>
+
+
+/**
+ * the global code runs:
+ *   n = 100; a = 3; b = 2; s = 0; r = 0.; i = 0;
+ *   loop(i < n) { s = s + a*a + i*4 + (i*4)/2 + a/b; r = r + real(i)*real(i); i = i + 1; }
+ * and computes s + int(r)
+ */
+static void create_program(IRProgram& prog)
+{
+	constexpr t_vm_addr addrsize = vm_type_size<VMType::ADDR_MEM, false>;
+	constexpr t_vm_addr intsize = vm_type_size<VMType::INT, true>;
+	constexpr t_vm_addr realsize = vm_type_size<VMType::REAL, true>;
+
+	SymTab& symtab = prog.GetSymbolTable();
+	const SymInfo sym_n = *symtab.AddSymbol("n", -addrsize - intsize, VMType::ADDR_GBP);
+	const SymInfo sym_a = *symtab.AddSymbol("a", -addrsize - 2*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_b = *symtab.AddSymbol("b", -addrsize - 3*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_s = *symtab.AddSymbol("s", -addrsize - 4*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_i = *symtab.AddSymbol("i", -addrsize - 5*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_r = *symtab.AddSymbol("r", -addrsize - 5*intsize - realsize, VMType::ADDR_GBP);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+	auto store = [](t_ir_reg val, const std::string& name, const SymInfo& sym) -> IRInstr
+	{
+		return IRInstr{ .op = IROp::STORE, .args = { val }, .name = name, .sym = sym };
+	};
+	auto load = [](t_ir_reg dst, const std::string& name, const SymInfo& sym) -> IRInstr
+	{
+		return IRInstr{ .op = IROp::LOAD, .dst = dst, .name = name, .sym = sym };
+	};
+	auto op = [](OpCode vmop, t_ir_reg dst, std::vector<t_ir_reg>&& args) -> IRInstr
+	{
+		return IRInstr{ .op = IROp::OP, .vmop = vmop, .dst = dst, .args = std::move(args) };
+	};
+
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = addrsize + 5*intsize + realsize;
+	glob.blocks.resize(4);
+
+	t_ir_reg n = reg(), a = reg(), b = reg(), s = reg(), r = reg(), i = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = n, .val = t_vm_int{100} }, store(n, "n", sym_n),
+		IRInstr{ .op = IROp::CONST, .dst = a, .val = t_vm_int{3} }, store(a, "a", sym_a),
+		IRInstr{ .op = IROp::CONST, .dst = b, .val = t_vm_int{2} }, store(b, "b", sym_b),
+		IRInstr{ .op = IROp::CONST, .dst = s, .val = t_vm_int{0} }, store(s, "s", sym_s),
+		IRInstr{ .op = IROp::CONST, .dst = r, .val = t_vm_real{0.} }, store(r, "r", sym_r),
+		IRInstr{ .op = IROp::CONST, .dst = i, .val = t_vm_int{0} }, store(i, "i", sym_i),
+		IRInstr{ .op = IROp::JMP, .targets = { 2, 0 } },
+	};
+
+	// loop body
+	t_ir_reg s1 = reg(), a1 = reg(), a2 = reg(), aa = reg(), sum1 = reg();
+	t_ir_reg i1 = reg(), four1 = reg(), i4_1 = reg(), sum2 = reg();
+	t_ir_reg i2 = reg(), four2 = reg(), i4_2 = reg(), two = reg(), half = reg(), sum3 = reg();
+	t_ir_reg a3 = reg(), b1 = reg(), ab = reg(), sum4 = reg();
+	t_ir_reg r1 = reg(), i3 = reg(), fi1 = reg(), i4 = reg(), fi2 = reg(), sq = reg(), rsum = reg();
+	t_ir_reg i5 = reg(), one = reg(), inext = reg();
+	glob.blocks[1].instrs =
+	{
+		load(s1, "s", sym_s),
+		load(a1, "a", sym_a), load(a2, "a", sym_a), op(OpCode::MUL, aa, { a1, a2 }),
+		op(OpCode::ADD, sum1, { s1, aa }),
+		load(i1, "i", sym_i), IRInstr{ .op = IROp::CONST, .dst = four1, .val = t_vm_int{4} },
+		op(OpCode::MUL, i4_1, { i1, four1 }),
+		op(OpCode::ADD, sum2, { sum1, i4_1 }),
+		load(i2, "i", sym_i), IRInstr{ .op = IROp::CONST, .dst = four2, .val = t_vm_int{4} },
+		op(OpCode::MUL, i4_2, { i2, four2 }),
+		IRInstr{ .op = IROp::CONST, .dst = two, .val = t_vm_int{2} },
+		op(OpCode::DIV, half, { i4_2, two }),
+		op(OpCode::ADD, sum3, { sum2, half }),
+		load(a3, "a", sym_a), load(b1, "b", sym_b), op(OpCode::DIV, ab, { a3, b1 }),
+		op(OpCode::ADD, sum4, { sum3, ab }),
+		store(sum4, "s", sym_s),
+
+		load(r1, "r", sym_r),
+		load(i3, "i", sym_i), op(OpCode::TOF, fi1, { i3 }),
+		load(i4, "i", sym_i), op(OpCode::TOF, fi2, { i4 }),
+		op(OpCode::MUL, sq, { fi1, fi2 }),
+		op(OpCode::ADD, rsum, { r1, sq }),
+		store(rsum, "r", sym_r),
+
+		load(i5, "i", sym_i), IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+		op(OpCode::ADD, inext, { i5, one }),
+		store(inext, "i", sym_i),
+		IRInstr{ .op = IROp::JMP, .targets = { 2, 0 } },
+	};
+
+	// loop condition
+	t_ir_reg i6 = reg(), n1 = reg(), cond = reg();
+	glob.blocks[2].instrs =
+	{
+		load(i6, "i", sym_i), load(n1, "n", sym_n),
+		op(OpCode::LT, cond, { i6, n1 }),
+		IRInstr{ .op = IROp::BRANCH, .args = { cond }, .targets = { 1, 3 } },
+	};
+
+	t_ir_reg s2 = reg(), r2 = reg(), ri = reg(), res = reg();
+	glob.blocks[3].instrs =
+	{
+		load(s2, "s", sym_s), load(r2, "r", sym_r), op(OpCode::TOI, ri, { r2 }),
+		op(OpCode::ADD, res, { s2, ri }),
+		IRInstr{ .op = IROp::HALT },
+	};
+}
+
+
+/**
+ * count the operators in a block
+ */
+static std::size_t count_ops(const IRBlock& block, OpCode vmop)
+{
+	std::size_t num = 0;
+	for(const IRInstr& instr : block.instrs)
+	{
+		if(instr.op == IROp::OP && instr.vmop == vmop)
+			++num;
+	}
+	return num;
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		const t_vm_int expected = 100*9 + 6*4950 + 100*1 + 328350;
+
+		// the invariant a*a is moved, i*4 and real(i) are replaced by additions,
+		// the divisions stay as the divisor of a/b is not known
+		{
+			IRProgram prog;
+			create_program(prog);
+			prog.Check();
+
+			ir_optimise(prog, 0, 0, false, false);
+			IRTypes types = ir_infer_types(prog);
+			std::size_t num_optimised = ir_optimise_loops(prog, types);
+			prog.Check();
+			std::cout << prog << std::endl;
+
+			const IRBlock& body = prog.GetGlobal().blocks[1];
+			check(num_optimised == 5, "number of optimised expressions");
+			check(count_ops(body, OpCode::MUL) == 1, "multiplications in the loop");
+			check(count_ops(body, OpCode::TOF) == 0, "casts in the loop");
+			check(count_ops(body, OpCode::DIV) == 2, "divisions in the loop");
+			check(count_ops(prog.GetGlobal().blocks[0], OpCode::MUL) == 2, "multiplications before the loop");
+		}
+
+		// compare the executed operations and the results with and without the optimisations
+		std::uint64_t num_muls[2]{};
+		for(bool optimise_loops : { false, true })
+		{
+			for(std::size_t num_regs : { std::size_t{0}, static_cast<std::size_t>(g_vm_num_regs) })
+			{
+				IRProgram prog;
+				create_program(prog);
+				ir_optimise(prog, 0, num_regs, optimise_loops);
+
+				CodeBuilder code;
+				IRAsm irasm{code};
+				irasm.Emit(prog);
+				auto vmcode = std::make_shared<const VMCode>(code.Release());
+
+				for(bool jit : { false, true })
+				{
+					VM vm(0x1000);
+					vm.SetCode(vmcode);
+					vm.Verify();
+					vm.SetJit(jit);
+					vm.SetJitThreshold(0);
+					vm.SetProfiling(!jit && num_regs == 0);
+					vm.Run();
+
+					const std::string desc = std::string(optimise_loops ? "optimised" : "plain")
+						+ " loop, " + std::to_string(num_regs) + " registers"
+						+ (jit ? ", native code" : "");
+					VM::t_data result = vm.TopData();
+					check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == expected,
+						"result of " + desc);
+
+					// the multiplications of the ints and reals use their untagged forms
+					if(const VMProfiler* prof = vm.GetProfiler(); prof)
+					{
+						num_muls[optimise_loops] = prof->GetNumInstructions(OpCode::MUL)
+							+ prof->GetNumInstructions(OpCode::IMUL)
+							+ prof->GetNumInstructions(OpCode::FMUL);
+					}
+				}
+			}
+		}
+
+		std::cout << "Executed multiplications: " << num_muls[0]
+			<< " without and " << num_muls[1] << " with loop optimisations." << std::endl;
+		check(num_muls[0] == 400 && num_muls[1] == 102, "executed multiplications");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
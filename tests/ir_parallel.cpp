@@ -0,0 +1,205 @@
+/**
+ * test of the parallel code generation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Lowers and optimises a program consisting of several functions with
+ * different numbers of threads and compares the generated code and the
+ * results with the ones of a serial code generation.
+ */
+
+#include "codegen/ast.h"
+#include "codegen/ast_ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+#include "ast_build.h"
+
+#include <iostream>
+
+
+using t_ops = std::unordered_map<std::size_t, std::tuple<std::string, OpCode>>;
+
+
+static t_astbaseptr make_assign(const std::string& name, VMType ty, const t_astbaseptr& val)
+{
+	return make_bin('=', val, make_var(name, ty, true));
+}
+
+
+static std::shared_ptr<ASTList> make_list(const std::vector<t_astbaseptr>& children)
+{
+	auto list = std::make_shared<ASTList>(0, 0);
+	for(const t_astbaseptr& child : children)
+		list->AddChild(child);
+	return list;
+}
+
+
+static t_astbaseptr make_call(const std::string& name, const t_astbaseptr& arg)
+{
+	return std::make_shared<ASTFuncCall>(0, 0, name, make_list({ arg }));
+}
+
+
+static t_astbaseptr make_return(const t_astbaseptr& val)
+{
+	return std::make_shared<ASTJump>(0, 0, ASTJump::JumpType::RETURN, val);
+}
+
+
+/**
+ * program with the functions f<k>(n), summing up i*k + n*n for i < n, and g(x),
+ * which declares sqrt as external function; the global code calls all of them
+ * and leaves the sum of the f<k>(10) on the stack
+ */
+static t_astbaseptr make_program(std::size_t num_funcs, const std::string& unknown_func = "")
+{
+	auto prog = make_list({});
+	auto sum = make_list({ make_assign("sum", VMType::INT, make_int(0)) });
+
+	for(std::size_t k=0; k<num_funcs; ++k)
+	{
+		const std::string name = "f" + std::to_string(k);
+		auto n = []() { return make_var("n", VMType::INT); };
+		auto i = []() { return make_var("i", VMType::INT); };
+		auto s = []() { return make_var("s", VMType::INT); };
+
+		auto loop = std::make_shared<ASTLoop>(0, 0, make_bin('<', i(), n()), make_list({
+			make_assign("s", VMType::INT, make_bin('+', make_bin('+', s(),
+				make_bin('*', i(), make_int(static_cast<t_int>(k)))), make_bin('*', n(), n()))),
+			make_assign("i", VMType::INT, make_bin('+', i(), make_int(1))),
+		}));
+
+		auto body = make_list({
+			make_assign("s", VMType::INT, make_int(0)),
+			make_assign("i", VMType::INT, make_int(0)),
+			loop,
+			make_return(s()),
+		});
+		if(k == 1 && unknown_func != "")
+			body->AddChild(make_call(unknown_func, n()));
+
+		prog->AddChild(std::make_shared<ASTFunc>(0, 0, name, make_list({ n() }), body));
+		sum->AddChild(make_assign("sum", VMType::INT, make_bin('+',
+			make_var("sum", VMType::INT), make_call(name, make_int(10)))));
+	}
+
+	// the declaration of the external function also applies to the following global code
+	auto sqrt_decl = std::make_shared<ASTDeclare>(0, 0, true, true,
+		make_list({ make_var("sqrt", VMType::UNKNOWN) }));
+	prog->AddChild(std::make_shared<ASTFunc>(0, 0, "g", make_list({ make_var("x", VMType::REAL) }),
+		make_list({ sqrt_decl, make_return(make_call("sqrt", make_var("x", VMType::REAL))) })));
+	prog->AddChild(make_assign("r", VMType::REAL, make_call("g", make_real(16.))));
+	prog->AddChild(make_assign("r", VMType::REAL, make_call("sqrt", make_var("r", VMType::REAL))));
+
+	prog->AddChild(sum);
+	prog->AddChild(make_var("sum", VMType::INT));
+	return prog;
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	t_ops ops
+	{{
+		std::make_pair('+', std::make_tuple("add", OpCode::ADD)),
+		std::make_pair('*', std::make_tuple("mul", OpCode::MUL)),
+		std::make_pair('<', std::make_tuple("lt", OpCode::LT)),
+		std::make_pair('=', std::make_tuple("wrmem", OpCode::WRMEM)),
+	}};
+
+	try
+	{
+		const std::size_t num_funcs = 6;
+		const t_vm_int expected = 45*(num_funcs*(num_funcs - 1)/2) + 1000*num_funcs;
+		t_astbaseptr ast = make_program(num_funcs);
+
+		for(std::size_t max_inline : { std::size_t{0}, std::size_t{32} })
+		{
+			std::vector<t_vm_byte> serial_code;
+			std::size_t serial_regs = 0;
+
+			for(std::size_t num_threads : { 1, 3, 0 })
+			{
+				const std::string desc = std::to_string(num_threads) + " threads, "
+					+ (max_inline ? "inlined calls" : "no inlining");
+
+				ASTIR astir{&ops};
+				astir.SetNumThreads(num_threads);
+				ast->accept(&astir);
+				astir.FinishCodegen();
+
+				IRProgram& ir = astir.GetProgram();
+				const std::size_t num_regs = ir.GetNumRegisters();
+				ir_optimise(ir, max_inline, g_vm_num_regs, true, true, num_threads);
+
+				CodeBuilder code;
+				IRAsm irasm{code};
+				irasm.Emit(ir);
+				std::vector<t_vm_byte> bytes = code.Release();
+
+				// the registers are numbered differently, but the code is the same
+				if(num_threads == 1)
+				{
+					serial_code = bytes;
+					serial_regs = num_regs;
+				}
+				check(num_regs == serial_regs, "number of registers with " + desc);
+				check(bytes == serial_code, "code generated with " + desc);
+
+				VM vm(0x1000);
+				vm.SetCode(std::make_shared<const VMCode>(std::move(bytes)));
+				vm.Verify();
+				vm.Run();
+
+				VM::t_data result = vm.TopData();
+				check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == expected,
+					"result with " + desc);
+			}
+		}
+
+		// errors in the functions are reported as in a serial code generation
+		t_astbaseptr ast_err = make_program(num_funcs, "h");
+		std::string serial_err;
+		for(std::size_t num_threads : { 1, 3 })
+		{
+			std::string err;
+			try
+			{
+				ASTIR astir{&ops};
+				astir.SetNumThreads(num_threads);
+				ast_err->accept(&astir);
+				astir.FinishCodegen();
+			}
+			catch(const std::exception& ex)
+			{
+				err = ex.what();
+			}
+
+			std::cout << err << std::endl;
+			if(num_threads == 1)
+				serial_err = err;
+			check(err != "" && err == serial_err, "error with " + std::to_string(num_threads) + " threads");
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
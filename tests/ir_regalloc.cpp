@@ -0,0 +1,250 @@
+/**
+ * test of the allocation of local variables to the vm's registers
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds a program with a loop and a function call, allocates the registers,
+ * verifies and runs it with and without native code and checks that the
+ * registers of interrupted code are kept and stored in snapshots.
+ */
+
+#include "codegen/ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_types.h"
+#include "codegen/ir_regalloc.h"
+#include "codegen/ir_asm.h"
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <iostream>
+
+
+/**
+ * the global code runs s = 0; t = 5; for(i = 0; i < num; i = i + 1) s = s + i*i;
+ * and computes f(s) + t with f(a) = { x = a*2; return x + 1; }
+ */
+static void create_program(IRProgram& prog, t_vm_int num)
+{
+	constexpr t_vm_addr addrsize = vm_type_size<VMType::ADDR_MEM, false>;
+	constexpr t_vm_addr intsize = vm_type_size<VMType::INT, true>;
+
+	SymTab& symtab = prog.GetSymbolTable();
+	const SymInfo sym_s = *symtab.AddSymbol("s", -addrsize - intsize, VMType::ADDR_GBP);
+	const SymInfo sym_i = *symtab.AddSymbol("i", -addrsize - 2*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_t = *symtab.AddSymbol("t", -addrsize - 3*intsize, VMType::ADDR_GBP);
+	const SymInfo sym_a = *symtab.AddSymbol("f/a", 2, VMType::ADDR_BP_ARG);
+	const SymInfo sym_x = *symtab.AddSymbol("f/x", -addrsize - intsize, VMType::ADDR_BP);
+	symtab.AddSymbol("f", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 1);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	// global code
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = addrsize + 3*intsize;
+	glob.blocks.resize(4);
+
+	t_ir_reg zero1 = reg(), zero2 = reg(), five = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::FUNC, .name = "f", .func = 1 },
+		IRInstr{ .op = IROp::CONST, .dst = zero1, .val = t_vm_int{0} },
+		IRInstr{ .op = IROp::STORE, .args = { zero1 }, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::CONST, .dst = five, .val = t_vm_int{5} },
+		IRInstr{ .op = IROp::STORE, .args = { five }, .name = "t", .sym = sym_t },
+		IRInstr{ .op = IROp::CONST, .dst = zero2, .val = t_vm_int{0} },
+		IRInstr{ .op = IROp::STORE, .args = { zero2 }, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::JMP, .targets = { 1, 0 } },
+	};
+
+	t_ir_reg i1 = reg(), n = reg(), cond = reg();
+	glob.blocks[1].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = i1, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::CONST, .dst = n, .val = num },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::LT, .dst = cond, .args = { i1, n } },
+		IRInstr{ .op = IROp::BRANCH, .args = { cond }, .targets = { 2, 3 } },
+	};
+
+	t_ir_reg s1 = reg(), i2 = reg(), i3 = reg(), sq = reg(), s_new = reg();
+	t_ir_reg i4 = reg(), one = reg(), i_new = reg();
+	glob.blocks[2].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = s1, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::LOAD, .dst = i2, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::LOAD, .dst = i3, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL, .dst = sq, .args = { i2, i3 } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = s_new, .args = { s1, sq } },
+		IRInstr{ .op = IROp::STORE, .args = { s_new }, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::LOAD, .dst = i4, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = i_new, .args = { i4, one } },
+		IRInstr{ .op = IROp::STORE, .args = { i_new }, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::JMP, .targets = { 1, 0 } },
+	};
+
+	t_ir_reg s2 = reg(), res = reg(), t = reg(), sum = reg();
+	glob.blocks[3].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = s2, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::CALL, .dst = res, .args = { s2 }, .name = "f" },
+		IRInstr{ .op = IROp::LOAD, .dst = t, .name = "t", .sym = sym_t },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum, .args = { res, t } },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	// function
+	IRFunc func{ .name = "f", .num_args = 1, .frame_size = addrsize + intsize };
+	t_ir_reg a = reg(), two = reg(), prod = reg(), x = reg(), one_f = reg(), ret = reg();
+	func.blocks.resize(1);
+	func.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = a, .name = "a", .sym = sym_a },
+		IRInstr{ .op = IROp::CONST, .dst = two, .val = t_vm_int{2} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL, .dst = prod, .args = { a, two } },
+		IRInstr{ .op = IROp::STORE, .args = { prod }, .name = "x", .sym = sym_x },
+		IRInstr{ .op = IROp::LOAD, .dst = x, .name = "x", .sym = sym_x },
+		IRInstr{ .op = IROp::CONST, .dst = one_f, .val = t_vm_int{1} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = ret, .args = { x, one_f } },
+		IRInstr{ .op = IROp::RET, .args = { ret } },
+	};
+	prog.GetFunctions().emplace_back(std::move(func));
+}
+
+
+/**
+ * are all accesses of a variable done via a register?
+ */
+static bool in_register(const IRFunc& func, const std::string& name)
+{
+	bool found = false;
+	for(const IRBlock& block : func.blocks)
+	{
+		for(const IRInstr& instr : block.instrs)
+		{
+			if((instr.op != IROp::LOAD && instr.op != IROp::STORE) || instr.name != name)
+				continue;
+			if(!instr.vmreg)
+				return false;
+			found = true;
+		}
+	}
+	return found;
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		constexpr t_vm_int num = 1000;
+		const t_vm_int expected = 2*((num - 1)*num*(2*num - 1)/6) + 1 + 5;
+
+		for(std::size_t num_regs : { 16, 1 })
+		{
+			IRProgram prog;
+			create_program(prog, num);
+			prog.Check();
+
+			// f is kept as a function, it would otherwise be inlined,
+			// the tagged operations can still be applied to registers
+			ir_optimise(prog, 0, 0, true, false);
+			IRTypes types = ir_infer_types(prog);
+			std::size_t num_allocated = ir_allocate_registers(prog, types, num_regs);
+			std::cout << prog << std::endl;
+
+			// t is live across the call, with one register the loop counter
+			// is preferred over the sum, which is accessed less often
+			const std::string regs = std::to_string(num_regs) + " registers";
+			const IRFunc& glob = prog.GetGlobal();
+			check(num_allocated == (num_regs > 1 ? 3 : 2), "allocated variables with " + regs);
+			check(in_register(glob, "i"), "loop counter with " + regs);
+			check(in_register(glob, "s") == (num_regs > 1), "sum with " + regs);
+			check(!in_register(glob, "t"), "variable live across a call with " + regs);
+			check(in_register(prog.GetFunctions()[1], "x"), "local variable of function with " + regs);
+
+			CodeBuilder code;
+			IRAsm irasm{code};
+			irasm.Emit(prog);
+			auto vmcode = std::make_shared<const VMCode>(code.Release());
+
+			for(bool jit : { false, true })
+			{
+				VM vm(0x1000);
+				vm.SetCode(vmcode);
+				vm.Verify();
+				vm.SetJit(jit);
+				vm.SetJitThreshold(0);
+				vm.SetProfiling(!jit);
+				vm.Run();
+
+				VM::t_data result = vm.TopData();
+				check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == expected,
+					"result with " + regs + (jit ? " and native code" : ""));
+
+				// i*i uses the register directly, only t and the argument are read from memory
+				if(!jit)
+				{
+					const VMProfiler* prof = vm.GetProfiler();
+					check(prof->GetNumInstructions(OpCode::OPR) == num, "register operands with " + regs);
+					check(prof->GetNumInstructions(OpCode::RDMEM) == (num_regs > 1 ? 2 : num + 3),
+						"memory reads with " + regs);
+				}
+			}
+		}
+
+		// an interrupt service routine does not change the registers of the interrupted code
+		CodeBuilder code;
+		code.PushInt(7);
+		code.Op(OpCode::STR);
+		code.Raw(t_vm_byte{3});
+		code.Op(OpCode::LDR);
+		code.Raw(t_vm_byte{3});
+		code.Op(OpCode::HALT);
+
+		t_vm_addr isr = static_cast<t_vm_addr>(code.GetCode().size());
+		code.PushInt(99);
+		code.Op(OpCode::STR);
+		code.Raw(t_vm_byte{3});
+		code.Op(OpCode::IRET);
+		auto vmcode = std::make_shared<const VMCode>(code.Release());
+
+		VM vm(0x1000);
+		vm.SetCode(vmcode);
+		vm.SetISR(1, isr);
+		vm.RunFor(2);
+		vm.RequestInterrupt(1);
+		vm.Run();
+
+		VM::t_data result = vm.TopData();
+		check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == 7,
+			"register after interrupt");
+
+		// the registers are part of the snapshots
+		VM restored(0x1000);
+		restored.SetCode(vmcode);
+		restored.Restore(*vm.Snapshot());
+		VM::t_data reg = restored.GetRegister(3);
+		check(reg.index() == VM::m_intidx && std::get<VM::m_intidx>(reg) == 7,
+			"register in snapshot");
+		check(restored.GetRegister(4).index() == 0, "unassigned register");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,330 @@
+/**
+ * test of the type inference on the intermediate representation
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Builds programs calling functions with integers and strings,
+ * specialises the functions, removes the casts and runs the programs.
+ * Arithmetic on ints and reals is compiled to the untagged operations.
+ */
+
+#include "codegen/ir.h"
+#include "codegen/ir_opt.h"
+#include "codegen/ir_types.h"
+#include "codegen/ir_asm.h"
+#include "vm/vm.h"
+
+#include <iostream>
+
+
+/**
+ * the global code sets s = "x" and computes f(5) + f("a") + s,
+ * with f(a) = "v" + a
+ */
+static void create_program(IRProgram& prog)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+	t_vm_addr glob_stack = vm_type_size<VMType::ADDR_MEM, false> + vm_type_size<VMType::STR, true>;
+	const SymInfo sym_s = *symtab.AddSymbol("s", -glob_stack, VMType::ADDR_GBP, VMType::UNKNOWN);
+	const SymInfo sym_a = *symtab.AddSymbol("f/a", 2, VMType::ADDR_BP_ARG, VMType::UNKNOWN);
+	symtab.AddSymbol("f", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 1);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = glob_stack;
+	glob.blocks.resize(1);
+
+	t_ir_reg x = reg(), five = reg(), res1 = reg(), a = reg(), res2 = reg(), sum1 = reg();
+	t_ir_reg s = reg(), s_str = reg(), sum2 = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::FUNC, .name = "f", .func = 1 },
+		IRInstr{ .op = IROp::CONST, .dst = x, .val = t_vm_str{"x"} },
+		IRInstr{ .op = IROp::STORE, .args = { x }, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::CONST, .dst = five, .val = t_vm_int{5} },
+		IRInstr{ .op = IROp::CALL, .dst = res1, .args = { five }, .name = "f" },
+		IRInstr{ .op = IROp::CONST, .dst = a, .val = t_vm_str{"a"} },
+		IRInstr{ .op = IROp::CALL, .dst = res2, .args = { a }, .name = "f" },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum1, .args = { res1, res2 } },
+		IRInstr{ .op = IROp::LOAD, .dst = s, .name = "s", .sym = sym_s },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = s_str, .args = { s } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum2, .args = { sum1, s_str } },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	// function
+	IRFunc func{ .name = "f", .num_args = 1, .frame_size = vm_type_size<VMType::ADDR_MEM, false> };
+	t_ir_reg v = reg(), arg = reg(), arg_str = reg(), sum = reg();
+	func.blocks.resize(1);
+	func.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = v, .val = t_vm_str{"v"} },
+		IRInstr{ .op = IROp::LOAD, .dst = arg, .name = "a", .sym = sym_a },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = arg_str, .args = { arg } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum, .args = { v, arg_str } },
+		IRInstr{ .op = IROp::RET, .args = { sum } },
+	};
+	prog.GetFunctions().emplace_back(std::move(func));
+}
+
+
+/**
+ * the global code computes k(1, "x") + k("y", 2),
+ * with k(a, b) = "<" + a + "|" + b + ">"
+ */
+static void create_program_args(IRProgram& prog)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+	const SymInfo sym_a = *symtab.AddSymbol("k/a", 2, VMType::ADDR_BP_ARG, VMType::UNKNOWN);
+	const SymInfo sym_b = *symtab.AddSymbol("k/b", 3, VMType::ADDR_BP_ARG, VMType::UNKNOWN);
+	symtab.AddSymbol("k", 0, VMType::ADDR_MEM, VMType::UNKNOWN, true, 2);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = vm_type_size<VMType::ADDR_MEM, false>;
+	glob.blocks.resize(1);
+
+	// the first argument is pushed last
+	t_ir_reg one = reg(), x = reg(), res1 = reg(), y = reg(), two = reg(), res2 = reg(), sum = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::FUNC, .name = "k", .func = 1 },
+		IRInstr{ .op = IROp::CONST, .dst = x, .val = t_vm_str{"x"} },
+		IRInstr{ .op = IROp::CONST, .dst = one, .val = t_vm_int{1} },
+		IRInstr{ .op = IROp::CALL, .dst = res1, .args = { x, one }, .name = "k" },
+		IRInstr{ .op = IROp::CONST, .dst = two, .val = t_vm_int{2} },
+		IRInstr{ .op = IROp::CONST, .dst = y, .val = t_vm_str{"y"} },
+		IRInstr{ .op = IROp::CALL, .dst = res2, .args = { two, y }, .name = "k" },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum, .args = { res1, res2 } },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	// function
+	IRFunc func{ .name = "k", .num_args = 2, .frame_size = vm_type_size<VMType::ADDR_MEM, false> };
+	t_ir_reg open = reg(), a = reg(), a_str = reg(), sum1 = reg(), sep = reg(), sum2 = reg();
+	t_ir_reg b = reg(), b_str = reg(), sum3 = reg(), close = reg(), sum4 = reg();
+	func.blocks.resize(1);
+	func.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = open, .val = t_vm_str{"<"} },
+		IRInstr{ .op = IROp::LOAD, .dst = a, .name = "a", .sym = sym_a },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = a_str, .args = { a } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum1, .args = { open, a_str } },
+		IRInstr{ .op = IROp::CONST, .dst = sep, .val = t_vm_str{"|"} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum2, .args = { sum1, sep } },
+		IRInstr{ .op = IROp::LOAD, .dst = b, .name = "b", .sym = sym_b },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOS, .dst = b_str, .args = { b } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum3, .args = { sum2, b_str } },
+		IRInstr{ .op = IROp::CONST, .dst = close, .val = t_vm_str{">"} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum4, .args = { sum3, close } },
+		IRInstr{ .op = IROp::RET, .args = { sum4 } },
+	};
+	prog.GetFunctions().emplace_back(std::move(func));
+}
+
+
+/**
+ * the global code sets i = -(i*3 - 4) with i = 7 and r = 2.5,
+ * and computes r*r + 1.5 + i if i < -10, and 0 otherwise
+ */
+static void create_program_untagged(IRProgram& prog)
+{
+	SymTab& symtab = prog.GetSymbolTable();
+	constexpr t_vm_addr addr_size = vm_type_size<VMType::ADDR_MEM, false>;
+	constexpr t_vm_addr val_size = vm_type_size<VMType::INT, true>;
+	const SymInfo sym_i = *symtab.AddSymbol("i", -(addr_size + val_size), VMType::ADDR_GBP, VMType::UNKNOWN);
+	const SymInfo sym_r = *symtab.AddSymbol("r", -(addr_size + 2*val_size), VMType::ADDR_GBP, VMType::UNKNOWN);
+
+	auto reg = [&prog]() -> t_ir_reg { return prog.NewRegister(); };
+
+	IRFunc& glob = prog.GetGlobal();
+	glob.frame_size = addr_size + 2*val_size;
+	glob.blocks.resize(3);
+
+	t_ir_reg seven = reg(), r_init = reg(), i1 = reg(), three = reg(), prod = reg();
+	t_ir_reg four = reg(), diff = reg(), neg = reg(), i2 = reg(), limit = reg(), cond = reg();
+	glob.blocks[0].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = seven, .val = t_vm_int{7} },
+		IRInstr{ .op = IROp::STORE, .args = { seven }, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::CONST, .dst = r_init, .val = t_vm_real{2.5} },
+		IRInstr{ .op = IROp::STORE, .args = { r_init }, .name = "r", .sym = sym_r },
+		IRInstr{ .op = IROp::LOAD, .dst = i1, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::CONST, .dst = three, .val = t_vm_int{3} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL, .dst = prod, .args = { i1, three } },
+		IRInstr{ .op = IROp::CONST, .dst = four, .val = t_vm_int{4} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::SUB, .dst = diff, .args = { prod, four } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::USUB, .dst = neg, .args = { diff } },
+		IRInstr{ .op = IROp::STORE, .args = { neg }, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::LOAD, .dst = i2, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::CONST, .dst = limit, .val = t_vm_int{-10} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::LT, .dst = cond, .args = { i2, limit } },
+		IRInstr{ .op = IROp::BRANCH, .args = { cond }, .targets = { 1, 2 } },
+	};
+
+	t_ir_reg r1 = reg(), r2 = reg(), sq = reg(), half = reg(), sum1 = reg();
+	t_ir_reg i3 = reg(), i3_real = reg(), sum2 = reg();
+	glob.blocks[1].instrs =
+	{
+		IRInstr{ .op = IROp::LOAD, .dst = r1, .name = "r", .sym = sym_r },
+		IRInstr{ .op = IROp::LOAD, .dst = r2, .name = "r", .sym = sym_r },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::MUL, .dst = sq, .args = { r1, r2 } },
+		IRInstr{ .op = IROp::CONST, .dst = half, .val = t_vm_real{1.5} },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum1, .args = { sq, half } },
+		IRInstr{ .op = IROp::LOAD, .dst = i3, .name = "i", .sym = sym_i },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::TOF, .dst = i3_real, .args = { i3 } },
+		IRInstr{ .op = IROp::OP, .vmop = OpCode::ADD, .dst = sum2, .args = { sum1, i3_real } },
+		IRInstr{ .op = IROp::HALT },
+	};
+
+	t_ir_reg zero = reg();
+	glob.blocks[2].instrs =
+	{
+		IRInstr{ .op = IROp::CONST, .dst = zero, .val = t_vm_real{0.} },
+		IRInstr{ .op = IROp::HALT },
+	};
+}
+
+
+/**
+ * compile and run a program, returning the value on top of the stack
+ */
+static VM::t_data run_program(IRProgram& prog)
+{
+	CodeBuilder code;
+	IRAsm irasm{code};
+	irasm.Emit(prog);
+
+	VM vm(0x1000);
+	vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+	vm.Verify();
+	vm.Run();
+
+	return vm.TopData();
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		IRProgram prog;
+		create_program(prog);
+		prog.Check();
+
+		// before the specialisation the argument has differing types
+		IRTypes types = ir_infer_types(prog);
+		check(types.vars["s"].Is(VMType::STR), "variable type");
+		check(types.args[1][0].kind == IRType::Kind::ANY, "varying argument type");
+		check(types.rets[1].Is(VMType::STR), "return type");
+
+		// f is kept as a function, it would otherwise be inlined
+		std::size_t num_instrs = prog.NumInstructions();
+		ir_optimise(prog, 0);
+		std::cout << prog << std::endl;
+
+		// f("a") calls a copy, in which the argument is a string
+		check(prog.GetFunctions().size() == 3, "specialised function");
+		check(prog.GetSymbolTable().GetSymbol("f<string>") != nullptr, "function symbol");
+		check(prog.GetSymbolTable().GetSymbol("f/a")->ty == VMType::INT, "argument type");
+		check(prog.GetSymbolTable().GetSymbol("f<string>/a")->ty == VMType::STR, "argument type of copy");
+		check(prog.GetSymbolTable().GetSymbol("s")->ty == VMType::STR, "symbol type");
+
+		// the casts of s and of the string argument are removed
+		check(prog.GetGlobal().NumInstructions() == 12, "removed cast in global code");
+		check(prog.GetFunctions()[1].NumInstructions() == 5, "kept cast");
+		check(prog.GetFunctions()[2].NumInstructions() == 4, "removed cast in copy");
+		check(prog.NumInstructions() == num_instrs + 4, "number of instructions");
+
+		VM::t_data result = run_program(prog);
+		check(result.index() == VM::m_stridx && std::get<VM::m_stridx>(result) == "v5vax", "result");
+
+		// arguments of differing types are matched to the parameters in order
+		IRProgram prog_args;
+		create_program_args(prog_args);
+		prog_args.Check();
+
+		IRTypes types_args = ir_infer_types(prog_args);
+		check(types_args.args[1][0].kind == IRType::Kind::ANY, "varying first argument type");
+		check(types_args.args[1][1].kind == IRType::Kind::ANY, "varying second argument type");
+
+		ir_optimise(prog_args, 0);
+		std::cout << prog_args << std::endl;
+
+		// k("y", 2) calls a copy with swapped argument types
+		check(prog_args.GetFunctions().size() == 3, "specialised two-argument function");
+		const SymTab& symtab_args = prog_args.GetSymbolTable();
+		check(symtab_args.GetSymbol("k/a")->ty == VMType::INT, "first argument type");
+		check(symtab_args.GetSymbol("k/b")->ty == VMType::STR, "second argument type");
+		const std::string& copy = prog_args.GetFunctions()[2].name;
+		check(symtab_args.GetSymbol(copy + "/a")->ty == VMType::STR, "first argument type of copy");
+		check(symtab_args.GetSymbol(copy + "/b")->ty == VMType::INT, "second argument type of copy");
+
+		// only the casts of the integer arguments are kept
+		check(prog_args.GetFunctions()[1].NumInstructions() == 11, "removed cast of second argument");
+		check(prog_args.GetFunctions()[2].NumInstructions() == 11, "removed cast of first argument");
+
+		result = run_program(prog_args);
+		check(result.index() == VM::m_stridx && std::get<VM::m_stridx>(result) == "<1|x><y|2>", "two-argument result");
+
+		// arithmetic on ints and reals works without the type descriptors
+		IRProgram prog_untagged;
+		create_program_untagged(prog_untagged);
+		prog_untagged.Check();
+		ir_optimise(prog_untagged, 0, 0);
+		std::cout << prog_untagged << std::endl;
+
+		std::size_t num_untagged = 0, num_tags = 0, num_consts = 0;
+		for(const IRBlock& block : prog_untagged.GetGlobal().blocks)
+		{
+			for(const IRInstr& instr : block.instrs)
+			{
+				if(instr.op == IROp::CONST && instr.vmop != OpCode::NOP)
+					++num_consts;
+				if(instr.op != IROp::OP)
+					continue;
+				if(get_vm_tagged_op(instr.vmop) != OpCode::INVALID)
+					++num_untagged;
+				else if(instr.vmop >= OpCode::UNTAGI && instr.vmop <= OpCode::TAGF)
+					++num_tags;
+			}
+		}
+
+		// the values are untagged after the loads and the cast, and tagged again
+		// before the stores and at the end, the constants are pushed untagged
+		check(num_untagged == 7, "untagged operations");
+		check(num_tags == 7, "type descriptor operations");
+		check(num_consts == 4, "untagged constants");
+
+		result = run_program(prog_untagged);
+		check(result.index() == VM::m_realidx && std::get<VM::m_realidx>(result) == -9.25, "untagged result");
+
+		// operators applied to vm registers keep their tagged forms
+		IRProgram prog_regs;
+		create_program_untagged(prog_regs);
+		ir_optimise(prog_regs, 0);
+		result = run_program(prog_regs);
+		check(result.index() == VM::m_realidx && std::get<VM::m_realidx>(result) == -9.25, "untagged result with registers");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,341 @@
+/**
+ * test of the incremental parser
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Parses a source text, edits it and compares the incrementally re-parsed
+ * syntax trees with the ones of complete parses of the edited texts.
+ */
+
+#include "parsergen/lr1.h"
+#include "codegen/lexer.h"
+#include "codegen/parser.h"
+#include "codegen/parser_incr.h"
+#include "codegen/ast.h"
+#include "ast_compare.h"
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <chrono>
+
+
+enum : std::size_t
+{
+	START,
+	STMTS,
+	STMT,
+	EXPR,
+	TERM,
+	FACTOR,
+};
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		auto start = std::make_shared<NonTerminal>(START, "start");
+		auto stmts = std::make_shared<NonTerminal>(STMTS, "stmts");
+		auto stmt = std::make_shared<NonTerminal>(STMT, "stmt");
+		auto expr = std::make_shared<NonTerminal>(EXPR, "expr");
+		auto term = std::make_shared<NonTerminal>(TERM, "term");
+		auto factor = std::make_shared<NonTerminal>(FACTOR, "factor");
+
+		auto plus = std::make_shared<Terminal>('+', "+");
+		auto mult = std::make_shared<Terminal>('*', "*");
+		auto assign = std::make_shared<Terminal>('=', "=");
+		auto stmt_end = std::make_shared<Terminal>(';', ";");
+		auto bracket_open = std::make_shared<Terminal>('(', "(");
+		auto bracket_close = std::make_shared<Terminal>(')', ")");
+		auto block_begin = std::make_shared<Terminal>('{', "{");
+		auto block_end = std::make_shared<Terminal>('}', "}");
+		auto sym_int = std::make_shared<Terminal>((std::size_t)Token::INT, "integer");
+		auto ident = std::make_shared<Terminal>((std::size_t)Token::IDENT, "ident");
+
+		std::size_t semanticindex = 0;
+		start->AddRule({ stmts }, semanticindex++);                               // rule 0
+		stmts->AddRule({ stmt, stmts }, semanticindex++);                         // rule 1
+		stmts->AddRule({ g_eps }, semanticindex++);                               // rule 2
+		stmt->AddRule({ ident, assign, expr, stmt_end }, semanticindex++);        // rule 3
+		stmt->AddRule({ expr, stmt_end }, semanticindex++);                       // rule 4
+		stmt->AddRule({ block_begin, stmts, block_end }, semanticindex++);        // rule 5
+		expr->AddRule({ expr, plus, term }, semanticindex++);                     // rule 6
+		expr->AddRule({ term }, semanticindex++);                                 // rule 7
+		term->AddRule({ term, mult, factor }, semanticindex++);                   // rule 8
+		term->AddRule({ factor }, semanticindex++);                               // rule 9
+		factor->AddRule({ bracket_open, expr, bracket_close }, semanticindex++);  // rule 10
+		factor->AddRule({ sym_int }, semanticindex++);                            // rule 11
+		factor->AddRule({ ident }, semanticindex++);                              // rule 12
+
+		ElementPtr elem = std::make_shared<Element>(start, 0, 0, Terminal::t_terminalset{{g_end}});
+		ClosurePtr closure = std::make_shared<Closure>();
+		closure->AddElement(elem);
+
+		Collection colls{closure};
+		colls.DoTransitions();
+		Collection collsLALR = colls.ConvertToLALR();
+
+		auto parsetables = collsLALR.CreateParseTables();
+		const t_mapIdIdx& mapTermIdx = std::get<3>(parsetables);
+		const t_mapIdIdx& mapNonTermIdx = std::get<4>(parsetables);
+
+		auto make_node = [&mapNonTermIdx](const NonTerminalPtr& nonterm) -> std::pair<std::size_t, std::size_t>
+		{
+			std::size_t id = nonterm->GetId();
+			return std::make_pair(id, mapNonTermIdx.find(id)->second);
+		};
+
+		// the rules modify the tokens and the statement lists as the script compiler does
+		std::vector<t_semanticrule> rules{{
+			// rule 0: start -> stmts
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(start);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 1: stmts -> stmt stmts
+			[](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto lst = std::dynamic_pointer_cast<ASTList>(args[1]);
+				lst->AddChild(args[0], true);
+				return lst;
+			},
+			// rule 2: stmts -> eps
+			[&]([[maybe_unused]] const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmts);
+				return std::make_shared<ASTList>(id, tableidx);
+			},
+			// rule 3: stmt -> ident = expr ;
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto var = std::dynamic_pointer_cast<ASTToken<std::string>>(args[0]);
+				var->SetIdent(true);
+				var->SetLValue(true);
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTBinary>(id, tableidx, args[2], var, assign->GetId());
+			},
+			// rule 4: stmt -> expr ;
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 5: stmt -> { stmts }
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[1]);
+			},
+			// rule 6: expr -> expr + term
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(expr);
+				return std::make_shared<ASTBinary>(id, tableidx, args[0], args[2], plus->GetId());
+			},
+			// rule 7: expr -> term
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(expr);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 8: term -> term * factor
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTBinary>(id, tableidx, args[0], args[2], mult->GetId());
+			},
+			// rule 9: term -> factor
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 10: factor -> ( expr )
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(factor);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[1]);
+			},
+			// rule 11: factor -> integer
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				args[0]->SetDataType(VMType::INT);
+				auto [id, tableidx] = make_node(factor);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 12: factor -> ident
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				std::dynamic_pointer_cast<ASTToken<std::string>>(args[0])->SetIdent(true);
+				auto [id, tableidx] = make_node(factor);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+		}};
+
+		Parser parser{parsetables, rules};
+		IncrementalParser incr_parser{parsetables, rules};
+
+		// complete parse of the current source text, nullptr on errors
+		auto parse = [&parser, &mapTermIdx](const std::string& src) -> t_astbaseptr
+		{
+			try
+			{
+				std::istringstream istr{src};
+				return parser.Parse(get_all_tokens(istr, &mapTermIdx, false));
+			}
+			catch(const std::exception&)
+			{
+				return nullptr;
+			}
+		};
+
+		// incremental parse, nullptr on errors
+		auto reparse = [&incr_parser](std::size_t offs, std::size_t len, const std::string& text) -> t_astbaseptr
+		{
+			try
+			{
+				return incr_parser.Reparse(offs, len, text);
+			}
+			catch(const std::exception&)
+			{
+				return nullptr;
+			}
+		};
+
+		// source text with nested blocks and comments
+		auto create_source = [](std::size_t num_stmts) -> std::string
+		{
+			std::ostringstream ostr;
+			for(std::size_t i=0; i<num_stmts; ++i)
+			{
+				if(i % 10 == 0)
+					ostr << "{  # block " << i/10 << "\n";
+				if(i % 3 == 0)
+					ostr << "\tx" << i << " + 1;\n";
+				else
+					ostr << "\tx" << i << " = " << i << " * (y + 2);\n";
+				if(i % 10 == 9)
+					ostr << "}\n";
+			}
+			return ostr.str();
+		};
+
+		using t_clock = std::chrono::steady_clock;
+		const std::string src = create_source(60);
+
+		auto time_start = t_clock::now();
+		t_astbaseptr ast = incr_parser.Parse(src);
+		std::chrono::duration<double> time_full = t_clock::now() - time_start;
+		check(same_tree(ast, parse(src)), "complete parse");
+		const std::size_t num_tokens = incr_parser.GetNumLexedTokens();
+
+		// change a number in the middle of the text
+		std::size_t offs = src.find("x31 = 31");
+		check(offs != std::string::npos, "statement in source");
+		time_start = t_clock::now();
+		ast = incr_parser.Reparse(offs + 6, 2, "12345");
+		std::chrono::duration<double> time_incr = t_clock::now() - time_start;
+		check(same_tree(ast, parse(incr_parser.GetSource())), "changed number");
+		check(incr_parser.GetNumLexedTokens() <= 3, "lexed tokens for a changed number");
+		check(incr_parser.GetNumShiftedTokens() <= 10, "shifted tokens for a changed number");
+		check(incr_parser.GetNumReusedSubtrees() >= 5, "reused subtrees for a changed number");
+
+		std::cout << "Complete parse of " << num_tokens << " tokens: " << time_full.count() << " s, "
+			<< "incremental parse: " << time_incr.count() << " s, "
+			<< incr_parser.GetNumLexedTokens() << " lexed and "
+			<< incr_parser.GetNumShiftedTokens() << " shifted tokens, "
+			<< incr_parser.GetNumReusedSubtrees() << " reused subtrees." << std::endl;
+
+		// a new line at the beginning moves all nodes
+		ast = incr_parser.Reparse(0, 0, "# comment\n");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "inserted line");
+		check(incr_parser.GetNumLexedTokens() <= 2, "lexed tokens for an inserted line");
+
+		// an assignment turned into an expression does not keep its l-value
+		offs = incr_parser.GetSource().find("x11 = ");
+		ast = incr_parser.Reparse(offs + 4, 1, "+");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "assignment changed to expression");
+
+		// insert and remove statements
+		offs = incr_parser.GetSource().find("x40");
+		ast = incr_parser.Reparse(offs, 0, "z = 1 + 2;\n\t{ a; b = 2; }\n\t");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "inserted statements");
+		offs = incr_parser.GetSource().find("x50");
+		std::size_t len = incr_parser.GetSource().find("x51") - offs;
+		ast = incr_parser.Reparse(offs, len, "");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "removed statement");
+
+		// syntax and lexer errors and their corrections
+		offs = incr_parser.GetSource().find("x20");
+		check(reparse(offs, 0, ")") == nullptr, "syntax error");
+		ast = reparse(offs, 1, "");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "corrected syntax error");
+		check(reparse(offs, 0, "$") == nullptr, "lexer error");
+		ast = reparse(offs, 1, "");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "corrected lexer error");
+
+		// edits at the end
+		ast = incr_parser.Reparse(incr_parser.GetSource().size(), 0, "w = 5;");
+		check(same_tree(ast, parse(incr_parser.GetSource())), "appended statement");
+
+		// random edits, the ones giving invalid texts are undone again
+		std::mt19937 rnd{1234};
+		const std::string chars = " \nab1+*=;(){}#$";
+		incr_parser.Parse("{ a = 1; b + 2; }\nc = (a + b) * 3;\n");
+		std::size_t num_valid = 0, num_invalid = 0;
+		for(std::size_t edit=0; edit<200; ++edit)
+		{
+			std::string cur = incr_parser.GetSource();
+			std::size_t offs = std::uniform_int_distribution<std::size_t>{0, cur.size()}(rnd);
+			std::size_t len = std::min<std::size_t>(cur.size() - offs,
+				std::uniform_int_distribution<std::size_t>{0, 2}(rnd));
+			std::string text;
+			for(std::size_t i=std::uniform_int_distribution<std::size_t>{0, 2}(rnd); i>0; --i)
+				text += chars[std::uniform_int_distribution<std::size_t>{0, chars.size() - 1}(rnd)];
+
+			t_astbaseptr ast = reparse(offs, len, text);
+			t_astbaseptr ast_full = parse(incr_parser.GetSource());
+			bool same = same_tree(ast, ast_full);
+
+			if(!ast_full)
+			{
+				++num_invalid;
+				ast = reparse(offs, text.size(), cur.substr(offs, len));
+				same = same && ast && same_tree(ast, parse(incr_parser.GetSource()));
+			}
+			else
+			{
+				++num_valid;
+			}
+
+			if(!same)
+			{
+				check(false, "random edit " + std::to_string(edit));
+				break;
+			}
+		}
+		std::cout << num_valid << " random edits gave valid and "
+			<< num_invalid << " invalid texts." << std::endl;
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
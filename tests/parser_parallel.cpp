@@ -0,0 +1,289 @@
+/**
+ * test of the parallel parser
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Parses a source text consisting of functions and global statements
+ * with different numbers of threads and compares the syntax trees with
+ * the one of a serial parse.
+ */
+
+#include "parsergen/lr1.h"
+#include "codegen/lexer.h"
+#include "codegen/parser.h"
+#include "codegen/parser_parallel.h"
+#include "codegen/ast.h"
+#include "ast_compare.h"
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+
+
+enum : std::size_t
+{
+	START,
+	STMTS,
+	STMT,
+	EXPR,
+	TERM,
+};
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const std::string& msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		// statement ends outside brackets, strings and comments and not before an 'else'
+		{
+			const std::string src =
+				"a = f(1;2);"
+				" func g() { x; }\n"
+				"if(a) { b; }  # }; comment\n"
+				"else { c; }"
+				"s = \"};\";";
+			std::vector<std::size_t> ends = ParallelParser::FindStatementEnds(src);
+			check(ends == std::vector<std::size_t>{ 11, 27, 66, 75 }, "statement ends");
+		}
+
+		auto start = std::make_shared<NonTerminal>(START, "start");
+		auto stmts = std::make_shared<NonTerminal>(STMTS, "stmts");
+		auto stmt = std::make_shared<NonTerminal>(STMT, "stmt");
+		auto expr = std::make_shared<NonTerminal>(EXPR, "expr");
+		auto term = std::make_shared<NonTerminal>(TERM, "term");
+
+		auto plus = std::make_shared<Terminal>('+', "+");
+		auto assign = std::make_shared<Terminal>('=', "=");
+		auto stmt_end = std::make_shared<Terminal>(';', ";");
+		auto bracket_open = std::make_shared<Terminal>('(', "(");
+		auto bracket_close = std::make_shared<Terminal>(')', ")");
+		auto block_begin = std::make_shared<Terminal>('{', "{");
+		auto block_end = std::make_shared<Terminal>('}', "}");
+		auto keyword_func = std::make_shared<Terminal>((std::size_t)Token::FUNC, "func");
+		auto keyword_if = std::make_shared<Terminal>((std::size_t)Token::IF, "if");
+		auto keyword_else = std::make_shared<Terminal>((std::size_t)Token::ELSE, "else");
+		auto sym_int = std::make_shared<Terminal>((std::size_t)Token::INT, "integer");
+		auto sym_str = std::make_shared<Terminal>((std::size_t)Token::STR, "string");
+		auto ident = std::make_shared<Terminal>((std::size_t)Token::IDENT, "ident");
+
+		std::size_t semanticindex = 0;
+		start->AddRule({ stmts }, semanticindex++);                                // rule 0
+		stmts->AddRule({ stmt, stmts }, semanticindex++);                          // rule 1
+		stmts->AddRule({ g_eps }, semanticindex++);                                // rule 2
+		stmt->AddRule({ ident, assign, expr, stmt_end }, semanticindex++);         // rule 3
+		stmt->AddRule({ expr, stmt_end }, semanticindex++);                        // rule 4
+		stmt->AddRule({ keyword_func, ident, bracket_open, bracket_close,
+			block_begin, stmts, block_end }, semanticindex++);                     // rule 5
+		stmt->AddRule({ keyword_if, bracket_open, expr, bracket_close,
+			block_begin, stmts, block_end }, semanticindex++);                     // rule 6
+		stmt->AddRule({ keyword_if, bracket_open, expr, bracket_close,
+			block_begin, stmts, block_end,
+			keyword_else, block_begin, stmts, block_end }, semanticindex++);       // rule 7
+		expr->AddRule({ expr, plus, term }, semanticindex++);                      // rule 8
+		expr->AddRule({ term }, semanticindex++);                                  // rule 9
+		term->AddRule({ bracket_open, expr, bracket_close }, semanticindex++);     // rule 10
+		term->AddRule({ sym_int }, semanticindex++);                               // rule 11
+		term->AddRule({ sym_str }, semanticindex++);                               // rule 12
+		term->AddRule({ ident }, semanticindex++);                                 // rule 13
+
+		ElementPtr elem = std::make_shared<Element>(start, 0, 0, Terminal::t_terminalset{{g_end}});
+		ClosurePtr closure = std::make_shared<Closure>();
+		closure->AddElement(elem);
+
+		Collection colls{closure};
+		colls.DoTransitions();
+		Collection collsLALR = colls.ConvertToLALR();
+
+		auto parsetables = collsLALR.CreateParseTables();
+		const t_mapIdIdx& mapTermIdx = std::get<3>(parsetables);
+		const t_mapIdIdx& mapNonTermIdx = std::get<4>(parsetables);
+
+		auto make_node = [&mapNonTermIdx](const NonTerminalPtr& nonterm) -> std::pair<std::size_t, std::size_t>
+		{
+			std::size_t id = nonterm->GetId();
+			return std::make_pair(id, mapNonTermIdx.find(id)->second);
+		};
+
+		std::vector<t_semanticrule> rules{{
+			// rule 0: start -> stmts
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(start);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 1: stmts -> stmt stmts
+			[](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto lst = std::dynamic_pointer_cast<ASTList>(args[1]);
+				lst->AddChild(args[0], true);
+				return lst;
+			},
+			// rule 2: stmts -> eps
+			[&]([[maybe_unused]] const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmts);
+				return std::make_shared<ASTList>(id, tableidx);
+			},
+			// rule 3: stmt -> ident = expr ;
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTBinary>(id, tableidx, args[2], args[0], assign->GetId());
+			},
+			// rule 4: stmt -> expr ;
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 5: stmt -> func ident ( ) { stmts }
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTBinary>(id, tableidx, args[1], args[5], keyword_func->GetId());
+			},
+			// rule 6: stmt -> if ( expr ) { stmts }
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTCondition>(id, tableidx, args[2], args[5]);
+			},
+			// rule 7: stmt -> if ( expr ) { stmts } else { stmts }
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(stmt);
+				return std::make_shared<ASTCondition>(id, tableidx, args[2], args[5], args[9]);
+			},
+			// rule 8: expr -> expr + term
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(expr);
+				return std::make_shared<ASTBinary>(id, tableidx, args[0], args[2], plus->GetId());
+			},
+			// rule 9: expr -> term
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(expr);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 10: term -> ( expr )
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[1]);
+			},
+			// rule 11: term -> integer
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 12: term -> string
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+			// rule 13: term -> ident
+			[&](const std::vector<t_astbaseptr>& args) -> t_astbaseptr
+			{
+				auto [id, tableidx] = make_node(term);
+				return std::make_shared<ASTDelegate>(id, tableidx, args[0]);
+			},
+		}};
+
+		ParallelParser parser{parsetables, rules};
+
+		// serial parse of the complete source text
+		auto parse = [&parser, &mapTermIdx](const std::string& src) -> t_astbaseptr
+		{
+			std::istringstream istr{src};
+			t_astbaseptr ast = parser.Parse(get_all_tokens(istr, &mapTermIdx, false));
+			ast->AssignLineNumbers();
+			return ast;
+		};
+
+		// functions and global statements, with comments and strings containing delimiters
+		auto create_source = [](std::size_t num_funcs) -> std::string
+		{
+			std::ostringstream ostr;
+			ostr << "# generated script\n";
+			for(std::size_t i=0; i<num_funcs; ++i)
+			{
+				ostr << "func f" << i << "()\n{\n"
+					<< "\tx = " << i << " + (y + 1);  # }; {\n"
+					<< "\tif(x) { s = \"};\"; }\n"
+					<< "\telse { x + " << i*2 << "; }\n"
+					<< "}\n";
+				if(i % 3 == 0)
+					ostr << "g" << i << " = f" << i << " + 2;\n";
+			}
+			ostr << "# end\n";
+			return ostr.str();
+		};
+
+		using t_clock = std::chrono::steady_clock;
+		const std::string src = create_source(12);
+
+		auto time_start = t_clock::now();
+		t_astbaseptr ast_serial = parse(src);
+		std::chrono::duration<double> time_serial = t_clock::now() - time_start;
+
+		for(std::size_t num_threads : { 1, 2, 3, 8, 0 })
+		{
+			time_start = t_clock::now();
+			t_astbaseptr ast = parser.Parse(src, num_threads);
+			std::chrono::duration<double> time_parallel = t_clock::now() - time_start;
+			ast->AssignLineNumbers();
+
+			// all hardware threads are used for 0
+			const bool serial = num_threads == 1 ||
+				(num_threads == 0 && std::thread::hardware_concurrency() <= 1);
+			const std::string desc = std::to_string(num_threads) + " threads";
+			check(same_tree(ast, ast_serial), "syntax tree using " + desc);
+			check(serial ? parser.GetNumChunks() == 1 : parser.GetNumChunks() > 1,
+				"number of chunks using " + desc);
+
+			std::cout << "Parse using " << desc << " and " << parser.GetNumChunks() << " chunks: "
+				<< time_parallel.count() << " s, serial parse: "
+				<< time_serial.count() << " s." << std::endl;
+		}
+
+		// the first error in the source is reported as in a serial parse
+		{
+			std::string src_err = src;
+			std::size_t offs = src_err.find("x = 7 + ");
+			check(offs != std::string::npos, "statement in source");
+			src_err.replace(offs, 8, "x = 7 + + ");
+
+			std::string err_serial, err_parallel;
+			try { parse(src_err); }
+			catch(const std::exception& err) { err_serial = err.what(); }
+			try { parser.Parse(src_err, 4); }
+			catch(const std::exception& err) { err_parallel = err.what(); }
+
+			std::cout << "Error: " << err_parallel << std::endl;
+			check(!err_serial.empty() && err_serial == err_parallel, "syntax error");
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
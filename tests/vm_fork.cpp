@@ -0,0 +1,117 @@
+/**
+ * test of the vm forks and benchmark of the forking
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Runs the prelude of a program, which sets up a number and a string
+ * in global variables, and forks vms from it, which run requests
+ * modifying the global number. The forked vms and their parent must
+ * not see each other's changes. Afterwards, the time for forking is
+ * compared to the time for restoring a snapshot.
+ */
+
+#include "vm_prelude.h"
+
+#include <iostream>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+int main()
+{
+	constexpr VM::t_int num = 20000;
+	constexpr VM::t_int num_requests = 100;
+	constexpr VM::t_addr mem_size = 0x100000;
+	const VM::t_int sum = num*(num - 1)/2;
+	const VM::t_int len = prelude_strlen;
+
+	bool ok = true;
+	std::vector<VM::t_byte> prog = create_program(num, true);
+	double time_fork = 0., time_restore = 0.;
+	std::size_t copied_pages = 0;
+
+	try
+	{
+		// run the prelude
+		VM vm(mem_size);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+
+		// forked vms only see their own changes
+		auto start_time = t_clock::now();
+		for(VM::t_int input=0; input<num_requests; ++input)
+		{
+			std::unique_ptr<VM> child = vm.Fork();
+			ok = run_request(*child, input, sum + input + len, "Fork") && ok;
+			copied_pages = std::max(copied_pages, child->GetNumCopiedPages());
+		}
+		time_fork = t_duration{t_clock::now() - start_time}.count() / double(num_requests);
+
+		// changes of the parent are not seen by its children and vice versa
+		std::unique_ptr<VM> child = vm.Fork();
+		std::unique_ptr<VM> grandchild = child->Fork();
+		std::unique_ptr<VM> jit_child = vm.Fork();
+		jit_child->SetJit(true);
+		jit_child->SetJitThreshold(1);
+
+		ok = run_request(vm, 5, sum + 5 + len, "Parent") && ok;
+		ok = run_request(*child, 1, sum + 1 + len, "Child") && ok;
+		ok = run_request(*grandchild, 2, sum + 2 + len, "Grandchild") && ok;
+		ok = run_request(*jit_child, 3, sum + 3 + len, "Jit child") && ok;
+
+		// a fork keeps its state when its parent is gone
+		std::unique_ptr<VM> child2 = child->Fork();
+		child.reset();
+		VM::t_data result = child2->TopData();
+		if(result.index() != VM::m_intidx || std::get<VM::m_intidx>(result) != sum + 1 + len)
+		{
+			std::cerr << "Fork of a deleted vm: wrong result." << std::endl;
+			ok = false;
+		}
+
+		std::cout << "Maximum number of copied pages: " << copied_pages
+			<< " of " << mem_size / VMMemory::m_pagesize << "." << std::endl;
+		if(copied_pages >= 8)
+		{
+			std::cerr << "Too many pages copied." << std::endl;
+			ok = false;
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Fork: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	try
+	{
+		// compare with the restoring of a snapshot
+		VM vm(mem_size);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+		std::shared_ptr<const VMSnapshot> snapshot = vm.Snapshot();
+
+		auto start_time = t_clock::now();
+		for(VM::t_int input=0; input<num_requests; ++input)
+		{
+			VM vm_req(mem_size);
+			vm_req.Restore(*snapshot);
+			ok = run_request(vm_req, input, sum + input + len, "Snapshot") && ok;
+		}
+		time_restore = t_duration{t_clock::now() - start_time}.count() / double(num_requests);
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Snapshot: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	std::cout << "Time for forking and running a request: " << time_fork << " s, "
+		<< "for restoring a snapshot and running a request: " << time_restore << " s." << std::endl;
+
+	return ok ? 0 : -1;
+}
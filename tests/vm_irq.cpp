@@ -0,0 +1,187 @@
+/**
+ * test of the vm's interrupt priorities and benchmark of the interrupt check
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Checks that higher-priority interrupts nest into lower-priority service
+ * routines and that lower-priority ones wait for the running routine to
+ * return. Afterwards, the time per instruction is measured and the
+ * pending-interrupt check is compared to scanning one flag per interrupt.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <vector>
+#include <array>
+#include <set>
+#include <atomic>
+#include <iostream>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * call an external function by its index
+ */
+static void ext_call(CodeBuilder& code, VM::t_addr idx)
+{
+	code.Op(OpCode::EXTCALLI);
+	code.Raw(idx);
+}
+
+
+/**
+ * run a program with two interrupt service routines,
+ * the one of interrupt 1 has a higher priority than the one of interrupt 5
+ */
+static bool test_priorities(VM::t_int first_irq, const std::vector<VM::t_int>& expected_log)
+{
+	VM vm(0x1000);
+
+	std::vector<VM::t_int> log;
+	std::set<VM::t_int> raised;
+
+	VM::t_addr idx_log = vm.RegisterExternal("log", { VMType::INT }, VMType::UNKNOWN,
+		[&log](VM&, const VM::t_extargs& args) -> VM::t_data
+	{
+		log.push_back(std::get<VM::m_intidx>(args[0]));
+		return VM::t_data{};
+	});
+
+	// every interrupt is only requested once to not run into loops
+	VM::t_addr idx_raise = vm.RegisterExternal("raise", { VMType::INT }, VMType::UNKNOWN,
+		[&raised](VM& vm, const VM::t_extargs& args) -> VM::t_data
+	{
+		VM::t_int irq = std::get<VM::m_intidx>(args[0]);
+		if(raised.insert(irq).second)
+			vm.RequestInterrupt(static_cast<VM::t_addr>(irq));
+		return VM::t_data{};
+	});
+
+	CodeBuilder prog;
+
+	// main program
+	prog.PushInt(first_irq);
+	ext_call(prog, idx_raise);
+	prog.Op(OpCode::NOP);
+	prog.Op(OpCode::HALT);
+
+	// low-priority routine, returning like a function
+	VM::t_addr isr_low = prog.GetPos();
+	prog.PushInt(10);
+	ext_call(prog, idx_log);
+	prog.PushInt(1);
+	ext_call(prog, idx_raise);
+	prog.Op(OpCode::NOP);
+	prog.PushInt(11);
+	ext_call(prog, idx_log);
+	prog.PushInt(0);
+	prog.Op(OpCode::RET);
+
+	// high-priority routine, returning explicitly
+	VM::t_addr isr_high = prog.GetPos();
+	prog.PushInt(20);
+	ext_call(prog, idx_log);
+	prog.PushInt(5);
+	ext_call(prog, idx_raise);
+	prog.Op(OpCode::NOP);
+	prog.PushInt(21);
+	ext_call(prog, idx_log);
+	prog.Op(OpCode::IRET);
+
+	vm.SetMem(0, prog.GetCode().data(), prog.GetCode().size(), true);
+	vm.SetISR(5, isr_low);
+	vm.SetISR(1, isr_high);
+
+	VM::t_addr sp = vm.GetSP(), bp = vm.GetBP();
+	vm.Run();
+
+	bool ok = true;
+	if(log != expected_log)
+	{
+		std::cerr << "Wrong order of the service routines, got:";
+		for(VM::t_int entry : log)
+			std::cerr << " " << entry;
+		std::cerr << "." << std::endl;
+		ok = false;
+	}
+
+	if(vm.GetSP() != sp || vm.GetBP() != bp)
+	{
+		std::cerr << "Stack not restored after interrupts." << std::endl;
+		ok = false;
+	}
+
+	return ok;
+}
+
+
+/**
+ * measure the time per instruction
+ */
+static void benchmark()
+{
+	constexpr std::size_t num_instrs = 1 << 22;
+
+	// time per instruction of the vm
+	CodeBuilder prog;
+	for(std::size_t i=0; i<num_instrs; ++i)
+		prog.Op(OpCode::NOP);
+	prog.Op(OpCode::HALT);
+
+	VM vm(num_instrs + 0x1000, 0x100);
+	vm.SetCode(VMCode::Create(prog.GetCode().data(), prog.GetCode().size()));
+
+	auto start_time = t_clock::now();
+	vm.Run();
+	double time_vm = t_duration{t_clock::now() - start_time}.count();
+
+	// time for scanning one flag per interrupt before each instruction
+	std::array<std::atomic_bool, VM::m_num_interrupts> flags{};
+	std::size_t num_set = 0;
+	start_time = t_clock::now();
+	for(std::size_t i=0; i<num_instrs; ++i)
+	{
+		for(std::atomic_bool& flag : flags)
+			num_set += flag ? 1 : 0;
+	}
+	double time_scan = t_duration{t_clock::now() - start_time}.count();
+
+	// time for checking the pending-interrupt mask before each instruction
+	std::atomic<std::uint32_t> mask{0};
+	start_time = t_clock::now();
+	for(std::size_t i=0; i<num_instrs; ++i)
+	{
+		if(mask.load(std::memory_order_relaxed))
+			++num_set;
+	}
+	double time_mask = t_duration{t_clock::now() - start_time}.count();
+
+	const double ns = 1e9 / double(num_instrs);
+	std::cout << "Time per instruction: " << time_vm*ns << " ns." << std::endl;
+	std::cout << "Interrupt check per instruction: "
+		<< time_scan*ns << " ns scanning " << flags.size() << " flags, "
+		<< time_mask*ns << " ns with a pending mask"
+		<< (num_set ? "" : ".") << std::endl;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	// interrupt 1 nests into the routine of interrupt 5
+	ok = test_priorities(5, { 10, 20, 21, 11 }) && ok;
+
+	// interrupt 5 waits for the routine of interrupt 1 to finish
+	ok = test_priorities(1, { 20, 21, 10, 11 }) && ok;
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	benchmark();
+
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,178 @@
+/**
+ * differential test of the vm's jit compiler against the interpreter
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Usage: vm_jit <compiled programs...> < input
+ * Runs each program (e.g. the .bin files created by script_run from the
+ * script_tests) once in the interpreter and once with native code,
+ * both getting the same standard input, and compares the output,
+ * the final vm registers and the used vm memory. The native code runs
+ * once with all blocks compiled and once with only the hot ones.
+ */
+
+#include "vm/vm.h"
+
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * final state of a vm run
+ */
+struct RunResult
+{
+	std::string output{};
+	std::string error{};
+	VM::t_addr ip{}, sp{}, bp{};
+	std::vector<VM::t_byte> mem{};
+	std::size_t num_blocks{};
+	double time{};
+};
+
+
+/**
+ * run a program in the interpreter (jit_threshold < 0)
+ * or with native code (jit_threshold >= 0)
+ */
+static RunResult run_vm(const std::vector<VM::t_byte>& prog,
+	const std::string& input, VM::t_addr jit_threshold)
+{
+	RunResult result;
+
+	std::ostringstream ostr;
+	std::istringstream istr(input);
+	std::streambuf *cout_buf = std::cout.rdbuf(ostr.rdbuf());
+	std::streambuf *cin_buf = std::cin.rdbuf(istr.rdbuf());
+
+	VM vm(4096);
+	vm.SetJit(jit_threshold >= 0);
+	vm.SetJitThreshold(jit_threshold);
+
+	auto start_time = t_clock::now();
+	try
+	{
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+	}
+	catch(const std::exception& err)
+	{
+		result.error = err.what();
+	}
+	result.time = t_duration{t_clock::now() - start_time}.count();
+
+	std::cout.rdbuf(cout_buf);
+	std::cin.rdbuf(cin_buf);
+
+	result.output = ostr.str();
+	result.ip = vm.GetIP();
+	result.sp = vm.GetSP();
+	result.bp = vm.GetBP();
+	result.mem.assign(vm.GetMem(), vm.GetMem() + vm.GetMemSize());
+	result.num_blocks = vm.GetNumJitBlocks();
+
+	return result;
+}
+
+
+static bool compare(const char* prog_name, const char* mode, std::size_t prog_size,
+	const RunResult& interp, const RunResult& jit)
+{
+	bool ok = true;
+	auto fail = [prog_name, mode, &ok](const std::string& msg)
+	{
+		std::cerr << prog_name << " (" << mode << "): Mismatch in "
+			<< msg << "." << std::endl;
+		ok = false;
+	};
+
+	if(interp.output != jit.output)
+		fail("output");
+	if(interp.error != jit.error)
+		fail("errors (\"" + interp.error + "\" vs. \"" + jit.error + "\")");
+	if(interp.ip != jit.ip)
+		fail("instruction pointer");
+	if(interp.sp != jit.sp)
+		fail("stack pointer");
+	if(interp.bp != jit.bp)
+		fail("base pointer");
+
+	// compare the code and the memory above the stack pointer,
+	// the values below it have already been popped
+	for(std::size_t addr=0; addr<interp.mem.size(); ++addr)
+	{
+		if(addr >= prog_size && addr < static_cast<std::size_t>(interp.sp))
+			continue;
+
+		if(interp.mem[addr] != jit.mem[addr])
+		{
+			fail("memory at address " + std::to_string(addr));
+			break;
+		}
+	}
+
+	return ok;
+}
+
+
+int main(int argc, char** argv)
+{
+	std::ios_base::sync_with_stdio(false);
+
+	if(argc <= 1)
+	{
+		std::cerr << "Please give compiled programs." << std::endl;
+		return -1;
+	}
+
+	// all runs get the same input
+	std::string input{std::istreambuf_iterator<char>(std::cin),
+		std::istreambuf_iterator<char>()};
+
+	std::size_t num_failed = 0;
+	for(int arg=1; arg<argc; ++arg)
+	{
+		const char* prog_name = argv[arg];
+
+		std::ifstream ifstr(prog_name, std::ios_base::binary);
+		if(!ifstr)
+		{
+			std::cerr << "Cannot open \"" << prog_name << "\"." << std::endl;
+			++num_failed;
+			continue;
+		}
+
+		std::vector<VM::t_byte> prog{std::istreambuf_iterator<char>(ifstr),
+			std::istreambuf_iterator<char>()};
+
+		RunResult interp = run_vm(prog, input, -1);
+		RunResult jit_all = run_vm(prog, input, 0);
+		RunResult jit_hot = run_vm(prog, input, 64);
+
+		bool ok_all = compare(prog_name, "all blocks", prog.size(), interp, jit_all);
+		bool ok_hot = compare(prog_name, "hot blocks", prog.size(), interp, jit_hot);
+
+		if(ok_all && ok_hot)
+		{
+			std::cout << prog_name << ": OK"
+				<< " (interpreter: " << interp.time << " s"
+				<< "; all " << jit_all.num_blocks << " blocks: " << jit_all.time << " s"
+				<< "; " << jit_hot.num_blocks << " hot blocks: " << jit_hot.time << " s)."
+				<< std::endl;
+		}
+		else
+		{
+			++num_failed;
+		}
+	}
+
+	return num_failed == 0 ? 0 : -1;
+}
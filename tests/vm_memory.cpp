@@ -0,0 +1,200 @@
+/**
+ * test of the vm's lazily committed memory
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Creates a vm with a large memory, of which only the pages at the top
+ * of the stack are touched, and runs a function whose stack frame makes
+ * the memory grow, which moves the global variables and the arguments.
+ * The strings held by the moved stack are released when they are popped.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <vector>
+#include <iostream>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * adds a global variable to a function argument,
+ * the function's stack frame does not fit into the initial memory
+ */
+static std::vector<VM::t_byte> create_program(VM::t_addr func_framesize)
+{
+	constexpr VM::t_addr var = -(VM::m_addrsize + VM::m_bytesize + VM::m_intsize);
+	CodeBuilder prog;
+	CodeBuilder::Label func = prog.NewLabel();
+
+	prog.Op(OpCode::FRAME);
+	prog.Raw(-var);
+	prog.PushInt(7);
+	prog.PushAddr(VMType::ADDR_GBP, var);
+	prog.Op(OpCode::WRMEM);
+
+	prog.PushInt(5);
+	prog.PushLabel(func, false);
+	prog.Op(OpCode::CALL);
+	prog.Op(OpCode::HALT);
+
+	prog.Bind(func);
+	prog.Op(OpCode::FRAME);
+	prog.Raw(func_framesize);
+	prog.PushAddr(VMType::ADDR_BP_ARG, 2);
+	prog.Op(OpCode::RDMEM);
+	prog.PushAddr(VMType::ADDR_GBP, var);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::ADD);
+	prog.PushInt(1);
+	prog.Op(OpCode::RET);
+
+	prog.Resolve();
+	return prog.Release();
+}
+
+
+/**
+ * concatenates a string argument and a global string in a local variable,
+ * the function's stack frame does not fit into the initial memory
+ */
+static std::vector<VM::t_byte> create_str_program(VM::t_addr func_framesize)
+{
+	constexpr VM::t_addr var = -(VM::m_addrsize + VM::m_bytesize + VM::m_addrsize);
+	CodeBuilder prog;
+	CodeBuilder::Label func = prog.NewLabel();
+
+	prog.Op(OpCode::FRAME);
+	prog.Raw(-var);
+	prog.PushStr("abc");
+	prog.PushAddr(VMType::ADDR_GBP, var);
+	prog.Op(OpCode::WRMEM);
+
+	prog.PushStr("x");
+	prog.PushLabel(func, false);
+	prog.Op(OpCode::CALL);
+	prog.PushAddr(VMType::ADDR_GBP, var);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::HALT);
+
+	prog.Bind(func);
+	prog.Op(OpCode::FRAME);
+	prog.Raw(func_framesize);
+	prog.PushAddr(VMType::ADDR_BP_ARG, 2);
+	prog.Op(OpCode::RDMEM);
+	prog.PushAddr(VMType::ADDR_GBP, var);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::ADD);
+	prog.PushAddr(VMType::ADDR_BP, var);
+	prog.Op(OpCode::WRMEM);
+	prog.PushInt(0);
+	prog.PushInt(1);
+	prog.Op(OpCode::RET);
+
+	prog.Resolve();
+	return prog.Release();
+}
+
+
+static bool check_result(VM& vm, const char* name)
+{
+	VM::t_data result = vm.TopData();
+	if(result.index() != VM::m_intidx || std::get<VM::m_intidx>(result) != 12)
+	{
+		std::cerr << name << ": wrong result." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	try
+	{
+		// the whole memory is only reserved, not allocated
+#if LR1_VM_ADDR_BITS == 64
+		constexpr VM::t_addr large_size = VM::t_addr(1) << 36;
+#else
+		constexpr VM::t_addr large_size = VM::t_addr(1) << 30;
+#endif
+		std::vector<VM::t_byte> prog = create_program(0x1000);
+
+		auto start_time = t_clock::now();
+		VM vm(large_size, 0x1000);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+		ok = check_result(vm, "Large memory") && ok;
+
+		// the memory is cleared again
+		vm.Reset();
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+		ok = check_result(vm, "Reset large memory") && ok;
+		double time = t_duration{t_clock::now() - start_time}.count();
+
+		std::cout << "Time for two runs with " << large_size
+			<< " bytes of memory: " << time << " s." << std::endl;
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Large memory: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	try
+	{
+		// the stack is moved within the reserved memory
+		std::vector<VM::t_byte> prog = create_program(0x100000);
+		VM vm(0x1000, 0x100);
+		vm.SetMaxMemSize(0x1000000);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+		ok = check_result(vm, "Growing memory") && ok;
+
+		if(vm.GetMemSize() <= 0x100000)
+		{
+			std::cerr << "Memory has not grown." << std::endl;
+			ok = false;
+		}
+
+		// the stack is moved to a newly reserved memory
+		VM vm2(0x1000, 0x100);
+		std::vector<VM::t_byte> prog2 = create_program(vm2.GetMaxMemSize());
+		vm2.SetMaxMemSize(vm2.GetMaxMemSize() * 2);
+		vm2.SetMem(0, prog2.data(), prog2.size(), true);
+		vm2.Run();
+		ok = check_result(vm2, "Enlarged maximum memory") && ok;
+
+		// the concatenated string is released with the function's stack frame,
+		// only the interned literals are left
+		std::vector<VM::t_byte> prog3 = create_str_program(0x100000);
+		VM vm3(0x1000, 0x100);
+		vm3.SetMaxMemSize(0x1000000);
+		vm3.SetMem(0, prog3.data(), prog3.size(), true);
+		vm3.Run();
+
+		VM::t_data result = vm3.TopData();
+		if(result.index() != VM::m_stridx || std::get<VM::m_stridx>(result) != "abc"
+			|| vm3.GetNumStrings() != 2 || vm3.GetMemSize() <= 0x100000)
+		{
+			std::cerr << "Strings in a growing memory: wrong result." << std::endl;
+			ok = false;
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Growing memory: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,158 @@
+/**
+ * test of the native bindings of external functions
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Registers host functions with deduced signatures, calls them with
+ * arguments of different types and checks that borrowed strings are
+ * released, also when the host function throws, and that function names
+ * which are no strings are rejected.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+
+/**
+ * the position of the digits shows the argument order
+ */
+static VM::t_int weigh(VM::t_int a, VM::t_real b, std::string_view c)
+{
+	return a*100 + static_cast<VM::t_int>(b*10.) + static_cast<VM::t_int>(c.length());
+}
+
+
+static VM::t_str join(std::string_view a, std::string_view b)
+{
+	return VM::t_str{a} + "|" + VM::t_str{b};
+}
+
+
+static VM::t_int fail(std::string_view str)
+{
+	throw std::runtime_error("Host function failed for \"" + std::string{str} + "\".");
+}
+
+
+/**
+ * call a native function, the arguments are pushed in reverse order
+ */
+static void ext_call(CodeBuilder& code, const std::string& name)
+{
+	code.PushStr(name);
+	code.Op(OpCode::EXTCALL);
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		// weigh(3, 2.5, "xyz") and join("a", "b")
+		CodeBuilder code;
+		code.PushStr("xyz");
+		code.PushReal(2.5);
+		code.PushInt(3);
+		ext_call(code, "weigh");
+		code.PushStr("b");
+		code.PushStr("a");
+		ext_call(code, "join");
+		code.Op(OpCode::HALT);
+		code.Resolve();
+
+		VM vm(0x1000);
+		vm.Register("weigh", &weigh);
+		vm.Register("join", &join);
+		vm.Register("fail", &fail);
+
+		const VM::ExtFuncInfo& info = vm.GetExternals()[*vm.GetExternalIndex("weigh")];
+		check(info.args.size() == 3 && info.args[0] == VMType::INT && info.args[1] == VMType::REAL
+			&& info.args[2] == VMType::STR && info.ret == VMType::INT, "deduced signature");
+
+		vm.SetCode(std::make_shared<const VMCode>(code.Release()));
+		check(vm.Run(), "run");
+
+		VM::t_data joined = vm.PopData();
+		check(joined.index() == VM::m_stridx && std::get<VM::m_stridx>(joined) == "a|b",
+			"string arguments");
+		VM::t_data weight = vm.PopData();
+		check(weight.index() == VM::m_intidx && std::get<VM::m_intidx>(weight) == 328,
+			"argument order");
+
+		// the string borrowed by the failing call is released
+		CodeBuilder code_fail;
+		code_fail.PushStr("oops");
+		ext_call(code_fail, "fail");
+		code_fail.Op(OpCode::HALT);
+		code_fail.Resolve();
+
+		vm.SetCode(std::make_shared<const VMCode>(code_fail.Release()));
+		bool thrown = false;
+		try
+		{
+			vm.Run();
+		}
+		catch(const std::runtime_error& err)
+		{
+			std::cout << err.what() << std::endl;
+			thrown = true;
+		}
+		check(thrown, "failing host function");
+
+		// the function name has to be a string
+		bool called = false;
+		vm.RegisterExternal("abc", {}, VMType::INT,
+			[&called](VM&, const VM::t_extargs&) -> VM::t_data
+		{
+			called = true;
+			return VM::t_data{std::in_place_index<VM::m_intidx>, 0};
+		});
+
+		CodeBuilder code_name;
+		code_name.PushStr("abc");
+		code_name.PushInt(0);
+		code_name.Op(OpCode::EXTCALL);
+		code_name.Op(OpCode::HALT);
+		code_name.Resolve();
+
+		vm.SetCode(std::make_shared<const VMCode>(code_name.Release()));
+		thrown = false;
+		try
+		{
+			vm.Run();
+		}
+		catch(const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		check(thrown && !called, "non-string function name");
+
+		// no external call is running anymore
+		check(vm.Snapshot() != nullptr, "snapshot after failed call");
+		check(vm.Fork() != nullptr, "fork after failed call");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
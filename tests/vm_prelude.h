@@ -0,0 +1,158 @@
+/**
+ * prelude program for the vm snapshot and fork tests
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * The prelude sets up a number and a string in global variables,
+ * the requests following it use the globals.
+ */
+
+#ifndef __LR1_TEST_VM_PRELUDE_H__
+#define __LR1_TEST_VM_PRELUDE_H__
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+
+/**
+ * call an external function by its name
+ */
+static inline void ext_call(CodeBuilder& prog, const std::string& name)
+{
+	prog.PushStr(name);
+	prog.Op(OpCode::EXTCALL);
+}
+
+
+// global variables
+constexpr VM::t_addr var_size = VM::m_bytesize + VM::m_intsize;
+constexpr VM::t_addr var_i = -(VM::m_addrsize + var_size);
+constexpr VM::t_addr var_sum = -(VM::m_addrsize + 2*var_size);
+constexpr VM::t_addr var_str = -(VM::m_addrsize + 3*var_size);
+
+// length of the string set by the prelude
+constexpr VM::t_int prelude_strlen = 7;
+
+
+/**
+ * the prelude sums up the numbers below the given one and sets a string,
+ * the request adds the input to the sum and returns it plus the length
+ * of the string; if store_sum is set, the request also writes the new
+ * sum back to its global variable
+ */
+static inline std::vector<VM::t_byte> create_program(VM::t_int num, bool store_sum)
+{
+	CodeBuilder prog;
+	CodeBuilder::Label loop = prog.NewLabel();
+	CodeBuilder::Label end = prog.NewLabel();
+
+	// prelude
+	prog.Op(OpCode::FRAME);
+	prog.Raw(-var_str);
+	prog.PushInt(0);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::WRMEM);
+	prog.PushInt(0);
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::WRMEM);
+	prog.PushStr("prelude");
+	prog.PushAddr(VMType::ADDR_GBP, var_str);
+	prog.Op(OpCode::WRMEM);
+
+	prog.Bind(loop);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	prog.PushInt(num);
+	prog.Op(OpCode::LT);
+	prog.Op(OpCode::NOT);
+	prog.PushLabel(end, false);
+	prog.Op(OpCode::JMPCND);
+
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::RDMEM);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::ADD);
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::WRMEM);
+
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	prog.PushInt(1);
+	prog.Op(OpCode::ADD);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::WRMEM);
+	prog.PushLabel(loop, false);
+	prog.Op(OpCode::JMP);
+
+	prog.Bind(end);
+	prog.Op(OpCode::HALT);
+
+	// request
+	ext_call(prog, "input");
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::ADD);
+	if(store_sum)
+	{
+		prog.PushAddr(VMType::ADDR_GBP, var_sum);
+		prog.Op(OpCode::WRMEM);
+		prog.PushAddr(VMType::ADDR_GBP, var_sum);
+		prog.Op(OpCode::RDMEM);
+	}
+	prog.PushAddr(VMType::ADDR_GBP, var_str);
+	prog.Op(OpCode::RDMEM);
+	ext_call(prog, "length");
+	prog.Op(OpCode::ADD);
+	prog.Op(OpCode::HALT);
+
+	prog.Resolve();
+	return prog.Release();
+}
+
+
+/**
+ * register the external functions used by the request
+ */
+static inline void register_funcs(VM& vm, VM::t_int input)
+{
+	vm.RegisterExternal("input", {}, VMType::INT,
+		[input](VM&, const VM::t_extargs&) -> VM::t_data
+	{
+		return VM::t_data{std::in_place_index<VM::m_intidx>, input};
+	});
+
+	vm.RegisterExternal("length", { VMType::STR }, VMType::INT,
+		[](VM&, const VM::t_extargs& args) -> VM::t_data
+	{
+		return VM::t_data{std::in_place_index<VM::m_intidx>,
+			static_cast<VM::t_int>(std::get<VM::m_stridx>(args[0]).length())};
+	});
+}
+
+
+/**
+ * run a request in the given vm and check its result
+ */
+static inline bool run_request(VM& vm, VM::t_int input, VM::t_int expected, const char* name)
+{
+	register_funcs(vm, input);
+	vm.Run();
+
+	VM::t_data result = vm.TopData();
+	if(result.index() != VM::m_intidx || std::get<VM::m_intidx>(result) != expected)
+	{
+		std::cerr << name << ": wrong result for input " << input << "." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * test of the vm profiler
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Runs a program whose global code calls a function three times,
+ * which in turn calls another function, and checks the counted
+ * instructions, the function calls and the exported profiles.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+
+/**
+ * the global code returns f() + f() + f(), with f() = 1 + g() and g() = 2
+ */
+static std::vector<VM::t_byte> create_program(VM::t_addr& addr_f, VM::t_addr& addr_g)
+{
+	CodeBuilder prog;
+	CodeBuilder::Label f = prog.NewLabel();
+	CodeBuilder::Label g = prog.NewLabel();
+
+	prog.PushLabel(f, false);
+	prog.Op(OpCode::CALL);
+	prog.PushLabel(f, false);
+	prog.Op(OpCode::CALL);
+	prog.Op(OpCode::ADD);
+	prog.PushLabel(f, false);
+	prog.Op(OpCode::CALL);
+	prog.Op(OpCode::ADD);
+	prog.Op(OpCode::HALT);
+
+	prog.Bind(f);
+	prog.PushInt(1);
+	prog.PushLabel(g, false);
+	prog.Op(OpCode::CALL);
+	prog.Op(OpCode::ADD);
+	prog.PushInt(0);
+	prog.Op(OpCode::RET);
+
+	prog.Bind(g);
+	prog.PushInt(2);
+	prog.PushInt(0);
+	prog.Op(OpCode::RET);
+
+	prog.Resolve();
+	addr_f = *prog.GetAddr(f);
+	addr_g = *prog.GetAddr(g);
+	return prog.Release();
+}
+
+
+int main()
+{
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	try
+	{
+		VM::t_addr addr_f = 0, addr_g = 0;
+		std::vector<VM::t_byte> prog = create_program(addr_f, addr_g);
+
+		VM vm(0x1000);
+		vm.SetProfiling(true);
+		vm.GetProfiler()->SetFunctionNames({ { addr_f, "f" }, { addr_g, "g" } });
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+
+		VM::t_data result = vm.TopData();
+		check(result.index() == VM::m_intidx && std::get<VM::m_intidx>(result) == 9, "result");
+
+		const VMProfiler* profiler = vm.GetProfiler();
+		check(profiler->GetNumInstructions(OpCode::CALL) == 6, "number of calls");
+		check(profiler->GetNumInstructions(OpCode::RET) == 6, "number of returns");
+		check(profiler->GetNumInstructions(OpCode::HALT) == 1, "number of halts");
+		check(profiler->GetNumInstructions(addr_f) == 3, "instructions at f");
+		check(profiler->GetNumInstructions(addr_g) == 3, "instructions at g");
+		check(profiler->GetNumInstructions() == 3*2 + 2 + 1 + 3*6 + 3*3, "number of instructions");
+		check(profiler->GetMaxStackSize() > 0, "stack size");
+
+		const auto& funcs = profiler->GetFunctions();
+		check(funcs.size() == 2, "number of functions");
+		check(funcs.at(addr_f).calls == 3 && funcs.at(addr_g).calls == 3, "function calls");
+		check(funcs.at(addr_f).total >= funcs.at(addr_g).total, "function times");
+
+		std::ostringstream ostrJson, ostrFolded;
+		profiler->WriteJson(ostrJson);
+		profiler->WriteFolded(ostrFolded);
+		std::cout << ostrJson.str() << "\n" << ostrFolded.str() << std::endl;
+
+		check(ostrJson.str().find("\"name\": \"f\"") != std::string::npos, "json output");
+		check(ostrJson.str().find("\"call\": 6") != std::string::npos, "json output");
+		check(ostrFolded.str().find("global;f;g ") != std::string::npos, "folded output");
+
+		// native code is not used while profiling
+		VM vm_jit(0x1000);
+		vm_jit.SetJit(true);
+		vm_jit.SetJitThreshold(0);
+		vm_jit.SetProfiling(true);
+		vm_jit.SetMem(0, prog.data(), prog.size(), true);
+		vm_jit.Run();
+		check(vm_jit.GetNumJitBlocks() == 0, "native code while profiling");
+		check(vm_jit.GetProfiler()->GetNumInstructions() == profiler->GetNumInstructions(),
+			"number of instructions with jit");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
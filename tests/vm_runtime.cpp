@@ -0,0 +1,178 @@
+/**
+ * test of the multi-instance vm runtime with a shared code image
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Usage: vm_runtime <compiled programs...>
+ * Runs each program (e.g. the .bin files created by script_run from the
+ * script_tests, not requiring any input) once in a stand-alone vm, once
+ * more in small time slices, and then concurrently in many time-sliced
+ * sessions sharing the same code image, and compares the printed output
+ * of each run with the first one.
+ */
+
+#include "vm/runtime.h"
+
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * register print functions writing to the given output
+ */
+static void setup_output(VM& vm, std::ostringstream *output)
+{
+	vm.RegisterExternal("print", { VMType::STR }, VMType::UNKNOWN,
+		[output](VM&, const VM::t_extargs& args) -> VM::t_data
+	{
+		*output << std::get<VM::m_stridx>(args[0]);
+		return VM::t_data{};
+	});
+
+	vm.RegisterExternal("println", { VMType::STR }, VMType::UNKNOWN,
+		[output](VM&, const VM::t_extargs& args) -> VM::t_data
+	{
+		*output << std::get<VM::m_stridx>(args[0]) << "\n";
+		return VM::t_data{};
+	});
+}
+
+
+/**
+ * run a program stand-alone with the code copied into the vm's memory,
+ * either at once or in time slices of the given number of instructions
+ */
+static std::string run_single(const VMCode& code, std::uint64_t timeslice = 0)
+{
+	std::ostringstream output;
+
+	VM vm(0x1000);
+	vm.SetMem(0, code.GetData(), code.GetSize(), true);
+	setup_output(vm, &output);
+
+	if(timeslice)
+	{
+		while(vm.RunFor(timeslice) == VM::RunState::SUSPENDED)
+			;
+	}
+	else
+	{
+		vm.Run();
+	}
+
+	return output.str();
+}
+
+
+/**
+ * run a program in many concurrent sessions
+ */
+static std::size_t run_sessions(VMRuntime& runtime,
+	const std::shared_ptr<const VMCode>& code,
+	std::size_t num_sessions, const std::string& expected_output)
+{
+	std::vector<std::ostringstream> outputs(num_sessions);
+	std::vector<std::future<bool>> results;
+	results.reserve(num_sessions);
+
+	for(std::size_t session=0; session<num_sessions; ++session)
+	{
+		std::ostringstream *output = &outputs[session];
+
+		results.emplace_back(runtime.Submit(code,
+			[output](VM& vm)
+			{
+				setup_output(vm, output);
+			}));
+	}
+
+	std::size_t num_failed = 0;
+	for(std::size_t session=0; session<num_sessions; ++session)
+	{
+		try
+		{
+			results[session].get();
+		}
+		catch(const std::exception& err)
+		{
+			std::cerr << "Session " << session << " failed: "
+				<< err.what() << std::endl;
+			++num_failed;
+			continue;
+		}
+
+		if(outputs[session].str() != expected_output)
+		{
+			std::cerr << "Session " << session << ": Mismatch in output." << std::endl;
+			++num_failed;
+		}
+	}
+
+	return num_failed;
+}
+
+
+int main(int argc, char** argv)
+{
+	std::ios_base::sync_with_stdio(false);
+
+	if(argc <= 1)
+	{
+		std::cerr << "Please give compiled programs." << std::endl;
+		return -1;
+	}
+
+	constexpr std::size_t num_sessions = 16;
+	VMRuntime runtime{};
+	runtime.SetTimeSlice(1000);
+
+	std::size_t num_failed = 0;
+	for(int arg=1; arg<argc; ++arg)
+	{
+		const char* prog_name = argv[arg];
+
+		try
+		{
+			std::shared_ptr<const VMCode> code = VMCode::Load(prog_name);
+			std::string expected_output = run_single(*code);
+			if(run_single(*code, 10) != expected_output)
+			{
+				std::cerr << prog_name << ": Mismatch in time-sliced output." << std::endl;
+				++num_failed;
+			}
+
+			for(bool jit : { false, true })
+			{
+				runtime.SetJit(jit);
+
+				auto start_time = t_clock::now();
+				std::size_t failed = run_sessions(runtime, code,
+					num_sessions, expected_output);
+				double time = t_duration{t_clock::now() - start_time}.count();
+
+				if(failed == 0)
+				{
+					std::cout << prog_name << (jit ? " (jit)" : "") << ": OK ("
+						<< num_sessions << " sessions on "
+						<< runtime.GetNumThreads() << " threads: "
+						<< time << " s)." << std::endl;
+				}
+
+				num_failed += failed;
+			}
+		}
+		catch(const std::exception& err)
+		{
+			std::cerr << prog_name << ": " << err.what() << std::endl;
+			++num_failed;
+		}
+	}
+
+	return num_failed == 0 ? 0 : -1;
+}
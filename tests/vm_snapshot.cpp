@@ -0,0 +1,215 @@
+/**
+ * test of the vm snapshots and benchmark of the warm start
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Runs the prelude of a program, which sets up a number and a string
+ * in global variables, takes a snapshot of the vm and runs requests,
+ * which use the globals, in new vms restored from the snapshot, both
+ * directly and after saving and loading it. Afterwards, the time for
+ * restoring is compared to the time for running the prelude.
+ * Snapshot files with a corrupted memory layout have to be rejected.
+ */
+
+#include "vm_prelude.h"
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <utility>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * run a request in a vm restored from the snapshot
+ */
+static bool run_restored(VM& vm, const VMSnapshot& snapshot,
+	VM::t_int input, VM::t_int expected, const char* name)
+{
+	vm.Restore(snapshot);
+	return run_request(vm, input, expected, name);
+}
+
+
+/**
+ * registers in the snapshot file which are patched
+ */
+enum class StateField : std::size_t
+{
+	IP = 0, SP = 1, BP = 2, GBP = 3, MEMSIZE = 4,
+};
+
+
+/**
+ * patch the registers of a saved snapshot and check that it is rejected
+ */
+static bool check_corrupted(const std::string& file, const std::string& corrupted,
+	const std::vector<std::pair<StateField, VM::t_addr>>& patches, const char* name)
+{
+	std::filesystem::copy_file(file, corrupted,
+		std::filesystem::copy_options::overwrite_existing);
+
+	{
+		// the state follows the magic number and the sizes of the address and real types
+		std::fstream fstr(corrupted, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		for(const auto& [field, val] : patches)
+		{
+			fstr.seekp(static_cast<std::streamoff>(16 + static_cast<std::size_t>(field)*sizeof(val)));
+			fstr.write(reinterpret_cast<const char*>(&val), sizeof(val));
+		}
+	}
+
+	try
+	{
+		std::shared_ptr<const VMSnapshot> snapshot = VMSnapshot::Load(corrupted);
+		VM vm(0x1000);
+		vm.Restore(*snapshot);
+	}
+	catch(const std::exception&)
+	{
+		return true;
+	}
+
+	std::cerr << "Corrupted snapshot with " << name << " not rejected." << std::endl;
+	return false;
+}
+
+
+int main()
+{
+	constexpr VM::t_int num = 20000;
+	constexpr VM::t_int num_requests = 100;
+	const VM::t_int sum = num*(num - 1)/2;
+	const VM::t_int len = prelude_strlen;
+
+	bool ok = true;
+	std::vector<VM::t_byte> prog = create_program(num, false);
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "vm_snapshot.snap";
+	double time_prelude = 0., time_restore = 0.;
+
+	try
+	{
+		// run the prelude
+		auto start_time = t_clock::now();
+		VM vm(0x1000);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Run();
+		time_prelude = t_duration{t_clock::now() - start_time}.count();
+
+		std::shared_ptr<const VMSnapshot> snapshot = vm.Snapshot();
+		snapshot->Save(file.string());
+		std::shared_ptr<const VMSnapshot> loaded = VMSnapshot::Load(file.string());
+
+		// the vm itself can also return to the snapshot
+		ok = run_restored(vm, *snapshot, 1, sum + 1 + len, "Same vm") && ok;
+		ok = run_restored(vm, *snapshot, 2, sum + 2 + len, "Same vm again") && ok;
+
+		start_time = t_clock::now();
+		for(VM::t_int input=0; input<num_requests; ++input)
+		{
+			VM vm_req(0x1000);
+			ok = run_restored(vm_req, *snapshot, input, sum + input + len, "Snapshot") && ok;
+		}
+		time_restore = t_duration{t_clock::now() - start_time}.count() / double(num_requests);
+
+		for(VM::t_int input=0; input<num_requests; input+=10)
+		{
+			VM vm_req(0x1000);
+			ok = run_restored(vm_req, *loaded, input, sum + input + len, "Loaded snapshot") && ok;
+		}
+
+		// a loaded snapshot can be saved again
+		loaded->Save(file.string() + "2");
+		std::shared_ptr<const VMSnapshot> reloaded = VMSnapshot::Load(file.string() + "2");
+		VM vm_req(0x1000);
+		ok = run_restored(vm_req, *reloaded, 5, sum + 5 + len, "Reloaded snapshot") && ok;
+
+		std::cout << "Stored memory: " << snapshot->GetStoredSize() << " bytes." << std::endl;
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Snapshot: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	try
+	{
+		// vms sharing the code image
+		auto code = VMCode::Create(prog.data(), prog.size());
+		VM vm(0x1000);
+		vm.SetCode(code);
+		vm.Run();
+
+		std::shared_ptr<const VMSnapshot> snapshot = vm.Snapshot();
+		snapshot->Save(file.string());
+		std::shared_ptr<const VMSnapshot> loaded = VMSnapshot::Load(file.string());
+
+		VM vm_req(0x1000);
+		vm_req.SetCode(code);
+		ok = run_restored(vm_req, *loaded, 3, sum + 3 + len, "Shared code") && ok;
+
+		// the snapshot does not fit a vm without the code image
+		try
+		{
+			VM vm_nocode(0x1000);
+			vm_nocode.Restore(*loaded);
+			std::cerr << "Snapshot restored without the code image." << std::endl;
+			ok = false;
+		}
+		catch(const std::exception&)
+		{
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Shared code: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	try
+	{
+		// corrupted snapshot files
+		VM vm(0x1000);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+		vm.Snapshot()->Save(file.string());
+
+		const std::string corrupted = file.string() + "3";
+		const VM::t_addr code_end = static_cast<VM::t_addr>(prog.size());
+		ok = check_corrupted(file.string(), corrupted, { { StateField::MEMSIZE, 0x7fff0000 },
+			{ StateField::SP, 0x7ffef000 }, { StateField::BP, 0x7ffef000 }, { StateField::IP, 0 } },
+			"a too large memory") && ok;
+		ok = check_corrupted(file.string(), corrupted,
+			{ { StateField::SP, 0x2000 }, { StateField::BP, 0x2000 } },
+			"a stack beyond the memory") && ok;
+		ok = check_corrupted(file.string(), corrupted, { { StateField::SP, code_end - 1 } },
+			"a stack in the code") && ok;
+		ok = check_corrupted(file.string(), corrupted, { { StateField::GBP, 0x1000 + 1 } },
+			"a global frame beyond the memory") && ok;
+		ok = check_corrupted(file.string(), corrupted, { { StateField::IP, code_end + 0x10 } },
+			"an instruction pointer outside the code") && ok;
+		std::filesystem::remove(corrupted);
+
+		// the unchanged file is still accepted
+		std::shared_ptr<const VMSnapshot> loaded = VMSnapshot::Load(file.string());
+		VM vm_req(0x1000);
+		vm_req.Restore(*loaded);
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Corrupted snapshot: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::filesystem::remove(file);
+	std::filesystem::remove(file.string() + "2");
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	std::cout << "Time for running the prelude: " << time_prelude << " s, "
+		<< "for restoring and running a request: " << time_restore << " s." << std::endl;
+
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,143 @@
+/**
+ * test of the vm's string heap
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Interns, concatenates and releases strings and checks that
+ * the entries of unused strings are recycled and that corrupt
+ * saved data is rejected.
+ */
+
+#include "vm/strheap.h"
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+
+
+int main()
+{
+	using t_handle = VMStrHeap::t_handle;
+
+	bool ok = true;
+	auto check = [&ok](bool cond, const char* msg)
+	{
+		if(!cond)
+		{
+			std::cerr << "Failed: " << msg << "." << std::endl;
+			ok = false;
+		}
+	};
+
+	auto is_invalid = [](const VMStrHeap& heap, t_handle handle) -> bool
+	{
+		try
+		{
+			heap.Get(handle);
+		}
+		catch(const std::exception&)
+		{
+			return true;
+		}
+		return false;
+	};
+
+	try
+	{
+		VMStrHeap heap;
+
+		// equal strings share one entry
+		t_handle abc = heap.Intern("abc");
+		t_handle abc2 = heap.Intern(std::string{"ab"} + "c");
+		t_handle de = heap.Intern("de");
+		check(abc == abc2, "interned strings");
+		check(abc != de, "different strings");
+		check(heap.GetNumStrings() == 2, "number of strings");
+		check(heap.Get(abc) == "abc" && heap.Get(de) == "de", "string contents");
+
+		// concatenations are interned as well
+		t_handle abcde = heap.Concat(abc, de);
+		check(heap.Get(abcde) == "abcde", "concatenation");
+		check(heap.Concat(abc, de) == abcde, "interned concatenation");
+		check(heap.Intern("abcde") == abcde, "interned concatenation by content");
+		check(heap.GetNumStrings() == 3, "number of strings after concatenation");
+
+		// concatenating an empty string gives the other one
+		t_handle empty = heap.Intern("");
+		check(heap.Concat(de, empty) == de, "concatenation with empty string");
+		check(heap.Concat(empty, de) == de, "concatenation to empty string");
+
+		// the string is kept until its last reference is released
+		heap.Release(abc);
+		check(heap.Get(abc2) == "abc", "string with remaining reference");
+		heap.Release(abc2);
+		check(is_invalid(heap, abc), "released string");
+		check(heap.GetNumStrings() == 3, "number of strings after release");
+
+		// the released entry is recycled
+		t_handle xyz = heap.Intern("xyz");
+		check(xyz == abc, "recycled entry");
+		check(heap.Intern("abc") != abc, "new entry for released string");
+
+		// copies are independent
+		VMStrHeap copy{heap};
+		copy.Release(xyz);
+		check(is_invalid(copy, xyz) && heap.Get(xyz) == "xyz", "copied heap");
+		check(copy.Intern("de") == de, "index of copied heap");
+
+		// saved and loaded heaps keep the handles and the free list
+		std::stringstream data;
+		copy.Save(data);
+		VMStrHeap loaded;
+		loaded.Load(data);
+		check(loaded.Get(abcde) == "abcde", "loaded string");
+		check(is_invalid(loaded, xyz), "loaded free entry");
+		check(loaded.Intern("uvw") == xyz, "recycled entry of loaded heap");
+
+		// corrupt data is rejected before it is used
+		const std::string saved = data.str();
+		auto is_rejected = [](const std::string& bytes) -> bool
+		{
+			std::istringstream istr{bytes};
+			VMStrHeap heap_corrupt;
+			try
+			{
+				heap_corrupt.Load(istr);
+			}
+			catch(const std::runtime_error& err)
+			{
+				return std::string{err.what()} == "Invalid string heap data."
+					&& heap_corrupt.GetNumStrings() == 0;
+			}
+			return false;
+		};
+		auto patch = [&saved](std::size_t pos, auto val) -> std::string
+		{
+			std::string bytes = saved;
+			std::memcpy(bytes.data() + pos, &val, sizeof(val));
+			return bytes;
+		};
+
+		// the free list is at the end, the first entry's length after the counts and its references
+		const std::size_t free_pos = saved.size() - sizeof(t_handle);
+		const std::size_t len_pos = sizeof(std::uint64_t) + sizeof(VMStrHeap::t_addr);
+		check(!is_rejected(saved), "valid data");
+		check(is_rejected(saved.substr(0, saved.size() - 1)), "truncated data");
+		check(is_rejected(patch(len_pos, std::uint64_t{1} << 60)), "string length beyond the data");
+		check(is_rejected(patch(0, std::uint64_t{1} << 60)), "number of strings beyond the data");
+		check(is_rejected(patch(free_pos, t_handle{1000})), "free handle beyond the strings");
+		check(is_rejected(patch(free_pos, abcde)), "free handle of a referenced string");
+
+		heap.Clear();
+		check(heap.GetNumStrings() == 0 && is_invalid(heap, de), "cleared heap");
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Error: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,187 @@
+/**
+ * test of the timer wheel delivering the vms' timer interrupts
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Runs many periodic timers with different periods, some of them spanning
+ * several wheels, removes half of them and compares the numbers of
+ * their expiries with the expected ones. Afterwards, a vm receives its
+ * timer interrupts from a wheel with a resolution finer than the
+ * process-wide one.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+#include "vm/timerwheel.h"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <iostream>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+
+/**
+ * run the timers on a wheel with the given resolution
+ */
+static bool test_wheel(VMTimerWheel::t_duration resolution,
+	const std::vector<VMTimerWheel::t_duration>& periods,
+	std::size_t timers_per_period)
+{
+	constexpr auto run_time = 500ms;
+
+	VMTimerWheel wheel{resolution};
+
+	std::size_t num_timers = periods.size() * timers_per_period;
+	auto counters = std::make_unique<std::atomic<std::size_t>[]>(num_timers);
+	std::vector<VMTimerWheel::t_id> ids;
+
+	auto start_time = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i<num_timers; ++i)
+	{
+		counters[i] = 0;
+		ids.push_back(wheel.Add(periods[i % periods.size()],
+			[&counters, i]() { ++counters[i]; }));
+	}
+
+	// remove every second timer after half of the time
+	std::this_thread::sleep_for(run_time / 2);
+	std::vector<std::size_t> counts_removed(num_timers);
+	for(std::size_t i=1; i<num_timers; i+=2)
+	{
+		wheel.Remove(ids[i]);
+		counts_removed[i] = counters[i];
+	}
+	auto remove_time = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(run_time / 2);
+
+	std::vector<std::size_t> counts(num_timers);
+	for(std::size_t i=0; i<num_timers; ++i)
+		counts[i] = counters[i];
+	auto end_time = std::chrono::steady_clock::now();
+
+	bool ok = true;
+	for(std::size_t i=0; i<num_timers; ++i)
+	{
+		std::size_t count = counts[i];
+		bool removed = (i % 2 == 1);
+		auto period = periods[i % periods.size()];
+
+		// the timers ran at most for the measured time, the scheduling
+		// of the timer thread can only delay the expiries
+		auto max_time = (removed ? remove_time : end_time) - start_time;
+		auto min_time = removed ? run_time / 2 : run_time;
+		double max_expected = double(max_time / period) + 1.;
+		double expected = double(min_time / period);
+
+		bool count_ok = (count <= max_expected) && (count + 1. >= expected * 0.5);
+		if(removed && count != counts_removed[i])
+			count_ok = false;
+
+		if(!count_ok)
+		{
+			std::cerr << "Timer " << i << " with period "
+				<< std::chrono::duration<double, std::milli>(period).count() << " ms"
+				<< (removed ? " (removed)" : "")
+				<< ": expected " << expected << " expiries, got " << count
+				<< "." << std::endl;
+			ok = false;
+		}
+	}
+
+	if(wheel.GetNumTimers() != num_timers - num_timers/2)
+	{
+		std::cerr << "Wrong number of remaining timers." << std::endl;
+		ok = false;
+	}
+
+	return ok;
+}
+
+
+/**
+ * count the timer interrupts of a vm with a sub-millisecond period
+ */
+static bool test_vm(VMTimerWheel::t_duration resolution, VMTimerWheel::t_duration period)
+{
+	constexpr auto run_time = 100ms;
+
+	VM vm(0x1000);
+	vm.SetTimerWheel(std::make_shared<VMTimerWheel>(resolution));
+
+	std::size_t num_irqs = 0;
+	VM::t_addr idx_count = vm.RegisterExternal("count", {}, VMType::UNKNOWN,
+		[&num_irqs](VM&, const VM::t_extargs&) -> VM::t_data
+	{
+		++num_irqs;
+		return VM::t_data{};
+	});
+
+	auto end_time = std::chrono::steady_clock::now() + run_time;
+	VM::t_addr idx_running = vm.RegisterExternal("running", {}, VMType::INT,
+		[end_time](VM&, const VM::t_extargs&) -> VM::t_data
+	{
+		return VM::t_data{std::in_place_index<VM::m_intidx>,
+			std::chrono::steady_clock::now() < end_time ? 1 : 0};
+	});
+
+	// loop until the time is up, the service routine counts the interrupts
+	CodeBuilder prog;
+	CodeBuilder::Label loop = prog.NewLabel();
+	prog.Bind(loop);
+	prog.Op(OpCode::EXTCALLI);
+	prog.Raw(idx_running);
+	prog.PushInt(1);
+	prog.Op(OpCode::EQU);
+	prog.PushLabel(loop, false);
+	prog.Op(OpCode::JMPCND);
+	prog.Op(OpCode::HALT);
+
+	VM::t_addr isr = prog.GetPos();
+	prog.Op(OpCode::EXTCALLI);
+	prog.Raw(idx_count);
+	prog.Op(OpCode::IRET);
+	prog.Resolve();
+
+	vm.SetMem(0, prog.GetCode().data(), prog.GetCode().size(), true);
+	vm.SetISR(0, isr);
+	vm.SetTimer(period);
+	vm.Run();
+	vm.SetTimer(std::nullopt);
+
+	// the interrupts can only be delayed, but more of them arrive than
+	// the process-wide wheel with its resolution of a millisecond could deliver
+	const double expected = double(run_time / period);
+	if(num_irqs > expected + 1. || num_irqs < expected * 0.4)
+	{
+		std::cerr << "Vm timer with period "
+			<< std::chrono::duration<double, std::micro>(period).count() << " us"
+			<< ": expected " << expected << " interrupts, got " << num_irqs
+			<< "." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+int main()
+{
+	bool ok = true;
+
+	// periods in the first and second wheel
+	ok = test_wheel(1ms, { 1ms, 3ms, 10ms, 70ms, 200ms }, 100) && ok;
+
+	// periods in the third wheel
+	ok = test_wheel(10us, { 100us, 1ms, 45ms, 130ms }, 10) && ok;
+
+	// vm timer interrupts from a wheel with a finer resolution
+	ok = test_vm(10us, 200us) && ok;
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,403 @@
+/**
+ * test of the bytecode verifier and benchmark of the check-free mode
+ * @author Tobias Weber (orcid: 0000-0002-7230-1932)
+ * @date 18-oct-2026
+ * @license see 'LICENSE.EUPL' file
+ *
+ * Usage: vm_verify [compiled programs...]
+ * Checks that a valid program passes the verifier and gives the same
+ * result with and without bounds checks and that invalid programs are
+ * rejected. The given programs (e.g. the .bin files created by script_run
+ * from the script_tests) are also verified. Afterwards, the time of the
+ * valid program with and without bounds checks is measured.
+ */
+
+#include "codegen/code_builder.h"
+#include "vm/vm.h"
+
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <chrono>
+
+using t_clock = std::chrono::steady_clock;
+using t_duration = std::chrono::duration<double>;
+
+
+/**
+ * sums up the numbers below the given one using a function for the addition
+ */
+static std::vector<VM::t_byte> create_sum(VM::t_int num)
+{
+	CodeBuilder prog;
+
+	// variables are stored below the frame size
+	constexpr VM::t_addr var_size = VM::m_bytesize + VM::m_intsize;
+	constexpr VM::t_addr var_i = -(VM::m_addrsize + var_size);
+	constexpr VM::t_addr var_sum = -(VM::m_addrsize + 2*var_size);
+
+	// global variables i and sum
+	prog.Op(OpCode::FRAME);
+	prog.Raw(static_cast<VM::t_addr>(VM::m_addrsize + 2*var_size));
+	prog.PushInt(0);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::WRMEM);
+	prog.PushInt(0);
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::WRMEM);
+
+	// loop condition
+	CodeBuilder::Label loop = prog.NewLabel();
+	prog.Bind(loop);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	prog.PushInt(num);
+	prog.Op(OpCode::LT);
+	prog.Op(OpCode::NOT);
+	CodeBuilder::Label end = prog.NewLabel();
+	prog.PushLabel(end, false);
+	prog.Op(OpCode::JMPCND);
+
+	// sum = add(sum, i)
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::RDMEM);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	CodeBuilder::Label func = prog.NewLabel();
+	prog.PushLabel(func, false);
+	prog.Op(OpCode::CALL);
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::WRMEM);
+
+	// i = i + 1
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::RDMEM);
+	prog.PushInt(1);
+	prog.Op(OpCode::ADD);
+	prog.PushAddr(VMType::ADDR_GBP, var_i);
+	prog.Op(OpCode::WRMEM);
+	prog.PushLabel(loop, false);
+	prog.Op(OpCode::JMP);
+
+	// leave the sum on the stack
+	prog.Bind(end);
+	prog.PushAddr(VMType::ADDR_GBP, var_sum);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::HALT);
+
+	// function add(a, b) with a local variable
+	prog.Bind(func);
+	prog.Op(OpCode::FRAME);
+	prog.Raw(static_cast<VM::t_addr>(VM::m_addrsize + var_size));
+	prog.PushAddr(VMType::ADDR_BP_ARG, 2);
+	prog.Op(OpCode::RDMEM);
+	prog.PushAddr(VMType::ADDR_BP_ARG, 3);
+	prog.Op(OpCode::RDMEM);
+	prog.Op(OpCode::ADD);
+	prog.PushAddr(VMType::ADDR_BP, -(VM::m_addrsize + var_size));
+	prog.Op(OpCode::WRMEM);
+	prog.PushAddr(VMType::ADDR_BP, -(VM::m_addrsize + var_size));
+	prog.Op(OpCode::RDMEM);
+	prog.PushInt(2);
+	prog.Op(OpCode::RET);
+
+	prog.Resolve();
+	return prog.Release();
+}
+
+
+/**
+ * invalid programs
+ */
+static std::vector<std::pair<std::string, std::vector<VM::t_byte>>> create_invalid()
+{
+	std::vector<std::pair<std::string, std::vector<VM::t_byte>>> progs;
+
+	{
+		CodeBuilder prog;
+		prog.Op(OpCode::NOP);
+		prog.PushAddr(VMType::ADDR_MEM, 2);
+		prog.Op(OpCode::JMP);
+		progs.emplace_back("jump into an instruction", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushAddr(VMType::ADDR_MEM, 0);
+		prog.Op(OpCode::NOP);
+		prog.Op(OpCode::JMP);
+		progs.emplace_back("jump to a computed address", prog.Release());
+	}
+	{
+		// the offset would overflow when added to the instruction's address
+		CodeBuilder prog;
+		prog.Op(OpCode::NOP);
+		prog.PushAddr(VMType::ADDR_IP, std::numeric_limits<VM::t_addr>::max() - 2);
+		prog.Op(OpCode::JMP);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("relative jump out of range", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushAddr(VMType::ADDR_IP, -0x100);
+		prog.Op(OpCode::CALL);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("relative call before the code", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushAddr(VMType::ADDR_GBP, -0x1000);
+		prog.Op(OpCode::WRMEM);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("variable outside the stack frame", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushAddr(VMType::ADDR_GBP, -8);
+		prog.Op(OpCode::WRMEM);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("variable overlapping the frame size", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushAddr(VMType::ADDR_SP, 0);
+		prog.Op(OpCode::WRMEM);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("variable relative to the stack pointer", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.Op(OpCode::ADD);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("stack underflow", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushInt(2);
+		prog.Op(OpCode::LT);
+		prog.PushInt(1);
+		prog.Op(OpCode::ADD);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("boolean used as value", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushAddr(VMType::ADDR_MEM, 0);
+		prog.Op(OpCode::JMPCND);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("value used as condition", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.Op(OpCode::UNTAGI);
+		prog.PushInt(2);
+		prog.Op(OpCode::ADD);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("untagged int used as value", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.Op(OpCode::UNTAGI);
+		prog.PushInt(2);
+		prog.Op(OpCode::UNTAGI);
+		prog.Op(OpCode::FADD);
+		prog.Op(OpCode::TAGF);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("untagged int used as real", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.Op(OpCode::PUSHI);
+		prog.Raw(VM::t_int{1});
+		prog.PushInt(2);
+		prog.Op(OpCode::ADD);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("untagged constant used as value", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		CodeBuilder::Label func = prog.NewLabel();
+		prog.PushLabel(func, false);
+		prog.Op(OpCode::CALL);
+		prog.Op(OpCode::HALT);
+		prog.Bind(func);
+		prog.PushAddr(VMType::ADDR_BP_ARG, 2);
+		prog.Op(OpCode::RDMEM);
+		prog.Op(OpCode::UNTAGI);
+		prog.Op(OpCode::IUSUB);
+		prog.PushInt(1);
+		prog.Op(OpCode::RET);
+		prog.Resolve();
+		progs.emplace_back("untagged return value", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(0);
+		prog.Op(OpCode::RET);
+		progs.emplace_back("return from the main program", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.Op(OpCode::NOP);
+		progs.emplace_back("missing halt", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		prog.PushInt(2);
+		CodeBuilder::Label func = prog.NewLabel();
+		prog.PushLabel(func, false);
+		prog.Op(OpCode::CALL);
+		prog.Op(OpCode::HALT);
+		prog.Bind(func);
+		prog.PushAddr(VMType::ADDR_BP_ARG, 4);
+		prog.Op(OpCode::RDMEM);
+		prog.PushInt(2);
+		prog.Op(OpCode::RET);
+		prog.Resolve();
+		progs.emplace_back("invalid argument index", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushInt(1);
+		CodeBuilder::Label func = prog.NewLabel();
+		prog.PushLabel(func, false);
+		prog.Op(OpCode::CALL);
+		prog.Op(OpCode::HALT);
+		prog.Bind(func);
+		prog.PushInt(2);
+		prog.Op(OpCode::RET);
+		prog.Resolve();
+		progs.emplace_back("missing function argument", prog.Release());
+	}
+	{
+		// each iteration leaves a value on the stack
+		CodeBuilder prog;
+		prog.PushInt(1);
+		CodeBuilder::Label loop = prog.NewLabel();
+		prog.Bind(loop);
+		prog.PushInt(1);
+		prog.PushInt(1);
+		prog.PushInt(1);
+		prog.Op(OpCode::EQU);
+		prog.PushLabel(loop, false);
+		prog.Op(OpCode::JMPCND);
+		prog.Op(OpCode::ADD);
+		prog.Op(OpCode::HALT);
+		prog.Resolve();
+		progs.emplace_back("unknown number of values", prog.Release());
+	}
+	{
+		CodeBuilder prog;
+		prog.PushStr("unknown_function");
+		prog.Op(OpCode::EXTCALL);
+		prog.Op(OpCode::HALT);
+		progs.emplace_back("unknown external function", prog.Release());
+	}
+
+	return progs;
+}
+
+
+/**
+ * run a program with or without bounds checks
+ */
+static VM::t_data run_vm(const std::vector<VM::t_byte>& prog, bool verify, double& time)
+{
+	VM vm(0x1000);
+	vm.SetMem(0, prog.data(), prog.size(), true);
+	if(verify)
+		vm.Verify();
+
+	auto start_time = t_clock::now();
+	vm.Run();
+	time = t_duration{t_clock::now() - start_time}.count();
+
+	return vm.TopData();
+}
+
+
+int main(int argc, char** argv)
+{
+	bool ok = true;
+
+	// valid program
+	constexpr VM::t_int num = 20000;
+	std::vector<VM::t_byte> sum = create_sum(num);
+	double time_checked = 0., time_verified = 0.;
+	try
+	{
+		VM::t_data result_checked = run_vm(sum, false, time_checked);
+		VM::t_data result_verified = run_vm(sum, true, time_verified);
+
+		if(result_checked != result_verified ||
+			std::get<VM::m_intidx>(result_verified) != num*(num - 1)/2)
+		{
+			std::cerr << "Wrong result of the verified program." << std::endl;
+			ok = false;
+		}
+	}
+	catch(const std::exception& err)
+	{
+		std::cerr << "Valid program: " << err.what() << std::endl;
+		ok = false;
+	}
+
+	// invalid programs
+	for(const auto& [name, prog] : create_invalid())
+	{
+		VM vm(0x1000);
+		vm.SetMem(0, prog.data(), prog.size(), true);
+
+		try
+		{
+			vm.Verify();
+			std::cerr << "Program with " << name << " not rejected." << std::endl;
+			ok = false;
+		}
+		catch(const std::exception&)
+		{
+		}
+
+		if(vm.IsVerified())
+			ok = false;
+	}
+
+	// compiled programs
+	for(int arg=1; arg<argc; ++arg)
+	{
+		std::ifstream ifstr(argv[arg], std::ios_base::binary);
+		std::vector<VM::t_byte> prog{
+			std::istreambuf_iterator<char>(ifstr),
+			std::istreambuf_iterator<char>() };
+
+		VM vm(4096);
+		try
+		{
+			vm.SetMem(0, prog.data(), prog.size(), true);
+			vm.Verify();
+			std::cout << argv[arg] << ": verified." << std::endl;
+		}
+		catch(const std::exception& err)
+		{
+			std::cerr << argv[arg] << ": " << err.what() << std::endl;
+			ok = false;
+		}
+	}
+
+	std::cout << (ok ? "OK." : "Failed.") << std::endl;
+	std::cout << "Time with bounds checks: " << time_checked << " s, "
+		<< "verified: " << time_verified << " s." << std::endl;
+
+	return ok ? 0 : -1;
+}